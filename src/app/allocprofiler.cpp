@@ -0,0 +1,167 @@
+/*
+ * allocprofiler.cpp — Heap allocation counters per pipeline stage
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "allocprofiler.h"
+
+#ifdef PRETTYREADER_ALLOC_PROFILING
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace AllocProfiler {
+thread_local int t_currentStage = -1;
+}
+
+namespace {
+
+// One cache line per stage so batch workers charging different stages
+// do not contend
+struct alignas(64) StageCounters {
+    std::atomic<quint64> allocations{0};
+    std::atomic<quint64> bytes{0};
+};
+
+StageCounters g_counters[AllocProfiler::StageCount];
+
+inline void record(std::size_t size)
+{
+    const int stage = AllocProfiler::t_currentStage;
+    if (stage < 0)
+        return;
+    g_counters[stage].allocations.fetch_add(1, std::memory_order_relaxed);
+    g_counters[stage].bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+// Definitions in the executable take precedence over libc's for every
+// shared object, Qt and libstdc++'s operator new included.
+extern "C" {
+
+void *__libc_malloc(std::size_t size) noexcept;
+void *__libc_calloc(std::size_t count, std::size_t size) noexcept;
+void *__libc_realloc(void *ptr, std::size_t size) noexcept;
+
+void *malloc(std::size_t size) noexcept
+{
+    record(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept
+{
+    record(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, std::size_t size) noexcept
+{
+    if (size > 0)
+        record(size);
+    return __libc_realloc(ptr, size);
+}
+
+} // extern "C"
+
+#else
+
+void *operator new(std::size_t size)
+{
+    record(size);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    record(size);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+
+#endif
+
+#endif // PRETTYREADER_ALLOC_PROFILING
+
+namespace AllocProfiler {
+
+Counters counters(Stage stage)
+{
+    Counters c;
+#ifdef PRETTYREADER_ALLOC_PROFILING
+    c.allocations = g_counters[stage].allocations.load(std::memory_order_relaxed);
+    c.bytes = g_counters[stage].bytes.load(std::memory_order_relaxed);
+#else
+    Q_UNUSED(stage);
+#endif
+    return c;
+}
+
+void reset()
+{
+#ifdef PRETTYREADER_ALLOC_PROFILING
+    for (auto &c : g_counters) {
+        c.allocations.store(0, std::memory_order_relaxed);
+        c.bytes.store(0, std::memory_order_relaxed);
+    }
+#endif
+}
+
+const char *stageName(Stage stage)
+{
+    switch (stage) {
+    case Parse:         return "parse";
+    case Layout:        return "layout";
+    case Shaping:       return "shaping";
+    case PdfGeneration: return "pdf";
+    case Painting:      return "painting";
+    case StageCount:    break;
+    }
+    return "?";
+}
+
+QString report(int pages)
+{
+    if (!isEnabled())
+        return {};
+
+    QString text;
+    for (int i = 0; i < StageCount; ++i) {
+        const Stage stage = static_cast<Stage>(i);
+        const Counters c = counters(stage);
+        text += QStringLiteral("alloc %1 %2 allocations, %3 KiB")
+                    .arg(QLatin1String(stageName(stage)), -9)
+                    .arg(c.allocations, 10)
+                    .arg(c.bytes / 1024.0, 10, 'f', 1);
+        if (pages > 0)
+            text += QStringLiteral("  (%1 allocations, %2 KiB per page)")
+                        .arg(c.allocations / qreal(pages), 0, 'f', 1)
+                        .arg(c.bytes / 1024.0 / pages, 0, 'f', 1);
+        text += QLatin1Char('\n');
+    }
+    return text;
+}
+
+} // namespace AllocProfiler
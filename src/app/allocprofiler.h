@@ -0,0 +1,89 @@
+/*
+ * allocprofiler.h — Heap allocation counters per pipeline stage
+ *
+ * Built with -DPRETTYREADER_ALLOC_PROFILING=ON, the allocation functions
+ * are replaced process-wide and every allocation made while a Scope is
+ * alive on the allocating thread is charged to that scope's stage.  On
+ * glibc malloc/calloc/realloc are interposed, which also catches QString
+ * and QList storage (Qt allocates that with malloc, not operator new);
+ * elsewhere only the global operator new is replaced.
+ *
+ * Scopes nest: the innermost one wins, so shaping done during layout is
+ * counted under Shaping only and the stage totals add up.
+ *
+ * Without the option Scope is an empty inline class, the hooks are not
+ * compiled and isEnabled() returns false.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_ALLOCPROFILER_H
+#define PRETTYREADER_ALLOCPROFILER_H
+
+#include <QString>
+#include <QtGlobal>
+
+namespace AllocProfiler {
+
+enum Stage {
+    Parse,          // ContentBuilder::build
+    Layout,         // Engine::layout / layoutContinuous
+    Shaping,        // TextShaper::shape
+    PdfGeneration,  // PdfGenerator::generate
+    Painting,       // QtBoxRenderer passes in WebViewItem
+    StageCount
+};
+
+struct Counters {
+    quint64 allocations = 0;
+    quint64 bytes = 0;   // requested sizes; frees are not subtracted
+};
+
+#ifdef PRETTYREADER_ALLOC_PROFILING
+
+extern thread_local int t_currentStage;
+
+class Scope
+{
+public:
+    explicit Scope(Stage stage)
+        : m_previous(t_currentStage)
+    {
+        t_currentStage = stage;
+    }
+    ~Scope() { t_currentStage = m_previous; }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    int m_previous;
+};
+
+constexpr bool isEnabled() { return true; }
+
+#else
+
+class Scope
+{
+public:
+    explicit Scope(Stage) {}
+};
+
+constexpr bool isEnabled() { return false; }
+
+#endif
+
+// Totals since the last reset(), summed over all threads
+Counters counters(Stage stage);
+void reset();
+
+const char *stageName(Stage stage);
+
+// One line per stage with allocations and bytes, plus per-page figures
+// when @p pages > 0.  Empty when profiling is not compiled in.
+QString report(int pages = 0);
+
+} // namespace AllocProfiler
+
+#endif // PRETTYREADER_ALLOCPROFILER_H
@@ -0,0 +1,283 @@
+/*
+ * batchmain.cpp — Headless batch conversion of markdown files to PDF
+ *
+ * Runs as a supervisor that spreads the documents over worker processes
+ * (BatchProcessExporter), each re-running this program with --worker and
+ * the same style options.  A document that crashes or hangs its worker
+ * is reported and the run goes on; failures are listed on stderr.  An
+ * input whose PDF would overwrite an earlier input's (the same base name
+ * in different directories with -o) fails without being converted.
+ *
+ * Usage:
+ *   prettyreader-batch [-j N] [-o DIR] [--type-set ID] [--palette ID]
+ *                      [--page-template ID] [--language LANG]
+ *                      [--no-hyphenation] [--no-short-words]
+ *                      [--reproducible] [--cache] [--timeout SECONDS]
+ *                      FILE.md...
+ *
+ * Exits with 0 if every document was converted, 1 if any failed and 2 on
+ * usage errors.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "batchpdfexporter.h"
+#include "batchprocessexporter.h"
+#include "exportcache.h"
+#include "hyphenator.h"
+#include "pagelayout.h"
+#include "pagetemplatemanager.h"
+#include "palettemanager.h"
+#include "pdfexportoptions.h"
+#include "shortwords.h"
+#include "stylemanager.h"
+#include "themecomposer.h"
+#include "thememanager.h"
+#include "typesetmanager.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QTextStream>
+
+#include <memory>
+
+namespace {
+
+// Resolves @p requested among @p available, falling back to @p preferred
+// and then the first one when nothing was requested
+QString pickId(const QStringList &available, const QString &requested, const QString &preferred)
+{
+    if (!requested.isEmpty())
+        return available.contains(requested) ? requested : QString();
+    if (available.isEmpty())
+        return {};
+    return available.contains(preferred) ? preferred : available.first();
+}
+
+struct Options {
+    QCommandLineOption worker{QStringLiteral("worker"),
+        QStringLiteral("Serve documents from the supervisor on stdin/stdout.")};
+    QCommandLineOption jobs{QStringList{QStringLiteral("j"), QStringLiteral("jobs")},
+        QStringLiteral("Worker processes (default: one per core)."), QStringLiteral("n")};
+    QCommandLineOption outputDir{QStringList{QStringLiteral("o"), QStringLiteral("output-dir")},
+        QStringLiteral("Directory for the PDFs (default: next to each input)."),
+        QStringLiteral("dir")};
+    QCommandLineOption typeSet{QStringLiteral("type-set"),
+        QStringLiteral("Type set id (default: default)."), QStringLiteral("id")};
+    QCommandLineOption palette{QStringLiteral("palette"),
+        QStringLiteral("Color palette id (default: default-light)."), QStringLiteral("id")};
+    QCommandLineOption pageTemplate{QStringLiteral("page-template"),
+        QStringLiteral("Page template id (default: default)."), QStringLiteral("id")};
+    QCommandLineOption language{QStringLiteral("language"),
+        QStringLiteral("Hyphenation and short-words language (default en_US)."),
+        QStringLiteral("lang"), QStringLiteral("en_US")};
+    QCommandLineOption noHyphenation{QStringLiteral("no-hyphenation"),
+        QStringLiteral("Do not hyphenate.")};
+    QCommandLineOption noShortWords{QStringLiteral("no-short-words"),
+        QStringLiteral("Do not bind short words to the next one.")};
+    QCommandLineOption reproducible{QStringLiteral("reproducible"),
+        QStringLiteral("Omit the creation date (see SOURCE_DATE_EPOCH).")};
+    QCommandLineOption cache{QStringLiteral("cache"),
+        QStringLiteral("Reuse PDFs of unchanged documents from the export cache.")};
+    QCommandLineOption timeout{QStringLiteral("timeout"),
+        QStringLiteral("Seconds one document may take before its worker is killed (default 300, 0 = none)."),
+        QStringLiteral("seconds"), QStringLiteral("300")};
+
+    Options() { worker.setFlags(QCommandLineOption::HiddenFromHelp); }
+
+    // Options a worker needs to set up the same styles and export options
+    QList<const QCommandLineOption *> forwarded() const
+    {
+        return {&typeSet, &palette, &pageTemplate, &language, &noHyphenation,
+                &noShortWords, &reproducible, &cache};
+    }
+};
+
+// Same composition as MainWindow's theme picker
+bool composeStyles(const QCommandLineParser &parser, const Options &opts,
+                   StyleManager *styleManager, PageLayout *pageLayout)
+{
+    ThemeManager themeManager;
+    TypeSetManager typeSets;
+    PaletteManager palettes;
+    PageTemplateManager pageTemplates;
+    ThemeComposer composer(&themeManager);
+
+    const QString typeSetId = pickId(typeSets.availableTypeSets(),
+                                     parser.value(opts.typeSet), QStringLiteral("default"));
+    const QString paletteId = pickId(palettes.availablePalettes(),
+                                     parser.value(opts.palette), QStringLiteral("default-light"));
+    const QString templateId = pickId(pageTemplates.availableTemplates(),
+                                      parser.value(opts.pageTemplate), QStringLiteral("default"));
+    if ((parser.isSet(opts.typeSet) && typeSetId.isEmpty())
+        || (parser.isSet(opts.palette) && paletteId.isEmpty())
+        || (parser.isSet(opts.pageTemplate) && templateId.isEmpty())) {
+        QTextStream(stderr) << "prettyreader-batch: unknown type set, palette or page template\n";
+        return false;
+    }
+    if (!typeSetId.isEmpty())
+        composer.setTypeSet(typeSets.typeSet(typeSetId));
+    if (!paletteId.isEmpty())
+        composer.setColorPalette(palettes.palette(paletteId));
+    composer.compose(styleManager);
+
+    if (!templateId.isEmpty())
+        *pageLayout = pageTemplates.pageTemplate(templateId).pageLayout;
+    const QColor pageBg = composer.currentPalette().pageBackground();
+    if (pageBg.isValid())
+        pageLayout->pageBackground = pageBg;
+    return true;
+}
+
+int runWorker(const QCommandLineParser &parser, const Options &opts)
+{
+    StyleManager styleManager;
+    PageLayout pageLayout;
+    if (!composeStyles(parser, opts, &styleManager, &pageLayout))
+        return 2;
+
+    const QString language = parser.value(opts.language);
+    Hyphenator hyphenator;
+    const bool hyphenate = !parser.isSet(opts.noHyphenation) && hyphenator.loadDictionary(language);
+    ShortWords shortWords;
+    shortWords.setLanguage(language);
+
+    BatchPdfExporter exporter;
+    exporter.setStyleManager(&styleManager);
+    exporter.setPageLayout(pageLayout);
+    exporter.setHyphenator(hyphenate ? &hyphenator : nullptr);
+    exporter.setShortWords(parser.isSet(opts.noShortWords) ? nullptr : &shortWords);
+    exporter.setHyphenateJustifiedText(hyphenate);
+    std::unique_ptr<ExportCache> cache;
+    if (parser.isSet(opts.cache)) {
+        cache = std::make_unique<ExportCache>();
+        exporter.setExportCache(cache.get());
+    }
+
+    PdfExportOptions options;
+    options.reproducible = parser.isSet(opts.reproducible);
+    return BatchProcessExporter::serveWorker(&exporter, options);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("prettyreader-batch"));
+
+    const Options opts;
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QStringLiteral("Converts markdown files to PDF in isolated worker processes."));
+    parser.addHelpOption();
+    parser.addOption(opts.worker);
+    parser.addOption(opts.jobs);
+    parser.addOption(opts.outputDir);
+    for (const QCommandLineOption *option : opts.forwarded())
+        parser.addOption(*option);
+    parser.addOption(opts.timeout);
+    parser.addPositionalArgument(QStringLiteral("files"),
+        QStringLiteral("Markdown documents."), QStringLiteral("FILE.md..."));
+    parser.process(app);
+
+    if (parser.isSet(opts.worker))
+        return runWorker(parser, opts);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        err << "prettyreader-batch: no input files\n";
+        return 2;
+    }
+    {
+        // Catch bad style options here rather than in every worker
+        StyleManager styleManager;
+        PageLayout pageLayout;
+        if (!composeStyles(parser, opts, &styleManager, &pageLayout))
+            return 2;
+    }
+    QDir outputDir;
+    if (parser.isSet(opts.outputDir)) {
+        outputDir.setPath(parser.value(opts.outputDir));
+        if (!outputDir.mkpath(QStringLiteral("."))) {
+            err << "prettyreader-batch: cannot create " << outputDir.path() << "\n";
+            return 2;
+        }
+    }
+
+    // Inputs that would overwrite an earlier input's PDF (same base name
+    // with -o, or the same file twice) fail up front; the rest convert
+    QList<BatchProcessExporter::Job> jobs;
+    jobs.reserve(files.size());
+    QHash<QString, QString> outputInputs; // cleaned output path -> input
+    int duplicates = 0;
+    for (const QString &file : files) {
+        const QFileInfo fi(file);
+        const QString pdfName = fi.completeBaseName() + QLatin1String(".pdf");
+        const QString outputPath = parser.isSet(opts.outputDir)
+            ? outputDir.absoluteFilePath(pdfName)
+            : fi.absoluteDir().filePath(pdfName);
+        const QString outputKey = QDir::cleanPath(outputPath);
+        const auto earlier = outputInputs.constFind(outputKey);
+        if (earlier != outputInputs.constEnd()) {
+            err << "failed   " << fi.absoluteFilePath() << ": " << outputPath
+                << " is already written for " << earlier.value() << Qt::endl;
+            ++duplicates;
+            continue;
+        }
+        outputInputs.insert(outputKey, fi.absoluteFilePath());
+        jobs.append({fi.absoluteFilePath(), outputPath});
+    }
+
+    QStringList workerArgs{QLatin1String("--worker")};
+    for (const QCommandLineOption *option : opts.forwarded()) {
+        if (!parser.isSet(*option))
+            continue;
+        const QString name = QLatin1String("--") + option->names().constLast();
+        if (option->valueName().isEmpty())
+            workerArgs << name;
+        else
+            workerArgs << name << parser.value(*option);
+    }
+
+    BatchProcessExporter exporter;
+    exporter.setWorkerProgram(QCoreApplication::applicationFilePath(), workerArgs);
+    exporter.setWorkerCount(parser.value(opts.jobs).toInt());
+    exporter.setJobTimeout(qMax(0, parser.value(opts.timeout).toInt()) * 1000);
+
+    int exitCode = 0;
+    QObject::connect(&exporter, &BatchProcessExporter::jobFinished,
+                     [&](int index, bool ok, const QString &error) {
+        if (!ok)
+            err << "failed   " << jobs[index].inputPath << ": " << error << Qt::endl;
+    });
+    QElapsedTimer timer;
+    timer.start();
+    QObject::connect(&exporter, &BatchProcessExporter::finished,
+                     [&](int succeeded, int reused, int failed, bool) {
+        failed += duplicates;
+        out << QStringLiteral("%1 converted (%2 unchanged), %3 failed in %4 s\n")
+                   .arg(succeeded).arg(reused).arg(failed)
+                   .arg(timer.elapsed() / 1000.0, 0, 'f', 1);
+        exitCode = failed > 0 ? 1 : 0;
+        if (parser.isSet(opts.cache))
+            ExportCache().prune();
+        // May come before app.exec() if no worker could be started
+        QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+    });
+
+    if (!exporter.start(jobs))
+        return 2;
+    app.exec();
+    return exitCode;
+}
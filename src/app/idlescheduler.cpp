@@ -0,0 +1,86 @@
+/*
+ * idlescheduler.cpp — Speculative work while the user is reading
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "idlescheduler.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QTimer>
+
+IdleScheduler::IdleScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(1500);
+    connect(m_idleTimer, &QTimer::timeout, this, &IdleScheduler::runSlice);
+
+    // Zero interval: the next slice waits until pending events (including
+    // the input that should pause it) have been delivered
+    m_sliceTimer = new QTimer(this);
+    m_sliceTimer->setSingleShot(true);
+    m_sliceTimer->setInterval(0);
+    connect(m_sliceTimer, &QTimer::timeout, this, &IdleScheduler::runSlice);
+
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+IdleScheduler::~IdleScheduler()
+{
+    if (auto *app = QCoreApplication::instance())
+        app->removeEventFilter(this);
+}
+
+void IdleScheduler::schedule(const Step &step)
+{
+    m_tasks.append(step);
+    if (!m_sliceTimer->isActive())
+        m_idleTimer->start();
+}
+
+void IdleScheduler::cancelAll()
+{
+    m_tasks.clear();
+    m_idleTimer->stop();
+    m_sliceTimer->stop();
+}
+
+void IdleScheduler::setIdleDelay(int msecs)
+{
+    m_idleTimer->setInterval(msecs);
+}
+
+bool IdleScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+    case QEvent::TouchBegin:
+        if (!m_tasks.isEmpty()) {
+            m_sliceTimer->stop();
+            m_idleTimer->start();
+        }
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void IdleScheduler::runSlice()
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!m_tasks.isEmpty() && timer.elapsed() < m_sliceBudgetMs) {
+        if (m_tasks.first()())
+            m_tasks.removeFirst();
+    }
+    if (!m_tasks.isEmpty() && !m_idleTimer->isActive())
+        m_sliceTimer->start();
+}
@@ -0,0 +1,61 @@
+/*
+ * idlescheduler.h — Speculative work while the user is reading
+ *
+ * Runs queued tasks on the GUI thread in short slices once input has
+ * been quiet for a moment, so that states the user is likely to ask for
+ * next (the other view mode, the export layout, neighbouring pages) are
+ * ready before they are requested.  Layout shares the FontManager and
+ * TextShaper with the GUI thread, which is why this is not a worker.
+ *
+ * Any key, mouse button, wheel or touch event stops the current slice
+ * from being followed by another until the user is idle again; the owner
+ * cancels and re-queues whenever the state the tasks were built from
+ * changes.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_IDLESCHEDULER_H
+#define PRETTYREADER_IDLESCHEDULER_H
+
+#include <QList>
+#include <QObject>
+
+#include <functional>
+
+class QTimer;
+
+class IdleScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Does a bounded piece of work; returns true once the task is done.
+    // Steps must not schedule() or cancelAll().
+    using Step = std::function<bool()>;
+
+    explicit IdleScheduler(QObject *parent = nullptr);
+    ~IdleScheduler() override;
+
+    // Tasks run in the order they were queued
+    void schedule(const Step &step);
+    void cancelAll();
+    bool isIdle() const { return m_tasks.isEmpty(); }
+
+    // Quiet time before work (re)starts, and the time one slice may take
+    void setIdleDelay(int msecs);
+    void setSliceBudget(int msecs) { m_sliceBudgetMs = msecs; }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void runSlice();
+
+    QList<Step> m_tasks;
+    QTimer *m_idleTimer = nullptr;
+    QTimer *m_sliceTimer = nullptr;
+    int m_sliceBudgetMs = 8;
+};
+
+#endif // PRETTYREADER_IDLESCHEDULER_H
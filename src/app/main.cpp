@@ -12,10 +12,13 @@
 #endif
 
 #include "mainwindow.h"
+#include "startuptrace.h"
 
 int main(int argc, char *argv[])
 {
+    StartupTrace::start();
     QApplication app(argc, argv);
+    StartupTrace::mark("application");
 
     KLocalizedString::setApplicationDomain("prettyreader");
 
@@ -45,8 +48,10 @@ int main(int argc, char *argv[])
         QStringLiteral("[file...]"));
     parser.process(app);
     aboutData.processCommandLine(&parser);
+    StartupTrace::mark("command line");
 
     MainWindow window;
+    StartupTrace::mark("main window");
 
 #ifdef HAVE_KDBUSSERVICE
     KDBusService service(KDBusService::Unique);
@@ -95,7 +100,9 @@ int main(int argc, char *argv[])
                 window.openFile(QUrl::fromLocalFile(fi.absoluteFilePath()));
         }
     }
+    StartupTrace::mark("open files");
 
     window.show();
+    StartupTrace::mark("show");
     return app.exec();
 }
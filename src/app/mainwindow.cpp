@@ -15,17 +15,23 @@
 #include "sidebar.h"
 #include "toolview.h"
 #include "codeblockhighlighter.h"
+#include "batchpdfexporter.h"
 #include "documentbuilder.h"
 #include "documenttab.h"
 #include "documentview.h"
+#include "exportcache.h"
 #include "filebrowserdock.h"
 #include "hyphenator.h"
+#include "idlescheduler.h"
 #include "markdownhighlighter.h"
 #include "metadatastore.h"
 #include "rtfexporter.h"
 #include "shortwords.h"
+#include "startuptrace.h"
+#include "startupwarmup.h"
 #include "tocwidget.h"
 #include "printcontroller.h"
+#include "stylediff.h"
 #include "stylemanager.h"
 #include "typedockwidget.h"
 #include "themepickerdock.h"
@@ -44,6 +50,7 @@
 
 // PDF rendering pipeline (Phase 4)
 #include "contentbuilder.h"
+#include "stylebinder.h"
 #include "fontmanager.h"
 #include "textshaper.h"
 #include "layoutengine.h"
@@ -57,8 +64,11 @@
 #include <QActionGroup>
 #include <QApplication>
 #include <QCloseEvent>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileSystemWatcher>
 #include <QFileInfo>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -66,7 +76,10 @@
 #include <QMenuBar>
 #include <QPalette>
 #include <QPlainTextEdit>
+#include <QProgressDialog>
 #include <QScrollBar>
+#include <QSet>
+#include <QShowEvent>
 #include <QAbstractTextDocumentLayout>
 #include <QSlider>
 #include <QSplitter>
@@ -78,6 +91,8 @@
 #include <QVBoxLayout>
 
 #include <functional>
+#include <memory>
+#include <utility>
 
 MainWindow::MainWindow(QWidget *parent)
     : KXmlGuiWindow(parent)
@@ -122,6 +137,13 @@ MainWindow::MainWindow(QWidget *parent)
                 m_filePathLabel->clear();
         }
 
+        // Wake the new tab before anything reads its view
+        if (m_activeTab && m_activeTab != tab)
+            m_activeTab->setActive(false);
+        m_activeTab = tab;
+        if (tab)
+            tab->setActive(true);
+
         // Sync view mode actions with current tab state
         if (tab && tab->isSourceMode()) {
             if (m_sourceViewAction)
@@ -134,9 +156,13 @@ MainWindow::MainWindow(QWidget *parent)
                 m_printViewAction->setChecked(true);
         }
 
-        // Rebuild stale tabs (composition changed since last render)
+        // Pick up changes saved while the tab was in the background
+        if (tab && tab->isSourceStale())
+            reloadCurrentDocument();
+
+        // Restyle stale tabs (composition changed since last render)
         if (tab && tab->compositionGeneration() < m_compositionGeneration) {
-            rebuildCurrentDocument();
+            restyleCurrentDocument();
         } else if (tab && tab->hasTocData()) {
             // Tab is current — just rebuild TOC from cached data
             m_tocWidget->buildFromContentModel(tab->cachedContentDoc(), tab->cachedSourceMap());
@@ -144,14 +170,45 @@ MainWindow::MainWindow(QWidget *parent)
             // Legacy path — rebuild TOC from QTextDocument
             m_tocWidget->buildFromDocument(tab->documentView()->document());
         }
+
+        scheduleIdleWork();
     });
 
+    m_restyleTimer = new QTimer(this);
+    m_restyleTimer->setSingleShot(true);
+    // Long enough to swallow the burst of edits from dragging a slider or
+    // colour picker, short enough for the preview to follow the control
+    m_restyleTimer->setInterval(30);
+    connect(m_restyleTimer, &QTimer::timeout, this, &MainWindow::restyleCurrentDocument);
+
+    m_hibernateTimer = new QTimer(this);
+    m_hibernateTimer->setInterval(60 * 1000);
+    connect(m_hibernateTimer, &QTimer::timeout, this, &MainWindow::hibernateIdleTabs);
+
+    m_fileWatcher = new QFileSystemWatcher(this);
+    m_reloadTimer = new QTimer(this);
+    m_reloadTimer->setSingleShot(true);
+    // Editors save in several steps (truncate and write, or write and
+    // rename); reload once they are done
+    m_reloadTimer->setInterval(200);
+    connect(m_reloadTimer, &QTimer::timeout, this, &MainWindow::reloadChangedFiles);
+
+    m_idleScheduler = new IdleScheduler(this);
+    connect(m_fileWatcher, &QFileSystemWatcher::fileChanged,
+            this, [this](const QString &path) {
+        m_changedFiles.insert(path);
+        m_reloadAttempts = 0;
+        m_reloadTimer->start();
+    });
+    m_hibernateTimer->start();
+
     m_themeManager = new ThemeManager(this);
     m_paletteManager = new PaletteManager(this);
     m_typeSetManager = new TypeSetManager(this);
     m_pageTemplateManager = new PageTemplateManager(this);
     m_themeComposer = new ThemeComposer(m_themeManager, this);
     m_metadataStore = new MetadataStore(this);
+    StartupTrace::mark("managers");
 
     // Typography engines
     m_hyphenator = new Hyphenator();
@@ -166,15 +223,18 @@ MainWindow::MainWindow(QWidget *parent)
         QStringLiteral(":/fonts/PrettySymbolsFallback.ttf"));
     m_textShaper->setFallbackFont(fallback);
 
-    // Apply settings
+    // Apply settings.  The dictionary itself is loaded by the warm-up,
+    // either in the background after show() or on first use.
     auto *settings = PrettyReaderSettings::self();
+    m_warmup = new StartupWarmup(m_fontManager, m_hyphenator, this);
     if (settings->hyphenationEnabled() || settings->hyphenateJustifiedText()) {
-        m_hyphenator->loadDictionary(settings->hyphenationLanguage());
+        m_warmup->setHyphenationLanguage(settings->hyphenationLanguage());
         m_hyphenator->setMinWordLength(settings->hyphenationMinWordLength());
     }
     if (settings->shortWordsEnabled()) {
         m_shortWords->setLanguage(settings->hyphenationLanguage());
     }
+    StartupTrace::mark("typography engines");
 
     setupSidebars();
 
@@ -198,8 +258,10 @@ MainWindow::MainWindow(QWidget *parent)
     m_rightSidebar->setCollapsed(true);
 
     setCentralWidget(m_splitter);
+    StartupTrace::mark("sidebars");
 
     setupActions();
+    StartupTrace::mark("actions");
 
     // A6: File path label (left-justified, auto-hides for temporary messages)
     m_filePathLabel = new QLabel;
@@ -257,16 +319,27 @@ MainWindow::MainWindow(QWidget *parent)
         }
         onCompositionApplied();
     }
+    StartupTrace::mark("default composition");
 
     restoreSession();
 
     // A1: Fresh launch = TOC open by default (saved session state takes priority)
     if (m_leftSidebar->isCollapsed())
         m_leftSidebar->showPanel(m_tocTabId);
+    StartupTrace::mark("session");
 }
 
 MainWindow::~MainWindow()
 {
+    // Waits for a running warm-up before its targets are deleted
+    delete m_warmup;
+    m_warmup = nullptr;
+
+    // Batch workers share the hyphenator and short-words tables
+    delete m_batchExporter;
+    m_batchExporter = nullptr;
+    delete m_exportCache;
+
     delete m_hyphenator;
     delete m_shortWords;
     delete m_textShaper;
@@ -286,8 +359,56 @@ void MainWindow::closeEvent(QCloseEvent *event)
     qApp->quit();
 }
 
+void MainWindow::showEvent(QShowEvent *event)
+{
+    KXmlGuiWindow::showEvent(event);
+
+    // Defer until the first frame has been painted
+    if (!event->spontaneous()) {
+        QTimer::singleShot(0, this, [this]() {
+            // With a document open the trace ends at its first painted page
+            if (m_tabWidget->count() == 0)
+                StartupTrace::finish("first frame");
+            startWarmup();
+        });
+    }
+}
+
+void MainWindow::startWarmup()
+{
+    if (!m_warmup || m_warmup->isFinished())
+        return;
+
+    // Fonts come from the composition that the first render will use
+    StyleManager *editingSm = m_typeDockWidget->currentStyleManager();
+    StyleManager *sm;
+    if (editingSm) {
+        sm = editingSm->clone(this);
+    } else {
+        sm = new StyleManager(this);
+        m_themeComposer->compose(sm);
+    }
+    QList<StartupWarmup::FontRequest> fonts = StartupWarmup::fontsForStyles(sm);
+    delete sm;
+
+    bool hershey = m_themeComposer->currentTypeSet().hersheyMode;
+    for (const auto &req : std::as_const(fonts)) {
+        if (req.family.startsWith(QLatin1String("Hershey ")))
+            hershey = true;
+    }
+
+    m_warmup->setFonts(fonts);
+    m_warmup->setLoadHersheyFonts(hershey);
+    m_warmup->start();
+}
+
 void MainWindow::onTabCloseRequested(int index)
 {
+    // A file is open in at most one tab (see openFile())
+    if (auto *tab = qobject_cast<DocumentTab *>(m_tabWidget->widget(index))) {
+        if (!tab->filePath().isEmpty())
+            m_fileWatcher->removePath(tab->filePath());
+    }
     m_tabWidget->removeTab(index);
 
     if (m_tabWidget->count() == 0) {
@@ -309,6 +430,8 @@ void MainWindow::setupSidebars()
 
     connect(m_fileBrowserWidget, &FileBrowserDock::fileActivated,
             this, &MainWindow::openFile);
+    connect(m_fileBrowserWidget, &FileBrowserDock::exportPdfRequested,
+            this, &MainWindow::exportPdfBatch);
 
     m_tocWidget = new TocWidget(this);
     auto *tocView = new ToolView(i18n("Contents"), m_tocWidget);
@@ -397,7 +520,7 @@ void MainWindow::setupSidebars()
         auto *view = currentDocumentView();
         if (view)
             view->setPageLayout(pl);
-        rebuildCurrentDocument();
+        m_restyleTimer->start();
     });
 
     // Double-click in Theme grid -> raise editing dock
@@ -475,6 +598,12 @@ void MainWindow::setupActions()
     exportPdf->setPriority(QAction::LowPriority);
     connect(exportPdf, &QAction::triggered, this, &MainWindow::onFileExportPdf);
 
+    // File > Export All Tabs as PDF
+    auto *exportAllPdf = ac->addAction(QStringLiteral("file_export_all_pdf"));
+    exportAllPdf->setText(i18n("Export All &Tabs as PDF..."));
+    exportAllPdf->setIcon(QIcon::fromTheme(QStringLiteral("document-export")));
+    connect(exportAllPdf, &QAction::triggered, this, &MainWindow::onFileExportAllPdf);
+
     // File > Export RTF
     auto *exportRtf = ac->addAction(QStringLiteral("file_export_rtf"));
     exportRtf->setText(i18n("Export as &RTF..."));
@@ -860,11 +989,23 @@ void MainWindow::onFileExportPdf()
         if (!tab)
             return;
 
+        m_warmup->join();
+
         QString filePath = tab->filePath();
+
+        // The document as shown is what gets exported, unless the source
+        // or the styles changed since it was built
+        const QByteArray &parseKey = tab->parseCache().key;
+        const bool shown = tab->hasTocData() && !parseKey.isEmpty()
+            && tab->compositionGeneration() == m_compositionGeneration
+            && !tab->isSourceStale()
+            && (!tab->isSourceMode()
+                || parseKey == QCryptographicHash::hash(tab->sourceText().toUtf8(),
+                                                        QCryptographicHash::Sha1));
         QString markdown;
-        if (tab->isSourceMode()) {
+        if (!shown && tab->isSourceMode()) {
             markdown = tab->sourceText();
-        } else {
+        } else if (!shown) {
             QFile file(filePath);
             if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
                 return;
@@ -872,38 +1013,52 @@ void MainWindow::onFileExportPdf()
             file.close();
         }
 
-        StyleManager *editingSm = m_typeDockWidget->currentStyleManager();
-        StyleManager *styleManager;
-        if (editingSm) {
-            styleManager = editingSm->clone(this);
-        } else {
-            styleManager = new StyleManager(this);
-            m_themeComposer->compose(styleManager);
-        }
-
         QFileInfo fi(filePath);
         PageLayout pl = m_pageDockWidget->currentPageLayout();
 
-        // Build content (needed for heading tree + page count)
-        ContentBuilder contentBuilder;
-        contentBuilder.setBasePath(fi.absolutePath());
-        contentBuilder.setStyleManager(styleManager);
-        if (PrettyReaderSettings::self()->hyphenationEnabled()
-            || PrettyReaderSettings::self()->hyphenateJustifiedText())
-            contentBuilder.setHyphenator(m_hyphenator);
-        if (PrettyReaderSettings::self()->shortWordsEnabled())
-            contentBuilder.setShortWords(m_shortWords);
-        contentBuilder.setFootnoteStyle(styleManager->footnoteStyle());
-        Content::Document contentDoc = contentBuilder.build(markdown);
-        view->applyLanguageOverrides(contentDoc);
+        // Content for the heading tree and the export
+        Content::Document contentDoc;
+        if (shown) {
+            contentDoc = tab->cachedContentDoc();
+        } else {
+            std::unique_ptr<StyleManager> styleManager(composeStyleManager());
+            ContentBuilder contentBuilder;
+            contentBuilder.setBasePath(fi.absolutePath());
+            contentBuilder.setStyleManager(styleManager.get());
+            if (PrettyReaderSettings::self()->hyphenationEnabled()
+                || PrettyReaderSettings::self()->hyphenateJustifiedText())
+                contentBuilder.setHyphenator(m_hyphenator);
+            if (PrettyReaderSettings::self()->shortWordsEnabled())
+                contentBuilder.setShortWords(m_shortWords);
+            contentBuilder.setFootnoteStyle(styleManager->footnoteStyle());
+            contentDoc = contentBuilder.build(markdown);
+            view->applyLanguageOverrides(contentDoc);
+        }
 
-        // Pre-layout to get page count for dialog
-        m_fontManager->resetUsage();
-        Layout::Engine preLayoutEngine(m_fontManager, m_textShaper);
-        preLayoutEngine.setHyphenateJustifiedText(
-            PrettyReaderSettings::self()->hyphenateJustifiedText());
-        Layout::LayoutResult preLayout = preLayoutEngine.layout(contentDoc, pl);
-        int pageCount = preLayout.pages.size();
+        // Page count for the dialog: the print layout on screen, else a
+        // pagination of the block boxes prepared while idle, else a full
+        // pre-layout
+        const auto &snapshot = tab->renderSnapshot();
+        int pageCount = 0;
+        if (shown && tab->hasRenderSnapshot() && !snapshot.webMode
+            && StyleDiff::comparePageLayouts(snapshot.pageLayout, pl) < StyleDiff::Relayout) {
+            pageCount = snapshot.printLayout.pages.size();
+        } else {
+            m_fontManager->resetUsage();
+            Layout::Engine preLayoutEngine(m_fontManager, m_textShaper);
+            preLayoutEngine.setHyphenateJustifiedText(
+                PrettyReaderSettings::self()->hyphenateJustifiedText());
+            if (shown) {
+                const Layout::Engine::BlockElements prepared = tab->preparedLayouts().value(
+                    preparedLayoutKey(tab, pl.contentSizePoints().width(), false));
+                if (!prepared.isEmpty() && prepared.size() == contentDoc.blocks.size()) {
+                    Content::Splice splice;
+                    splice.leading = contentDoc.blocks.size();
+                    preLayoutEngine.setReusableBlocks(prepared, splice);
+                }
+            }
+            pageCount = preLayoutEngine.layout(contentDoc, pl).pages.size();
+        }
 
         // Load saved options from KConfig
         PdfExportOptions opts;
@@ -1052,6 +1207,18 @@ void MainWindow::onFileExportPdf()
             PrettyReaderSettings::self()->hyphenateJustifiedText());
         if (opts.markdownCopy)
             layoutEngine.setMarkdownDecorations(true);
+        // Laid out while idle, unless sections or fonts were changed for
+        // this export or the text changed since
+        if (shown && opts.markdownCopy && !opts.useHersheyFonts
+            && !(opts.sectionsModified && !opts.excludedHeadingIndices.isEmpty())) {
+            const Layout::Engine::BlockElements prepared =
+                tab->preparedLayouts().value(preparedLayoutKey(tab, pl.contentSizePoints().width(), true));
+            if (!prepared.isEmpty() && prepared.size() == filteredDoc.blocks.size()) {
+                Content::Splice splice;
+                splice.leading = filteredDoc.blocks.size();
+                layoutEngine.setReusableBlocks(prepared, splice);
+            }
+        }
         Layout::LayoutResult layoutResult = layoutEngine.layout(filteredDoc, pl);
 
         // Filter pages by range
@@ -1095,6 +1262,153 @@ void MainWindow::onFileExportPdf()
     }
 }
 
+void MainWindow::onFileExportAllPdf()
+{
+    QStringList paths;
+    for (int i = 0; i < m_tabWidget->count(); ++i) {
+        auto *tab = qobject_cast<DocumentTab *>(m_tabWidget->widget(i));
+        if (tab && !tab->filePath().isEmpty() && !paths.contains(tab->filePath()))
+            paths.append(tab->filePath());
+    }
+    exportPdfBatch(paths);
+}
+
+void MainWindow::exportPdfBatch(const QStringList &paths)
+{
+    if (paths.isEmpty()) {
+        statusBar()->showMessage(i18n("No documents to export."), 3000);
+        return;
+    }
+    if (m_batchExporter && m_batchExporter->isRunning()) {
+        statusBar()->showMessage(i18n("A batch export is already running."), 3000);
+        return;
+    }
+
+    QString outDir = QFileDialog::getExistingDirectory(
+        this, i18n("Export PDFs to Folder"), QFileInfo(paths.first()).absolutePath());
+    if (outDir.isEmpty())
+        return;
+
+    // The hyphenator is shared with the workers; make sure it is loaded
+    m_warmup->join();
+
+    // Global export defaults plus each document's saved metadata.  Page
+    // ranges and section exclusions are interactive-only and not applied.
+    PdfExportOptions defaults;
+    auto *settings = PrettyReaderSettings::self();
+    defaults.author = settings->pdfAuthor();
+    defaults.markdownCopy = settings->pdfMarkdownCopy();
+    defaults.unwrapParagraphs = settings->pdfUnwrapParagraphs();
+    defaults.includeBookmarks = settings->pdfIncludeBookmarks();
+    defaults.bookmarkMaxDepth = settings->pdfBookmarkMaxDepth();
+    defaults.initialView = static_cast<PdfExportOptions::InitialView>(
+        settings->pdfInitialView());
+    defaults.pageLayout = static_cast<PdfExportOptions::PageLayout>(
+        settings->pdfPageLayout());
+    // Same input, same bytes: lets unchanged documents come from the cache
+    defaults.reproducible = true;
+
+    QList<BatchPdfExporter::Job> jobs;
+    QSet<QString> usedNames;
+    for (const QString &path : paths) {
+        QFileInfo fi(path);
+
+        // Same base name in different folders: number the later ones
+        QString name = fi.completeBaseName();
+        for (int n = 2; usedNames.contains(name); ++n)
+            name = fi.completeBaseName() + QStringLiteral("-%1").arg(n);
+        usedNames.insert(name);
+
+        BatchPdfExporter::Job job;
+        job.inputPath = fi.absoluteFilePath();
+        job.outputPath = QDir(outDir).filePath(name + QStringLiteral(".pdf"));
+        job.options = defaults;
+
+        QJsonObject perDoc = m_metadataStore->load(job.inputPath);
+        QJsonObject saved = perDoc[QStringLiteral("pdfExportOptions")].toObject();
+        if (saved.contains(QStringLiteral("title")))
+            job.options.title = saved[QStringLiteral("title")].toString();
+        if (saved.contains(QStringLiteral("author")))
+            job.options.author = saved[QStringLiteral("author")].toString();
+        if (saved.contains(QStringLiteral("subject")))
+            job.options.subject = saved[QStringLiteral("subject")].toString();
+        if (saved.contains(QStringLiteral("keywords")))
+            job.options.keywords = saved[QStringLiteral("keywords")].toString();
+        jobs.append(job);
+    }
+
+    if (!m_batchExporter) {
+        m_batchExporter = new BatchPdfExporter(this);
+        connect(m_batchExporter, &BatchPdfExporter::progressChanged,
+                this, [this](int done, int total) {
+            if (!m_batchProgress)
+                return;
+            m_batchProgress->setMaximum(total);
+            m_batchProgress->setValue(done);
+            m_batchProgress->setLabelText(i18n("Exported %1 of %2 documents...", done, total));
+        });
+        connect(m_batchExporter, &BatchPdfExporter::finished,
+                this, [this](int succeeded, int reused, int failed, bool canceled) {
+            if (m_batchProgress) {
+                m_batchProgress->deleteLater();
+                m_batchProgress = nullptr;
+            }
+            QString message;
+            if (failed > 0)
+                message = i18np("Exported %2 PDFs; %1 document failed.",
+                                "Exported %2 PDFs; %1 documents failed.", failed, succeeded);
+            else if (canceled)
+                message = i18np("Export canceled after %1 PDF.",
+                                "Export canceled after %1 PDFs.", succeeded);
+            else
+                message = i18np("Exported %1 PDF.", "Exported %1 PDFs.", succeeded);
+            if (reused > 0)
+                message += QLatin1Char(' ')
+                    + i18np("%1 was unchanged.", "%1 were unchanged.", reused);
+            statusBar()->showMessage(message, 5000);
+        });
+    }
+
+    // Same style source as the single-document export
+    StyleManager *editingSm = m_typeDockWidget->currentStyleManager();
+    StyleManager *composed = nullptr;
+    if (!editingSm) {
+        composed = new StyleManager(this);
+        m_themeComposer->compose(composed);
+    }
+    m_batchExporter->setStyleManager(editingSm ? editingSm : composed);
+    m_batchExporter->setPageLayout(m_pageDockWidget->currentPageLayout());
+    m_batchExporter->setHyphenator(
+        (settings->hyphenationEnabled() || settings->hyphenateJustifiedText())
+            ? m_hyphenator : nullptr);
+    m_batchExporter->setShortWords(settings->shortWordsEnabled() ? m_shortWords : nullptr);
+    m_batchExporter->setHyphenateJustifiedText(settings->hyphenateJustifiedText());
+    m_batchExporter->setMaxJustifyGap(settings->maxJustifyGap());
+    if (settings->pdfExportCache() && !m_exportCache)
+        m_exportCache = new ExportCache();
+    m_batchExporter->setExportCache(settings->pdfExportCache() ? m_exportCache : nullptr);
+
+    // Non-modal: the window stays usable while the workers run
+    m_batchProgress = new QProgressDialog(i18n("Exporting PDFs..."), i18n("Cancel"),
+                                          0, jobs.size(), this);
+    m_batchProgress->setWindowTitle(i18n("Export as PDF"));
+    m_batchProgress->setWindowModality(Qt::NonModal);
+    m_batchProgress->setMinimumDuration(0);
+    m_batchProgress->setAutoClose(false);
+    m_batchProgress->setAutoReset(false);
+    connect(m_batchProgress, &QProgressDialog::canceled,
+            m_batchExporter, &BatchPdfExporter::cancel);
+
+    bool started = m_batchExporter->start(jobs);
+    delete composed; // cloned per worker by start()
+    if (!started) {
+        m_batchProgress->deleteLater();
+        m_batchProgress = nullptr;
+        return;
+    }
+    m_batchProgress->show();
+}
+
 void MainWindow::onFileExportRtf()
 {
     auto *view = currentDocumentView();
@@ -1181,7 +1495,7 @@ void MainWindow::onCompositionApplied()
             view->setPageLayout(pl);
     }
 
-    rebuildCurrentDocument();
+    m_restyleTimer->start();
 }
 
 void MainWindow::onStyleOverrideChanged()
@@ -1199,7 +1513,7 @@ void MainWindow::onStyleOverrideChanged()
             view->setPageLayout(pl);
     }
 
-    rebuildCurrentDocument();
+    m_restyleTimer->start();
 }
 
 void MainWindow::onPageLayoutChanged()
@@ -1210,7 +1524,7 @@ void MainWindow::onPageLayoutChanged()
     auto *view = currentDocumentView();
     if (view)
         view->setPageLayout(pl);
-    rebuildCurrentDocument();
+    m_restyleTimer->start();
 }
 
 void MainWindow::onZoomIn()
@@ -1271,6 +1585,14 @@ void MainWindow::onSettingsChanged()
 {
     auto *settings = PrettyReaderSettings::self();
 
+    m_warmup->join();
+
+    // Workers read the hyphenator and short-words tables being replaced
+    if (m_batchExporter && m_batchExporter->isRunning()) {
+        m_batchExporter->cancel();
+        m_batchExporter->waitForFinished();
+    }
+
     // Reconfigure hyphenator
     if (settings->hyphenationEnabled() || settings->hyphenateJustifiedText()) {
         m_hyphenator->loadDictionary(settings->hyphenationLanguage());
@@ -1281,6 +1603,12 @@ void MainWindow::onSettingsChanged()
     if (settings->shortWordsEnabled())
         m_shortWords->setLanguage(settings->hyphenationLanguage());
 
+    // Hyphenation and short words are applied at parse time
+    for (int i = 0; i < m_tabWidget->count(); ++i) {
+        if (auto *tab = qobject_cast<DocumentTab *>(m_tabWidget->widget(i)))
+            tab->clearParseCache();
+    }
+
     rebuildCurrentDocument();
 }
 
@@ -1492,12 +1820,24 @@ void MainWindow::restoreSession()
         onCompositionApplied();
 }
 
-void MainWindow::rebuildCurrentDocument()
+namespace {
+
+// Width the web view's continuous layout flows into at the current zoom
+qreal webLayoutWidth(DocumentView *view)
 {
-    auto *tab = currentDocumentTab();
-    if (!tab)
-        return;
+    qreal availWidth = view->viewport()->width() - 2 * DocumentView::kSceneMargin;
+    qreal zoomFactor = view->zoomPercent() / 100.0;
+    if (zoomFactor > 0)
+        availWidth /= zoomFactor;
+    if (availWidth < 200)
+        availWidth = 200;
+    return availWidth;
+}
+
+} // namespace
 
+void MainWindow::applyEditorPalette(DocumentTab *tab)
+{
     // Apply palette colours to source editor
     const auto &palette = m_themeComposer->currentPalette();
     auto *editor = tab->sourceEditor();
@@ -1512,11 +1852,50 @@ void MainWindow::rebuildCurrentDocument()
         palette.surfaceCode(),
         palette.surfaceInlineCode(),
         palette.borderInner());
+}
+
+StyleManager *MainWindow::composeStyleManager()
+{
+    // Use the editing copy from the style dock, or load fresh if none
+    StyleManager *editingSm = m_typeDockWidget->currentStyleManager();
+    if (editingSm)
+        return editingSm->clone(this);
+
+    auto *styleManager = new StyleManager(this);
+    m_themeComposer->compose(styleManager);
+    return styleManager;
+}
+
+void MainWindow::hibernateIdleTabs()
+{
+    const int minutes = PrettyReaderSettings::self()->hibernateTabsAfterMinutes();
+    if (minutes <= 0)
+        return;
+
+    auto *current = currentDocumentTab();
+    for (int i = 0; i < m_tabWidget->count(); ++i) {
+        auto *tab = qobject_cast<DocumentTab *>(m_tabWidget->widget(i));
+        if (!tab || tab == current || tab->isHibernated())
+            continue;
+        if (tab->inactiveMsecs() >= minutes * 60 * 1000LL)
+            tab->hibernate();
+    }
+}
+
+void MainWindow::rebuildCurrentDocument()
+{
+    auto *tab = currentDocumentTab();
+    if (!tab)
+        return;
+
+    applyEditorPalette(tab);
 
     QString filePath = tab->filePath();
     if (filePath.isEmpty())
         return;
 
+    m_warmup->join();
+
     // Use source text from editor if in source mode, otherwise read from file
     QString markdown;
     if (tab->isSourceMode()) {
@@ -1529,70 +1908,223 @@ void MainWindow::rebuildCurrentDocument()
         file.close();
     }
 
-    // Use the editing copy from the style dock, or load fresh if none
-    StyleManager *editingSm = m_typeDockWidget->currentStyleManager();
-    StyleManager *styleManager;
-    if (editingSm) {
-        styleManager = editingSm->clone(this);
-    } else {
-        styleManager = new StyleManager(this);
-        m_themeComposer->compose(styleManager);
-    }
+    StyleManager *styleManager = composeStyleManager();
 
     auto *view = tab->documentView();
     if (!view)
         return;
 
-    ViewState state = view->saveViewState();
     PageLayout pl = m_pageDockWidget->currentPageLayout();
     QFileInfo fi(filePath);
 
     if (PrettyReaderSettings::self()->usePdfRenderer()) {
         // --- New rendering pipeline (shared content building) ---
-        ContentBuilder contentBuilder;
-        contentBuilder.setBasePath(fi.absolutePath());
-        contentBuilder.setStyleManager(styleManager);
+        // Parse only when the text changed; theme edits re-bind the
+        // cached tree and skip md4c, footnotes and hyphenation.
+        auto &parsed = tab->parseCache();
+        const QByteArray parseKey =
+            QCryptographicHash::hash(markdown.toUtf8(), QCryptographicHash::Sha1);
+        // An edit to a cached parse only re-parses the blocks around it
+        Content::Splice splice;
+        if (parsed.key != parseKey) {
+            ContentBuilder contentBuilder;
+            contentBuilder.setBasePath(fi.absolutePath());
+            if (PrettyReaderSettings::self()->hyphenationEnabled()
+                || PrettyReaderSettings::self()->hyphenateJustifiedText())
+                contentBuilder.setHyphenator(m_hyphenator);
+            if (PrettyReaderSettings::self()->shortWordsEnabled())
+                contentBuilder.setShortWords(m_shortWords);
+            if (parsed.key.isEmpty())
+                parsed.doc = contentBuilder.parse(markdown);
+            else
+                parsed.doc = contentBuilder.reparse(markdown, parsed.doc,
+                                                    parsed.processedMarkdown, &splice);
+            parsed.processedMarkdown = contentBuilder.processedMarkdown();
+            parsed.key = parseKey;
+        }
+
+        Content::Document contentDoc = parsed.doc;
+        StyleBinder(styleManager, styleManager->footnoteStyle()).bind(contentDoc);
+
+        view->applyLanguageOverrides(contentDoc);
+
+        // The unchanged blocks keep their boxes only if nothing else that
+        // shapes them changed since they were laid out
+        auto &snapshot = tab->renderSnapshot();
+        if (!splice.isEmpty()) {
+            const bool webMode = PrettyReaderSettings::self()->useWebView();
+            bool reusable = tab->hasRenderSnapshot()
+                && snapshot.webMode == webMode
+                && StyleDiff::compare(tab->snapshotStyles(), styleManager).impact()
+                       == StyleDiff::NoChange;
+            if (reusable) {
+                reusable = webMode
+                    ? qFuzzyCompare(snapshot.webLayout.contentWidth, webLayoutWidth(view))
+                    : StyleDiff::comparePageLayouts(snapshot.pageLayout, pl) < StyleDiff::Relayout;
+            }
+            if (!reusable)
+                splice = Content::Splice();
+        } else if (tab->hasRenderSnapshot() && !contentDoc.blocks.isEmpty()
+                   && snapshot.webMode != PrettyReaderSettings::self()->useWebView()) {
+            // A view mode switch may find its blocks laid out already
+            const bool webMode = PrettyReaderSettings::self()->useWebView();
+            const qreal width = webMode ? webLayoutWidth(view) : pl.contentSizePoints().width();
+            Layout::Engine::BlockElements prepared =
+                tab->preparedLayouts().take(preparedLayoutKey(tab, width, false));
+            if (prepared.size() == contentDoc.blocks.size()) {
+                snapshot.blockElements = std::move(prepared);
+                splice.leading = contentDoc.blocks.size();
+            }
+        }
+
+        snapshot.processedMarkdown = parsed.processedMarkdown;
+        layoutCurrentDocument(tab, contentDoc, pl, splice);
+        tab->setSnapshotStyles(styleManager);
+    } else {
+        // --- Legacy QTextDocument pipeline ---
+        tab->clearRenderSnapshot();
+        ViewState state = view->saveViewState();
+
+        auto *doc = new QTextDocument(this);
+        auto *builder = new DocumentBuilder(doc, this);
+        builder->setBasePath(fi.absolutePath());
+        builder->setStyleManager(styleManager);
         if (PrettyReaderSettings::self()->hyphenationEnabled()
             || PrettyReaderSettings::self()->hyphenateJustifiedText())
-            contentBuilder.setHyphenator(m_hyphenator);
+            builder->setHyphenator(m_hyphenator);
         if (PrettyReaderSettings::self()->shortWordsEnabled())
-            contentBuilder.setShortWords(m_shortWords);
-        contentBuilder.setFootnoteStyle(styleManager->footnoteStyle());
-        Content::Document contentDoc = contentBuilder.build(markdown);
+            builder->setShortWords(m_shortWords);
+        builder->setFootnoteStyle(styleManager->footnoteStyle());
+        builder->build(markdown);
 
-        view->applyLanguageOverrides(contentDoc);
+        CodeBlockHighlighter rebuildHighlighter;
+        rebuildHighlighter.highlight(doc);
 
-        m_fontManager->resetUsage();
+        QTextDocument *oldDoc = view->document();
+        view->setDocument(doc);
+        delete oldDoc;
+        view->restoreViewState(state);
+        view->setDocumentInfo(fi.fileName(), fi.baseName());
 
-        Layout::Engine layoutEngine(m_fontManager, m_textShaper);
-        layoutEngine.setHyphenateJustifiedText(
-            PrettyReaderSettings::self()->hyphenateJustifiedText());
+        m_tocWidget->buildFromDocument(doc);
+    }
 
-        if (PrettyReaderSettings::self()->useWebView()) {
-            // --- Web view pipeline ---
-            qreal availWidth = view->viewport()->width() - 2 * DocumentView::kSceneMargin;
-            qreal zoomFactor = view->zoomPercent() / 100.0;
-            if (zoomFactor > 0)
-                availWidth /= zoomFactor;
-            if (availWidth < 200)
-                availWidth = 200;
+    tab->setCompositionGeneration(m_compositionGeneration);
+    statusBar()->showMessage(i18n("Theme applied"), 2000);
+    scheduleIdleWork();
+}
 
-            Layout::ContinuousLayoutResult webResult =
-                layoutEngine.layoutContinuous(contentDoc, availWidth);
+void MainWindow::layoutCurrentDocument(DocumentTab *tab, const Content::Document &contentDoc,
+                                       const PageLayout &pl, const Content::Splice &splice,
+                                       const QList<bool> &reuseBlocks)
+{
+    auto *view = tab->documentView();
+    auto &snapshot = tab->renderSnapshot();
+    ViewState state = view->saveViewState();
+    QFileInfo fi(tab->filePath());
+
+    m_fontManager->resetUsage();
+
+    Layout::Engine layoutEngine(m_fontManager, m_textShaper);
+    layoutEngine.setHyphenateJustifiedText(
+        PrettyReaderSettings::self()->hyphenateJustifiedText());
+    if (!splice.isEmpty())
+        layoutEngine.setReusableBlocks(snapshot.blockElements, splice);
+    else if (!reuseBlocks.isEmpty())
+        layoutEngine.setReusableBlocks(snapshot.blockElements, reuseBlocks);
+
+    if (PrettyReaderSettings::self()->useWebView()) {
+        // --- Web view pipeline ---
+        Layout::ContinuousLayoutResult webResult =
+            layoutEngine.layoutContinuous(contentDoc, webLayoutWidth(view));
+
+        // Build heading positions (absolute y from source map)
+        QList<HeadingPosition> headingPositions;
+        for (const auto &block : contentDoc.blocks) {
+            const auto *heading = std::get_if<Content::Heading>(&block);
+            if (!heading || heading->level < 1 || heading->level > 6)
+                continue;
+            HeadingPosition hp;
+            hp.page = 0;
+            hp.sourceLine = heading->source.startLine;
+            if (heading->source.startLine > 0) {
+                for (const auto &entry : webResult.sourceMap) {
+                    if (entry.startLine == heading->source.startLine
+                        && entry.endLine == heading->source.endLine) {
+                        hp.yOffset = entry.rect.top();
+                        break;
+                    }
+                }
+            }
+            headingPositions.append(hp);
+        }
 
-            // Build heading positions (absolute y from source map)
+        // TOC from content model
+        m_tocWidget->buildFromContentModel(contentDoc, webResult.sourceMap);
+        tab->setTocData(contentDoc, webResult.sourceMap);
+
+        // Kept for colour-only restyles; shares its boxes with the view's copy
+        snapshot.webMode = true;
+        snapshot.webLayout = webResult;
+        snapshot.printLayout = {};
+
+        view->setWebFontManager(m_fontManager);
+        view->setHeadingPositions(headingPositions);
+        view->setSourceData(snapshot.processedMarkdown, webResult.sourceMap,
+                            contentDoc, webResult.codeBlockRegions);
+        view->setWebContent(std::move(webResult));
+        view->setRenderMode(DocumentView::WebMode);
+        view->restoreViewState(state);
+        view->setDocumentInfo(fi.fileName(), fi.baseName());
+        connect(view, &DocumentView::currentHeadingChanged,
+                m_tocWidget, &TocWidget::highlightHeading,
+                Qt::UniqueConnection);
+
+        // Wire debounced relayout: a new width reflows the cached content
+        connect(view, &DocumentView::webRelayoutRequested,
+                this, &MainWindow::restyleCurrentDocument,
+                Qt::UniqueConnection);
+    } else {
+        // --- PDF rendering pipeline ---
+        Layout::LayoutResult layoutResult = layoutEngine.layout(contentDoc, pl);
+
+        PdfGenerator pdfGen(m_fontManager);
+        pdfGen.setMaxJustifyGap(PrettyReaderSettings::self()->maxJustifyGap());
+        QByteArray pdf = pdfGen.generate(layoutResult, pl, fi.baseName());
+
+        // Clear legacy document if switching pipelines
+        QTextDocument *oldDoc = view->document();
+        if (oldDoc) {
+            view->setDocument(nullptr);
+            delete oldDoc;
+        }
+
+        view->setPdfData(pdf);
+        view->setSourceData(snapshot.processedMarkdown, layoutResult.sourceMap, contentDoc,
+                            layoutResult.codeBlockRegions);
+        view->setSelectionIndex(Layout::SelectionIndex(layoutResult, pl));
+        view->setRenderMode(DocumentView::PrintMode);
+        view->restoreViewState(state);
+        view->setDocumentInfo(fi.fileName(), fi.baseName());
+
+        // Build TOC directly from content model + source map
+        m_tocWidget->buildFromContentModel(contentDoc, layoutResult.sourceMap);
+        tab->setTocData(contentDoc, layoutResult.sourceMap);
+
+        // Pass heading positions to view for scroll-sync
+        {
             QList<HeadingPosition> headingPositions;
             for (const auto &block : contentDoc.blocks) {
                 const auto *heading = std::get_if<Content::Heading>(&block);
                 if (!heading || heading->level < 1 || heading->level > 6)
                     continue;
                 HeadingPosition hp;
-                hp.page = 0;
                 hp.sourceLine = heading->source.startLine;
                 if (heading->source.startLine > 0) {
-                    for (const auto &entry : webResult.sourceMap) {
+                    for (const auto &entry : layoutResult.sourceMap) {
                         if (entry.startLine == heading->source.startLine
                             && entry.endLine == heading->source.endLine) {
+                            hp.page = entry.pageNumber;
                             hp.yOffset = entry.rect.top();
                             break;
                         }
@@ -1600,108 +2132,302 @@ void MainWindow::rebuildCurrentDocument()
                 }
                 headingPositions.append(hp);
             }
-
-            // TOC from content model
-            m_tocWidget->buildFromContentModel(contentDoc, webResult.sourceMap);
-            tab->setTocData(contentDoc, webResult.sourceMap);
-
-            view->setWebFontManager(m_fontManager);
             view->setHeadingPositions(headingPositions);
-            view->setSourceData(contentBuilder.processedMarkdown(), webResult.sourceMap,
-                                contentDoc, webResult.codeBlockRegions);
-            view->setWebContent(std::move(webResult));
-            view->setRenderMode(DocumentView::WebMode);
-            view->restoreViewState(state);
-            view->setDocumentInfo(fi.fileName(), fi.baseName());
             connect(view, &DocumentView::currentHeadingChanged,
                     m_tocWidget, &TocWidget::highlightHeading,
                     Qt::UniqueConnection);
+        }
 
-            // Wire debounced relayout
-            connect(view, &DocumentView::webRelayoutRequested,
-                    this, &MainWindow::rebuildCurrentDocument,
-                    Qt::UniqueConnection);
-        } else {
-            // --- PDF rendering pipeline ---
-            Layout::LayoutResult layoutResult = layoutEngine.layout(contentDoc, pl);
-
-            PdfGenerator pdfGen(m_fontManager);
-            pdfGen.setMaxJustifyGap(PrettyReaderSettings::self()->maxJustifyGap());
-            QByteArray pdf = pdfGen.generate(layoutResult, pl, fi.baseName());
-
-            // Clear legacy document if switching pipelines
-            QTextDocument *oldDoc = view->document();
-            if (oldDoc) {
-                view->setDocument(nullptr);
-                delete oldDoc;
-            }
+        // Kept for colour-only restyles
+        snapshot.webMode = false;
+        snapshot.printLayout = std::move(layoutResult);
+        snapshot.webLayout = {};
+    }
 
-            view->setPdfData(pdf);
-            view->setSourceData(contentBuilder.processedMarkdown(), layoutResult.sourceMap, contentDoc,
-                                layoutResult.codeBlockRegions);
-            view->setRenderMode(DocumentView::PrintMode);
-            view->restoreViewState(state);
-            view->setDocumentInfo(fi.fileName(), fi.baseName());
-
-            // Build TOC directly from content model + source map
-            m_tocWidget->buildFromContentModel(contentDoc, layoutResult.sourceMap);
-            tab->setTocData(contentDoc, layoutResult.sourceMap);
-
-            // Pass heading positions to view for scroll-sync
-            {
-                QList<HeadingPosition> headingPositions;
-                for (const auto &block : contentDoc.blocks) {
-                    const auto *heading = std::get_if<Content::Heading>(&block);
-                    if (!heading || heading->level < 1 || heading->level > 6)
-                        continue;
-                    HeadingPosition hp;
-                    hp.sourceLine = heading->source.startLine;
-                    if (heading->source.startLine > 0) {
-                        for (const auto &entry : layoutResult.sourceMap) {
-                            if (entry.startLine == heading->source.startLine
-                                && entry.endLine == heading->source.endLine) {
-                                hp.page = entry.pageNumber;
-                                hp.yOffset = entry.rect.top();
-                                break;
-                            }
-                        }
-                    }
-                    headingPositions.append(hp);
-                }
-                view->setHeadingPositions(headingPositions);
-                connect(view, &DocumentView::currentHeadingChanged,
-                        m_tocWidget, &TocWidget::highlightHeading,
-                        Qt::UniqueConnection);
-            }
-        }
+    snapshot.blockElements = layoutEngine.blockElements();
+    snapshot.pageLayout = pl;
+}
+
+void MainWindow::repaintCurrentDocument(DocumentTab *tab, StyleManager *styleManager,
+                                        const PageLayout &pl)
+{
+    auto *view = tab->documentView();
+    auto &snapshot = tab->renderSnapshot();
+    ViewState state = view->saveViewState();
+
+    // Binding the cached tree again keeps it in step with the boxes for
+    // copying and later relayouts; the boxes take the new value of each
+    // colour slot
+    Content::Document contentDoc = tab->cachedContentDoc();
+    StyleBinder binder(styleManager, styleManager->footnoteStyle());
+    binder.bind(contentDoc);
+    const QList<QColor> colorSlots = binder.colorSlots(contentDoc);
+    for (auto &elements : snapshot.blockElements)
+        Layout::recolor(elements, colorSlots);
+
+    if (snapshot.webMode) {
+        Layout::recolor(snapshot.webLayout.elements, colorSlots);
+        view->setWebFontManager(m_fontManager);
+        view->setWebContent(Layout::ContinuousLayoutResult(snapshot.webLayout));
+        view->setSourceData(snapshot.processedMarkdown, snapshot.webLayout.sourceMap,
+                            contentDoc, snapshot.webLayout.codeBlockRegions);
+        tab->setTocData(contentDoc, snapshot.webLayout.sourceMap);
     } else {
-        // --- Legacy QTextDocument pipeline ---
-        auto *doc = new QTextDocument(this);
-        auto *builder = new DocumentBuilder(doc, this);
-        builder->setBasePath(fi.absolutePath());
-        builder->setStyleManager(styleManager);
-        if (PrettyReaderSettings::self()->hyphenationEnabled()
-            || PrettyReaderSettings::self()->hyphenateJustifiedText())
-            builder->setHyphenator(m_hyphenator);
-        if (PrettyReaderSettings::self()->shortWordsEnabled())
-            builder->setShortWords(m_shortWords);
-        builder->setFootnoteStyle(styleManager->footnoteStyle());
-        builder->build(markdown);
+        for (auto &page : snapshot.printLayout.pages)
+            Layout::recolor(page.elements, colorSlots);
 
-        CodeBlockHighlighter rebuildHighlighter;
-        rebuildHighlighter.highlight(doc);
+        // Subsetting needs this document's glyphs, which other tabs may
+        // have reset since it was shaped
+        m_fontManager->resetUsage();
+        for (const auto &page : std::as_const(snapshot.printLayout.pages))
+            Layout::markGlyphsUsed(page.elements, m_fontManager);
 
-        QTextDocument *oldDoc = view->document();
-        view->setDocument(doc);
-        delete oldDoc;
-        view->restoreViewState(state);
-        view->setDocumentInfo(fi.fileName(), fi.baseName());
+        QFileInfo fi(tab->filePath());
+        PdfGenerator pdfGen(m_fontManager);
+        pdfGen.setMaxJustifyGap(PrettyReaderSettings::self()->maxJustifyGap());
+        view->setPdfData(pdfGen.generate(snapshot.printLayout, pl, fi.baseName()));
+        view->setSourceData(snapshot.processedMarkdown, snapshot.printLayout.sourceMap,
+                            contentDoc, snapshot.printLayout.codeBlockRegions);
+        view->setSelectionIndex(Layout::SelectionIndex(snapshot.printLayout, pl));
+        tab->setTocData(contentDoc, snapshot.printLayout.sourceMap);
+    }
 
-        m_tocWidget->buildFromDocument(doc);
+    view->restoreViewState(state);
+    snapshot.pageLayout = pl;
+}
+
+void MainWindow::restyleCurrentDocument()
+{
+    m_restyleTimer->stop();
+
+    auto *tab = currentDocumentTab();
+    if (!tab)
+        return;
+
+    auto *settings = PrettyReaderSettings::self();
+    auto &snapshot = tab->renderSnapshot();
+
+    // Only the content pipeline keeps a snapshot, and it is only valid
+    // for the view mode it was rendered in
+    if (!tab->hasRenderSnapshot() || !settings->usePdfRenderer()
+        || snapshot.webMode != settings->useWebView()) {
+        rebuildCurrentDocument();
+        return;
+    }
+
+    applyEditorPalette(tab);
+    m_warmup->join();
+
+    StyleManager *styleManager = composeStyleManager();
+    const PageLayout pl = m_pageDockWidget->currentPageLayout();
+
+    const StyleDiff diff = StyleDiff::compare(tab->snapshotStyles(), styleManager);
+    StyleDiff::Impact pageImpact = StyleDiff::comparePageLayouts(snapshot.pageLayout, pl);
+    if (snapshot.webMode) {
+        // The continuous layout ignores page geometry but follows the
+        // viewport width
+        if (pageImpact == StyleDiff::Relayout)
+            pageImpact = StyleDiff::Repaint;
+        if (!qFuzzyCompare(snapshot.webLayout.contentWidth, webLayoutWidth(tab->documentView())))
+            pageImpact = StyleDiff::Relayout;
+    }
+
+    switch (qMax(diff.impact(), pageImpact)) {
+    case StyleDiff::NoChange:
+        delete styleManager;
+        break;
+    case StyleDiff::Repaint:
+        repaintCurrentDocument(tab, styleManager, pl);
+        tab->setSnapshotStyles(styleManager);
+        break;
+    case StyleDiff::Relayout: {
+        // The cached tree is bound to the new styles; at an unchanged
+        // measure only the blocks that read a changed style are laid out
+        // again
+        Content::Document contentDoc = tab->cachedContentDoc();
+        StyleBinder binder(styleManager, styleManager->footnoteStyle());
+        binder.bind(contentDoc);
+
+        QList<bool> reuseBlocks;
+        if (pageImpact < StyleDiff::Relayout
+            && snapshot.blockElements.size() == contentDoc.blocks.size()) {
+            const QStringList changed = diff.changedStyles();
+            const QSet<QString> changedStyles(changed.cbegin(), changed.cend());
+            reuseBlocks.reserve(contentDoc.blocks.size());
+            for (const auto &block : std::as_const(contentDoc.blocks))
+                reuseBlocks.append(!binder.stylesRead(contentDoc, block).intersects(changedStyles));
+        }
+        layoutCurrentDocument(tab, contentDoc, pl, Content::Splice(), reuseBlocks);
+        tab->setSnapshotStyles(styleManager);
+        break;
+    }
+    case StyleDiff::Rebuild:
+        delete styleManager;
+        rebuildCurrentDocument();
+        return;
     }
 
     tab->setCompositionGeneration(m_compositionGeneration);
-    statusBar()->showMessage(i18n("Theme applied"), 2000);
+    scheduleIdleWork();
+}
+
+QByteArray MainWindow::preparedLayoutKey(DocumentTab *tab, qreal availWidth,
+                                         bool markdownDecorations)
+{
+    // Same text, composition, code languages and hyphenation, same measure
+    QByteArray key = tab->parseCache().key + QByteArray::number(m_compositionGeneration) + '/'
+        + QByteArray::number(availWidth, 'f', 2) + (markdownDecorations ? "/md" : "/")
+        + (PrettyReaderSettings::self()->hyphenateJustifiedText() ? "/hj" : "/");
+    const QHash<QString, QString> languages = tab->documentView()->codeBlockLanguageOverrides();
+    if (!languages.isEmpty()) {
+        QStringList codes = languages.keys();
+        codes.sort();
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (const QString &code : std::as_const(codes)) {
+            hash.addData(code.toUtf8());
+            hash.addData(QByteArrayView("\0", 1));
+            hash.addData(languages.value(code).toUtf8());
+            hash.addData(QByteArrayView("\0", 1));
+        }
+        key += hash.result().toHex();
+    }
+    return key;
+}
+
+void MainWindow::scheduleIdleWork()
+{
+    m_idleScheduler->cancelAll();
+
+    auto *settings = PrettyReaderSettings::self();
+    auto *tab = currentDocumentTab();
+    if (!tab || !settings->prepareViewsWhileIdle() || !settings->usePdfRenderer()
+        || !m_warmup->isFinished() || !tab->hasTocData() || tab->parseCache().key.isEmpty())
+        return;
+
+    const bool webMode = settings->useWebView();
+    QPointer<DocumentTab> guard(tab);
+
+    // Cheapest first: the pages either side of the one being read
+    if (!webMode) {
+        m_idleScheduler->schedule([guard]() {
+            if (guard)
+                guard->documentView()->prefetchNeighbourPages(2);
+            return true;
+        });
+    }
+
+    // Phase-1 layouts for the other view mode and for PDF export with the
+    // markdown copy layer.  Pagination is cheap next to shaping, so the
+    // block boxes are what is worth having ready.
+    struct Target {
+        qreal width;
+        bool markdownDecorations;
+    };
+    const qreal printWidth = m_pageDockWidget->currentPageLayout().contentSizePoints().width();
+    QList<Target> targets;
+    targets.append({webMode ? printWidth : webLayoutWidth(tab->documentView()), false});
+    if (settings->pdfMarkdownCopy())
+        targets.append({printWidth, true});
+
+    auto &prepared = tab->preparedLayouts();
+    QHash<QByteArray, Layout::Engine::BlockElements> kept;
+    const Content::Document doc = tab->cachedContentDoc();
+    for (const Target &target : std::as_const(targets)) {
+        const QByteArray key = preparedLayoutKey(tab, target.width, target.markdownDecorations);
+        if (prepared.contains(key)) {
+            kept.insert(key, prepared.value(key));
+            continue;
+        }
+
+        auto engine = std::make_shared<Layout::Engine>(m_fontManager, m_textShaper);
+        engine->setHyphenateJustifiedText(settings->hyphenateJustifiedText());
+        engine->setMarkdownDecorations(target.markdownDecorations);
+        auto blocks = std::make_shared<Layout::Engine::BlockElements>();
+        m_idleScheduler->schedule([guard, doc, engine, blocks, key, width = target.width]() {
+            if (!guard)
+                return true;
+            // A few blocks per step; the scheduler checks its time budget
+            // between steps
+            for (int n = 0; n < 4 && blocks->size() < doc.blocks.size(); ++n)
+                blocks->append(engine->layoutBlock(doc.blocks.at(blocks->size()), width));
+            if (blocks->size() < doc.blocks.size())
+                return false;
+            guard->preparedLayouts().insert(key, *blocks);
+            return true;
+        });
+    }
+    // Layouts for other widths or an older composition are no use
+    prepared = kept;
+}
+
+void MainWindow::reloadChangedFiles()
+{
+    const QSet<QString> changed = std::exchange(m_changedFiles, {});
+    QSet<QString> reloaded;
+    for (const QString &path : changed) {
+        // Saving through a temporary file and a rename drops the watch
+        if (!m_fileWatcher->files().contains(path)) {
+            if (!QFileInfo::exists(path)) {
+                // Not renamed into place yet; give up after a few seconds
+                if (m_reloadAttempts < 10)
+                    m_changedFiles.insert(path);
+                continue;
+            }
+            m_fileWatcher->addPath(path);
+        }
+        reloaded.insert(path);
+    }
+    if (!m_changedFiles.isEmpty()) {
+        ++m_reloadAttempts;
+        m_reloadTimer->start();
+    }
+
+    if (reloaded.isEmpty() || !PrettyReaderSettings::self()->autoReloadOnChange())
+        return;
+
+    auto *current = currentDocumentTab();
+    for (int i = 0; i < m_tabWidget->count(); ++i) {
+        auto *tab = qobject_cast<DocumentTab *>(m_tabWidget->widget(i));
+        if (!tab || !reloaded.contains(tab->filePath()))
+            continue;
+        if (tab == current)
+            reloadCurrentDocument();
+        else
+            tab->setSourceStale(true);
+    }
+}
+
+void MainWindow::reloadCurrentDocument()
+{
+    auto *tab = currentDocumentTab();
+    if (!tab || tab->filePath().isEmpty())
+        return;
+    tab->setSourceStale(false);
+
+    QFile file(tab->filePath());
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+    const QString markdown = QString::fromUtf8(file.readAll());
+    file.close();
+
+    const QFileInfo fi(tab->filePath());
+    auto *editor = tab->sourceEditor();
+    if (editor->document()->isModified()) {
+        statusBar()->showMessage(
+            i18n("%1 changed on disk; keeping the edited source", fi.fileName()), 5000);
+        return;
+    }
+    if (markdown == tab->sourceText())
+        return;
+
+    // The view keeps its place through rebuildCurrentDocument(); the
+    // editor needs it restored by hand
+    const int editorScroll = editor->verticalScrollBar()->value();
+    tab->setSourceText(markdown);
+    editor->verticalScrollBar()->setValue(editorScroll);
+
+    rebuildCurrentDocument();
+    statusBar()->showMessage(i18n("Reloaded %1", fi.fileName()), 3000);
 }
 
 void MainWindow::openFile(const QUrl &url)
@@ -1729,6 +2455,8 @@ void MainWindow::openFile(const QUrl &url)
     const QString markdown = QString::fromUtf8(file.readAll());
     file.close();
 
+    m_warmup->join();
+
     // Build document with style manager (use editing copy if available)
     StyleManager *editingSm = m_typeDockWidget->currentStyleManager();
     StyleManager *styleManager;
@@ -1767,14 +2495,20 @@ void MainWindow::openFile(const QUrl &url)
         // --- New PDF rendering pipeline ---
         ContentBuilder contentBuilder;
         contentBuilder.setBasePath(fi.absolutePath());
-        contentBuilder.setStyleManager(styleManager);
         if (PrettyReaderSettings::self()->hyphenationEnabled()
             || PrettyReaderSettings::self()->hyphenateJustifiedText())
             contentBuilder.setHyphenator(m_hyphenator);
         if (PrettyReaderSettings::self()->shortWordsEnabled())
             contentBuilder.setShortWords(m_shortWords);
-        contentBuilder.setFootnoteStyle(styleManager->footnoteStyle());
-        Content::Document contentDoc = contentBuilder.build(markdown);
+
+        // Keep the unbound tree so later theme edits only re-bind it
+        auto &parsed = tab->parseCache();
+        parsed.doc = contentBuilder.parse(markdown);
+        parsed.processedMarkdown = contentBuilder.processedMarkdown();
+        parsed.key = QCryptographicHash::hash(markdown.toUtf8(), QCryptographicHash::Sha1);
+
+        Content::Document contentDoc = parsed.doc;
+        StyleBinder(styleManager, styleManager->footnoteStyle()).bind(contentDoc);
 
         tab->documentView()->applyLanguageOverrides(contentDoc);
 
@@ -1793,11 +2527,19 @@ void MainWindow::openFile(const QUrl &url)
         tab->documentView()->setSourceData(
             contentBuilder.processedMarkdown(), layoutResult.sourceMap, contentDoc,
             layoutResult.codeBlockRegions);
+        tab->documentView()->setSelectionIndex(Layout::SelectionIndex(layoutResult, openPl));
 
         // Build TOC from content model (PDF mode)
         m_tocWidget->buildFromContentModel(contentDoc, layoutResult.sourceMap);
         tab->setTocData(contentDoc, layoutResult.sourceMap);
 
+        auto &snapshot = tab->renderSnapshot();
+        snapshot.pageLayout = openPl;
+        snapshot.processedMarkdown = contentBuilder.processedMarkdown();
+        snapshot.printLayout = layoutResult;
+        snapshot.blockElements = layoutEngine.blockElements();
+        tab->setSnapshotStyles(styleManager->clone());
+
         // Pass heading positions to view for scroll-sync
         {
             QList<HeadingPosition> headingPositions;
@@ -1893,6 +2635,9 @@ void MainWindow::openFile(const QUrl &url)
         for (auto it = overrides.cbegin(); it != overrides.cend(); ++it)
             langObj.insert(it.key(), it.value());
         m_metadataStore->setValue(filePath, QStringLiteral("codeBlockLanguages"), langObj);
+        // Prepared layouts carry the old highlighting
+        if (auto *tab = currentDocumentTab())
+            tab->preparedLayouts().clear();
         rebuildCurrentDocument();
     });
 
@@ -1957,6 +2702,7 @@ void MainWindow::openFile(const QUrl &url)
 
     int index = m_tabWidget->addTab(tab, fi.fileName());
     m_tabWidget->setTabToolTip(index, filePath);
+    m_fileWatcher->addPath(filePath);
     m_tabWidget->setCurrentIndex(index);
 
     // In web mode, build now that the tab is current (needs viewport width)
@@ -1978,4 +2724,5 @@ void MainWindow::openFile(const QUrl &url)
         m_filePathLabel->setText(filePath);
 
     statusBar()->showMessage(i18n("Opened %1", fi.fileName()), 3000);
+    scheduleIdleWork();
 }
@@ -3,13 +3,22 @@
 
 #include <KXmlGuiWindow>
 
+#include <QColor>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+
 class QAction;
 class QCloseEvent;
+class QFileSystemWatcher;
+class QShowEvent;
 class QLabel;
+class QProgressDialog;
 class QSlider;
 class QSplitter;
 class QSpinBox;
 class QTabWidget;
+class QTimer;
 class KActionMenu;
 class KRecentFilesAction;
 class FileBrowserDock;
@@ -31,6 +40,14 @@ class DocumentTab;
 class DocumentView;
 class Hyphenator;
 class ShortWords;
+class StartupWarmup;
+class BatchPdfExporter;
+class ExportCache;
+class IdleScheduler;
+class StyleManager;
+struct PageLayout;
+
+namespace Content { struct Document; struct Splice; }
 
 class MainWindow : public KXmlGuiWindow
 {
@@ -46,11 +63,13 @@ public:
 
 protected:
     void closeEvent(QCloseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 
 private Q_SLOTS:
     void onFileOpen();
     void onFileOpenRecent(const QUrl &url);
     void onFileExportPdf();
+    void onFileExportAllPdf();
     void onFileExportRtf();
     void onFilePrint();
     void onFileClose();
@@ -71,8 +90,23 @@ private:
     void setupActions();
     void setupSidebars();
     void rebuildCurrentDocument();
+    void restyleCurrentDocument();
+    void reloadCurrentDocument();
+    void reloadChangedFiles();
+    void layoutCurrentDocument(DocumentTab *tab, const Content::Document &contentDoc,
+                               const PageLayout &pl, const Content::Splice &splice,
+                               const QList<bool> &reuseBlocks = {});
+    void repaintCurrentDocument(DocumentTab *tab, StyleManager *styleManager,
+                                const PageLayout &pl);
+    StyleManager *composeStyleManager();
+    void applyEditorPalette(DocumentTab *tab);
     void saveSession();
     void restoreSession();
+    void startWarmup();
+    void exportPdfBatch(const QStringList &paths);
+    void hibernateIdleTabs();
+    void scheduleIdleWork();
+    QByteArray preparedLayoutKey(DocumentTab *tab, qreal availWidth, bool markdownDecorations);
     DocumentView *currentDocumentView() const;
     DocumentTab *currentDocumentTab() const;
 
@@ -111,6 +145,10 @@ private:
     // PDF rendering pipeline (Phase 4)
     FontManager *m_fontManager = nullptr;
     TextShaper *m_textShaper = nullptr;
+    StartupWarmup *m_warmup = nullptr;
+    BatchPdfExporter *m_batchExporter = nullptr;
+    ExportCache *m_exportCache = nullptr;
+    QProgressDialog *m_batchProgress = nullptr;
 
     // Render mode (Web / Print / Source)
     QAction *m_webViewAction = nullptr;
@@ -121,6 +159,18 @@ private:
 
     // Composition generation counter — incremented on any theme/style/layout change
     quint64 m_compositionGeneration = 1;
+    // Coalesces style/page edits into one restyleCurrentDocument()
+    QTimer *m_restyleTimer = nullptr;
+    // Background tab hibernation
+    QTimer *m_hibernateTimer = nullptr;
+    QPointer<DocumentTab> m_activeTab;
+    // Open files, reloaded when saved by another program
+    QFileSystemWatcher *m_fileWatcher = nullptr;
+    QTimer *m_reloadTimer = nullptr;
+    QSet<QString> m_changedFiles;
+    int m_reloadAttempts = 0;
+    // Speculative layout and page rendering between user actions
+    IdleScheduler *m_idleScheduler = nullptr;
 };
 
 #endif // PRETTYREADER_MAINWINDOW_H
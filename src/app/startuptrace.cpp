@@ -0,0 +1,80 @@
+/*
+ * startuptrace.cpp — Cold-start phase timings
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "startuptrace.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QList>
+#include <QLoggingCategory>
+
+#include <utility>
+
+Q_LOGGING_CATEGORY(lcStartup, "prettyreader.startup", QtWarningMsg)
+
+namespace StartupTrace {
+
+namespace {
+
+struct Phase {
+    const char *name;
+    qint64 endNs; // since start()
+};
+
+enum State { NotStarted, Running, Finished };
+
+State s_state = NotStarted;
+QElapsedTimer s_timer;
+QList<Phase> s_phases;
+
+} // anonymous namespace
+
+void start()
+{
+    if (!lcStartup().isDebugEnabled())
+        return;
+    s_state = Running;
+    s_phases.clear();
+    s_timer.start();
+}
+
+void mark(const char *name)
+{
+    if (s_state == Running)
+        s_phases.append({name, s_timer.nsecsElapsed()});
+}
+
+void finish(const char *name)
+{
+    if (s_state != Running)
+        return;
+    mark(name);
+    s_state = Finished;
+    qCDebug(lcStartup).noquote() << report().trimmed();
+}
+
+bool isRunning()
+{
+    return s_state == Running;
+}
+
+QString report()
+{
+    QString text;
+    qint64 previous = 0;
+    for (const Phase &phase : std::as_const(s_phases)) {
+        text += QStringLiteral("startup  %1 %2 ms\n")
+                    .arg(QLatin1String(phase.name), -22)
+                    .arg((phase.endNs - previous) / 1.0e6, 8, 'f', 1);
+        previous = phase.endNs;
+    }
+    if (!s_phases.isEmpty())
+        text += QStringLiteral("startup  %1 %2 ms\n")
+                    .arg(QLatin1String("total"), -22)
+                    .arg(previous / 1.0e6, 8, 'f', 1);
+    return text;
+}
+
+} // namespace StartupTrace
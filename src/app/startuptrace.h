@@ -0,0 +1,46 @@
+/*
+ * startuptrace.h — Cold-start phase timings
+ *
+ * main() starts the clock; main() and the MainWindow constructor mark the
+ * end of each startup phase, and the first painted page (or the first
+ * frame, when no document is open) finishes the trace and writes it to
+ * the debug output.  The trace is off unless the prettyreader.startup
+ * logging category is enabled, e.g.
+ * QT_LOGGING_RULES="prettyreader.startup.debug=true":
+ *
+ *   startup  application            12.4 ms
+ *   startup  managers                0.3 ms
+ *   ...
+ *   startup  total                 412.9 ms
+ *
+ * Every phase is timed from the end of the previous one.  When the category
+ * is off, or without start() (benchmarks, the batch converter), marks are
+ * ignored and nothing is timed.  GUI thread only.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_STARTUPTRACE_H
+#define PRETTYREADER_STARTUPTRACE_H
+
+#include <QString>
+
+namespace StartupTrace {
+
+// Starts the clock if the prettyreader.startup category is enabled
+void start();
+
+// Ends phase @p name (a string literal) at the current time
+void mark(const char *name);
+
+// Ends the last phase and reports the trace; later calls do nothing
+void finish(const char *name);
+
+bool isRunning();
+
+// One line per phase plus the total
+QString report();
+
+} // namespace StartupTrace
+
+#endif // PRETTYREADER_STARTUPTRACE_H
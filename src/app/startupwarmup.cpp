@@ -0,0 +1,146 @@
+/*
+ * startupwarmup.cpp — Background font, dictionary and syntax warm-up
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "startupwarmup.h"
+
+#include "codespancollector.h"
+#include "fontmanager.h"
+#include "hersheyfont.h"
+#include "hyphenator.h"
+#include "stylemanager.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+StartupWarmup::StartupWarmup(FontManager *fontManager, Hyphenator *hyphenator,
+                             QObject *parent)
+    : QObject(parent)
+    , m_fontManager(fontManager)
+    , m_hyphenator(hyphenator)
+{
+}
+
+StartupWarmup::~StartupWarmup()
+{
+    // Never let the worker outlive the FontManager/Hyphenator it writes to
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void StartupWarmup::start()
+{
+    if (m_state != Idle)
+        return;
+    m_state = Running;
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName(QStringLiteral("StartupWarmup"));
+    connect(m_thread, &QThread::finished, this, [this]() {
+        if (m_state == Finished)
+            return; // already joined
+        m_state = Finished;
+        Q_EMIT finished(m_elapsedMs);
+    });
+    m_thread->start(QThread::LowPriority);
+}
+
+void StartupWarmup::join()
+{
+    switch (m_state) {
+    case Finished:
+        return;
+    case Idle:
+        m_state = Running;
+        run();
+        break;
+    case Running:
+        m_thread->wait();
+        break;
+    }
+    m_state = Finished;
+    Q_EMIT finished(m_elapsedMs);
+}
+
+void StartupWarmup::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Stroke fonts are parsed all at once; do it up front so that
+    // loadFont() below only has to resolve the family table.
+    if (m_loadHershey)
+        HersheyFontRegistry::instance().ensureLoaded();
+
+    // fontconfig match + file read + FreeType/HarfBuzz face creation.
+    // FontManager caches by (family, weight, italic), so the first
+    // render finds every face already resident.
+    if (m_fontManager) {
+        for (const FontRequest &req : std::as_const(m_fonts))
+            m_fontManager->loadFont(req.family, req.weight, req.italic);
+    }
+
+    if (m_hyphenator && !m_hyphenationLanguage.isEmpty())
+        m_hyphenator->loadDictionary(m_hyphenationLanguage);
+
+    // Constructing the repository scans every syntax definition on disk.
+    // The repository is a QObject: hand it back to the GUI thread so it
+    // does not stay affine to this short-lived worker.
+    KSyntaxHighlighting::Repository &repo = CodeSpanCollector::sharedRepository();
+    QThread *guiThread = QCoreApplication::instance()
+        ? QCoreApplication::instance()->thread() : nullptr;
+    if (guiThread && repo.thread() == QThread::currentThread()
+        && repo.thread() != guiThread)
+        repo.moveToThread(guiThread);
+
+    m_elapsedMs = timer.elapsed();
+}
+
+QList<StartupWarmup::FontRequest> StartupWarmup::fontsForStyles(StyleManager *sm)
+{
+    QList<FontRequest> fonts;
+    if (!sm)
+        return fonts;
+
+    auto addFamily = [&fonts](const QString &family, int weight, bool italic) {
+        if (family.isEmpty())
+            return;
+        // Regular/bold x upright/italic covers **strong** and *emphasis*
+        // inside a run of this family, plus the style's own face.
+        const FontRequest candidates[] = {
+            {family, weight, italic},
+            {family, 400, false},
+            {family, 700, false},
+            {family, 400, true},
+            {family, 700, true},
+        };
+        for (const FontRequest &req : candidates) {
+            if (!fonts.contains(req))
+                fonts.append(req);
+        }
+    };
+
+    const QStringList paraNames = sm->paragraphStyleNames();
+    for (const QString &name : paraNames) {
+        ParagraphStyle ps = sm->resolvedParagraphStyle(name);
+        addFamily(ps.fontFamily(), static_cast<int>(ps.fontWeight()), ps.fontItalic());
+    }
+
+    const QStringList charNames = sm->characterStyleNames();
+    for (const QString &name : charNames) {
+        CharacterStyle cs = sm->resolvedCharacterStyle(name);
+        addFamily(cs.fontFamily(), static_cast<int>(cs.fontWeight()), cs.fontItalic());
+    }
+
+    // Header/footer text is always set in Noto Sans by PdfGenerator
+    const FontRequest headerFooter{QStringLiteral("Noto Sans"), 400, false};
+    if (!fonts.contains(headerFooter))
+        fonts.append(headerFooter);
+
+    return fonts;
+}
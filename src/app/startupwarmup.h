@@ -0,0 +1,85 @@
+/*
+ * startupwarmup.h — Background font, dictionary and syntax warm-up
+ *
+ * Pre-loads the font faces referenced by the active composition, the
+ * hyphenation dictionary and the KSyntaxHighlighting repository on a
+ * worker thread once the main window is visible, so the first document
+ * render is as fast as subsequent ones.
+ *
+ * The FontManager and Hyphenator handed to the warm-up are not
+ * thread-safe: callers must join() before using them on the GUI thread.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_STARTUPWARMUP_H
+#define PRETTYREADER_STARTUPWARMUP_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class FontManager;
+class Hyphenator;
+class QThread;
+class StyleManager;
+
+class StartupWarmup : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct FontRequest {
+        QString family;
+        int weight = 400;
+        bool italic = false;
+
+        bool operator==(const FontRequest &o) const
+        {
+            return family == o.family && weight == o.weight && italic == o.italic;
+        }
+    };
+
+    StartupWarmup(FontManager *fontManager, Hyphenator *hyphenator,
+                  QObject *parent = nullptr);
+    ~StartupWarmup() override;
+
+    void setFonts(const QList<FontRequest> &fonts) { m_fonts = fonts; }
+    // Empty language = leave the hyphenator untouched
+    void setHyphenationLanguage(const QString &language) { m_hyphenationLanguage = language; }
+    void setLoadHersheyFonts(bool load) { m_loadHershey = load; }
+
+    // Start the warm-up on a worker thread (no-op if already started).
+    void start();
+
+    // Block until the warm-up has completed.  If it was never started,
+    // the work runs synchronously on the calling thread instead.
+    void join();
+
+    bool isFinished() const { return m_state == Finished; }
+
+    // Font faces a document composed with @p sm will request: every
+    // resolved family at its own weight/slant plus the bold and italic
+    // variants used by inline emphasis.
+    static QList<FontRequest> fontsForStyles(StyleManager *sm);
+
+Q_SIGNALS:
+    void finished(qint64 elapsedMs);
+
+private:
+    void run();
+
+    enum State { Idle, Running, Finished };
+
+    FontManager *m_fontManager = nullptr;
+    Hyphenator *m_hyphenator = nullptr;
+    QList<FontRequest> m_fonts;
+    QString m_hyphenationLanguage;
+    bool m_loadHershey = false;
+
+    State m_state = Idle;
+    QThread *m_thread = nullptr;
+    qint64 m_elapsedMs = 0;
+};
+
+#endif // PRETTYREADER_STARTUPWARMUP_H
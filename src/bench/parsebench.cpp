@@ -0,0 +1,227 @@
+/*
+ * parsebench.cpp — Chunked against serial markdown parsing
+ *
+ * Times ContentBuilder::parse() over a large document with the parallel
+ * parse on and off, and checks that both give the same blocks: kinds,
+ * source lines and link targets of every block, and the RTF export of
+ * the bound documents for their text and styles.  Without a file argument
+ * a synthetic document is generated whose reference definitions sit in
+ * the places a chunked parse must find them: under headings, with the
+ * destination or title on the next line, and at the end of the document.
+ *
+ * Usage:
+ *   prettyreader-parsebench [--iterations N] [--paragraphs N] [FILE.md]
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "contentbuilder.h"
+#include "contentrtfexporter.h"
+#include "stylebinder.h"
+#include "stylemanager.h"
+#include "themecomposer.h"
+#include "thememanager.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+
+QString syntheticDocument(int paragraphs)
+{
+    static const char *const words[] = {
+        "typography", "kerning", "ligature", "baseline", "justification",
+        "hyphenation", "paragraph", "glyph", "serif", "measure", "leading",
+        "counter", "ascender", "descender", "a", "of", "the", "and", "in",
+    };
+    constexpr int wordCount = sizeof(words) / sizeof(words[0]);
+
+    QString md;
+    md += QStringLiteral("# Parse benchmark document\n\n");
+    quint32 seed = 12345;
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 16) & 0x7fff; };
+    for (int p = 0; p < paragraphs; ++p) {
+        if (p % 20 == 0) {
+            const int section = p / 20 + 1;
+            md += QStringLiteral("## Section %1\n").arg(section);
+            // Definitions right under the heading, one continued onto
+            // the next line, one with its title on the next line
+            md += QStringLiteral("[s%1]: https://example.org/s/%1\n").arg(section);
+            md += QStringLiteral("[t%1]:\n  https://example.org/t/%1\n").arg(section);
+            md += QStringLiteral("[u%1]: https://example.org/u/%1\n  \"Title %1\"\n\n").arg(section);
+        }
+        const bool list = p % 7 == 3;
+        for (int s = 0; s < 6; ++s) {
+            if (list)
+                md += QStringLiteral("- ");
+            for (int w = 0; w < 14; ++w) {
+                const int r = next();
+                QString word = QString::fromLatin1(words[r % wordCount]);
+                if (r % 23 == 0)
+                    word = QStringLiteral("`%1()`").arg(word);
+                else if (r % 17 == 0)
+                    word = QStringLiteral("*%1*").arg(word);
+                else if (r % 29 == 0)
+                    word = QStringLiteral("[%1][%2%3]").arg(word)
+                               .arg(QLatin1Char("stue"[r % 4]))
+                               .arg((r % 4 == 3 ? 0 : r) % (paragraphs / 20 + 1) + 1);
+                md += word;
+                md += w == 13 ? QStringLiteral(". ") : QStringLiteral(" ");
+            }
+            if (list)
+                md += QLatin1Char('\n');
+        }
+        md += QStringLiteral("\n\n");
+    }
+    md += QStringLiteral("[e1]: https://example.org/end\n");
+    return md;
+}
+
+// Kind, source lines and link targets of @p blocks, one line per block
+void outline(QStringList &lines, const QList<Content::BlockNode> &blocks, int depth = 0);
+
+void outlineInlines(QString &line, const QList<Content::InlineNode> &inlines)
+{
+    for (const auto &node : inlines) {
+        if (const auto *link = std::get_if<Content::Link>(&node))
+            line += QLatin1Char(' ') + link->href;
+    }
+}
+
+void outline(QStringList &lines, const QList<Content::BlockNode> &blocks, int depth)
+{
+    for (const auto &block : blocks) {
+        QString line = QStringLiteral("%1%2").arg(QString(depth * 2, QLatin1Char(' '))).arg(block.index());
+        std::visit([&](const auto &b) {
+            using T = std::decay_t<decltype(b)>;
+            if constexpr (std::is_same_v<T, Content::Paragraph> || std::is_same_v<T, Content::Heading>) {
+                line += QStringLiteral(" %1-%2").arg(b.source.startLine).arg(b.source.endLine);
+                outlineInlines(line, b.inlines);
+                lines.append(line);
+            } else if constexpr (std::is_same_v<T, Content::CodeBlock>
+                                 || std::is_same_v<T, Content::HorizontalRule>) {
+                lines.append(line + QStringLiteral(" %1-%2").arg(b.source.startLine).arg(b.source.endLine));
+            } else if constexpr (std::is_same_v<T, Content::BlockQuote>) {
+                lines.append(line);
+                outline(lines, b.children, depth + 1);
+            } else if constexpr (std::is_same_v<T, Content::List>) {
+                lines.append(line + QStringLiteral(" %1-%2").arg(b.source.startLine).arg(b.source.endLine));
+                for (const auto &item : b.items)
+                    outline(lines, item.children, depth + 1);
+            } else if constexpr (std::is_same_v<T, Content::Table>) {
+                line += QStringLiteral(" %1-%2").arg(b.source.startLine).arg(b.source.endLine);
+                for (const auto &row : b.rows)
+                    for (const auto &cell : row.cells)
+                        outlineInlines(line, cell.inlines);
+                lines.append(line);
+            } else {
+                lines.append(line + QStringLiteral(" %1").arg(b.footnotes.size()));
+            }
+        }, block);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("prettyreader-parsebench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QStringLiteral("Times chunked against serial parsing and compares the blocks."));
+    parser.addHelpOption();
+    QCommandLineOption iterOpt(QStringLiteral("iterations"),
+        QStringLiteral("Parse runs per mode (default 5)."),
+        QStringLiteral("n"), QStringLiteral("5"));
+    QCommandLineOption paraOpt(QStringLiteral("paragraphs"),
+        QStringLiteral("Paragraphs in the synthetic document (default 3000)."),
+        QStringLiteral("n"), QStringLiteral("3000"));
+    parser.addOption(iterOpt);
+    parser.addOption(paraOpt);
+    parser.addPositionalArgument(QStringLiteral("file"),
+        QStringLiteral("Markdown document (default: synthetic)."), QStringLiteral("[file]"));
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const int iterations = qMax(1, parser.value(iterOpt).toInt());
+    QString markdown;
+    QString name;
+    QString basePath;
+    const QStringList args = parser.positionalArguments();
+    if (!args.isEmpty()) {
+        QFileInfo fi(args.first());
+        QFile file(fi.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            err << "parsebench: cannot open " << fi.filePath() << "\n";
+            return 1;
+        }
+        markdown = QString::fromUtf8(file.readAll());
+        name = fi.fileName();
+        basePath = fi.absolutePath();
+    } else {
+        markdown = syntheticDocument(qMax(20, parser.value(paraOpt).toInt()));
+        name = QStringLiteral("<synthetic>");
+    }
+
+    ThemeManager themeManager;
+    ThemeComposer composer(&themeManager);
+    StyleManager styleManager;
+    composer.compose(&styleManager);
+
+    Content::Document docs[2];
+    QList<qreal> runMs[2];
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        for (int mode = 0; mode < 2; ++mode) {
+            ContentBuilder builder;
+            builder.setBasePath(basePath);
+            builder.setFootnoteStyle(styleManager.footnoteStyle());
+            builder.setParallelParse(mode == 1);
+            timer.restart();
+            docs[mode] = builder.parse(markdown);
+            runMs[mode].append(timer.nsecsElapsed() / 1.0e6);
+        }
+    }
+
+    QStringList outlines[2];
+    QByteArray rtf[2];
+    for (int mode = 0; mode < 2; ++mode) {
+        outline(outlines[mode], docs[mode].blocks);
+        StyleBinder(&styleManager, styleManager.footnoteStyle()).bind(docs[mode]);
+        rtf[mode] = ContentRtfExporter().exportBlocks(docs[mode].blocks);
+    }
+
+    out << "document   " << name << " (" << markdown.toUtf8().size() << " bytes)\n";
+    out << QStringLiteral("parse      serial %1 ms, chunked %2 ms  (min of %3 runs)\n")
+               .arg(*std::min_element(runMs[0].begin(), runMs[0].end()), 0, 'f', 1)
+               .arg(*std::min_element(runMs[1].begin(), runMs[1].end()), 0, 'f', 1)
+               .arg(iterations);
+    out << QStringLiteral("blocks     %1 top-level, %2 outline lines (%3)\n")
+               .arg(docs[0].blocks.size())
+               .arg(outlines[0].size())
+               .arg(outlines[0] == outlines[1] && rtf[0] == rtf[1]
+                        ? QStringLiteral("identical output")
+                        : QStringLiteral("OUTPUT DIFFERS"));
+    if (outlines[0] != outlines[1]) {
+        const auto diff = std::mismatch(outlines[0].begin(), outlines[0].end(),
+                                        outlines[1].begin(), outlines[1].end());
+        out << "first difference\n  serial:  "
+            << (diff.first != outlines[0].end() ? *diff.first : QString())
+            << "\n  chunked: "
+            << (diff.second != outlines[1].end() ? *diff.second : QString()) << "\n";
+    }
+    return outlines[0] == outlines[1] && rtf[0] == rtf[1] ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+/*
+ * pdfbench.cpp — PDF serialization benchmark on glyph-dense pages
+ *
+ * Lays out a markdown document once, then times repeated PdfGenerator
+ * runs over the same layout, so the figures isolate content stream and
+ * object serialization from parsing and layout.  Without a file argument
+ * a synthetic glyph-dense document (long justified paragraphs, inline
+ * code, lists) is generated.  A second section times the raw formatting
+ * primitives: one Tm/Tj pair per glyph through Pdf::Buffer against the
+ * same operators built by QByteArray concatenation, and the UTF-16
+ * transcoding helpers (ActualText hex, UTF-8 lengths) against their
+ * per-character loops.  Built with
+ * PRETTYREADER_ALLOC_PROFILING, heap allocations of the build, layout,
+ * shaping and first PDF run are reported per stage and per page.
+ *
+ * Usage:
+ *   prettyreader-pdfbench [--iterations N] [--paragraphs N] [FILE.md]
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "allocprofiler.h"
+#include "contentbuilder.h"
+#include "fontmanager.h"
+#include "hyphenator.h"
+#include "layoutengine.h"
+#include "pagelayout.h"
+#include "palettemanager.h"
+#include "pdfbuffer.h"
+#include "pdfgenerator.h"
+#include "pdfwriter.h"
+#include "stylemanager.h"
+#include "textshaper.h"
+#include "themecomposer.h"
+#include "thememanager.h"
+#include "typeset.h"
+#include "typesetmanager.h"
+#include "utf16.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+
+QString syntheticDocument(int paragraphs)
+{
+    static const char *const words[] = {
+        "typography", "kerning", "ligature", "baseline", "justification",
+        "hyphenation", "paragraph", "glyph", "serif", "measure", "leading",
+        "counter", "ascender", "descender", "a", "of", "the", "and", "in",
+    };
+    constexpr int wordCount = sizeof(words) / sizeof(words[0]);
+
+    QString md;
+    md += QStringLiteral("# Glyph-dense benchmark document\n\n");
+    quint32 seed = 12345;
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 16) & 0x7fff; };
+    for (int p = 0; p < paragraphs; ++p) {
+        if (p % 20 == 0)
+            md += QStringLiteral("## Section %1\n\n").arg(p / 20 + 1);
+        const bool list = p % 7 == 3;
+        for (int s = 0; s < 6; ++s) {
+            if (list)
+                md += QStringLiteral("- ");
+            for (int w = 0; w < 14; ++w) {
+                const int r = next();
+                QString word = QString::fromLatin1(words[r % wordCount]);
+                if (r % 23 == 0)
+                    word = QStringLiteral("`%1()`").arg(word);
+                else if (r % 17 == 0)
+                    word = QStringLiteral("*%1*").arg(word);
+                md += word;
+                md += w == 13 ? QStringLiteral(". ") : QStringLiteral(" ");
+            }
+            if (list)
+                md += QLatin1Char('\n');
+        }
+        md += QStringLiteral("\n\n");
+    }
+    return md;
+}
+
+qreal mean(const QList<qreal> &values)
+{
+    qreal sum = 0;
+    for (qreal v : values)
+        sum += v;
+    return values.isEmpty() ? 0 : sum / values.size();
+}
+
+// --- Raw formatting primitives ---
+
+struct GlyphSample {
+    qreal x;
+    qreal y;
+    quint16 gid;
+};
+
+QByteArray formatConcatenated(const QList<GlyphSample> &glyphs)
+{
+    QByteArray out;
+    for (const auto &g : glyphs) {
+        out += "1 0 0 1 " + QByteArray::number(g.x, 'f', 2) + " "
+             + QByteArray::number(g.y, 'f', 2) + " Tm\n";
+        out += Pdf::toHexString16(g.gid) + " Tj\n";
+    }
+    return out;
+}
+
+QByteArray formatBuffered(const QList<GlyphSample> &glyphs)
+{
+    Pdf::Buffer out;
+    for (const auto &g : glyphs) {
+        out << "1 0 0 1 " << Pdf::coord(g.x) << ' ' << Pdf::coord(g.y) << " Tm\n";
+        out.appendGlyph(g.gid) << " Tj\n";
+    }
+    return out.take();
+}
+
+QByteArray hexPerChar(const QStringList &texts)
+{
+    Pdf::Buffer out;
+    for (const QString &text : texts) {
+        for (QChar ch : text)
+            out.appendHex16(ch.unicode());
+    }
+    return out.take();
+}
+
+QByteArray hexTranscoded(const QStringList &texts)
+{
+    Pdf::Buffer out;
+    for (const QString &text : texts)
+        out.appendUtf16Hex(text);
+    return out.take();
+}
+
+qsizetype utf16LengthPerByte(const QByteArray &utf8)
+{
+    qsizetype units = 0;
+    for (char c : utf8) {
+        if ((uchar(c) & 0xC0) != 0x80)
+            units += uchar(c) >= 0xF0 ? 2 : 1;
+    }
+    return units;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("prettyreader-pdfbench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QStringLiteral("Times PDF generation over a fixed layout."));
+    parser.addHelpOption();
+    QCommandLineOption iterOpt(QStringLiteral("iterations"),
+        QStringLiteral("PDF generation runs (default 10)."),
+        QStringLiteral("n"), QStringLiteral("10"));
+    QCommandLineOption paraOpt(QStringLiteral("paragraphs"),
+        QStringLiteral("Paragraphs in the synthetic document (default 400)."),
+        QStringLiteral("n"), QStringLiteral("400"));
+    parser.addOption(iterOpt);
+    parser.addOption(paraOpt);
+    parser.addPositionalArgument(QStringLiteral("file"),
+        QStringLiteral("Markdown document (default: synthetic)."), QStringLiteral("[file]"));
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const int iterations = qMax(1, parser.value(iterOpt).toInt());
+    QString markdown;
+    QString name;
+    QString basePath;
+    const QStringList args = parser.positionalArguments();
+    if (!args.isEmpty()) {
+        QFileInfo fi(args.first());
+        QFile file(fi.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            err << "pdfbench: cannot open " << fi.filePath() << "\n";
+            return 1;
+        }
+        markdown = QString::fromUtf8(file.readAll());
+        name = fi.fileName();
+        basePath = fi.absolutePath();
+    } else {
+        markdown = syntheticDocument(qMax(1, parser.value(paraOpt).toInt()));
+        name = QStringLiteral("<synthetic>");
+    }
+
+    // Same style setup as MainWindow's default theme
+    ThemeManager themeManager;
+    TypeSetManager typeSets;
+    PaletteManager palettes;
+    ThemeComposer composer(&themeManager);
+    const QStringList typeSetIds = typeSets.availableTypeSets();
+    if (!typeSetIds.isEmpty())
+        composer.setTypeSet(typeSets.typeSet(
+            typeSetIds.contains(QStringLiteral("default")) ? QStringLiteral("default") : typeSetIds.first()));
+    const QStringList paletteIds = palettes.availablePalettes();
+    if (!paletteIds.isEmpty())
+        composer.setColorPalette(palettes.palette(
+            paletteIds.contains(QStringLiteral("default-light")) ? QStringLiteral("default-light") : paletteIds.first()));
+    StyleManager styleManager;
+    composer.compose(&styleManager);
+
+    FontManager fontManager;
+    TextShaper textShaper(&fontManager);
+    textShaper.setFallbackFont(fontManager.loadFontFromPath(
+        QStringLiteral(":/fonts/PrettySymbolsFallback.ttf")));
+    Hyphenator hyphenator;
+    hyphenator.loadDictionary(QStringLiteral("en_US"));
+    PageLayout pageLayout;
+
+    AllocProfiler::reset();
+    QElapsedTimer timer;
+    timer.start();
+    ContentBuilder builder;
+    builder.setBasePath(basePath);
+    builder.setStyleManager(&styleManager);
+    if (hyphenator.isLoaded())
+        builder.setHyphenator(&hyphenator);
+    builder.setFootnoteStyle(styleManager.footnoteStyle());
+    Content::Document doc = builder.build(markdown);
+    Layout::Engine engine(&fontManager, &textShaper);
+    Layout::LayoutResult layout = engine.layout(doc, pageLayout);
+    const qreal layoutMs = timer.nsecsElapsed() / 1.0e6;
+
+    qsizetype glyphCount = 0;
+    for (const auto &page : layout.pages) {
+        for (const auto &elem : page.elements) {
+            if (const auto *block = std::get_if<Layout::BlockBox>(&elem)) {
+                for (const auto &line : block->lines)
+                    for (const auto &gbox : line.glyphs)
+                        glyphCount += gbox.glyphs.size();
+            }
+        }
+    }
+
+    const int pages = qMax<int>(1, layout.pages.size());
+    QList<qreal> runMs;
+    qsizetype pdfBytes = 0;
+    QString allocations;
+    for (int i = 0; i < iterations; ++i) {
+        fontManager.resetUsage();
+        timer.restart();
+        PdfGenerator generator(&fontManager);
+        QByteArray pdf = generator.generate(layout, pageLayout, name);
+        runMs.append(timer.nsecsElapsed() / 1.0e6);
+        pdfBytes = pdf.size();
+        if (i == 0)
+            allocations = AllocProfiler::report(pages);
+    }
+
+    out << "document   " << name << " (" << markdown.size() << " chars)\n";
+    out << QStringLiteral("layout     %1 ms, %2 pages, %3 glyphs in paragraphs\n")
+               .arg(layoutMs, 0, 'f', 1).arg(layout.pages.size()).arg(glyphCount);
+    out << QStringLiteral("pdf        mean/min %1 / %2 ms  (%3 ms/page, %4 runs)\n")
+               .arg(mean(runMs), 0, 'f', 1)
+               .arg(*std::min_element(runMs.begin(), runMs.end()), 0, 'f', 1)
+               .arg(mean(runMs) / pages, 0, 'f', 3)
+               .arg(iterations);
+    out << QStringLiteral("pdf size   %1 KiB\n").arg(pdfBytes / 1024.0, 0, 'f', 1);
+    out << allocations;
+
+    // Raw operator formatting, one Tm + Tj per glyph
+    QList<GlyphSample> samples;
+    samples.reserve(200000);
+    for (int i = 0; i < 200000; ++i)
+        samples.append({72.0 + (i % 80) * 5.37, 720.0 - (i / 80 % 60) * 11.9,
+                        static_cast<quint16>(i * 7919 % 2000)});
+
+    timer.restart();
+    const QByteArray concatenated = formatConcatenated(samples);
+    const qreal concatMs = timer.nsecsElapsed() / 1.0e6;
+    timer.restart();
+    const QByteArray buffered = formatBuffered(samples);
+    const qreal bufferMs = timer.nsecsElapsed() / 1.0e6;
+
+    out << QStringLiteral("operators  %1 glyphs: concatenation %2 ms, Pdf::Buffer %3 ms (%4)\n")
+               .arg(samples.size())
+               .arg(concatMs, 0, 'f', 1)
+               .arg(bufferMs, 0, 'f', 1)
+               .arg(concatenated == buffered ? QStringLiteral("identical output")
+                                             : QStringLiteral("OUTPUT DIFFERS"));
+
+    // Transcoding: ActualText hex of the document's lines, and the UTF-16
+    // length of its UTF-8 form (ContentBuilder's source offsets)
+    const QStringList lines = markdown.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    timer.restart();
+    const QByteArray perChar = hexPerChar(lines);
+    const qreal perCharMs = timer.nsecsElapsed() / 1.0e6;
+    timer.restart();
+    const QByteArray transcoded = hexTranscoded(lines);
+    const qreal transcodedMs = timer.nsecsElapsed() / 1.0e6;
+
+    const QByteArray utf8 = markdown.toUtf8();
+    timer.restart();
+    const qsizetype perByteUnits = utf16LengthPerByte(utf8);
+    const qreal perByteMs = timer.nsecsElapsed() / 1.0e6;
+    timer.restart();
+    const qsizetype units = Utf16::lengthOfUtf8(utf8.constData(), utf8.size());
+    const qreal unitsMs = timer.nsecsElapsed() / 1.0e6;
+
+    out << QStringLiteral("utf16 hex  %1 units: per char %2 ms, Utf16 %3 ms (%4)\n")
+               .arg(markdown.size())
+               .arg(perCharMs, 0, 'f', 2)
+               .arg(transcodedMs, 0, 'f', 2)
+               .arg(perChar == transcoded ? QStringLiteral("identical output")
+                                          : QStringLiteral("OUTPUT DIFFERS"));
+    out << QStringLiteral("utf8 len   %1 bytes: per byte %2 ms, Utf16 %3 ms (%4)\n")
+               .arg(utf8.size())
+               .arg(perByteMs, 0, 'f', 2)
+               .arg(unitsMs, 0, 'f', 2)
+               .arg(perByteUnits == units ? QStringLiteral("identical output")
+                                          : QStringLiteral("OUTPUT DIFFERS"));
+    return 0;
+}
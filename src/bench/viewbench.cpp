@@ -0,0 +1,497 @@
+/*
+ * viewbench.cpp — Scripted scroll/zoom replay benchmark for DocumentView
+ *
+ * Opens a markdown document in an offscreen DocumentView (offscreen QPA,
+ * no GPU), replays a scripted sequence of scrolls, page jumps and zoom
+ * steps in print mode and web mode, and reports frame times, RenderCache
+ * hit rates, time-to-sharp-page and peak memory.  Built with
+ * PRETTYREADER_ALLOC_PROFILING, each mode also reports heap allocations
+ * per pipeline stage (painting covers the web-mode QtBoxRenderer passes).
+ *
+ * Usage:
+ *   prettyreader-viewbench [--mode print|web|both] [--size WxH]
+ *                          [--script FILE] FILE.md
+ *
+ * Script format — one command per line, '#' starts a comment:
+ *   scroll <px>      scroll the viewport by <px> (negative = up)
+ *   page <n>         jump to page <n> (1-based; web mode: n viewports down)
+ *   jump <fraction>  jump to a fraction (0..1) of the scroll range
+ *   zoom <percent>   set the zoom level
+ *   wait <ms>        pump the event loop for <ms> milliseconds
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "allocprofiler.h"
+#include "colorpalette.h"
+#include "contentbuilder.h"
+#include "documentview.h"
+#include "fontmanager.h"
+#include "hyphenator.h"
+#include "layoutengine.h"
+#include "pagelayout.h"
+#include "palettemanager.h"
+#include "pdfgenerator.h"
+#include "rendercache.h"
+#include "stylemanager.h"
+#include "textshaper.h"
+#include "themecomposer.h"
+#include "thememanager.h"
+#include "typeset.h"
+#include "typesetmanager.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QScrollBar>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+struct Step {
+    enum Kind { Scroll, Page, Jump, Zoom, Wait };
+    Kind kind = Scroll;
+    qreal value = 0;
+};
+
+struct ModeReport {
+    QString mode;
+    QList<qreal> frameMs;
+    QList<qreal> sharpMs;       // one sample per page jump / zoom step
+    int sharpTimeouts = 0;
+    RenderCache::Stats cache;
+    qreal setupMs = 0;          // build + layout (+ PDF) before the first frame
+    QString allocations;        // AllocProfiler::report(), empty when not built in
+};
+
+constexpr qint64 kSharpTimeoutMs = 10000;
+
+QList<Step> defaultScript()
+{
+    QList<Step> steps;
+    auto add = [&steps](Step::Kind kind, qreal value) { steps.append({kind, value}); };
+
+    // Smooth wheel-style scrolling through the first part of the document
+    for (int i = 0; i < 40; ++i)
+        add(Step::Scroll, 120);
+    // Page jumps across the document and back
+    for (qreal f : {0.25, 0.5, 0.75, 1.0, 0.0})
+        add(Step::Jump, f);
+    // Zoom ladder
+    for (int z : {125, 150, 200, 300, 75, 100})
+        add(Step::Zoom, z);
+    // Scroll back up after zooming (exercises re-rasterization)
+    for (int i = 0; i < 20; ++i)
+        add(Step::Scroll, 240);
+    for (int i = 0; i < 20; ++i)
+        add(Step::Scroll, -240);
+    return steps;
+}
+
+bool parseScript(const QString &path, QList<Step> &steps, QString &error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        error = QStringLiteral("cannot open script %1").arg(path);
+        return false;
+    }
+
+    int lineNo = 0;
+    while (!file.atEnd()) {
+        ++lineNo;
+        QString line = QString::fromUtf8(file.readLine());
+        int hash = line.indexOf(QLatin1Char('#'));
+        if (hash >= 0)
+            line.truncate(hash);
+        const QStringList parts = line.simplified().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        if (parts.isEmpty())
+            continue;
+
+        bool ok = parts.size() == 2;
+        qreal value = ok ? parts[1].toDouble(&ok) : 0;
+        const QString &cmd = parts[0];
+        Step step;
+        step.value = value;
+        if (cmd == QLatin1String("scroll"))
+            step.kind = Step::Scroll;
+        else if (cmd == QLatin1String("page"))
+            step.kind = Step::Page;
+        else if (cmd == QLatin1String("jump"))
+            step.kind = Step::Jump;
+        else if (cmd == QLatin1String("zoom"))
+            step.kind = Step::Zoom;
+        else if (cmd == QLatin1String("wait"))
+            step.kind = Step::Wait;
+        else
+            ok = false;
+
+        if (!ok) {
+            error = QStringLiteral("%1:%2: cannot parse '%3'")
+                        .arg(path).arg(lineNo).arg(line.trimmed());
+            return false;
+        }
+        steps.append(step);
+    }
+    return true;
+}
+
+qint64 peakRssKb()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss; // kilobytes on Linux
+#endif
+    return -1;
+}
+
+qreal percentile(QList<qreal> values, qreal p)
+{
+    if (values.isEmpty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    int idx = qBound(0, static_cast<int>(p * (values.size() - 1) + 0.5), int(values.size() - 1));
+    return values[idx];
+}
+
+qreal mean(const QList<qreal> &values)
+{
+    if (values.isEmpty())
+        return 0;
+    qreal sum = 0;
+    for (qreal v : values)
+        sum += v;
+    return sum / values.size();
+}
+
+// --- Rendering pipeline (mirrors MainWindow::rebuildCurrentDocument) ---
+
+class Pipeline
+{
+public:
+    Pipeline()
+        : m_composer(&m_themeManager)
+        , m_textShaper(&m_fontManager)
+    {
+        const QStringList typeSets = m_typeSets.availableTypeSets();
+        if (!typeSets.isEmpty())
+            m_composer.setTypeSet(m_typeSets.typeSet(
+                typeSets.contains(QStringLiteral("default")) ? QStringLiteral("default") : typeSets.first()));
+        const QStringList palettes = m_palettes.availablePalettes();
+        if (!palettes.isEmpty())
+            m_composer.setColorPalette(m_palettes.palette(
+                palettes.contains(QStringLiteral("default-light")) ? QStringLiteral("default-light") : palettes.first()));
+        m_composer.compose(&m_styleManager);
+
+        m_textShaper.setFallbackFont(m_fontManager.loadFontFromPath(
+            QStringLiteral(":/fonts/PrettySymbolsFallback.ttf")));
+        m_hyphenator.loadDictionary(QStringLiteral("en_US"));
+
+        QColor pageBg = m_composer.currentPalette().pageBackground();
+        if (pageBg.isValid())
+            m_pageLayout.pageBackground = pageBg;
+    }
+
+    void build(const QString &markdown, const QString &basePath)
+    {
+        ContentBuilder builder;
+        builder.setBasePath(basePath);
+        builder.setStyleManager(&m_styleManager);
+        if (m_hyphenator.isLoaded())
+            builder.setHyphenator(&m_hyphenator);
+        builder.setFootnoteStyle(m_styleManager.footnoteStyle());
+        m_doc = builder.build(markdown);
+    }
+
+    QByteArray printPdf(const QString &title)
+    {
+        m_fontManager.resetUsage();
+        Layout::Engine engine(&m_fontManager, &m_textShaper);
+        Layout::LayoutResult result = engine.layout(m_doc, m_pageLayout);
+        PdfGenerator generator(&m_fontManager);
+        return generator.generate(result, m_pageLayout, title);
+    }
+
+    Layout::ContinuousLayoutResult webLayout(qreal availWidth)
+    {
+        Layout::Engine engine(&m_fontManager, &m_textShaper);
+        return engine.layoutContinuous(m_doc, availWidth);
+    }
+
+    FontManager *fontManager() { return &m_fontManager; }
+    const PageLayout &pageLayout() const { return m_pageLayout; }
+
+private:
+    ThemeManager m_themeManager;
+    TypeSetManager m_typeSets;
+    PaletteManager m_palettes;
+    ThemeComposer m_composer;
+    StyleManager m_styleManager;
+    FontManager m_fontManager;
+    TextShaper m_textShaper;
+    Hyphenator m_hyphenator;
+    PageLayout m_pageLayout;
+    Content::Document m_doc;
+};
+
+// Same available-width computation as MainWindow's web pipeline
+qreal webAvailWidth(DocumentView *view)
+{
+    qreal availWidth = view->viewport()->width() - 2 * DocumentView::kSceneMargin;
+    qreal zoomFactor = view->zoomPercent() / 100.0;
+    if (zoomFactor > 0)
+        availWidth /= zoomFactor;
+    return qMax<qreal>(availWidth, 200);
+}
+
+qint64 cacheMisses(DocumentView *view)
+{
+    RenderCache::Stats s = view->renderCache()->stats();
+    return s.lookups - s.hits;
+}
+
+qreal paintFrame(DocumentView *view)
+{
+    QElapsedTimer timer;
+    timer.start();
+    view->viewport()->repaint();
+    return timer.nsecsElapsed() / 1.0e6;
+}
+
+// Repaint until a frame is drawn entirely from cached rasters (print mode)
+// or once (web mode paints synchronously).  Returns -1 on timeout.
+qreal waitUntilSharp(DocumentView *view, ModeReport &report)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (;;) {
+        QCoreApplication::processEvents();
+        qint64 missesBefore = cacheMisses(view);
+        report.frameMs.append(paintFrame(view));
+        if (view->renderMode() == DocumentView::WebMode
+            || cacheMisses(view) == missesBefore)
+            return timer.nsecsElapsed() / 1.0e6;
+        if (timer.elapsed() > kSharpTimeoutMs)
+            return -1;
+        QThread::msleep(1);
+    }
+}
+
+ModeReport runMode(DocumentView::RenderMode mode, Pipeline &pipeline,
+                   const QString &markdown, const QFileInfo &fi,
+                   const QSize &viewportSize, const QList<Step> &script)
+{
+    ModeReport report;
+    report.mode = mode == DocumentView::WebMode ? QStringLiteral("web") : QStringLiteral("print");
+
+    DocumentView view;
+    view.resize(viewportSize);
+    view.setPageLayout(pipeline.pageLayout());
+    view.setRenderMode(mode);
+    view.show();
+    QCoreApplication::processEvents();
+
+    AllocProfiler::reset();
+    QElapsedTimer setup;
+    setup.start();
+    pipeline.build(markdown, fi.absolutePath());
+    if (mode == DocumentView::WebMode) {
+        view.setWebFontManager(pipeline.fontManager());
+        view.setWebContent(pipeline.webLayout(webAvailWidth(&view)));
+        QObject::connect(&view, &DocumentView::webRelayoutRequested, &view, [&]() {
+            view.setWebContent(pipeline.webLayout(webAvailWidth(&view)));
+        });
+    } else {
+        view.setPdfData(pipeline.printPdf(fi.baseName()));
+    }
+    report.setupMs = setup.nsecsElapsed() / 1.0e6;
+
+    // Let the deferred fit-width run, then start from a sharp first page
+    QCoreApplication::processEvents();
+    view.renderCache()->resetStats();
+    qreal firstSharp = waitUntilSharp(&view, report);
+    if (firstSharp >= 0)
+        report.sharpMs.append(firstSharp);
+    else
+        ++report.sharpTimeouts;
+
+    QScrollBar *vbar = view.verticalScrollBar();
+    for (const Step &step : script) {
+        bool measureSharp = false;
+        switch (step.kind) {
+        case Step::Scroll:
+            vbar->setValue(vbar->value() + qRound(step.value));
+            break;
+        case Step::Page:
+            if (mode == DocumentView::WebMode)
+                vbar->setValue(qRound(step.value * view.viewport()->height()));
+            else
+                view.goToPage(qRound(step.value) - 1);
+            measureSharp = true;
+            break;
+        case Step::Jump:
+            vbar->setValue(qRound(qBound<qreal>(0, step.value, 1) * vbar->maximum()));
+            measureSharp = true;
+            break;
+        case Step::Zoom:
+            view.setZoomPercent(qRound(step.value));
+            measureSharp = true;
+            break;
+        case Step::Wait: {
+            QElapsedTimer wait;
+            wait.start();
+            while (wait.elapsed() < step.value)
+                QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+            continue;
+        }
+        }
+
+        if (measureSharp) {
+            qreal ms = waitUntilSharp(&view, report);
+            if (ms >= 0)
+                report.sharpMs.append(ms);
+            else
+                ++report.sharpTimeouts;
+        } else {
+            QCoreApplication::processEvents();
+            report.frameMs.append(paintFrame(&view));
+        }
+    }
+
+    report.cache = view.renderCache()->stats();
+    report.allocations = AllocProfiler::report(view.pageCount());
+    return report;
+}
+
+void printReport(QTextStream &out, const ModeReport &r)
+{
+    out << "[" << r.mode << "]\n";
+    out << QStringLiteral("  setup (build+layout%1)   %2 ms\n")
+               .arg(r.mode == QLatin1String("print") ? QStringLiteral("+pdf") : QString())
+               .arg(r.setupMs, 0, 'f', 1);
+    out << QStringLiteral("  frames                  %1\n").arg(r.frameMs.size());
+    out << QStringLiteral("  frame ms  mean/p50/p95/max  %1 / %2 / %3 / %4\n")
+               .arg(mean(r.frameMs), 0, 'f', 2)
+               .arg(percentile(r.frameMs, 0.5), 0, 'f', 2)
+               .arg(percentile(r.frameMs, 0.95), 0, 'f', 2)
+               .arg(percentile(r.frameMs, 1.0), 0, 'f', 2);
+    out << QStringLiteral("  time-to-sharp ms  mean/max   %1 / %2  (%3 samples, %4 timeouts)\n")
+               .arg(mean(r.sharpMs), 0, 'f', 1)
+               .arg(percentile(r.sharpMs, 1.0), 0, 'f', 1)
+               .arg(r.sharpMs.size())
+               .arg(r.sharpTimeouts);
+    if (r.mode == QLatin1String("print")) {
+        qreal hitRate = r.cache.lookups > 0
+            ? 100.0 * r.cache.hits / r.cache.lookups : 0;
+        out << QStringLiteral("  cache lookups/hits      %1 / %2  (%3% hit rate)\n")
+                   .arg(r.cache.lookups).arg(r.cache.hits).arg(hitRate, 0, 'f', 1);
+        out << QStringLiteral("  cache renders/evictions %1 / %2\n")
+                   .arg(r.cache.renders).arg(r.cache.evictions);
+        out << QStringLiteral("  cache resident          %1 MiB\n")
+                   .arg(r.cache.memoryBytes / (1024.0 * 1024.0), 0, 'f', 1);
+        out << QStringLiteral("  cold restores/resident  %1 / %2 MiB\n")
+                   .arg(r.cache.restores)
+                   .arg(r.cache.coldMemoryBytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    for (const QString &line : r.allocations.split(QLatin1Char('\n'), Qt::SkipEmptyParts))
+        out << "  " << line << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Offscreen QPA: no display or GPU needed, raster paint engine only
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("prettyreader-viewbench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QStringLiteral("Replays scripted scrolling and zooming in DocumentView."));
+    parser.addHelpOption();
+    QCommandLineOption modeOpt(QStringLiteral("mode"),
+        QStringLiteral("Render mode: print, web or both (default both)."),
+        QStringLiteral("mode"), QStringLiteral("both"));
+    QCommandLineOption sizeOpt(QStringLiteral("size"),
+        QStringLiteral("Viewport size (default 1200x800)."),
+        QStringLiteral("WxH"), QStringLiteral("1200x800"));
+    QCommandLineOption scriptOpt(QStringLiteral("script"),
+        QStringLiteral("Replay script (default: built-in scroll/jump/zoom sequence)."),
+        QStringLiteral("file"));
+    parser.addOption(modeOpt);
+    parser.addOption(sizeOpt);
+    parser.addOption(scriptOpt);
+    parser.addPositionalArgument(QStringLiteral("file"), QStringLiteral("Markdown document."));
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    QFileInfo fi(args.first());
+    QFile file(fi.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        err << "viewbench: cannot open " << fi.filePath() << "\n";
+        return 1;
+    }
+    const QString markdown = QString::fromUtf8(file.readAll());
+
+    QList<Step> script = defaultScript();
+    if (parser.isSet(scriptOpt)) {
+        script.clear();
+        QString error;
+        if (!parseScript(parser.value(scriptOpt), script, error)) {
+            err << "viewbench: " << error << "\n";
+            return 1;
+        }
+    }
+
+    QSize viewportSize(1200, 800);
+    {
+        const QStringList wh = parser.value(sizeOpt).split(QLatin1Char('x'));
+        if (wh.size() == 2 && wh[0].toInt() > 0 && wh[1].toInt() > 0)
+            viewportSize = QSize(wh[0].toInt(), wh[1].toInt());
+    }
+
+    const QString mode = parser.value(modeOpt);
+    QList<DocumentView::RenderMode> modes;
+    if (mode == QLatin1String("print") || mode == QLatin1String("both"))
+        modes << DocumentView::PrintMode;
+    if (mode == QLatin1String("web") || mode == QLatin1String("both"))
+        modes << DocumentView::WebMode;
+    if (modes.isEmpty()) {
+        err << "viewbench: unknown mode " << mode << "\n";
+        return 1;
+    }
+
+    Pipeline pipeline;
+
+    out << "document   " << fi.fileName() << " (" << markdown.size() << " chars)\n";
+    out << "viewport   " << viewportSize.width() << "x" << viewportSize.height() << "\n";
+    out << "script     " << script.size() << " steps\n";
+
+    for (DocumentView::RenderMode m : modes) {
+        ModeReport report = runMode(m, pipeline, markdown, fi, viewportSize, script);
+        printReport(out, report);
+        out.flush();
+    }
+
+    out << "peak RSS   " << peakRssKb() / 1024 << " MiB\n";
+    return 0;
+}
@@ -7,6 +7,7 @@
 #include "contentrtfexporter.h"
 
 #include <climits>
+#include <memory>
 
 #include <QAction>
 #include <QApplication>
@@ -18,6 +19,7 @@
 #include <QMimeData>
 #include <QMouseEvent>
 #include <QScrollBar>
+#include <QThread>
 #include <QTimer>
 #include <QWheelEvent>
 #include <QtMath>
@@ -114,17 +116,35 @@ void DocumentView::setPdfData(const QByteArray &pdf)
 
     m_pdfData = pdf;
     m_pdfMode = true;
+    m_hibernated = false;
+    ++m_loadGeneration;
     m_linkCache.clear();  // A7: invalidate link cache for new document
     m_sourceMap.clear();
     m_processedMarkdown.clear();
     m_contentDoc.blocks.clear();
     m_codeBlockRegions.clear();
+    m_selectionIndex = {};
 
+    installPopplerDocument(Poppler::Document::loadFromData(pdf).release());
+    if (!m_popplerDoc)
+        return;
+
+    if (!m_pdfPageItems.isEmpty()) {
+        m_currentPage = 0;
+        if (!m_skipAutoFit) {
+            QTimer::singleShot(0, this, &DocumentView::fitWidth);
+        }
+        m_skipAutoFit = false;
+    }
+}
+
+void DocumentView::installPopplerDocument(Poppler::Document *doc)
+{
     // Detach render cache before freeing the old Poppler document —
     // blocks until any in-progress render finishes, preventing use-after-free.
     m_renderCache->setDocument(nullptr);
     delete m_popplerDoc;
-    m_popplerDoc = Poppler::Document::loadFromData(pdf).release();
+    m_popplerDoc = doc;
     if (!m_popplerDoc) {
         m_pageCount = 0;
         return;
@@ -136,14 +156,72 @@ void DocumentView::setPdfData(const QByteArray &pdf)
     m_pageCount = m_popplerDoc->numPages();
 
     layoutPages();
+}
 
-    if (!m_pdfPageItems.isEmpty()) {
-        m_currentPage = 0;
-        if (!m_skipAutoFit) {
-            QTimer::singleShot(0, this, &DocumentView::fitWidth);
-        }
-        m_skipAutoFit = false;
+// --- Hibernation ---
+
+void DocumentView::hibernate()
+{
+    if (m_hibernated)
+        return;
+    const bool webMode = m_renderMode == WebMode;
+    if (webMode ? !m_webViewItem : !(m_pdfMode && m_popplerDoc))
+        return;
+
+    m_hibernatedState = saveViewState();
+    m_relayoutTimer.stop();
+
+    // The PDF bytes are the compact form of the laid-out pages (content
+    // streams and fonts are already Flate-compressed); everything derived
+    // from them is dropped.
+    clearPdfPages();
+    m_renderCache->setDocument(nullptr);
+    delete m_popplerDoc;
+    m_popplerDoc = nullptr;
+    if (webMode)
+        m_pdfData.clear();
+
+    m_scene->clear();
+    m_webViewItem = nullptr;
+    m_linkCache.clear();
+    m_pagesWithSelection.clear();
+    m_pageCount = 0;
+    ++m_loadGeneration;
+    m_hibernated = true;
+}
+
+void DocumentView::wake()
+{
+    if (!m_hibernated)
+        return;
+
+    if (m_renderMode == WebMode) {
+        // The owner lays the content out again; the view state is
+        // restored from saveViewState()
+        Q_EMIT webRelayoutRequested();
+        return;
     }
+
+    // Parse on a worker thread; the scene stays empty until the
+    // document is installed.  The document is owned by the lambdas
+    // until then, so it is freed with them if the view goes first.
+    auto loaded = std::make_shared<std::unique_ptr<Poppler::Document>>();
+    const QByteArray pdf = m_pdfData;
+    const int generation = m_loadGeneration;
+
+    QThread *thread = QThread::create([loaded, pdf]() {
+        *loaded = Poppler::Document::loadFromData(pdf);
+    });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::finished, this, [this, loaded, generation]() {
+        if (generation != m_loadGeneration || !m_hibernated)
+            return; // superseded by new content or hibernated again
+        m_hibernated = false;
+        installPopplerDocument(loaded->release());
+        restoreViewState(m_hibernatedState);
+        m_skipAutoFit = false;
+    });
+    thread->start();
 }
 
 void DocumentView::clearPdfPages()
@@ -184,6 +262,9 @@ void DocumentView::setDocumentInfo(const QString &fileName, const QString &title
 
 ViewState DocumentView::saveViewState() const
 {
+    if (m_hibernated)
+        return m_hibernatedState;
+
     ViewState state;
     state.zoomPercent = m_currentZoom;
     state.currentPage = m_currentPage;
@@ -691,6 +772,34 @@ void DocumentView::nextPage()
         goToPage(m_currentPage + 1);
 }
 
+void DocumentView::prefetchNeighbourPages(int radius)
+{
+    if (!m_pdfMode || !m_popplerDoc || m_hibernated)
+        return;
+
+    // Same sizes PdfPageItem::paint() asks for
+    const qreal zoom = m_currentZoom / 100.0;
+    const qreal dpr = viewport()->devicePixelRatioF();
+    for (int distance = 1; distance <= radius; ++distance) {
+        for (int page : {m_currentPage + distance, m_currentPage - distance}) {
+            if (page < 0 || page >= m_pageCount)
+                continue;
+            QSizeF pageSize = m_pageSize;
+            std::unique_ptr<Poppler::Page> pp(m_popplerDoc->page(page));
+            if (pp)
+                pageSize = pp->pageSizeF();
+
+            RenderCache::Request req;
+            req.pageNumber = page;
+            req.width = qRound(pageSize.width() * zoom);
+            req.height = qRound(pageSize.height() * zoom);
+            req.dpr = dpr;
+            req.priority = distance;
+            m_renderCache->requestPixmap(req);
+        }
+    }
+}
+
 // --- View mode ---
 
 void DocumentView::setViewMode(ViewMode mode)
@@ -724,6 +833,9 @@ void DocumentView::setWebContent(Layout::ContinuousLayoutResult &&result)
 {
     Q_ASSERT(m_webFontManager);
 
+    m_hibernated = false;
+    ++m_loadGeneration;
+
     m_scene->clear();
     m_pageItems.clear();
     m_pdfPageItems.clear();
@@ -907,6 +1019,32 @@ void DocumentView::mouseDoubleClickEvent(QMouseEvent *event)
         // B2: Double-click to select a word
         QPointF scenePos = mapToScene(event->pos());
 
+        if (!m_selectionIndex.isEmpty()) {
+            int pageNum = -1;
+            selectionOffsetAt(scenePos, &pageNum);
+            PdfPageItem *pageItem = nullptr;
+            for (auto *item : m_pdfPageItems) {
+                if (item->pageNumber() == pageNum)
+                    pageItem = item;
+            }
+            int from = 0;
+            int to = 0;
+            if (pageItem && m_selectionIndex.wordAt(pageNum, scenePos - pageItem->pos(), &from, &to)) {
+                clearSelection();
+                m_wordSelection = true;
+                m_selectionFrom = from;
+                m_selectionTo = to;
+                pageItem->setSelectionRects(m_selectionIndex.rects(pageNum, from, to));
+                m_pagesWithSelection.insert(pageNum);
+                // Auto-copy word (Okular pattern)
+                auto *mimeData = new QMimeData;
+                mimeData->setText(m_selectionIndex.text(from, to));
+                QApplication::clipboard()->setMimeData(mimeData);
+            }
+            event->accept();
+            return;
+        }
+
         for (auto *pageItem : m_pdfPageItems) {
             QRectF itemRect = QRectF(0, 0, pageItem->pageSize().width(),
                                       pageItem->pageSize().height())
@@ -982,7 +1120,7 @@ void DocumentView::applyLanguageOverrides(Content::Document &doc) const
 
     for (auto &block : doc.blocks) {
         if (auto *cb = std::get_if<Content::CodeBlock>(&block)) {
-            QString key = cb->code.trimmed();
+            QString key = cb->code.toString().trimmed();
             auto it = m_codeBlockLanguageOverrides.find(key);
             if (it != m_codeBlockLanguageOverrides.end())
                 cb->language = it.value();
@@ -1068,6 +1206,8 @@ void DocumentView::clearSelection()
         }
     }
     m_pagesWithSelection.clear();
+    m_selectionFrom = -1;
+    m_selectionTo = -1;
     m_textSelecting = false;
 }
 
@@ -1087,6 +1227,35 @@ void DocumentView::updateTextSelection()
         }
     }
     m_pagesWithSelection.clear();
+    m_selectionFrom = -1;
+    m_selectionTo = -1;
+
+    // Layout text index: the drag endpoints become text offsets and only
+    // the pages between them are touched
+    if (!m_selectionIndex.isEmpty()) {
+        int pressPage = -1;
+        int currentPage = -1;
+        const int a = selectionOffsetAt(m_selectPressPos, &pressPage);
+        const int b = selectionOffsetAt(m_selectCurrentPos, &currentPage);
+        if (a < 0 || b < 0 || a == b)
+            return;
+        m_selectionFrom = qMin(a, b);
+        m_selectionTo = qMax(a, b);
+        const int firstPage = qMin(pressPage, currentPage);
+        const int lastPage = qMax(pressPage, currentPage);
+        for (auto *pageItem : m_pdfPageItems) {
+            const int pageNum = pageItem->pageNumber();
+            if (pageNum < firstPage || pageNum > lastPage)
+                continue;
+            const QList<QRectF> rects = m_selectionIndex.rects(pageNum, m_selectionFrom,
+                                                               m_selectionTo);
+            if (!rects.isEmpty()) {
+                pageItem->setSelectionRects(rects);
+                m_pagesWithSelection.insert(pageNum);
+            }
+        }
+        return;
+    }
 
     // Prefer source map rects for continuous, clean band-style highlighting
     // (since we generated the PDF ourselves and know the exact layout).
@@ -1157,14 +1326,58 @@ QString DocumentView::extractSelectedText() const
     if (m_pagesWithSelection.isEmpty())
         return {};
 
-    // For word selection (double-click) or missing source data, use Poppler fallback
+    // For word selection (double-click) or missing source data, copy the
+    // rendered text
     if (m_wordSelection || m_sourceMap.isEmpty() || m_processedMarkdown.isEmpty())
-        return extractSelectedTextFromPdf();
+        return extractSelectedPlainText();
+
+    // Map the selection to markdown source lines
+    int minLine = 0;
+    int maxLine = 0;
+    if (!selectedSourceLines(&minLine, &maxLine))
+        return {};
 
-    // Source map approach: map selection rect to markdown source lines
+    // Extract lines from processed markdown
+    const QStringList lines = m_processedMarkdown.split(QLatin1Char('\n'));
+    QStringList selected;
+    for (int i = minLine - 1; i < maxLine && i < lines.size(); ++i) {
+        selected.append(lines[i]);
+    }
+    return selected.join(QLatin1Char('\n'));
+}
+
+int DocumentView::selectionOffsetAt(const QPointF &scenePos, int *pageNum) const
+{
+    // The page under the point, else the vertically nearest one
+    PdfPageItem *nearest = nullptr;
+    qreal nearestDistance = 0;
+    for (auto *pageItem : m_pdfPageItems) {
+        const QRectF itemRect = pageItem->boundingRect().translated(pageItem->pos());
+        const qreal distance = scenePos.y() < itemRect.top() ? itemRect.top() - scenePos.y()
+                             : scenePos.y() > itemRect.bottom() ? scenePos.y() - itemRect.bottom()
+                             : 0;
+        if (!nearest || distance < nearestDistance) {
+            nearest = pageItem;
+            nearestDistance = distance;
+        }
+        if (distance == 0 && itemRect.contains(scenePos))
+            break;
+    }
+    if (!nearest)
+        return -1;
+    *pageNum = nearest->pageNumber();
+    return m_selectionIndex.offsetAt(*pageNum, scenePos - nearest->pos());
+}
+
+bool DocumentView::selectedSourceLines(int *minLine, int *maxLine) const
+{
+    if (m_selectionFrom >= 0)
+        return m_selectionIndex.sourceLines(m_selectionFrom, m_selectionTo, minLine, maxLine);
+
+    // Source map blocks the selection rect touches
     QRectF selRect = QRectF(m_selectPressPos, m_selectCurrentPos).normalized();
-    int minLine = INT_MAX;
-    int maxLine = -1;
+    int lo = INT_MAX;
+    int hi = -1;
 
     for (auto *pageItem : m_pdfPageItems) {
         QRectF itemRect = pageItem->boundingRect().translated(pageItem->pos());
@@ -1181,27 +1394,26 @@ QString DocumentView::extractSelectedText() const
         for (const auto &entry : m_sourceMap) {
             if (entry.pageNumber == pageNum && entry.rect.intersects(localSel)) {
                 if (entry.startLine > 0) {
-                    minLine = qMin(minLine, entry.startLine);
-                    maxLine = qMax(maxLine, entry.endLine);
+                    lo = qMin(lo, entry.startLine);
+                    hi = qMax(hi, entry.endLine);
                 }
             }
         }
     }
 
-    if (minLine > maxLine)
-        return {};
-
-    // Extract lines from processed markdown
-    const QStringList lines = m_processedMarkdown.split(QLatin1Char('\n'));
-    QStringList selected;
-    for (int i = minLine - 1; i < maxLine && i < lines.size(); ++i) {
-        selected.append(lines[i]);
-    }
-    return selected.join(QLatin1Char('\n'));
+    if (lo > hi)
+        return false;
+    *minLine = lo;
+    *maxLine = hi;
+    return true;
 }
 
-QString DocumentView::extractSelectedTextFromPdf() const
+QString DocumentView::extractSelectedPlainText() const
 {
+    if (m_selectionFrom >= 0)
+        return m_selectionIndex.text(m_selectionFrom, m_selectionTo);
+
+    // Poppler fallback
     if (!m_pdfMode || !m_popplerDoc || m_pagesWithSelection.isEmpty())
         return {};
 
@@ -1335,34 +1547,10 @@ void DocumentView::copySelection()
 
     // Generate styled RTF from content model blocks
     if (hasSourceData && !m_contentDoc.blocks.isEmpty()) {
-        // Compute line range from source map (same logic as extractSelectedText)
-        QRectF selRect = QRectF(m_selectPressPos, m_selectCurrentPos).normalized();
-        int minLine = INT_MAX;
-        int maxLine = -1;
-
-        for (auto *pageItem : m_pdfPageItems) {
-            QRectF itemRect = pageItem->boundingRect().translated(pageItem->pos());
-            if (!selRect.intersects(itemRect))
-                continue;
-
-            int pageNum = pageItem->pageNumber();
-            QRectF localSel = selRect.translated(-pageItem->pos());
-            localSel = localSel.intersected(
-                QRectF(0, 0, pageItem->pageSize().width(), pageItem->pageSize().height()));
-            if (localSel.isEmpty())
-                continue;
-
-            for (const auto &entry : m_sourceMap) {
-                if (entry.pageNumber == pageNum && entry.rect.intersects(localSel)) {
-                    if (entry.startLine > 0) {
-                        minLine = qMin(minLine, entry.startLine);
-                        maxLine = qMax(maxLine, entry.endLine);
-                    }
-                }
-            }
-        }
-
-        if (minLine <= maxLine) {
+        // Same line range as extractSelectedText
+        int minLine = 0;
+        int maxLine = 0;
+        if (selectedSourceLines(&minLine, &maxLine)) {
             QList<Content::BlockNode> filteredBlocks = extractSelectedBlocks(minLine, maxLine);
             if (!filteredBlocks.isEmpty()) {
                 ContentRtfExporter rtfExporter;
@@ -1384,31 +1572,9 @@ void DocumentView::copySelectionAsRtf()
     if (!hasSourceData || m_pagesWithSelection.isEmpty())
         return;
 
-    QRectF selRect = QRectF(m_selectPressPos, m_selectCurrentPos).normalized();
-    int minLine = INT_MAX;
-    int maxLine = -1;
-
-    for (auto *pageItem : m_pdfPageItems) {
-        QRectF itemRect = pageItem->boundingRect().translated(pageItem->pos());
-        if (!selRect.intersects(itemRect))
-            continue;
-        int pageNum = pageItem->pageNumber();
-        QRectF localSel = selRect.translated(-pageItem->pos());
-        localSel = localSel.intersected(
-            QRectF(0, 0, pageItem->pageSize().width(), pageItem->pageSize().height()));
-        if (localSel.isEmpty())
-            continue;
-        for (const auto &entry : m_sourceMap) {
-            if (entry.pageNumber == pageNum && entry.rect.intersects(localSel)) {
-                if (entry.startLine > 0) {
-                    minLine = qMin(minLine, entry.startLine);
-                    maxLine = qMax(maxLine, entry.endLine);
-                }
-            }
-        }
-    }
-
-    if (minLine > maxLine)
+    int minLine = 0;
+    int maxLine = 0;
+    if (!selectedSourceLines(&minLine, &maxLine))
         return;
 
     QList<Content::BlockNode> filteredBlocks = extractSelectedBlocks(minLine, maxLine);
@@ -1421,9 +1587,9 @@ void DocumentView::copySelectionAsRtf()
     auto *mimeData = new QMimeData;
     mimeData->setData(QStringLiteral("text/rtf"), rtf);
     mimeData->setData(QStringLiteral("application/rtf"), rtf);
-    // Plain text fallback: use Poppler-extracted text (no markdown syntax)
-    // so paste targets that prefer text/plain get clean rendered text.
-    QString plainText = extractSelectedTextFromPdf();
+    // Plain text fallback: the rendered text (no markdown syntax) so
+    // paste targets that prefer text/plain get clean text.
+    QString plainText = extractSelectedPlainText();
     if (!plainText.isEmpty())
         mimeData->setText(plainText);
     QApplication::clipboard()->setMimeData(mimeData);
@@ -1463,31 +1629,9 @@ void DocumentView::copySelectionWithFilter(const RtfFilterOptions &filter)
     if (!hasSourceData || m_pagesWithSelection.isEmpty())
         return;
 
-    QRectF selRect = QRectF(m_selectPressPos, m_selectCurrentPos).normalized();
-    int minLine = INT_MAX;
-    int maxLine = -1;
-
-    for (auto *pageItem : m_pdfPageItems) {
-        QRectF itemRect = pageItem->boundingRect().translated(pageItem->pos());
-        if (!selRect.intersects(itemRect))
-            continue;
-        int pageNum = pageItem->pageNumber();
-        QRectF localSel = selRect.translated(-pageItem->pos());
-        localSel = localSel.intersected(
-            QRectF(0, 0, pageItem->pageSize().width(), pageItem->pageSize().height()));
-        if (localSel.isEmpty())
-            continue;
-        for (const auto &entry : m_sourceMap) {
-            if (entry.pageNumber == pageNum && entry.rect.intersects(localSel)) {
-                if (entry.startLine > 0) {
-                    minLine = qMin(minLine, entry.startLine);
-                    maxLine = qMax(maxLine, entry.endLine);
-                }
-            }
-        }
-    }
-
-    if (minLine > maxLine)
+    int minLine = 0;
+    int maxLine = 0;
+    if (!selectedSourceLines(&minLine, &maxLine))
         return;
 
     QList<Content::BlockNode> filteredBlocks = extractSelectedBlocks(minLine, maxLine);
@@ -1500,8 +1644,8 @@ void DocumentView::copySelectionWithFilter(const RtfFilterOptions &filter)
     auto *mimeData = new QMimeData;
     mimeData->setData(QStringLiteral("text/rtf"), rtf);
     mimeData->setData(QStringLiteral("application/rtf"), rtf);
-    // Plain text fallback via Poppler
-    QString plainText = extractSelectedTextFromPdf();
+    // Plain text fallback: the rendered text
+    QString plainText = extractSelectedPlainText();
     if (!plainText.isEmpty())
         mimeData->setText(plainText);
     QApplication::clipboard()->setMimeData(mimeData);
@@ -1564,7 +1708,7 @@ void DocumentView::contextMenuEvent(QContextMenuEvent *event)
                 label = tr("Syntax: %1...").arg(cb->language);
 
             auto *langAction = menu.addAction(label);
-            QString codeKey = cb->code.trimmed();
+            QString codeKey = cb->code.toString().trimmed();
             QString currentLang = cb->language;
 
             connect(langAction, &QAction::triggered, this, [this, codeKey, currentLang]() {
@@ -1687,6 +1831,21 @@ void DocumentView::updateCurrentPage()
 {
     QPointF center = mapToScene(viewport()->rect().center());
 
+    // Keep the rasters of visible pages, and one page either side, cached
+    if (!m_pdfPageItems.isEmpty()) {
+        const QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+        int first = m_pageCount;
+        int last = -1;
+        for (auto *item : std::as_const(m_pdfPageItems)) {
+            if (item->boundingRect().translated(item->pos()).intersects(visible)) {
+                first = qMin(first, item->pageNumber());
+                last = qMax(last, item->pageNumber());
+            }
+        }
+        if (last >= 0)
+            m_renderCache->setPinnedPages(first - 1, last + 1);
+    }
+
     // Check PDF pages
     for (int i = 0; i < m_pdfPageItems.size(); ++i) {
         QRectF r = m_pdfPageItems[i]->boundingRect().translated(m_pdfPageItems[i]->pos());
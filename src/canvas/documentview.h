@@ -12,6 +12,7 @@
 #include "layoutengine.h"
 #include "pagelayout.h"
 #include "rtffilteroptions.h"
+#include "selectionindex.h"
 
 class FontManager;
 class PageItem;
@@ -80,6 +81,9 @@ public:
     void nextPage();
     int currentPage() const { return m_currentPage; }
     int pageCount() const { return m_pageCount; }
+    // Queue renders of the @p radius pages either side of the current one
+    // at the current zoom, so paging through them finds them cached
+    void prefetchNeighbourPages(int radius);
 
     // B1: Cursor mode
     enum CursorMode { HandTool, SelectionTool };
@@ -100,6 +104,8 @@ public:
                        const QList<Layout::SourceMapEntry> &sourceMap,
                        const Content::Document &contentDoc,
                        const QList<Layout::CodeBlockRegion> &codeBlockRegions = {});
+    // Text of the PDF's layout for selection; cleared by setPdfData()
+    void setSelectionIndex(const Layout::SelectionIndex &index) { m_selectionIndex = index; }
 
     // Code block language overrides (per-session, persisted via MetadataStore)
     void setCodeBlockLanguageOverrides(const QHash<QString, QString> &overrides);
@@ -128,6 +134,19 @@ public:
     bool isPdfMode() const { return m_pdfMode; }
     QByteArray pdfData() const { return m_pdfData; }
 
+    // Background tab hibernation.  hibernate() drops the Poppler document,
+    // rendered pixmaps and scene items, keeping only the PDF bytes (web
+    // mode drops its layout; the owner lays it out again from its kept
+    // parse).  wake()
+    // reloads the PDF off the GUI thread and restores the view state;
+    // saveViewState() reports the hibernated state until then.
+    void hibernate();
+    void wake();
+    bool isHibernated() const { return m_hibernated; }
+
+    // Page raster cache (exposed for the view benchmark's hit-rate stats)
+    RenderCache *renderCache() const { return m_renderCache; }
+
 Q_SIGNALS:
     void zoomChanged(int percent);
     void statusHintChanged(const QString &hint);  // A7: hover hints
@@ -160,11 +179,14 @@ private:
     void layoutPagesContinuousFacingFirstAlone();
     void updateCurrentPage();
     void clearPdfPages();
+    void installPopplerDocument(Poppler::Document *doc);
 
     // B2: Text selection helpers
     void updateTextSelection();
+    int selectionOffsetAt(const QPointF &scenePos, int *pageNum) const;
+    bool selectedSourceLines(int *minLine, int *maxLine) const;
     QString extractSelectedText() const;
-    QString extractSelectedTextFromPdf() const; // Poppler fallback
+    QString extractSelectedPlainText() const; // layout text, else Poppler
     QList<Content::BlockNode> extractSelectedBlocks(int minLine, int maxLine) const;
     // Code block hit-test
     int codeBlockIndexAtScenePos(const QPointF &scenePos) const;
@@ -194,6 +216,11 @@ private:
     RenderCache *m_renderCache = nullptr;
     QList<PdfPageItem *> m_pdfPageItems;
 
+    // Hibernation
+    bool m_hibernated = false;
+    ViewState m_hibernatedState;
+    int m_loadGeneration = 0;       // discards stale background loads
+
     // Web view rendering
     RenderMode m_renderMode = PrintMode;
     WebViewItem *m_webViewItem = nullptr;
@@ -214,6 +241,9 @@ private:
     QPointF m_selectPressPos;        // scene coords
     QPointF m_selectCurrentPos;      // scene coords
     QSet<int> m_pagesWithSelection;
+    Layout::SelectionIndex m_selectionIndex;
+    int m_selectionFrom = -1;        // text offsets in m_selectionIndex
+    int m_selectionTo = -1;
     static constexpr int kSelectionThreshold = 5;  // 5px before selecting
 
     // A7: Link hover cache
@@ -0,0 +1,264 @@
+/*
+ * glyphatlas.cpp — Shared glyph raster atlas for the QPainter backend
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "glyphatlas.h"
+#include "fontmanager.h"
+
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPainterPath>
+
+#include <cmath>
+
+GlyphAtlas &GlyphAtlas::instance()
+{
+    static GlyphAtlas s_instance;
+    return s_instance;
+}
+
+// --- Fonts ---
+
+int GlyphAtlas::faceIdLocked(FontFace *face)
+{
+    // Keyed by file rather than FontFace pointer: every FontManager that
+    // loads the same file shares one parse and one set of rasters.
+    const QString key = face->filePath + QLatin1Char('#') + QString::number(face->faceIndex);
+    auto it = m_faceIds.constFind(key);
+    if (it != m_faceIds.constEnd())
+        return it.value();
+
+    int id = m_faceIds.size() + 1;
+    m_faceIds.insert(key, id);
+    m_baseFonts.insert(id, QRawFont(face->rawData, 12.0));
+    return id;
+}
+
+QRawFont GlyphAtlas::sizedFontLocked(int faceId, FontFace *face, qreal pixelSize)
+{
+    // setPixelSize() clones the parsed engine instead of re-reading the blob
+    QRawFont font = m_baseFonts.value(faceId);
+    if (!font.isValid())
+        font = QRawFont(face->rawData, pixelSize);
+    else
+        font.setPixelSize(pixelSize);
+    return font;
+}
+
+QRawFont GlyphAtlas::bucketFontLocked(int faceId, FontFace *face, int sizeBucket)
+{
+    // Rasters only: zooming reuses a few clones per face
+    auto key = qMakePair(faceId, sizeBucket);
+    auto it = m_sizedFonts.constFind(key);
+    if (it != m_sizedFonts.constEnd())
+        return it.value();
+
+    // Each clone keeps its own engine caches; flush rather than grow
+    if (m_sizedFonts.size() >= kMaxSizedFonts)
+        m_sizedFonts.clear();
+
+    QRawFont font = sizedFontLocked(faceId, face, qreal(sizeBucket) / kSizeSteps);
+    m_sizedFonts.insert(key, font);
+    return font;
+}
+
+QRawFont GlyphAtlas::rawFont(FontFace *face, qreal pixelSize)
+{
+    if (!face)
+        return {};
+    QMutexLocker lock(&m_mutex);
+    const int faceId = faceIdLocked(face);
+
+    // Outlines are drawn against advances shaped at the exact size, so
+    // these clones are never rounded; the few sizes a page uses are kept
+    // most recent first
+    for (qsizetype i = 0; i < m_exactFonts.size(); ++i) {
+        if (m_exactFonts[i].faceId == faceId && m_exactFonts[i].pixelSize == pixelSize) {
+            if (i > 0)
+                m_exactFonts.move(i, 0);
+            return m_exactFonts.first().font;
+        }
+    }
+    const QRawFont font = sizedFontLocked(faceId, face, pixelSize);
+    if (m_exactFonts.size() >= kMaxExactFonts)
+        m_exactFonts.removeLast();
+    m_exactFonts.prepend({faceId, pixelSize, font});
+    return font;
+}
+
+// --- Glyph rasters ---
+
+GlyphAtlas::GlyphEntry GlyphAtlas::rasterize(const QRawFont &font, quint32 glyphId,
+                                             int subpixel)
+{
+    GlyphEntry entry;
+
+    QPainterPath path = font.pathForGlyph(glyphId);
+    if (path.isEmpty())
+        return entry;
+    path.translate(qreal(subpixel) / kSubpixelSteps, 0);
+
+    // One pixel of padding for antialiasing bleed
+    QRect bounds = path.boundingRect().toAlignedRect().adjusted(-1, -1, 1, 1);
+    QImage mask(bounds.size(), QImage::Format_Alpha8);
+    mask.fill(0);
+    {
+        QPainter p(&mask);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setPen(Qt::NoPen);
+        p.setBrush(Qt::black);
+        p.translate(-bounds.topLeft());
+        p.drawPath(path);
+    }
+
+    int page = -1;
+    QPoint pos = allocate(bounds.size(), &page);
+    {
+        QPainter p(&m_pages[page]);
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        p.drawImage(pos, mask);
+    }
+
+    entry.page = page;
+    entry.source = QRect(pos, bounds.size());
+    entry.offset = bounds.topLeft();
+    return entry;
+}
+
+QPoint GlyphAtlas::allocate(const QSize &size, int *page)
+{
+    // Oversized glyph: give it a page of its own and start the next
+    // glyph on a fresh shelf page
+    if (size.width() > kPageSize || size.height() > kPageSize) {
+        QImage own(size, QImage::Format_Alpha8);
+        own.fill(0);
+        m_pages.append(own);
+        m_shelfY = kPageSize;
+        *page = m_pages.size() - 1;
+        return {};
+    }
+
+    if (!m_pages.isEmpty() && m_shelfX + size.width() > kPageSize) {
+        m_shelfY += m_shelfHeight;
+        m_shelfX = 0;
+        m_shelfHeight = 0;
+    }
+    if (m_pages.isEmpty() || m_shelfY + size.height() > kPageSize) {
+        QImage fresh(kPageSize, kPageSize, QImage::Format_Alpha8);
+        fresh.fill(0);
+        m_pages.append(fresh);
+        m_shelfX = 0;
+        m_shelfY = 0;
+        m_shelfHeight = 0;
+    }
+
+    QPoint pos(m_shelfX, m_shelfY);
+    m_shelfX += size.width() + 1;
+    m_shelfHeight = qMax(m_shelfHeight, size.height() + 1);
+    *page = m_pages.size() - 1;
+    return pos;
+}
+
+GlyphAtlas::GlyphEntry GlyphAtlas::glyphLocked(FontFace *face, const GlyphKey &key)
+{
+    auto it = m_glyphs.constFind(key);
+    if (it != m_glyphs.constEnd())
+        return it.value();
+
+    QRawFont font = bucketFontLocked(key.faceId, face, key.sizeBucket);
+    GlyphEntry entry = font.isValid() ? rasterize(font, key.glyphId, key.subpixel)
+                                      : GlyphEntry{};
+    m_glyphs.insert(key, entry);
+    return entry;
+}
+
+QImage GlyphAtlas::renderRun(FontFace *face, qreal pixelSize,
+                             const QList<quint32> &glyphIds,
+                             const QList<QPointF> &penPositions,
+                             const QColor &color, QPoint *origin)
+{
+    if (!face || glyphIds.isEmpty() || glyphIds.size() != penPositions.size())
+        return {};
+
+    QMutexLocker lock(&m_mutex);
+
+    // Flush between runs, never during one: entries looked up below must
+    // stay valid until the run is composed.
+    if (m_pages.size() >= kMaxPages)
+        clearLocked();
+
+    GlyphKey key;
+    key.faceId = faceIdLocked(face);
+    key.sizeBucket = qMax(1, qRound(pixelSize * kSizeSteps));
+
+    struct Placed {
+        GlyphEntry entry;
+        QPoint pos; // device top-left of the glyph raster
+    };
+    QList<Placed> placed;
+    placed.reserve(glyphIds.size());
+    QRect bounds;
+
+    for (qsizetype i = 0; i < glyphIds.size(); ++i) {
+        const QPointF &pen = penPositions[i];
+        // Subpixel steps horizontally; the baseline snaps to whole pixels
+        qreal penX = std::floor(pen.x() * kSubpixelSteps + 0.5) / kSubpixelSteps;
+        int ix = int(std::floor(penX));
+        int iy = qRound(pen.y());
+        key.glyphId = glyphIds[i];
+        key.subpixel = qRound((penX - ix) * kSubpixelSteps) % kSubpixelSteps;
+
+        GlyphEntry entry = glyphLocked(face, key);
+        if (entry.page < 0)
+            continue;
+        QPoint pos(ix + entry.offset.x(), iy + entry.offset.y());
+        placed.append({entry, pos});
+        bounds |= QRect(pos, entry.source.size());
+    }
+
+    if (placed.isEmpty())
+        return {};
+
+    QImage run(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+    run.fill(Qt::transparent);
+    {
+        QPainter p(&run);
+        // Overlapping glyphs (kerned pairs, combining marks) add coverage
+        p.setCompositionMode(QPainter::CompositionMode_Plus);
+        for (const Placed &g : std::as_const(placed))
+            p.drawImage(g.pos - bounds.topLeft(), m_pages[g.entry.page], g.entry.source);
+        // Alpha8 draws as black; recolour keeping the summed coverage
+        p.setCompositionMode(QPainter::CompositionMode_SourceIn);
+        p.fillRect(run.rect(), color);
+    }
+
+    *origin = bounds.topLeft();
+    return run;
+}
+
+void GlyphAtlas::clearLocked()
+{
+    m_glyphs.clear();
+    m_pages.clear();
+    m_sizedFonts.clear();
+    m_exactFonts.clear();
+    m_shelfX = 0;
+    m_shelfY = 0;
+    m_shelfHeight = 0;
+}
+
+void GlyphAtlas::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    clearLocked();
+}
+
+qint64 GlyphAtlas::memoryBytes() const
+{
+    QMutexLocker lock(&m_mutex);
+    qint64 bytes = 0;
+    for (const QImage &page : m_pages)
+        bytes += page.sizeInBytes();
+    return bytes;
+}
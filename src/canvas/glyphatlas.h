@@ -0,0 +1,118 @@
+/*
+ * glyphatlas.h — Shared glyph raster atlas for the QPainter backend
+ *
+ * Rasterizes glyph coverage masks once per (face, glyph, pixel size
+ * bucket, subpixel offset) and packs them into shared Alpha8 pages, so
+ * repeated glyphs are blitted instead of re-rasterized.  Font blobs are
+ * parsed into a QRawFont once per face; other sizes are clones that
+ * share the parsed face.
+ *
+ * Shared by every QtBoxRenderer through instance().  All methods lock.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_GLYPHATLAS_H
+#define PRETTYREADER_GLYPHATLAS_H
+
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QPoint>
+#include <QPointF>
+#include <QRawFont>
+#include <QRect>
+#include <QString>
+
+struct FontFace;
+
+class GlyphAtlas
+{
+public:
+    static GlyphAtlas &instance();
+
+    // Sizes are quantized to 1/kSizeSteps px, pen x to 1/kSubpixelSteps px
+    static constexpr int kSizeSteps = 4;
+    static constexpr int kSubpixelSteps = 4;
+    // Larger text is drawn as outlines; caching it would flood the atlas
+    static constexpr qreal kMaxPixelSize = 192.0;
+
+    // QRawFont for @p face at exactly @p pixelSize, for drawing outlines.
+    // The font data is parsed on first use of the face only; every size
+    // shares that parse.  The raster path's own clones are rounded to the
+    // size bucket and dropped with the atlas pages.
+    QRawFont rawFont(FontFace *face, qreal pixelSize);
+
+    // Compose a glyph run in @p color into one image.  @p penPositions are
+    // device-pixel pen positions; the result is an ARGB32_Premultiplied
+    // image whose top-left device pixel is returned in @p origin.  Returns
+    // a null image if nothing in the run is inked.
+    QImage renderRun(FontFace *face, qreal pixelSize,
+                     const QList<quint32> &glyphIds,
+                     const QList<QPointF> &penPositions,
+                     const QColor &color, QPoint *origin);
+
+    void clear();
+    qint64 memoryBytes() const;
+
+private:
+    GlyphAtlas() = default;
+
+    struct GlyphKey {
+        int faceId = 0;
+        quint32 glyphId = 0;
+        int sizeBucket = 0;
+        int subpixel = 0;
+
+        bool operator==(const GlyphKey &o) const {
+            return faceId == o.faceId && glyphId == o.glyphId
+                && sizeBucket == o.sizeBucket && subpixel == o.subpixel;
+        }
+        friend size_t qHash(const GlyphKey &k, size_t seed) {
+            return qHashMulti(seed, k.faceId, k.glyphId, k.sizeBucket, k.subpixel);
+        }
+    };
+
+    struct GlyphEntry {
+        int page = -1;      // -1 = nothing inked (e.g. space)
+        QRect source;       // rect within the page image
+        QPoint offset;      // top-left relative to the integer pen position
+    };
+
+    int faceIdLocked(FontFace *face);
+    QRawFont sizedFontLocked(int faceId, FontFace *face, qreal pixelSize);
+    QRawFont bucketFontLocked(int faceId, FontFace *face, int sizeBucket);
+    GlyphEntry glyphLocked(FontFace *face, const GlyphKey &key);
+    GlyphEntry rasterize(const QRawFont &font, quint32 glyphId, int subpixel);
+    QPoint allocate(const QSize &size, int *page);
+    void clearLocked();
+
+    static constexpr int kPageSize = 512;
+    static constexpr int kMaxPages = 32;   // 8 MiB of Alpha8 coverage
+    static constexpr int kMaxSizedFonts = 64;
+    static constexpr int kMaxExactFonts = 16;
+
+    struct ExactFont {
+        int faceId = 0;
+        qreal pixelSize = 0;
+        QRawFont font;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QString, int> m_faceIds;             // "path#index" -> id
+    QHash<int, QRawFont> m_baseFonts;          // one parse per face
+    QHash<QPair<int, int>, QRawFont> m_sizedFonts; // (faceId, size bucket)
+    QList<ExactFont> m_exactFonts;             // rawFont(), most recent first
+    QHash<GlyphKey, GlyphEntry> m_glyphs;
+    QList<QImage> m_pages;
+
+    // Shelf packer state for the last page
+    int m_shelfX = 0;
+    int m_shelfY = 0;
+    int m_shelfHeight = 0;
+};
+
+#endif // PRETTYREADER_GLYPHATLAS_H
@@ -5,6 +5,7 @@
 
 #include "pdfpageitem.h"
 #include "rendercache.h"
+#include "startuptrace.h"
 
 #include <QApplication>
 #include <QPainter>
@@ -49,16 +50,18 @@ void PdfPageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *optio
     int renderWidth = qRound(m_pageSize.width() * m_zoom);
     int renderHeight = qRound(m_pageSize.height() * m_zoom);
 
-    QImage img = m_cache->cachedPixmap(m_pageNumber, renderWidth, renderHeight);
-    if (!img.isNull()) {
-        painter->drawImage(pageRect, img);
+    const qreal dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    QPixmap pixmap = m_cache->cachedPixmap(m_pageNumber, renderWidth, renderHeight, dpr);
+    if (!pixmap.isNull()) {
+        painter->drawPixmap(pageRect, pixmap, QRectF(pixmap.rect()));
+        StartupTrace::finish("first page painted");
     } else {
         // Request render
         RenderCache::Request req;
         req.pageNumber = m_pageNumber;
         req.width = renderWidth;
         req.height = renderHeight;
-        req.dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+        req.dpr = dpr;
         m_cache->requestPixmap(req);
 
         // Placeholder
@@ -5,8 +5,10 @@
 
 #include "qtboxrenderer.h"
 #include "fontmanager.h"
+#include "glyphatlas.h"
 
 #include <QGlyphRun>
+#include <QPaintEngine>
 #include <QPainter>
 #include <QPen>
 #include <QPolygonF>
@@ -22,21 +24,6 @@ void QtBoxRenderer::setPainter(QPainter *painter)
     m_painter = painter;
 }
 
-// --- QRawFont cache ---
-
-const QRawFont &QtBoxRenderer::rawFontFor(FontFace *face, qreal sizePoints)
-{
-    int sizeKey = qRound(sizePoints * 100);
-    auto key = qMakePair(face, sizeKey);
-    auto it = m_rawFontCache.find(key);
-    if (it != m_rawFontCache.end())
-        return it.value();
-
-    QByteArray data = m_fontManager->rawFontData(face);
-    auto inserted = m_rawFontCache.insert(key, QRawFont(data, sizePoints));
-    return inserted.value();
-}
-
 // --- Drawing primitives ---
 
 void QtBoxRenderer::drawRect(const QRectF &rect, const QColor &fill,
@@ -108,7 +95,49 @@ void QtBoxRenderer::drawGlyphs(FontFace *face, qreal fontSize,
                                 const QColor &foreground,
                                 qreal x, qreal baselineY)
 {
-    const QRawFont &rf = rawFontFor(face, fontSize);
+    if (!face || info.glyphIds.isEmpty())
+        return;
+
+    // Blit from the shared atlas when painting unrotated onto a raster
+    // device; anything else (printer, rotation, huge text) uses outlines.
+    const QTransform device = m_painter->deviceTransform();
+    const qreal scale = device.m11();
+    const qreal pixelSize = fontSize * scale;
+    QPaintEngine *engine = m_painter->paintEngine();
+    if (!engine || engine->type() != QPaintEngine::Raster
+        || device.type() > QTransform::TxScale
+        || !qFuzzyCompare(scale, device.m22())
+        || pixelSize <= 0 || pixelSize > GlyphAtlas::kMaxPixelSize) {
+        drawGlyphsAsOutlines(face, fontSize, info, foreground, x, baselineY);
+        return;
+    }
+
+    QList<QPointF> pens;
+    pens.reserve(info.positions.size());
+    for (const QPointF &pos : info.positions)
+        pens.append(device.map(QPointF(x + pos.x(), baselineY + pos.y())));
+
+    QPoint origin;
+    QImage run = GlyphAtlas::instance().renderRun(face, pixelSize, info.glyphIds,
+                                                  pens, foreground, &origin);
+    if (run.isNull())
+        return;
+
+    // Draw 1:1 in device pixels
+    const qreal dpr = m_painter->device()->devicePixelRatioF();
+    run.setDevicePixelRatio(dpr);
+    m_painter->save();
+    m_painter->resetTransform();
+    m_painter->drawImage(QPointF(origin) / dpr, run);
+    m_painter->restore();
+}
+
+void QtBoxRenderer::drawGlyphsAsOutlines(FontFace *face, qreal fontSize,
+                                          const GlyphRenderInfo &info,
+                                          const QColor &foreground,
+                                          qreal x, qreal baselineY)
+{
+    QRawFont rf = GlyphAtlas::instance().rawFont(face, fontSize);
     if (!rf.isValid())
         return;
 
@@ -13,10 +13,7 @@
 
 #include "boxtreerenderer.h"
 
-#include <QHash>
 #include <QList>
-#include <QPair>
-#include <QRawFont>
 #include <QRectF>
 #include <QString>
 
@@ -82,10 +79,12 @@ public:
     void collectLink(const QRectF &rect, const QString &href) override;
 
 private:
-    const QRawFont &rawFontFor(FontFace *face, qreal sizePoints);
+    void drawGlyphsAsOutlines(FontFace *face, qreal fontSize,
+                              const GlyphRenderInfo &info,
+                              const QColor &foreground,
+                              qreal x, qreal baselineY);
 
     QPainter *m_painter = nullptr;
-    QHash<QPair<FontFace *, int>, QRawFont> m_rawFontCache; // key: (face, size*100)
     QList<LinkHitRect> m_linkHitRects;
 };
 
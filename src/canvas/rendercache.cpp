@@ -66,11 +66,13 @@ public Q_SLOTS:
 
                 QImage image = page->renderToImage(xres, yres, -1, -1,
                                                    req.width * req.dpr, req.height * req.dpr);
+                // Convert here rather than on every paint
+                image.convertTo(QImage::Format_ARGB32_Premultiplied);
                 image.setDevicePixelRatio(req.dpr);
 
                 int gen = m_generation;
                 lock.unlock();
-                Q_EMIT finished(req.pageNumber, image, req.width, req.height, gen);
+                Q_EMIT finished(req.pageNumber, image, req.width, req.height, req.dpr, gen);
             }
         }
 
@@ -83,7 +85,8 @@ public Q_SLOTS:
     }
 
 Q_SIGNALS:
-    void finished(int pageNumber, QImage image, int width, int height, int generation);
+    void finished(int pageNumber, QImage image, int width, int height, qreal dpr,
+                  int generation);
 
 private:
     struct PendingRequest {
@@ -100,6 +103,41 @@ private:
     QMutex m_queueMutex;
 };
 
+// --- Cold tier worker (compresses evicted pages, restores them) ---
+
+class RenderCache::ColdStoreWorker : public QObject {
+    Q_OBJECT
+public:
+    ColdStoreWorker() = default;
+
+    void compress(int pageNumber, const QImage &image, int width, int height,
+                  qreal dpr, int generation) {
+        const QByteArray data = qCompress(image.constBits(), int(image.sizeInBytes()), 1);
+        Q_EMIT compressed(pageNumber, data, width, height, dpr, generation);
+    }
+
+    void restore(int pageNumber, const QByteArray &data, QSize pixelSize,
+                 QImage::Format format, int width, int height, qreal dpr,
+                 int generation) {
+        const QByteArray pixels = qUncompress(data);
+        QImage image(pixelSize, format);
+        if (image.isNull() || pixels.size() != image.sizeInBytes()) {
+            qWarning() << "RenderCache: cannot restore page" << pageNumber;
+            image = QImage();
+        } else {
+            memcpy(image.bits(), pixels.constData(), pixels.size());
+            image.setDevicePixelRatio(dpr);
+        }
+        Q_EMIT restored(pageNumber, image, width, height, dpr, generation);
+    }
+
+Q_SIGNALS:
+    void compressed(int pageNumber, QByteArray data, int width, int height,
+                    qreal dpr, int generation);
+    void restored(int pageNumber, QImage image, int width, int height,
+                  qreal dpr, int generation);
+};
+
 // --- RenderCache ---
 
 RenderCache::RenderCache(QObject *parent)
@@ -111,15 +149,26 @@ RenderCache::RenderCache(QObject *parent)
     connect(m_worker, &RenderWorker::finished,
             this, &RenderCache::onRenderFinished, Qt::QueuedConnection);
 
+    m_coldWorker = new ColdStoreWorker;
+    m_coldWorker->moveToThread(&m_coldThread);
+    connect(m_coldWorker, &ColdStoreWorker::compressed,
+            this, &RenderCache::onCompressed, Qt::QueuedConnection);
+    connect(m_coldWorker, &ColdStoreWorker::restored,
+            this, &RenderCache::onRestored, Qt::QueuedConnection);
+
     m_renderThread.start();
+    m_coldThread.start(QThread::LowPriority);
 }
 
 RenderCache::~RenderCache()
 {
     m_worker->clearQueue();
     m_renderThread.quit();
+    m_coldThread.quit();
     m_renderThread.wait();
+    m_coldThread.wait();
     delete m_worker;
+    delete m_coldWorker;
 }
 
 void RenderCache::setDocument(Poppler::Document *doc)
@@ -132,12 +181,29 @@ void RenderCache::setDocument(Poppler::Document *doc)
 
 void RenderCache::requestPixmap(const Request &req)
 {
-    CacheKey key{req.pageNumber, req.width, req.height};
+    CacheKey key = makeKey(req.pageNumber, req.width, req.height, req.dpr);
 
     {
         QMutexLocker lock(&m_mutex);
         if (m_cache.contains(key))
             return; // already cached
+
+        auto cold = m_cold.constFind(key);
+        if (cold != m_cold.constEnd()) {
+            if (!m_coldPending.contains(key)) {
+                m_coldPending.insert(key);
+                const QByteArray data = cold->data;
+                const QSize pixelSize = cold->pixelSize;
+                const QImage::Format format = cold->format;
+                const int generation = m_generation;
+                QMetaObject::invokeMethod(m_coldWorker, [worker = m_coldWorker, req, data, pixelSize,
+                                                          format, generation]() {
+                    worker->restore(req.pageNumber, data, pixelSize, format,
+                                    req.width, req.height, req.dpr, generation);
+                }, Qt::QueuedConnection);
+            }
+            return;
+        }
     }
 
     // Enqueue on worker — coalesces with any prior request for this page
@@ -145,27 +211,60 @@ void RenderCache::requestPixmap(const Request &req)
     QMetaObject::invokeMethod(m_worker, "processQueue", Qt::QueuedConnection);
 }
 
-QImage RenderCache::cachedPixmap(int page, int width, int height) const
+QPixmap RenderCache::cachedPixmap(int page, int width, int height, qreal dpr) const
 {
     QMutexLocker lock(&m_mutex);
-    CacheKey key{page, width, height};
-    auto it = m_cache.find(key);
-    if (it != m_cache.end()) {
-        it->lastAccess = ++m_accessCounter;
-        return it->image;
+    ++m_stats.lookups;
+    CacheKey key = makeKey(page, width, height, dpr);
+    m_lookedUpKeys.insert(page, key);
+    auto it = m_cache.constFind(key);
+    if (it != m_cache.constEnd()) {
+        ++m_stats.hits;
+        m_lru.splice(m_lru.begin(), m_lru, it->lruPos);
+        return it->pixmap;
     }
     return {};
 }
 
+void RenderCache::setPinnedPages(int first, int last)
+{
+    QMutexLocker lock(&m_mutex);
+    m_pinnedFirst = first;
+    m_pinnedLast = last;
+}
+
+RenderCache::Stats RenderCache::stats() const
+{
+    QMutexLocker lock(&m_mutex);
+    Stats s = m_stats;
+    s.memoryBytes = m_currentMemory;
+    s.coldMemoryBytes = m_coldMemory;
+    return s;
+}
+
+void RenderCache::resetStats()
+{
+    QMutexLocker lock(&m_mutex);
+    m_stats = Stats();
+}
+
 void RenderCache::invalidateAll()
 {
     m_worker->clearQueue();
     QMutexLocker lock(&m_mutex);
     m_cache.clear();
+    m_lru.clear();
+    m_lookedUpKeys.clear();
     m_currentMemory = 0;
+    m_cold.clear();
+    m_coldLru.clear();
+    m_coldPending.clear();
+    m_coldGeometry.clear();
+    m_coldMemory = 0;
 }
 
-void RenderCache::onRenderFinished(int pageNumber, QImage image, int width, int height, int generation)
+void RenderCache::onRenderFinished(int pageNumber, QImage image, int width, int height,
+                                   qreal dpr, int generation)
 {
     if (image.isNull())
         return;
@@ -174,39 +273,139 @@ void RenderCache::onRenderFinished(int pageNumber, QImage image, int width, int
     if (generation != m_generation)
         return;
 
-    CacheKey key{pageNumber, width, height};
-    CacheEntry entry;
-    entry.image = image;
-    entry.width = width;
-    entry.height = height;
-    entry.sizeBytes = static_cast<qint64>(image.sizeInBytes());
-    entry.lastAccess = ++m_accessCounter;
+    {
+        QMutexLocker lock(&m_mutex);
+        ++m_stats.renders;
+    }
+    insertImage(makeKey(pageNumber, width, height, dpr), std::move(image));
+    Q_EMIT pixmapReady(pageNumber);
+}
+
+void RenderCache::onCompressed(int pageNumber, QByteArray data, int width, int height,
+                               qreal dpr, int generation)
+{
+    const CacheKey key = makeKey(pageNumber, width, height, dpr);
+    QMutexLocker lock(&m_mutex);
+    m_coldPending.remove(key);
+    // Geometry of the image that was sent; see evictIfNeeded()
+    ColdEntry entry = m_coldGeometry.take(key);
+    if (generation != m_generation || m_cold.contains(key))
+        return;
+
+    entry.data = data;
+    m_coldLru.push_front(key);
+    entry.lruPos = m_coldLru.begin();
+    m_coldMemory += data.size();
+    m_cold.insert(key, entry);
+    evictColdIfNeeded();
+}
+
+void RenderCache::onRestored(int pageNumber, QImage image, int width, int height,
+                             qreal dpr, int generation)
+{
+    const CacheKey key = makeKey(pageNumber, width, height, dpr);
+    {
+        QMutexLocker lock(&m_mutex);
+        m_coldPending.remove(key);
+        if (generation != m_generation)
+            return;
+        if (image.isNull()) {
+            // Undecodable copy: drop it and render the page from Poppler
+            auto cold = m_cold.find(key);
+            if (cold != m_cold.end()) {
+                m_coldMemory -= cold->data.size();
+                m_coldLru.erase(cold->lruPos);
+                m_cold.erase(cold);
+            }
+            lock.unlock();
+            m_worker->enqueue(pageNumber, width, height, dpr);
+            QMetaObject::invokeMethod(m_worker, "processQueue", Qt::QueuedConnection);
+            return;
+        }
+        // The compressed copy stays, so evicting this page again is free
+        auto cold = m_cold.find(key);
+        if (cold != m_cold.end())
+            m_coldLru.splice(m_coldLru.begin(), m_coldLru, cold->lruPos);
+        ++m_stats.restores;
+    }
+    insertImage(key, std::move(image));
+    Q_EMIT pixmapReady(pageNumber);
+}
+
+void RenderCache::insertImage(const CacheKey &key, QImage image)
+{
+    const qint64 sizeBytes = static_cast<qint64>(image.sizeInBytes());
+    // Premultiplied ARGB32 is adopted without a conversion
+    QPixmap pixmap = QPixmap::fromImage(std::move(image), Qt::NoFormatConversion);
 
     {
         QMutexLocker lock(&m_mutex);
         auto existing = m_cache.find(key);
-        if (existing != m_cache.end())
+        if (existing != m_cache.end()) {
             m_currentMemory -= existing->sizeBytes;
-        m_cache[key] = entry;
-        m_currentMemory += entry.sizeBytes;
+            m_lru.erase(existing->lruPos);
+            m_cache.erase(existing);
+        }
+        m_lru.push_front(key);
+        m_cache.insert(key, CacheEntry{pixmap, sizeBytes, m_lru.begin()});
+        m_currentMemory += sizeBytes;
     }
 
     evictIfNeeded();
-    Q_EMIT pixmapReady(pageNumber);
+}
+
+bool RenderCache::isPinned(const CacheKey &key) const
+{
+    if (key.page < m_pinnedFirst || key.page > m_pinnedLast)
+        return false;
+    // Only the size the page is painted at; older zoom levels may go
+    auto it = m_lookedUpKeys.constFind(key.page);
+    return it != m_lookedUpKeys.constEnd() && *it == key;
 }
 
 void RenderCache::evictIfNeeded()
 {
     QMutexLocker lock(&m_mutex);
-    while (m_currentMemory > m_memoryLimit && !m_cache.isEmpty()) {
-        // Find LRU entry
-        auto lruIt = m_cache.begin();
-        for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
-            if (it->lastAccess < lruIt->lastAccess)
-                lruIt = it;
+    // Walk from the least recently used end; the pinned entries skipped
+    // are bounded by the pinned range
+    auto it = m_lru.end();
+    while (m_currentMemory > m_memoryLimit && it != m_lru.begin()) {
+        --it;
+        if (isPinned(*it))
+            continue;
+        const CacheKey key = *it;
+        auto entry = m_cache.find(key);
+        m_currentMemory -= entry->sizeBytes;
+
+        // Hand the pixels to the cold tier unless it already has them
+        if (!m_cold.contains(key) && !m_coldPending.contains(key)) {
+            const QImage image = entry->pixmap.toImage();
+            if (!image.isNull()) {
+                m_coldPending.insert(key);
+                m_coldGeometry.insert(key, ColdEntry{QByteArray(), image.size(),
+                                                     image.format(), {}});
+                const int generation = m_generation;
+                const qreal dpr = key.dpr / 100.0;
+                QMetaObject::invokeMethod(m_coldWorker, [worker = m_coldWorker, key, image, dpr,
+                                                          generation]() {
+                    worker->compress(key.page, image, key.width, key.height, dpr, generation);
+                }, Qt::QueuedConnection);
+            }
         }
-        m_currentMemory -= lruIt->sizeBytes;
-        m_cache.erase(lruIt);
+
+        m_cache.erase(entry);
+        it = m_lru.erase(it);
+        ++m_stats.evictions;
+    }
+}
+
+void RenderCache::evictColdIfNeeded()
+{
+    while (m_coldMemory > m_coldMemoryLimit && !m_coldLru.empty()) {
+        auto entry = m_cold.find(m_coldLru.back());
+        m_coldMemory -= entry->data.size();
+        m_cold.erase(entry);
+        m_coldLru.pop_back();
     }
 }
 
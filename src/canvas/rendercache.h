@@ -1,8 +1,18 @@
 /*
  * rendercache.h — Async render cache with LRU eviction (Okular pattern)
  *
- * Renders PDF pages via Poppler in a background thread.
- * Caches rendered pixmaps with configurable memory limit.
+ * Renders PDF pages via Poppler in a background thread, converted there
+ * to premultiplied ARGB32 (what QPixmap keeps as is on raster backends
+ * and the paint engine blends without conversion).  The GUI thread wraps
+ * each result in a QPixmap once; entries are keyed by page, size and
+ * device pixel ratio.  Eviction is least-recently-used through a linked
+ * list, O(1) per touch and per evicted entry, and skips pinned pages
+ * (those in or near the viewport) at their current size.
+ *
+ * Evicted pages drop to a cold tier: their pixels are zlib-compressed
+ * (fastest level, lossless) on a second worker thread and kept in memory
+ * under a separate budget.  Requesting a page found there decompresses
+ * it on that thread instead of asking Poppler to render it again.
  *
  * SPDX-License-Identifier: GPL-2.0-or-later
  */
@@ -15,8 +25,12 @@
 #include <QList>
 #include <QMutex>
 #include <QObject>
+#include <QPixmap>
+#include <QSet>
 #include <QThread>
 
+#include <list>
+
 namespace Poppler { class Document; class Page; }
 
 class RenderCache : public QObject {
@@ -30,48 +44,100 @@ public:
         int priority = 0;      // lower = higher priority
     };
 
+    // Counters for the view benchmark (reset with resetStats())
+    struct Stats {
+        qint64 lookups = 0;    // cachedPixmap() calls
+        qint64 hits = 0;       // lookups served from the cache
+        qint64 renders = 0;    // pages rasterized by the worker
+        qint64 evictions = 0;  // entries dropped to stay under the limit
+        qint64 restores = 0;   // pages decompressed from the cold tier
+        qint64 memoryBytes = 0;
+        qint64 coldMemoryBytes = 0;
+    };
+
     explicit RenderCache(QObject *parent = nullptr);
     ~RenderCache() override;
 
     void setDocument(Poppler::Document *doc);
     void requestPixmap(const Request &req);
-    QImage cachedPixmap(int page, int width, int height) const;
+    QPixmap cachedPixmap(int page, int width, int height, qreal dpr) const;
     void invalidateAll();
 
+    // Pages [first, last] are kept at the size they were last looked up
+    // at, however far over the memory limit that takes the cache.
+    void setPinnedPages(int first, int last);
+
+    Stats stats() const;
+    void resetStats();
+
 Q_SIGNALS:
     void pixmapReady(int pageNumber);
 
 private Q_SLOTS:
-    void onRenderFinished(int pageNumber, QImage image, int width, int height, int generation);
+    void onRenderFinished(int pageNumber, QImage image, int width, int height,
+                          qreal dpr, int generation);
+    void onCompressed(int pageNumber, QByteArray data, int width, int height,
+                      qreal dpr, int generation);
+    void onRestored(int pageNumber, QImage image, int width, int height,
+                    qreal dpr, int generation);
 
 private:
-    struct CacheEntry {
-        QImage image;
-        int width = 0;
-        int height = 0;
-        qint64 sizeBytes = 0;
-        mutable qint64 lastAccess = 0;
-    };
-
     struct CacheKey {
         int page;
         int width;
         int height;
+        int dpr; // device pixel ratio in percent
         bool operator==(const CacheKey &o) const {
-            return page == o.page && width == o.width && height == o.height;
+            return page == o.page && width == o.width && height == o.height
+                   && dpr == o.dpr;
         }
     };
     friend size_t qHash(const CacheKey &k, size_t seed) {
-        return qHash(k.page, seed) ^ qHash(k.width, seed) ^ qHash(k.height, seed);
+        return qHashMulti(seed, k.page, k.width, k.height, k.dpr);
     }
+    static CacheKey makeKey(int page, int width, int height, qreal dpr) {
+        return {page, width, height, qRound(dpr * 100)};
+    }
+
+    using LruList = std::list<CacheKey>; // front = most recently used
+
+    struct CacheEntry {
+        QPixmap pixmap;
+        qint64 sizeBytes = 0;
+        LruList::iterator lruPos;
+    };
 
+    // Compressed pixels of an evicted page; the image geometry is kept
+    // here so the worker can rebuild it
+    struct ColdEntry {
+        QByteArray data;
+        QSize pixelSize;
+        QImage::Format format = QImage::Format_Invalid;
+        LruList::iterator lruPos;
+    };
+
+    bool isPinned(const CacheKey &key) const;
+    void insertImage(const CacheKey &key, QImage image);
     void evictIfNeeded();
+    void evictColdIfNeeded();
 
     QHash<CacheKey, CacheEntry> m_cache;
+    mutable LruList m_lru;
+    mutable QHash<int, CacheKey> m_lookedUpKeys; // page -> size last painted
+    int m_pinnedFirst = 0;
+    int m_pinnedLast = -1;
     Poppler::Document *m_doc = nullptr;
     qint64 m_memoryLimit = 100 * 1024 * 1024; // 100MB default
     qint64 m_currentMemory = 0;
-    mutable qint64 m_accessCounter = 0;
+
+    QHash<CacheKey, ColdEntry> m_cold;
+    LruList m_coldLru;
+    QSet<CacheKey> m_coldPending; // being compressed or restored
+    QHash<CacheKey, ColdEntry> m_coldGeometry; // sent for compression
+    qint64 m_coldMemoryLimit = 64 * 1024 * 1024;
+    qint64 m_coldMemory = 0;
+
+    mutable Stats m_stats;
     mutable QMutex m_mutex;
     int m_generation = 0;
 
@@ -79,6 +145,11 @@ private:
     class RenderWorker;
     QThread m_renderThread;
     RenderWorker *m_worker = nullptr;
+
+    // Cold tier compression thread
+    class ColdStoreWorker;
+    QThread m_coldThread;
+    ColdStoreWorker *m_coldWorker = nullptr;
 };
 
 #endif // PRETTYREADER_RENDERCACHE_H
@@ -4,6 +4,8 @@
  */
 
 #include "webviewitem.h"
+#include "allocprofiler.h"
+#include "startuptrace.h"
 
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -49,6 +51,7 @@ int WebViewItem::firstVisibleElement(qreal top) const
 void WebViewItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                          QWidget * /*widget*/)
 {
+    AllocProfiler::Scope allocScope(AllocProfiler::Painting);
     QRectF exposed = option->exposedRect;
 
     // Page background
@@ -73,6 +76,7 @@ void WebViewItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *optio
 
         m_renderer.renderElement(element);
     }
+    StartupTrace::finish("first page painted");
 }
 
 QString WebViewItem::linkAt(const QPointF &pos) const
@@ -0,0 +1,259 @@
+/*
+ * batchpdfexporter.cpp — Parallel PDF export of several documents
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "batchpdfexporter.h"
+
+#include "allocprofiler.h"
+#include "contentbuilder.h"
+#include "exportcache.h"
+#include "fontmanager.h"
+#include "hyphenator.h"
+#include "layoutengine.h"
+#include "pdfgenerator.h"
+#include "shortwords.h"
+#include "stylediff.h"
+#include "stylemanager.h"
+#include "textshaper.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDate>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+
+BatchPdfExporter::BatchPdfExporter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+BatchPdfExporter::~BatchPdfExporter()
+{
+    // Workers dereference this object; never let them outlive it
+    m_canceled = true;
+    for (QThread *thread : std::as_const(m_threads))
+        thread->wait();
+    qDeleteAll(m_threads);
+    qDeleteAll(m_workerStyles);
+    delete m_localStyles;
+}
+
+bool BatchPdfExporter::start(const QList<Job> &jobs)
+{
+    if (isRunning() || jobs.isEmpty() || !m_styleManager)
+        return false;
+
+    m_jobs = jobs;
+    m_nextJob = 0;
+    m_canceled = false;
+    m_done = 0;
+    m_succeeded = 0;
+    m_reused = 0;
+    m_exportedPages = 0;
+    AllocProfiler::reset();
+    if (m_cache)
+        m_environment = environmentFingerprint();
+
+    int workers = m_workerCount;
+    if (workers <= 0)
+        workers = qMax(1, QThread::idealThreadCount() - 1);
+    workers = qMin(workers, int(m_jobs.size()));
+
+    for (int i = 0; i < workers; ++i) {
+        // ContentBuilder resolves styles through the StyleManager; give
+        // each worker a private copy so the GUI can keep editing its own.
+        StyleManager *styles = m_styleManager->clone();
+        m_workerStyles.append(styles);
+
+        QThread *thread = QThread::create([this, styles]() { runWorker(styles); });
+        thread->setObjectName(QStringLiteral("BatchPdfExport-%1").arg(i));
+        connect(thread, &QThread::finished, this, &BatchPdfExporter::onWorkerExited);
+        m_threads.append(thread);
+    }
+
+    m_runningWorkers = m_threads.size();
+    Q_EMIT progressChanged(0, m_jobs.size());
+    for (QThread *thread : std::as_const(m_threads))
+        thread->start(QThread::LowPriority);
+    return true;
+}
+
+void BatchPdfExporter::cancel()
+{
+    m_canceled = true;
+}
+
+void BatchPdfExporter::waitForFinished()
+{
+    for (QThread *thread : std::as_const(m_threads))
+        thread->wait();
+    // Deliver the queued per-job and per-worker notifications now, so the
+    // batch is fully wound down when this returns.
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+BatchPdfExporter::JobResult BatchPdfExporter::exportOne(const Job &job)
+{
+    if (isRunning() || !m_styleManager)
+        return Failed;
+
+    if (!m_localStyles) {
+        m_localStyles = m_styleManager->clone();
+        m_localFonts = std::make_unique<FontManager>();
+        m_localShaper = std::make_unique<TextShaper>(m_localFonts.get());
+        m_localShaper->setFallbackFont(m_localFonts->loadFontFromPath(
+            QStringLiteral(":/fonts/PrettySymbolsFallback.ttf")));
+        if (m_cache)
+            m_environment = environmentFingerprint();
+    }
+    return exportJob(job, m_localStyles, m_localFonts.get(), m_localShaper.get());
+}
+
+void BatchPdfExporter::runWorker(StyleManager *styleManager)
+{
+    // Kept for the worker's lifetime: faces loaded for one document are
+    // reused by the next.
+    FontManager fontManager;
+    TextShaper textShaper(&fontManager);
+    textShaper.setFallbackFont(fontManager.loadFontFromPath(
+        QStringLiteral(":/fonts/PrettySymbolsFallback.ttf")));
+
+    while (!m_canceled.load(std::memory_order_relaxed)) {
+        const int index = m_nextJob.fetch_add(1);
+        if (index >= m_jobs.size())
+            break;
+
+        JobResult result = exportJob(m_jobs[index], styleManager, &fontManager, &textShaper);
+        QMetaObject::invokeMethod(this, [this, index, result]() {
+            onJobDone(index, result);
+        }, Qt::QueuedConnection);
+    }
+}
+
+QByteArray BatchPdfExporter::environmentFingerprint() const
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << StyleDiff::fingerprint(m_styleManager) << StyleDiff::fingerprint(m_pageLayout)
+        << (m_hyphenator ? m_hyphenator->language() : QString())
+        << (m_hyphenator ? m_hyphenator->minWordLength() : 0)
+        << (m_shortWords ? m_shortWords->language() : QString())
+        << m_hyphenateJustifiedText << m_maxJustifyGap;
+
+    // {date} header/footer fields make the output depend on the day
+    QStringList fields = {m_pageLayout.headerLeft, m_pageLayout.headerCenter,
+                          m_pageLayout.headerRight, m_pageLayout.footerLeft,
+                          m_pageLayout.footerCenter, m_pageLayout.footerRight};
+    for (const MasterPage &mp : m_pageLayout.masterPages)
+        fields << mp.headerLeft << mp.headerCenter << mp.headerRight
+               << mp.footerLeft << mp.footerCenter << mp.footerRight;
+    for (const QString &field : std::as_const(fields)) {
+        if (field.contains(QLatin1String("{date"))) {
+            out << QDate::currentDate();
+            break;
+        }
+    }
+    return data;
+}
+
+BatchPdfExporter::JobResult BatchPdfExporter::exportJob(const Job &job, StyleManager *styleManager,
+                                                        FontManager *fontManager, TextShaper *textShaper)
+{
+    QFile file(job.inputPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "BatchPdfExporter: cannot open" << job.inputPath;
+        return Failed;
+    }
+    const QByteArray source = file.readAll();
+    file.close();
+
+    QFileInfo fi(job.inputPath);
+
+    QByteArray cacheKey;
+    if (m_cache) {
+        cacheKey = ExportCache::documentKey(m_environment, source, fi, job.options);
+        if (m_cache->restore(cacheKey, job.outputPath) != ExportCache::Miss)
+            return Reused;
+    }
+    const QString markdown = QString::fromUtf8(source);
+
+    ContentBuilder contentBuilder;
+    contentBuilder.setBasePath(fi.absolutePath());
+    contentBuilder.setStyleManager(styleManager);
+    if (m_hyphenator)
+        contentBuilder.setHyphenator(m_hyphenator);
+    if (m_shortWords)
+        contentBuilder.setShortWords(m_shortWords);
+    contentBuilder.setFootnoteStyle(styleManager->footnoteStyle());
+    Content::Document contentDoc = contentBuilder.build(markdown);
+
+    fontManager->resetUsage();
+    Layout::Engine layoutEngine(fontManager, textShaper);
+    layoutEngine.setHyphenateJustifiedText(m_hyphenateJustifiedText);
+    if (job.options.markdownCopy)
+        layoutEngine.setMarkdownDecorations(true);
+    Layout::LayoutResult layoutResult = layoutEngine.layout(contentDoc, m_pageLayout);
+    m_exportedPages += int(layoutResult.pages.size());
+
+    PdfGenerator pdfGen(fontManager);
+    pdfGen.setMaxJustifyGap(m_maxJustifyGap);
+    pdfGen.setExportOptions(job.options);
+    const QByteArray pdf = pdfGen.generate(layoutResult, m_pageLayout, fi.baseName());
+    QSaveFile output(job.outputPath);
+    if (pdf.isEmpty() || !output.open(QIODevice::WriteOnly)
+        || output.write(pdf) != pdf.size() || !output.commit()) {
+        qWarning() << "BatchPdfExporter: failed to write" << job.outputPath;
+        return Failed;
+    }
+
+    if (m_cache)
+        m_cache->store(cacheKey, pdf, fontManager->usedFontFiles(), job.outputPath);
+    return Exported;
+}
+
+void BatchPdfExporter::onJobDone(int index, JobResult result)
+{
+    const bool ok = result != Failed;
+    ++m_done;
+    if (ok)
+        ++m_succeeded;
+    if (result == Reused)
+        ++m_reused;
+    Q_EMIT jobFinished(index, ok);
+    Q_EMIT progressChanged(m_done, m_jobs.size());
+}
+
+void BatchPdfExporter::onWorkerExited()
+{
+    if (--m_runningWorkers > 0)
+        return;
+
+    const bool canceled = m_canceled.load();
+    const int succeeded = m_succeeded;
+    const int reused = m_reused;
+    const int failed = m_done - m_succeeded;
+    cleanup();
+    if (m_cache)
+        m_cache->prune();
+    if (AllocProfiler::isEnabled())
+        qInfo().noquote() << "BatchPdfExporter: allocations for" << m_exportedPages.load()
+                          << "exported pages\n" + AllocProfiler::report(m_exportedPages);
+    Q_EMIT finished(succeeded, reused, failed, canceled);
+}
+
+void BatchPdfExporter::cleanup()
+{
+    for (QThread *thread : std::as_const(m_threads)) {
+        thread->wait();
+        thread->deleteLater();
+    }
+    m_threads.clear();
+    qDeleteAll(m_workerStyles);
+    m_workerStyles.clear();
+    m_jobs.clear();
+}
@@ -0,0 +1,132 @@
+/*
+ * batchpdfexporter.h — Parallel PDF export of several documents
+ *
+ * Runs the build → layout → PDF pipeline for a list of markdown files on
+ * a pool of worker threads.  Each worker owns its FontManager/TextShaper
+ * (glyph usage tracking is per document) and keeps them across jobs, so
+ * faces load once per worker; font file data and fontconfig matches are
+ * shared process-wide by FontManager.  The hyphenator and short-words
+ * tables are shared read-only and must not change while a batch runs.
+ *
+ * With an ExportCache set, each document's inputs are hashed first and
+ * the pipeline only runs for documents the cache has not seen.
+ *
+ * Built with PRETTYREADER_ALLOC_PROFILING, the allocations of each batch
+ * are logged per stage and per exported page when it finishes.
+ *
+ * Signals are delivered on the thread that owns the exporter.
+ *
+ * exportOne() runs a single job on the calling thread instead; batch
+ * worker processes (see BatchProcessExporter) drive the pipeline that way,
+ * one document per request.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_BATCHPDFEXPORTER_H
+#define PRETTYREADER_BATCHPDFEXPORTER_H
+
+#include "pagelayout.h"
+#include "pdfexportoptions.h"
+
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+
+class FontManager;
+class Hyphenator;
+class QThread;
+class ExportCache;
+class ShortWords;
+class StyleManager;
+class TextShaper;
+
+class BatchPdfExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Job {
+        QString inputPath;
+        QString outputPath;
+        PdfExportOptions options;
+    };
+
+    enum JobResult { Failed, Exported, Reused };
+
+    explicit BatchPdfExporter(QObject *parent = nullptr);
+    ~BatchPdfExporter() override;
+
+    // Cloned once per worker when the batch starts
+    void setStyleManager(StyleManager *styleManager) { m_styleManager = styleManager; }
+    void setPageLayout(const PageLayout &layout) { m_pageLayout = layout; }
+    // Shared by all workers; null disables the feature
+    void setHyphenator(Hyphenator *hyphenator) { m_hyphenator = hyphenator; }
+    void setShortWords(ShortWords *shortWords) { m_shortWords = shortWords; }
+    void setHyphenateJustifiedText(bool enabled) { m_hyphenateJustifiedText = enabled; }
+    void setMaxJustifyGap(qreal gap) { m_maxJustifyGap = gap; }
+    // 0 = one per core, leaving one for the GUI thread
+    void setWorkerCount(int count) { m_workerCount = count; }
+    // Null disables caching; must outlive the batch
+    void setExportCache(ExportCache *cache) { m_cache = cache; }
+
+    // Returns false if a batch is already running or @p jobs is empty.
+    bool start(const QList<Job> &jobs);
+
+    // Stop handing out jobs; documents already in progress still finish.
+    void cancel();
+    // Block until every worker has exited (cancel() first to return early).
+    void waitForFinished();
+
+    bool isRunning() const { return !m_threads.isEmpty(); }
+
+    // Export @p job on the calling thread, outside a batch.  Fonts and
+    // the style copy are set up on the first call and kept for later ones.
+    JobResult exportOne(const Job &job);
+
+Q_SIGNALS:
+    void jobFinished(int index, bool ok);
+    void progressChanged(int done, int total);
+    // @p reused of the @p succeeded documents came from the export cache
+    void finished(int succeeded, int reused, int failed, bool canceled);
+
+private:
+    void runWorker(StyleManager *styleManager);
+    JobResult exportJob(const Job &job, StyleManager *styleManager,
+                        FontManager *fontManager, TextShaper *textShaper);
+    QByteArray environmentFingerprint() const;
+    void onJobDone(int index, JobResult result);
+    void onWorkerExited();
+    void cleanup();
+
+    StyleManager *m_styleManager = nullptr;
+    PageLayout m_pageLayout;
+    Hyphenator *m_hyphenator = nullptr;
+    ShortWords *m_shortWords = nullptr;
+    bool m_hyphenateJustifiedText = false;
+    qreal m_maxJustifyGap = 14.0;
+    int m_workerCount = 0;
+    ExportCache *m_cache = nullptr;
+    QByteArray m_environment; // fingerprint of the above, set by start()
+
+    QList<Job> m_jobs;
+    QList<QThread *> m_threads;
+    QList<StyleManager *> m_workerStyles;
+    std::atomic<int> m_nextJob{0};
+    std::atomic<bool> m_canceled{false};
+    std::atomic<int> m_exportedPages{0};
+    int m_runningWorkers = 0;
+    int m_done = 0;
+    int m_succeeded = 0;
+    int m_reused = 0;
+
+    // exportOne() state
+    StyleManager *m_localStyles = nullptr;
+    std::unique_ptr<FontManager> m_localFonts;
+    std::unique_ptr<TextShaper> m_localShaper;
+};
+
+#endif // PRETTYREADER_BATCHPDFEXPORTER_H
@@ -0,0 +1,287 @@
+/*
+ * batchprocessexporter.cpp — PDF batch export over worker processes
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "batchprocessexporter.h"
+
+#include "batchpdfexporter.h"
+#include "pdfexportoptions.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+
+#include <cstdio>
+
+namespace {
+
+constexpr qsizetype kFrameHeader = sizeof(quint32);
+
+QByteArray frame(const QByteArray &payload)
+{
+    QByteArray data(kFrameHeader, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(payload.size()), data.data());
+    return data + payload;
+}
+
+// Removes one complete frame from the front of @p buffer
+bool takeFrame(QByteArray &buffer, QByteArray *payload)
+{
+    if (buffer.size() < kFrameHeader)
+        return false;
+    const qsizetype length = qFromBigEndian<quint32>(buffer.constData());
+    if (buffer.size() < kFrameHeader + length)
+        return false;
+    *payload = buffer.mid(kFrameHeader, length);
+    buffer.remove(0, kFrameHeader + length);
+    return true;
+}
+
+// Blocks until @p size bytes arrived; short only at end of input
+QByteArray readExactly(QFile &in, qsizetype size)
+{
+    QByteArray data;
+    while (data.size() < size) {
+        const QByteArray chunk = in.read(size - data.size());
+        if (chunk.isEmpty())
+            break;
+        data += chunk;
+    }
+    return data;
+}
+
+} // namespace
+
+BatchProcessExporter::BatchProcessExporter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+BatchProcessExporter::~BatchProcessExporter()
+{
+    for (Worker *worker : std::as_const(m_workers)) {
+        worker->process->disconnect(this);
+        worker->process->kill();
+        worker->process->waitForFinished(1000);
+        delete worker;
+    }
+}
+
+bool BatchProcessExporter::start(const QList<Job> &jobs)
+{
+    if (isRunning() || jobs.isEmpty() || m_program.isEmpty())
+        return false;
+
+    m_jobs = jobs;
+    m_nextJob = 0;
+    m_done = 0;
+    m_succeeded = 0;
+    m_reused = 0;
+    m_canceled = false;
+    m_startFailed = false;
+
+    int workers = m_workerCount;
+    if (workers <= 0)
+        workers = qMax(1, QThread::idealThreadCount());
+    workers = qMin(workers, int(m_jobs.size()));
+
+    Q_EMIT progressChanged(0, m_jobs.size());
+    for (int i = 0; i < workers; ++i)
+        startWorker();
+    return true;
+}
+
+void BatchProcessExporter::cancel()
+{
+    m_canceled = true;
+}
+
+void BatchProcessExporter::startWorker()
+{
+    auto *worker = new Worker;
+    worker->process = new QProcess(this);
+    worker->process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    worker->timer = new QTimer(this);
+    worker->timer->setSingleShot(true);
+
+    connect(worker->process, &QProcess::readyReadStandardOutput, this, [this, worker]() {
+        onReadyRead(worker);
+    });
+    connect(worker->process, &QProcess::finished, this,
+            [this, worker](int exitCode, QProcess::ExitStatus status) {
+        onWorkerFinished(worker, exitCode, status);
+    });
+    // No finished() follows a failed start.  Queued: start() may report
+    // it before returning, and the worker must outlive this function.
+    connect(worker->process, &QProcess::errorOccurred, this,
+            [this, worker](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return;
+        m_startFailed = true;
+        worker->error = tr("cannot start worker: %1").arg(worker->process->errorString());
+        onWorkerFinished(worker, -1, QProcess::CrashExit);
+    }, Qt::QueuedConnection);
+    connect(worker->timer, &QTimer::timeout, this, [this, worker]() {
+        onTimeout(worker);
+    });
+
+    m_workers.append(worker);
+    worker->process->start(m_program, m_arguments);
+    dispatch(worker);
+}
+
+void BatchProcessExporter::dispatch(Worker *worker)
+{
+    if (m_canceled || m_nextJob >= m_jobs.size()) {
+        // The worker exits at end of input
+        worker->process->closeWriteChannel();
+        return;
+    }
+
+    const int index = m_nextJob++;
+    worker->job = index;
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint32(index) << m_jobs[index].inputPath << m_jobs[index].outputPath;
+    worker->process->write(frame(payload));
+    if (m_jobTimeout > 0)
+        worker->timer->start(m_jobTimeout);
+}
+
+void BatchProcessExporter::onReadyRead(Worker *worker)
+{
+    worker->pending += worker->process->readAllStandardOutput();
+
+    QByteArray payload;
+    while (takeFrame(worker->pending, &payload)) {
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_6_0);
+        quint32 index = 0;
+        qint32 result = BatchPdfExporter::Failed;
+        in >> index >> result;
+        if (in.status() != QDataStream::Ok || int(index) != worker->job) {
+            qWarning() << "BatchProcessExporter: unexpected reply from worker"
+                       << worker->process->processId();
+            worker->error = tr("protocol error");
+            worker->process->kill();
+            return;
+        }
+
+        worker->timer->stop();
+        worker->job = -1;
+        completeJob(int(index), result,
+                    result == BatchPdfExporter::Failed ? tr("export failed") : QString());
+        dispatch(worker);
+    }
+}
+
+void BatchProcessExporter::onWorkerFinished(Worker *worker, int exitCode,
+                                            QProcess::ExitStatus status)
+{
+    worker->timer->stop();
+    const int job = worker->job;
+    if (job >= 0) {
+        QString error = worker->error;
+        if (error.isEmpty())
+            error = status == QProcess::CrashExit
+                ? tr("worker crashed")
+                : tr("worker exited with code %1").arg(exitCode);
+        completeJob(job, BatchPdfExporter::Failed, error);
+    }
+    removeWorker(worker);
+
+    // Replace a worker lost mid-document while there is work left
+    if (job >= 0 && !m_canceled && !m_startFailed && m_nextJob < m_jobs.size())
+        startWorker();
+    finishIfDone();
+}
+
+void BatchProcessExporter::onTimeout(Worker *worker)
+{
+    worker->error = tr("timed out after %1 s").arg(m_jobTimeout / 1000.0, 0, 'f', 1);
+    worker->process->kill();
+}
+
+void BatchProcessExporter::removeWorker(Worker *worker)
+{
+    m_workers.removeOne(worker);
+    worker->process->disconnect(this);
+    worker->timer->disconnect(this);
+    worker->process->deleteLater();
+    worker->timer->deleteLater();
+    delete worker;
+}
+
+void BatchProcessExporter::completeJob(int index, int result, const QString &error)
+{
+    const bool ok = result != BatchPdfExporter::Failed;
+    ++m_done;
+    if (ok)
+        ++m_succeeded;
+    if (result == BatchPdfExporter::Reused)
+        ++m_reused;
+    Q_EMIT jobFinished(index, ok, error);
+    Q_EMIT progressChanged(m_done, m_jobs.size());
+}
+
+void BatchProcessExporter::finishIfDone()
+{
+    if (!m_workers.isEmpty())
+        return;
+
+    // Jobs no worker could take (the program failed to start)
+    if (!m_canceled) {
+        while (m_nextJob < m_jobs.size())
+            completeJob(m_nextJob++, BatchPdfExporter::Failed, tr("no worker available"));
+    }
+
+    const int failed = m_done - m_succeeded;
+    m_jobs.clear();
+    Q_EMIT finished(m_succeeded, m_reused, failed, m_canceled);
+}
+
+int BatchProcessExporter::serveWorker(BatchPdfExporter *exporter, const PdfExportOptions &options)
+{
+    // Standard output carries the protocol only; diagnostics go to stderr
+    QFile in;
+    QFile out;
+    if (!in.open(stdin, QIODevice::ReadOnly, QFileDevice::DontCloseHandle)
+        || !out.open(stdout, QIODevice::WriteOnly, QFileDevice::DontCloseHandle)) {
+        qWarning() << "BatchProcessExporter: cannot open the standard streams";
+        return 1;
+    }
+
+    for (;;) {
+        const QByteArray header = readExactly(in, kFrameHeader);
+        if (header.isEmpty())
+            return 0; // supervisor is done
+        if (header.size() < kFrameHeader)
+            return 1;
+        const QByteArray payload = readExactly(in, qFromBigEndian<quint32>(header.constData()));
+
+        QDataStream request(payload);
+        request.setVersion(QDataStream::Qt_6_0);
+        quint32 index = 0;
+        BatchPdfExporter::Job job;
+        request >> index >> job.inputPath >> job.outputPath;
+        if (request.status() != QDataStream::Ok)
+            return 1;
+        job.options = options;
+
+        const BatchPdfExporter::JobResult result = exporter->exportOne(job);
+
+        QByteArray reply;
+        QDataStream stream(&reply, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << index << qint32(result);
+        const QByteArray data = frame(reply);
+        if (out.write(data) != data.size() || !out.flush())
+            return 1;
+    }
+}
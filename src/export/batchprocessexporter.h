@@ -0,0 +1,124 @@
+/*
+ * batchprocessexporter.h — PDF batch export over worker processes
+ *
+ * Supervises N worker processes that each run the BatchPdfExporter
+ * pipeline one document at a time, so a document that crashes a library
+ * (a malformed image or font taking down Poppler or FreeType) fails alone
+ * instead of ending the batch.  A worker that dies is replaced and the
+ * document it held is reported as failed; a worker that takes longer
+ * than the job timeout is killed the same way.
+ *
+ * Workers are started as workerProgram() workerArguments() and speak a
+ * framed protocol on their standard streams, serveWorker() being the
+ * worker side.  Every frame is a quint32 byte length followed by a
+ * QDataStream (Qt_6_0) payload:
+ *
+ *   request   quint32 index, QString inputPath, QString outputPath
+ *   reply     quint32 index, qint32 BatchPdfExporter::JobResult
+ *
+ * Styles, page layout and export options are set up by the worker itself
+ * (from its arguments), so only paths cross the pipe.  Standard error of
+ * the workers is forwarded.  Font files are memory-mapped by FontManager
+ * and the compiled hyphenation patterns are used in place from the
+ * executable, so the workers share those pages through the page cache.
+ *
+ * Signals are delivered on the thread that owns the exporter, which needs
+ * an event loop.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_BATCHPROCESSEXPORTER_H
+#define PRETTYREADER_BATCHPROCESSEXPORTER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+class BatchPdfExporter;
+class QTimer;
+struct PdfExportOptions;
+
+class BatchProcessExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Job {
+        QString inputPath;
+        QString outputPath;
+    };
+
+    explicit BatchProcessExporter(QObject *parent = nullptr);
+    ~BatchProcessExporter() override;
+
+    void setWorkerProgram(const QString &program, const QStringList &arguments)
+    {
+        m_program = program;
+        m_arguments = arguments;
+    }
+    QString workerProgram() const { return m_program; }
+    QStringList workerArguments() const { return m_arguments; }
+
+    // 0 = one per core
+    void setWorkerCount(int count) { m_workerCount = count; }
+    // Per document; 0 = no limit
+    void setJobTimeout(int msecs) { m_jobTimeout = msecs; }
+
+    // Returns false if a batch is already running or @p jobs is empty.
+    bool start(const QList<Job> &jobs);
+
+    // Stop handing out jobs; documents already in progress still finish.
+    void cancel();
+
+    bool isRunning() const { return !m_workers.isEmpty(); }
+
+    // Worker side: answer requests from standard input with @p exporter,
+    // exporting with @p options, until the supervisor closes it.  Returns
+    // the process exit code.
+    static int serveWorker(BatchPdfExporter *exporter, const PdfExportOptions &options);
+
+Q_SIGNALS:
+    // @p error is empty for documents that were exported
+    void jobFinished(int index, bool ok, const QString &error);
+    void progressChanged(int done, int total);
+    // @p reused of the @p succeeded documents came from the export cache
+    void finished(int succeeded, int reused, int failed, bool canceled);
+
+private:
+    struct Worker {
+        QProcess *process = nullptr;
+        QTimer *timer = nullptr;
+        QByteArray pending;  // unparsed reply bytes
+        int job = -1;        // index in flight, -1 when idle
+        QString error;       // why the supervisor stopped it, if it did
+    };
+
+    void startWorker();
+    void dispatch(Worker *worker);
+    void onReadyRead(Worker *worker);
+    void onWorkerFinished(Worker *worker, int exitCode, QProcess::ExitStatus status);
+    void onTimeout(Worker *worker);
+    void removeWorker(Worker *worker);
+    void completeJob(int index, int result, const QString &error);
+    void finishIfDone();
+
+    QString m_program;
+    QStringList m_arguments;
+    int m_workerCount = 0;
+    int m_jobTimeout = 0;
+
+    QList<Job> m_jobs;
+    QList<Worker *> m_workers;
+    int m_nextJob = 0;
+    int m_done = 0;
+    int m_succeeded = 0;
+    int m_reused = 0;
+    bool m_canceled = false;
+    bool m_startFailed = false;  // the program cannot be run; no restarts
+};
+
+#endif // PRETTYREADER_BATCHPROCESSEXPORTER_H
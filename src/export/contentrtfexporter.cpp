@@ -137,7 +137,7 @@ QList<Content::InlineNode> ContentRtfExporter::buildCodeInlines(const Content::C
 
     if (!cb.language.isEmpty()) {
         CodeSpanCollector collector;
-        auto spans = collector.highlight(cb.code, cb.language);
+        auto spans = collector.highlight(cb.code.toString(), cb.language);
 
         if (!spans.isEmpty()) {
             std::sort(spans.begin(), spans.end(),
@@ -315,7 +315,7 @@ void ContentRtfExporter::writeCodeBlock(QByteArray &out, const Content::CodeBloc
             continue;
 
         // Split this TextRun at '\n' characters
-        const QStringList parts = tr->text.split(QLatin1Char('\n'));
+        const QStringList parts = tr->text.toString().split(QLatin1Char('\n'));
         for (int i = 0; i < parts.size(); ++i) {
             if (i > 0)
                 lines.emplaceBack(); // newline → start new line group
@@ -346,7 +346,7 @@ void ContentRtfExporter::writeCodeBlock(QByteArray &out, const Content::CodeBloc
             for (const auto &run : lineRuns) {
                 out.append("{");
                 writeCharFormat(out, run.style);
-                out.append(RtfUtils::escapeText(run.text));
+                out.append(RtfUtils::escapeText(run.text.toString()));
                 out.append("}");
             }
         }
@@ -543,17 +543,17 @@ void ContentRtfExporter::writeInlines(QByteArray &out, const QList<Content::Inli
                     style.foreground = foregroundOverride;
                 out.append("{");
                 writeCharFormat(out, style);
-                out.append(RtfUtils::escapeText(n.text));
+                out.append(RtfUtils::escapeText(n.text.toString()));
                 out.append("}");
             } else if constexpr (std::is_same_v<T, Content::InlineCode>) {
                 out.append("{");
                 writeCharFormat(out, useBaseStyle ? baseStyle : n.style);
-                out.append(RtfUtils::escapeText(n.text));
+                out.append(RtfUtils::escapeText(n.text.toString()));
                 out.append("}");
             } else if constexpr (std::is_same_v<T, Content::Link>) {
                 out.append("{");
                 writeCharFormat(out, useBaseStyle ? baseStyle : n.style);
-                out.append(RtfUtils::escapeText(n.text));
+                out.append(RtfUtils::escapeText(n.text.toString()));
                 out.append("}");
             } else if constexpr (std::is_same_v<T, Content::FootnoteRef>) {
                 out.append("{");
@@ -0,0 +1,298 @@
+/*
+ * exportcache.cpp — Content-addressed cache of exported PDFs
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "exportcache.h"
+#include "pdfexportoptions.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QWaitCondition>
+
+#include <algorithm>
+
+namespace {
+
+// Bump when anything that shapes PDF output changes without the
+// application version changing.
+constexpr int kFormatVersion = 2;
+
+// Local files a document may embed: inline image targets and every
+// reference definition (those may be used by ![alt][ref]).  Listing a
+// file that turns out to be a plain link only costs a hash.
+QStringList referencedFiles(const QByteArray &markdown, const QString &basePath)
+{
+    static const QRegularExpression inlineImageRx(
+        QStringLiteral(R"(!\[(?:[^\]\\]|\\.|\[[^\]]*\])*\]\(\s*(<[^>]*>|[^\s)]+))"));
+    static const QRegularExpression referenceRx(
+        QStringLiteral(R"(^ {0,3}\[[^\]]+\]:\s*(<[^>]*>|\S+))"),
+        QRegularExpression::MultilineOption);
+
+    const QString text = QString::fromUtf8(markdown);
+    QStringList files;
+    for (const QRegularExpression *rx : {&inlineImageRx, &referenceRx}) {
+        auto it = rx->globalMatch(text);
+        while (it.hasNext()) {
+            QString src = it.next().captured(1);
+            if (src.startsWith(QLatin1Char('<')))
+                src = src.mid(1, src.size() - 2);
+            if (src.isEmpty() || src.startsWith(QLatin1Char('#'))
+                || src.contains(QLatin1String("://")) || src.startsWith(QLatin1String("data:")))
+                continue;
+            // Resolved the way ContentBuilder loads images
+            if (QFileInfo(src).isRelative() && !basePath.isEmpty())
+                src = QDir(basePath).filePath(src);
+            files.append(QDir::cleanPath(src));
+        }
+    }
+    files.sort();
+    files.removeDuplicates();
+    return files;
+}
+
+// Serialises restore() and store() on one key across batch workers, so
+// a stale entry is never removed while it is being rewritten.  Other keys
+// proceed in parallel.
+QMutex s_busyMutex;
+QWaitCondition s_keyReleased;
+QSet<QByteArray> s_busyKeys;
+
+class KeyLocker
+{
+public:
+    explicit KeyLocker(const QByteArray &key)
+        : m_key(key)
+    {
+        QMutexLocker lock(&s_busyMutex);
+        while (s_busyKeys.contains(m_key))
+            s_keyReleased.wait(&s_busyMutex);
+        s_busyKeys.insert(m_key);
+    }
+
+    ~KeyLocker()
+    {
+        QMutexLocker lock(&s_busyMutex);
+        s_busyKeys.remove(m_key);
+        s_keyReleased.wakeAll();
+    }
+
+    KeyLocker(const KeyLocker &) = delete;
+    KeyLocker &operator=(const KeyLocker &) = delete;
+
+private:
+    QByteArray m_key;
+};
+
+void setModificationTime(const QString &path, const QDateTime &time)
+{
+    QFile file(path);
+    if (file.open(QIODevice::ReadWrite))
+        file.setFileTime(time, QFileDevice::FileModificationTime);
+}
+
+bool fontsUnchanged(const QJsonArray &fonts)
+{
+    for (const QJsonValue &value : fonts) {
+        const QJsonObject font = value.toObject();
+        const QFileInfo fi(font[QLatin1String("path")].toString());
+        if (!fi.exists()
+            || fi.size() != font[QLatin1String("size")].toInteger()
+            || fi.lastModified().toMSecsSinceEpoch() != font[QLatin1String("modified")].toInteger())
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ExportCache::ExportCache(const QString &directory)
+    : m_directory(directory)
+{
+    if (m_directory.isEmpty())
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QLatin1String("/pdf-export");
+}
+
+QString ExportCache::entryPath(const QByteArray &key, const char *suffix) const
+{
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(key.toHex())
+        + QLatin1String(suffix);
+}
+
+QByteArray ExportCache::documentKey(const QByteArray &environment,
+                                    const QByteArray &markdown,
+                                    const QFileInfo &input,
+                                    const PdfExportOptions &options)
+{
+    QList<int> excluded(options.excludedHeadingIndices.cbegin(),
+                        options.excludedHeadingIndices.cend());
+    std::sort(excluded.begin(), excluded.end());
+
+    QByteArray header;
+    {
+        QDataStream out(&header, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << kFormatVersion << QCoreApplication::applicationVersion() << environment
+            // Title and the {filename} header field come from the name
+            << input.fileName()
+            << options.title << options.author << options.subject << options.keywords
+            << options.markdownCopy << options.unwrapParagraphs << options.xobjectGlyphs
+            << options.useHersheyFonts << options.sectionsModified << excluded
+            << options.pageRangeModified << options.pageRangeExpr
+            << options.includeBookmarks << options.bookmarkMaxDepth
+            << int(options.initialView) << int(options.pageLayout) << options.reproducible
+            << qint64(markdown.size());
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(header);
+    hash.addData(markdown);
+
+    for (const QString &path : referencedFiles(markdown, input.absolutePath())) {
+        hash.addData(path.toUtf8());
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly)) {
+            hash.addData(QByteArray::number(file.size()));
+            hash.addData(&file);
+        } else {
+            hash.addData("-");
+        }
+    }
+    return hash.result();
+}
+
+ExportCache::Result ExportCache::restore(const QByteArray &key, const QString &outputPath) const
+{
+    KeyLocker lock(key);
+    const QString pdfPath = entryPath(key, ".pdf");
+    const QString manifestPath = entryPath(key, ".json");
+    const QFileInfo cached(pdfPath);
+    if (!cached.exists())
+        return Miss;
+
+    QFile manifestFile(manifestPath);
+    if (!manifestFile.open(QIODevice::ReadOnly))
+        return Miss;
+    const QJsonObject manifest = QJsonDocument::fromJson(manifestFile.readAll()).object();
+    manifestFile.close();
+    if (!fontsUnchanged(manifest[QLatin1String("fonts")].toArray())) {
+        QFile::remove(pdfPath);
+        QFile::remove(manifestPath);
+        return Miss;
+    }
+
+    // The manifest's time records the last use, for prune()
+    setModificationTime(manifestPath, QDateTime::currentDateTime());
+
+    const QFileInfo output(outputPath);
+    if (output.exists() && output.size() == cached.size()
+        && output.lastModified() == cached.lastModified())
+        return Unchanged;
+
+    if (output.exists())
+        QFile::remove(outputPath);
+    if (!QFile::copy(pdfPath, outputPath)) {
+        qWarning() << "ExportCache: cannot copy cached PDF to" << outputPath;
+        return Miss;
+    }
+    setModificationTime(outputPath, cached.lastModified());
+    return Copied;
+}
+
+bool ExportCache::store(const QByteArray &key, const QByteArray &pdf,
+                        const QStringList &fontFiles, const QString &outputPath) const
+{
+    if (!QDir().mkpath(m_directory))
+        return false;
+
+    KeyLocker lock(key);
+    const QString pdfPath = entryPath(key, ".pdf");
+    QSaveFile pdfFile(pdfPath);
+    if (!pdfFile.open(QIODevice::WriteOnly) || pdfFile.write(pdf) != pdf.size()
+        || !pdfFile.commit()) {
+        qWarning() << "ExportCache: cannot write" << pdfPath;
+        return false;
+    }
+
+    QJsonArray fonts;
+    for (const QString &path : fontFiles) {
+        const QFileInfo fi(path);
+        QJsonObject font;
+        font[QLatin1String("path")] = path;
+        font[QLatin1String("size")] = fi.size();
+        font[QLatin1String("modified")] = fi.lastModified().toMSecsSinceEpoch();
+        fonts.append(font);
+    }
+    QJsonObject manifest;
+    manifest[QLatin1String("fonts")] = fonts;
+
+    // Written last: restore() only trusts entries that have one
+    QSaveFile manifestFile(entryPath(key, ".json"));
+    if (!manifestFile.open(QIODevice::WriteOnly)) {
+        QFile::remove(pdfPath);
+        return false;
+    }
+    manifestFile.write(QJsonDocument(manifest).toJson(QJsonDocument::Compact));
+    if (!manifestFile.commit()) {
+        QFile::remove(pdfPath);
+        return false;
+    }
+
+    setModificationTime(outputPath, QFileInfo(pdfPath).lastModified());
+    return true;
+}
+
+void ExportCache::prune() const
+{
+    if (m_maxSize <= 0)
+        return;
+
+    struct Entry {
+        QString pdfPath;
+        QString manifestPath;
+        QDateTime lastUsed;
+        qint64 size;
+    };
+
+    QList<Entry> entries;
+    qint64 total = 0;
+    const QDir dir(m_directory);
+    const QFileInfoList pdfs = dir.entryInfoList({QStringLiteral("*.pdf")}, QDir::Files);
+    for (const QFileInfo &pdf : pdfs) {
+        const QFileInfo manifest(dir.filePath(pdf.completeBaseName() + QLatin1String(".json")));
+        Entry entry{pdf.filePath(), manifest.filePath(),
+                    manifest.exists() ? manifest.lastModified() : QDateTime(),
+                    pdf.size() + (manifest.exists() ? manifest.size() : 0)};
+        total += entry.size;
+        entries.append(entry);
+    }
+    if (total <= m_maxSize)
+        return;
+
+    // Entries without a manifest sort first (invalid QDateTime)
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.lastUsed < b.lastUsed;
+    });
+    for (const Entry &entry : std::as_const(entries)) {
+        if (total <= m_maxSize)
+            break;
+        QFile::remove(entry.manifestPath);
+        QFile::remove(entry.pdfPath);
+        total -= entry.size;
+    }
+}
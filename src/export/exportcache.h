@@ -0,0 +1,77 @@
+/*
+ * exportcache.h — Content-addressed cache of exported PDFs
+ *
+ * Batch export keys every document on a SHA-256 over its inputs: the
+ * markdown bytes, the local images it references, the export options and
+ * a per-batch environment hash (resolved styles, page layout, typography
+ * settings).  PdfGenerator output is deterministic for reproducible
+ * exports, so an equal key means an equal file and the pipeline can be
+ * skipped: the output is left alone if it still matches the cache entry,
+ * or copied from the cache otherwise.
+ *
+ * Font files are not part of the key (which faces a document uses is only
+ * known after layout); each entry's manifest lists the files embedded in
+ * it with their size and modification time, and an entry whose fonts
+ * changed on disk is treated as a miss.
+ *
+ * Entries live flat in directory() as <key>.pdf plus <key>.json.
+ * restore() and store() may be called concurrently from batch workers;
+ * calls on the same key run one at a time.  prune() runs once the
+ * workers are done.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_EXPORTCACHE_H
+#define PRETTYREADER_EXPORTCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class QFileInfo;
+struct PdfExportOptions;
+
+class ExportCache
+{
+public:
+    enum Result {
+        Miss,       // not cached, or the entry is stale
+        Copied,     // output written from the cache
+        Unchanged,  // output already matched the cache entry
+    };
+
+    // Empty = <cache location>/pdf-export
+    explicit ExportCache(const QString &directory = QString());
+
+    QString directory() const { return m_directory; }
+
+    // Size prune() trims the cache down to; 0 = unlimited
+    void setMaxSize(qint64 bytes) { m_maxSize = bytes; }
+    qint64 maxSize() const { return m_maxSize; }
+
+    // @p environment hashes everything shared by the whole batch;
+    // @p markdown is the raw file content of @p input.
+    static QByteArray documentKey(const QByteArray &environment,
+                                  const QByteArray &markdown,
+                                  const QFileInfo &input,
+                                  const PdfExportOptions &options);
+
+    Result restore(const QByteArray &key, const QString &outputPath) const;
+
+    // Adds @p pdf under @p key and stamps @p outputPath (already written
+    // with the same bytes) so a later restore() reports it Unchanged.
+    bool store(const QByteArray &key, const QByteArray &pdf,
+               const QStringList &fontFiles, const QString &outputPath) const;
+
+    // Evict least recently used entries until the cache fits maxSize()
+    void prune() const;
+
+private:
+    QString entryPath(const QByteArray &key, const char *suffix) const;
+
+    QString m_directory;
+    qint64 m_maxSize = 512 * 1024 * 1024;
+};
+
+#endif // PRETTYREADER_EXPORTCACHE_H
@@ -9,6 +9,8 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -25,6 +27,60 @@ size_t qHash(const FontManager::FontKey &k, size_t seed = 0)
     return qHash(k.family, seed) ^ qHash(k.weight, seed) ^ qHash(k.italic, seed);
 }
 
+// Process-wide caches shared by every FontManager (GUI, batch export
+// workers).  Font files are mapped once and their bytes shared implicitly;
+// fontconfig matches are remembered so FcInitLoadConfigAndFonts runs once
+// per (family, weight, italic) rather than once per FontManager.
+namespace {
+QMutex s_sharedMutex;
+QHash<QString, QByteArray> s_fileData;
+QHash<QString, QString> s_resolvedPaths; // "family|weight|italic" -> path
+QList<QFile *> s_mappedFiles;             // never closed, see mapFile()
+
+// Mapped read-only rather than read, so the pages come from the page
+// cache and are shared with every other process using the same font
+// (batch worker processes in particular).  Mappings live as long as the
+// process; font packages replace files rather than rewrite them in place.
+QByteArray mapFile(const QString &filePath)
+{
+    auto *file = new QFile(filePath);
+    if (!file->open(QIODevice::ReadOnly) || file->size() <= 0) {
+        delete file;
+        return {};
+    }
+    if (uchar *data = file->map(0, file->size())) {
+        QMutexLocker lock(&s_sharedMutex);
+        s_mappedFiles.append(file);
+        return QByteArray::fromRawData(reinterpret_cast<const char *>(data), file->size());
+    }
+    // Compressed resources cannot be mapped
+    QByteArray data = file->readAll();
+    delete file;
+    return data;
+}
+
+QByteArray sharedFileData(const QString &filePath)
+{
+    {
+        QMutexLocker lock(&s_sharedMutex);
+        auto it = s_fileData.constFind(filePath);
+        if (it != s_fileData.constEnd())
+            return it.value();
+    }
+
+    QByteArray data = mapFile(filePath);
+    if (data.isEmpty())
+        return {};
+
+    QMutexLocker lock(&s_sharedMutex);
+    auto it = s_fileData.constFind(filePath);
+    if (it != s_fileData.constEnd())
+        return it.value(); // another thread raced us; keep its copy
+    s_fileData.insert(filePath, data);
+    return data;
+}
+} // namespace
+
 FontFace::~FontFace()
 {
     if (hbFont) {
@@ -63,6 +119,25 @@ FontManager::~FontManager()
 }
 
 QString FontManager::resolveFontPath(const QString &family, int weight, bool italic) const
+{
+    const QString cacheKey = family + QLatin1Char('|') + QString::number(weight)
+        + QLatin1Char('|') + QLatin1Char(italic ? '1' : '0');
+    {
+        QMutexLocker lock(&s_sharedMutex);
+        auto it = s_resolvedPaths.constFind(cacheKey);
+        if (it != s_resolvedPaths.constEnd())
+            return it.value();
+    }
+
+    QString path = matchFontPath(family, weight, italic);
+    if (!path.isEmpty()) {
+        QMutexLocker lock(&s_sharedMutex);
+        s_resolvedPaths.insert(cacheKey, path);
+    }
+    return path;
+}
+
+QString FontManager::matchFontPath(const QString &family, int weight, bool italic)
 {
     FcConfig *config = FcInitLoadConfigAndFonts();
     if (!config)
@@ -157,8 +232,8 @@ FontFace *FontManager::loadFontFromPath(const QString &filePath, int faceIndex)
     if (!m_ftLibrary)
         return nullptr;
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    QByteArray data = sharedFileData(filePath);
+    if (data.isEmpty()) {
         qWarning() << "FontManager: Cannot open font file:" << filePath;
         return nullptr;
     }
@@ -166,7 +241,7 @@ FontFace *FontManager::loadFontFromPath(const QString &filePath, int faceIndex)
     auto *face = new FontFace;
     face->filePath = filePath;
     face->faceIndex = faceIndex;
-    face->rawData = file.readAll();
+    face->rawData = data;
 
     FT_Error err = FT_New_Memory_Face(
         m_ftLibrary,
@@ -215,6 +290,23 @@ void FontManager::resetUsage()
         face->usedGlyphs.clear();
 }
 
+QStringList FontManager::usedFontFiles() const
+{
+    QStringList files;
+    auto collect = [&files](const FontFace *face) {
+        if (!face->usedGlyphs.isEmpty() && !face->filePath.isEmpty()
+            && !face->filePath.startsWith(QLatin1Char(':')))
+            files.append(face->filePath);
+    };
+    for (const auto *face : m_faces)
+        collect(face);
+    for (const auto *face : m_facesByPath)
+        collect(face);
+    files.sort();
+    files.removeDuplicates();
+    return files;
+}
+
 // --- Metrics ---
 
 static qreal ftUnitsToPoints(FT_Face face, FT_Long units, qreal sizePoints)
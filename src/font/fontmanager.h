@@ -14,6 +14,7 @@
 #include <QObject>
 #include <QSet>
 #include <QString>
+#include <QStringList>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -27,7 +28,7 @@ struct FontFace {
     hb_font_t *hbFont = nullptr;
     QString filePath;
     int faceIndex = 0;
-    QByteArray rawData; // kept alive for FreeType/HarfBuzz
+    QByteArray rawData; // kept alive for FreeType/HarfBuzz; shared per file
 
     QSet<uint> usedGlyphs;
 
@@ -54,6 +55,9 @@ public:
     void markGlyphUsed(FontFace *face, uint glyphId);
     sfnt::SubsetResult subsetFont(FontFace *face) const;
     void resetUsage();
+    // Sorted, de-duplicated files of the faces with glyphs marked used
+    // since the last resetUsage(); Qt resource fonts are left out.
+    QStringList usedFontFiles() const;
 
     // Metrics (all in points at the given size)
     qreal ascent(FontFace *face, qreal sizePoints) const;
@@ -90,6 +94,7 @@ private:
     QHash<QString, FontFace *> m_facesByPath;
 
     QString resolveFontPath(const QString &family, int weight, bool italic) const;
+    static QString matchFontPath(const QString &family, int weight, bool italic);
 };
 
 #endif // PRETTYREADER_FONTMANAGER_H
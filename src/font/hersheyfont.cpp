@@ -11,6 +11,7 @@
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
 
 #include <cmath>
 #include <limits>
@@ -205,9 +206,11 @@ HersheyFontRegistry &HersheyFontRegistry::instance()
 
 void HersheyFontRegistry::ensureLoaded()
 {
-    if (m_loaded)
+    if (m_loaded.load(std::memory_order_acquire))
+        return;
+    QMutexLocker lock(&m_loadMutex);
+    if (m_loaded.load(std::memory_order_relaxed))
         return;
-    m_loaded = true;
 
     // Load all .jhf files from the Qt resource bundle
     QDirIterator it(QStringLiteral(":/hershey"), {QStringLiteral("*.jhf")},
@@ -280,6 +283,8 @@ void HersheyFontRegistry::ensureLoaded()
               QStringLiteral("cyrillic"),
               QStringLiteral("cyrilc_1"),
               QString(), QString());
+
+    m_loaded.store(true, std::memory_order_release);
 }
 
 HersheyFontResult HersheyFontRegistry::resolve(const QString &family,
@@ -12,11 +12,14 @@
 #define PRETTYREADER_HERSHEYFONT_H
 
 #include <QHash>
+#include <QMutex>
 #include <QPointF>
 #include <QString>
 #include <QStringList>
 #include <QVector>
 
+#include <atomic>
+
 // ---------------------------------------------------------------------------
 // HersheyGlyph — a single glyph as a list of stroked polylines
 // ---------------------------------------------------------------------------
@@ -94,6 +97,7 @@ public:
     static HersheyFontRegistry &instance();
 
     /// Lazy, idempotent — loads all .jhf files from :/hershey/ on first call.
+    /// Safe to call from several threads (batch export workers).
     void ensureLoaded();
 
     /// Resolve a CSS-style family/weight/italic request to a Hershey font,
@@ -116,7 +120,8 @@ private:
         QString boldItalic;
     };
 
-    bool m_loaded = false;
+    std::atomic<bool> m_loaded{false};
+    QMutex m_loadMutex;
     QHash<QString, HersheyFont *> m_fonts;           // name → font
     QHash<QString, FamilyEntry> m_families;           // family → entry
 };
@@ -6,6 +6,7 @@
  */
 
 #include "textshaper.h"
+#include "allocprofiler.h"
 #include "fontmanager.h"
 #include "hersheyfont.h"
 
@@ -285,6 +286,7 @@ QList<TextShaper::InternalRun> TextShaper::itemizeFontCoverage(
 
 QList<ShapedRun> TextShaper::shape(const QString &text, const QList<StyleRun> &styles)
 {
+    AllocProfiler::Scope allocScope(AllocProfiler::Shaping);
     QList<ShapedRun> result;
     if (text.isEmpty() || styles.isEmpty())
         return result;
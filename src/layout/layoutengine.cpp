@@ -4,6 +4,7 @@
  */
 
 #include "layoutengine.h"
+#include "allocprofiler.h"
 #include "codespancollector.h"
 #include "fontmanager.h"
 #include "linebreaker.h"
@@ -17,6 +18,8 @@
 #include <unicode/brkiter.h>
 #include <unicode/unistr.h>
 
+#include <utility>
+
 namespace Layout {
 
 Engine::Engine(FontManager *fontManager, TextShaper *textShaper)
@@ -29,6 +32,7 @@ Engine::Engine(FontManager *fontManager, TextShaper *textShaper)
 
 LayoutResult Engine::layout(const Content::Document &doc, const PageLayout &pageLayout)
 {
+    AllocProfiler::Scope allocScope(AllocProfiler::Layout);
     LayoutResult result;
     result.pageSize = QSizeF(
         pageLayout.pageSizeId == QPageSize::Custom
@@ -42,41 +46,7 @@ LayoutResult Engine::layout(const Content::Document &doc, const PageLayout &page
     qreal availWidth = contentSize.width();
 
     // Layout all blocks into page elements
-    QList<PageElement> elements;
-
-    for (const auto &block : doc.blocks) {
-        std::visit([&](const auto &b) {
-            using T = std::decay_t<decltype(b)>;
-            if constexpr (std::is_same_v<T, Content::Paragraph>) {
-                // Detect image-only paragraphs (single InlineImage inline)
-                if (b.inlines.size() == 1
-                    && std::holds_alternative<Content::InlineImage>(b.inlines.first())) {
-                    const auto &img = std::get<Content::InlineImage>(b.inlines.first());
-                    if (!img.resolvedImageData.isEmpty()) {
-                        elements.append(layoutImage(img, availWidth));
-                    }
-                } else {
-                    elements.append(layoutParagraph(b, availWidth));
-                }
-            } else if constexpr (std::is_same_v<T, Content::Heading>) {
-                elements.append(layoutHeading(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::CodeBlock>) {
-                elements.append(layoutCodeBlock(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::BlockQuote>) {
-                auto bqElements = layoutBlockQuote(b, availWidth);
-                elements.append(bqElements);
-            } else if constexpr (std::is_same_v<T, Content::List>) {
-                auto listElements = layoutList(b, availWidth);
-                elements.append(listElements);
-            } else if constexpr (std::is_same_v<T, Content::Table>) {
-                elements.append(layoutTable(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::HorizontalRule>) {
-                elements.append(layoutHorizontalRule(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::FootnoteSection>) {
-                elements.append(layoutFootnoteSection(b, availWidth));
-            }
-        }, block);
-    }
+    QList<PageElement> elements = layoutBlocks(doc, availWidth);
 
     // Assign elements to pages
     assignToPages(elements, pageLayout, result);
@@ -132,49 +102,104 @@ LayoutResult Engine::layout(const Content::Document &doc, const PageLayout &page
     return result;
 }
 
+// --- Block layout (phase 1) ---
+
+void Engine::setReusableBlocks(const BlockElements &previous, const Content::Splice &splice)
+{
+    m_reusableBlocks = previous;
+    m_splice = splice;
+    m_reuseMask.clear();
+}
+
+void Engine::setReusableBlocks(const BlockElements &previous, const QList<bool> &reuse)
+{
+    m_reusableBlocks = previous;
+    m_splice = Content::Splice();
+    m_reuseMask = reuse;
+}
+
+QList<PageElement> Engine::layoutBlocks(const Content::Document &doc, qreal availWidth)
+{
+    const BlockElements reusable = std::exchange(m_reusableBlocks, {});
+    const Content::Splice splice = std::exchange(m_splice, {});
+    const QList<bool> mask = std::exchange(m_reuseMask, {});
+    const int blockCount = doc.blocks.size();
+    const bool reuse = !splice.isEmpty()
+        && splice.leading + splice.trailing <= qMin<qsizetype>(reusable.size(), blockCount);
+    const bool reuseMasked = mask.size() == blockCount && reusable.size() == blockCount;
+
+    m_blockElements.clear();
+    m_blockElements.reserve(blockCount);
+    QList<PageElement> elements;
+
+    for (int i = 0; i < blockCount; ++i) {
+        QList<PageElement> blockElements;
+        if (reuseMasked && mask.at(i)) {
+            blockElements = reusable.at(i);
+            markGlyphsUsed(blockElements, m_fontManager);
+        } else if (reuse && i < splice.leading) {
+            blockElements = reusable.at(i);
+            markGlyphsUsed(blockElements, m_fontManager);
+        } else if (reuse && i >= blockCount - splice.trailing) {
+            blockElements = reusable.at(reusable.size() - (blockCount - i));
+            if (splice.lineDelta != 0)
+                shiftSourceLines(blockElements, splice.lineDelta);
+            markGlyphsUsed(blockElements, m_fontManager);
+        } else {
+            blockElements = layoutBlock(doc.blocks.at(i), availWidth);
+        }
+        elements.append(blockElements);
+        m_blockElements.append(std::move(blockElements));
+    }
+    return elements;
+}
+
+QList<PageElement> Engine::layoutBlock(const Content::BlockNode &block, qreal availWidth)
+{
+    QList<PageElement> elements;
+    std::visit([&](const auto &b) {
+        using T = std::decay_t<decltype(b)>;
+        if constexpr (std::is_same_v<T, Content::Paragraph>) {
+            // Detect image-only paragraphs (single InlineImage inline)
+            if (b.inlines.size() == 1
+                && std::holds_alternative<Content::InlineImage>(b.inlines.first())) {
+                const auto &img = std::get<Content::InlineImage>(b.inlines.first());
+                if (!img.resolvedImageData.isEmpty()) {
+                    elements.append(layoutImage(img, availWidth));
+                }
+            } else {
+                elements.append(layoutParagraph(b, availWidth));
+            }
+        } else if constexpr (std::is_same_v<T, Content::Heading>) {
+            elements.append(layoutHeading(b, availWidth));
+        } else if constexpr (std::is_same_v<T, Content::CodeBlock>) {
+            elements.append(layoutCodeBlock(b, availWidth));
+        } else if constexpr (std::is_same_v<T, Content::BlockQuote>) {
+            elements.append(layoutBlockQuote(b, availWidth));
+        } else if constexpr (std::is_same_v<T, Content::List>) {
+            elements.append(layoutList(b, availWidth));
+        } else if constexpr (std::is_same_v<T, Content::Table>) {
+            elements.append(layoutTable(b, availWidth));
+        } else if constexpr (std::is_same_v<T, Content::HorizontalRule>) {
+            elements.append(layoutHorizontalRule(b, availWidth));
+        } else if constexpr (std::is_same_v<T, Content::FootnoteSection>) {
+            elements.append(layoutFootnoteSection(b, availWidth));
+        }
+    }, block);
+    resolveGlyphPositions(elements);
+    return elements;
+}
+
 // --- Continuous (web-view) layout ---
 
 ContinuousLayoutResult Engine::layoutContinuous(const Content::Document &doc, qreal availWidth)
 {
+    AllocProfiler::Scope allocScope(AllocProfiler::Layout);
     ContinuousLayoutResult result;
     result.contentWidth = availWidth;
 
     // Phase 1: layout all blocks into page elements (identical to layout())
-    QList<PageElement> elements;
-
-    for (const auto &block : doc.blocks) {
-        std::visit([&](const auto &b) {
-            using T = std::decay_t<decltype(b)>;
-            if constexpr (std::is_same_v<T, Content::Paragraph>) {
-                // Detect image-only paragraphs (single InlineImage inline)
-                if (b.inlines.size() == 1
-                    && std::holds_alternative<Content::InlineImage>(b.inlines.first())) {
-                    const auto &img = std::get<Content::InlineImage>(b.inlines.first());
-                    if (!img.resolvedImageData.isEmpty()) {
-                        elements.append(layoutImage(img, availWidth));
-                    }
-                } else {
-                    elements.append(layoutParagraph(b, availWidth));
-                }
-            } else if constexpr (std::is_same_v<T, Content::Heading>) {
-                elements.append(layoutHeading(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::CodeBlock>) {
-                elements.append(layoutCodeBlock(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::BlockQuote>) {
-                auto bqElements = layoutBlockQuote(b, availWidth);
-                elements.append(bqElements);
-            } else if constexpr (std::is_same_v<T, Content::List>) {
-                auto listElements = layoutList(b, availWidth);
-                elements.append(listElements);
-            } else if constexpr (std::is_same_v<T, Content::Table>) {
-                elements.append(layoutTable(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::HorizontalRule>) {
-                elements.append(layoutHorizontalRule(b, availWidth));
-            } else if constexpr (std::is_same_v<T, Content::FootnoteSection>) {
-                elements.append(layoutFootnoteSection(b, availWidth));
-            }
-        }, block);
-    }
+    QList<PageElement> elements = layoutBlocks(doc, availWidth);
 
     // Phase 2: simple vertical stacking (no page breaks, no splitting)
     qreal y = 0;
@@ -257,18 +282,22 @@ struct CollectedText {
     QList<MarkdownRange> markdownRanges;
 };
 
-// Strip U+00AD (soft hyphen) from text, recording their cleaned-text positions
-QString stripSoftHyphens(const QString &text, int offset, QSet<int> &positions)
+// Append text to @p out without its U+00AD (soft hyphens), recording their
+// cleaned-text positions; returns the number of characters appended
+int appendWithoutSoftHyphens(const Content::TextSlice &text, QString &out, QSet<int> &positions)
 {
-    QString clean;
-    clean.reserve(text.size());
-    for (int i = 0; i < text.size(); ++i) {
-        if (text[i] == QChar(0x00AD))
-            positions.insert(offset + clean.size());
-        else
-            clean.append(text[i]);
+    const int start = out.size();
+    if (text.edits().isEmpty() && !text.source().contains(QChar(0x00AD))) {
+        out.append(text.source());
+    } else {
+        text.forEachChar([&](QChar c) {
+            if (c == QChar(0x00AD))
+                positions.insert(out.size());
+            else
+                out.append(c);
+        });
     }
-    return clean;
+    return out.size() - start;
 }
 
 CollectedText collectInlines(const QList<Content::InlineNode> &inlines,
@@ -281,10 +310,11 @@ CollectedText collectInlines(const QList<Content::InlineNode> &inlines,
             using T = std::decay_t<decltype(n)>;
             if constexpr (std::is_same_v<T, Content::TextRun>) {
                 int startPos = result.text.size();
-                QString clean = stripSoftHyphens(n.text, startPos, result.softHyphenPositions);
+                const int length = appendWithoutSoftHyphens(n.text, result.text,
+                                                            result.softHyphenPositions);
                 StyleRun sr;
                 sr.start = startPos;
-                sr.length = clean.size();
+                sr.length = length;
                 sr.fontFamily = n.style.fontFamily;
                 sr.fontWeight = n.style.fontWeight;
                 sr.fontItalic = n.style.italic;
@@ -292,7 +322,6 @@ CollectedText collectInlines(const QList<Content::InlineNode> &inlines,
                 sr.fontFeatures = n.style.fontFeatures;
                 result.styleRuns.append(sr);
                 result.textStyles.append(n.style);
-                result.text.append(clean);
                 if (markdownMode) {
                     QString prefix, suffix;
                     // Only mark bold/italic if it differs from the base style
@@ -305,7 +334,7 @@ CollectedText collectInlines(const QList<Content::InlineNode> &inlines,
                     else if (italic)    { prefix += QStringLiteral("*");   suffix.prepend(QStringLiteral("*")); }
                     if (strike)         { prefix += QStringLiteral("~~");  suffix.prepend(QStringLiteral("~~")); }
                     if (!prefix.isEmpty())
-                        result.markdownRanges.append({startPos, startPos + static_cast<int>(clean.size()), prefix, suffix});
+                        result.markdownRanges.append({startPos, startPos + length, prefix, suffix});
                 }
             } else if constexpr (std::is_same_v<T, Content::InlineCode>) {
                 StyleRun sr;
@@ -318,7 +347,7 @@ CollectedText collectInlines(const QList<Content::InlineNode> &inlines,
                 sr.fontFeatures = n.style.fontFeatures;
                 result.styleRuns.append(sr);
                 result.textStyles.append(n.style);
-                result.text.append(n.text);
+                n.text.appendTo(result.text);
                 if (markdownMode)
                     result.markdownRanges.append({sr.start, sr.start + sr.length,
                                                    QStringLiteral("`"), QStringLiteral("`")});
@@ -360,19 +389,19 @@ CollectedText collectInlines(const QList<Content::InlineNode> &inlines,
                 result.text.append(QChar('\n'));
             } else if constexpr (std::is_same_v<T, Content::Link>) {
                 int startPos = result.text.size();
-                QString clean = stripSoftHyphens(n.text, startPos, result.softHyphenPositions);
+                const int length = appendWithoutSoftHyphens(n.text, result.text,
+                                                            result.softHyphenPositions);
                 StyleRun sr;
                 sr.start = startPos;
-                sr.length = clean.size();
+                sr.length = length;
                 sr.fontFamily = n.style.fontFamily;
                 sr.fontWeight = n.style.fontWeight;
                 sr.fontItalic = n.style.italic;
                 sr.fontSize = n.style.fontSize;
                 result.styleRuns.append(sr);
                 result.textStyles.append(n.style);
-                result.text.append(clean);
                 if (markdownMode)
-                    result.markdownRanges.append({startPos, startPos + static_cast<int>(clean.size()),
+                    result.markdownRanges.append({startPos, startPos + length,
                                                    QStringLiteral("["),
                                                    QStringLiteral("](") + n.href + QStringLiteral(")")});
             } else if constexpr (std::is_same_v<T, Content::InlineImage>) {
@@ -818,11 +847,12 @@ QList<LineBox> Engine::breakIntoLines(const QList<Content::InlineNode> &inlines,
                         currentLine.alignment = format.alignment;
                         part.glyphs.clear();
                         part.width = 0;
+                        part.textStart = glyph.cluster;
                         part.textLength = 0;
                     }
                     part.glyphs.append(glyph);
                     part.width += glyph.xAdvance;
-                    part.textLength++;
+                    part.textLength = glyph.cluster - part.textStart + 1;
                 }
                 if (!part.glyphs.isEmpty()) {
                     currentLine.glyphs.append(part);
@@ -868,6 +898,7 @@ QList<LineBox> Engine::breakIntoLines(const QList<Content::InlineNode> &inlines,
 
     // Compute line metrics
     for (auto &line : lines) {
+        line.text = collected.text;
         qreal maxAscent = 0;
         qreal maxDescent = 0;
         qreal totalWidth = 0;
@@ -1030,11 +1061,11 @@ BlockBox Engine::layoutHeading(const Content::Heading &heading, qreal availWidth
         std::visit([&](const auto &n) {
             using T = std::decay_t<decltype(n)>;
             if constexpr (std::is_same_v<T, Content::TextRun>)
-                box.headingText += n.text;
+                n.text.appendTo(box.headingText);
             else if constexpr (std::is_same_v<T, Content::InlineCode>)
-                box.headingText += n.text;
+                n.text.appendTo(box.headingText);
             else if constexpr (std::is_same_v<T, Content::Link>)
-                box.headingText += n.text;
+                n.text.appendTo(box.headingText);
         }, node);
     }
 
@@ -1054,6 +1085,7 @@ BlockBox Engine::layoutCodeBlock(const Content::CodeBlock &cb, qreal availWidth)
     box.width = availWidth - 24.0; // subtract left + right margins (12pt each)
     box.padding = cb.padding;
     box.background = cb.background;
+    box.backgroundSlot = Content::ColorSlot::CodeBlockBackground;
     box.borderColor = QColor(0xe1, 0xe4, 0xe8);
     box.borderWidth = 0.5;
     box.codeLanguage = cb.language;
@@ -1066,7 +1098,7 @@ BlockBox Engine::layoutCodeBlock(const Content::CodeBlock &cb, qreal availWidth)
     // Try syntax highlighting if language is known
     if (!cb.language.isEmpty()) {
         CodeSpanCollector collector;
-        auto spans = collector.highlight(cb.code, cb.language);
+        auto spans = collector.highlight(cb.code.toString(), cb.language);
 
         if (!spans.isEmpty()) {
             // Sort spans by start position
@@ -1086,10 +1118,14 @@ BlockBox Engine::layoutCodeBlock(const Content::CodeBlock &cb, qreal availWidth)
                 Content::TextRun run;
                 run.text = cb.code.mid(span.start, span.length);
                 run.style = cb.style; // base monospace style
-                if (span.foreground.isValid())
+                if (span.foreground.isValid()) {
                     run.style.foreground = span.foreground;
-                if (span.background.isValid())
+                    run.style.foregroundSlot = Content::ColorSlot::Fixed;
+                }
+                if (span.background.isValid()) {
                     run.style.background = span.background;
+                    run.style.backgroundSlot = Content::ColorSlot::Fixed;
+                }
                 if (span.bold)
                     run.style.fontWeight = 700;
                 if (span.italic)
@@ -1201,12 +1237,16 @@ TableBox Engine::layoutTable(const Content::Table &table, qreal availWidth)
             // Resolve cell background: explicit cell bg > alternating row > body bg
             if (cell.background.isValid()) {
                 cbox.background = cell.background;
+                cbox.backgroundSlot = cell.backgroundSlot;
             } else if (!cell.isHeader) {
                 int bodyRowIdx = rowIdx - table.headerRowCount;
-                if (bodyRowIdx >= 0 && (bodyRowIdx % 2) == 1 && table.alternateRowColor.isValid())
+                if (bodyRowIdx >= 0 && (bodyRowIdx % 2) == 1 && table.alternateRowColor.isValid()) {
                     cbox.background = table.alternateRowColor;
-                else if (table.bodyBackground.isValid())
+                    cbox.backgroundSlot = Content::ColorSlot::TableAlternateRow;
+                } else if (table.bodyBackground.isValid()) {
                     cbox.background = table.bodyBackground;
+                    cbox.backgroundSlot = Content::ColorSlot::TableBodyBackground;
+                }
             }
 
             // Layout cell content
@@ -1706,6 +1746,205 @@ splitFootnoteSection(const FootnoteSectionBox &box, qreal availableHeight)
     return std::make_pair(frag1, frag2);
 }
 
+// --- Recolouring ---
+
+namespace {
+
+void applySlot(QColor &color, int slot, const QList<QColor> &colorSlots)
+{
+    if (slot >= 0 && slot < colorSlots.size())
+        color = colorSlots[slot];
+}
+
+void recolorStyle(Content::TextStyle &style, const QList<QColor> &colorSlots)
+{
+    applySlot(style.foreground, style.foregroundSlot, colorSlots);
+    applySlot(style.background, style.backgroundSlot, colorSlots);
+}
+
+void recolorLines(QList<LineBox> &lines, const QList<QColor> &colorSlots)
+{
+    for (LineBox &line : lines) {
+        for (GlyphBox &gbox : line.glyphs)
+            recolorStyle(gbox.style, colorSlots);
+    }
+}
+
+// Widest inter-word gap the legacy justification path (lines without
+// JustifyInfo) stretches to before leaving the line ragged
+constexpr qreal kMaxLegacyJustifyGap = 20.0;
+
+void resolveGlyphRun(GlyphBox &gbox)
+{
+    qreal shift = 0;
+    if (gbox.style.superscript)
+        shift = -gbox.fontSize * RenderConstants::kSuperscriptRise;
+    else if (gbox.style.subscript)
+        shift = gbox.fontSize * RenderConstants::kSubscriptDrop;
+
+    const int count = gbox.glyphs.size();
+    gbox.run.glyphIds.resize(count);
+    gbox.run.positions.resize(count);
+    qreal penX = 0;
+    for (int i = 0; i < count; ++i) {
+        const GlyphInfo &g = gbox.glyphs[i];
+        gbox.run.glyphIds[i] = g.glyphId;
+        gbox.run.positions[i] = QPointF(penX + g.xOffset, shift - g.yOffset);
+        penX += g.xAdvance;
+    }
+}
+
+void resolveLines(QList<LineBox> &lines, qreal availWidth, qreal firstLineIndent = 0)
+{
+    for (int li = 0; li < lines.size(); ++li)
+        resolveLinePositions(lines[li], li == 0 ? availWidth - firstLineIndent : availWidth);
+}
+
+void markLinesUsed(const QList<LineBox> &lines, FontManager *fontManager)
+{
+    for (const LineBox &line : lines) {
+        for (const GlyphBox &gbox : line.glyphs) {
+            if (!gbox.font)
+                continue;
+            for (const GlyphInfo &g : gbox.glyphs)
+                fontManager->markGlyphUsed(gbox.font, g.glyphId);
+        }
+    }
+}
+
+} // namespace
+
+void recolor(QList<PageElement> &elements, const QList<QColor> &colorSlots)
+{
+    using namespace Content::ColorSlot;
+
+    for (PageElement &element : elements) {
+        if (auto *block = std::get_if<BlockBox>(&element)) {
+            applySlot(block->background, block->backgroundSlot, colorSlots);
+            recolorLines(block->lines, colorSlots);
+        } else if (auto *table = std::get_if<TableBox>(&element)) {
+            // Table colours all come from the one table style
+            applySlot(table->borderColor, TableBorder, colorSlots);
+            applySlot(table->innerBorderColor, TableInnerBorder, colorSlots);
+            applySlot(table->headerBottomBorderColor, TableHeaderBottomBorder, colorSlots);
+            for (TableRowBox &row : table->rows) {
+                for (TableCellBox &cell : row.cells) {
+                    applySlot(cell.background, cell.backgroundSlot, colorSlots);
+                    recolorLines(cell.lines, colorSlots);
+                }
+            }
+        } else if (auto *section = std::get_if<FootnoteSectionBox>(&element)) {
+            for (FootnoteBox &fn : section->footnotes) {
+                recolorStyle(fn.numberStyle, colorSlots);
+                recolorLines(fn.lines, colorSlots);
+            }
+        }
+    }
+}
+
+void markGlyphsUsed(const QList<PageElement> &elements, FontManager *fontManager)
+{
+    for (const PageElement &element : elements) {
+        if (const auto *block = std::get_if<BlockBox>(&element)) {
+            markLinesUsed(block->lines, fontManager);
+        } else if (const auto *table = std::get_if<TableBox>(&element)) {
+            for (const TableRowBox &row : table->rows) {
+                for (const TableCellBox &cell : row.cells)
+                    markLinesUsed(cell.lines, fontManager);
+            }
+        } else if (const auto *section = std::get_if<FootnoteSectionBox>(&element)) {
+            for (const FootnoteBox &fn : section->footnotes)
+                markLinesUsed(fn.lines, fontManager);
+        }
+    }
+}
+
+void resolveLinePositions(LineBox &line, qreal availWidth)
+{
+    for (GlyphBox &gbox : line.glyphs)
+        resolveGlyphRun(gbox);
+
+    const int count = line.glyphs.size();
+    bool doJustify = false;
+    qreal extraPerGap = 0;
+    qreal extraPerChar = 0;
+    if (line.alignment == Qt::AlignJustify && !line.isLastLine
+        && count > 1 && line.width < availWidth) {
+        if (line.justify.wordGapCount > 0) {
+            doJustify = true;
+            extraPerGap = line.justify.extraWordSpacing;
+            extraPerChar = line.justify.extraLetterSpacing;
+        } else {
+            int gapCount = 0;
+            for (int i = 1; i < count; ++i) {
+                if (!shouldSkipJustifyGap(line.glyphs[i - 1], line.glyphs[i]))
+                    gapCount++;
+            }
+            if (gapCount > 0) {
+                extraPerGap = (availWidth - line.width) / gapCount;
+                doJustify = extraPerGap <= kMaxLegacyJustifyGap;
+            }
+        }
+    }
+
+    line.boxX.resize(count);
+    qreal x = 0;
+    if (doJustify) {
+        for (int i = 0; i < count; ++i) {
+            line.boxX[i] = x;
+            x += line.glyphs[i].width;
+            if (i < count - 1) {
+                x += extraPerChar * line.glyphs[i].glyphs.size();
+                if (!shouldSkipJustifyGap(line.glyphs[i], line.glyphs[i + 1]))
+                    x += extraPerGap;
+            }
+        }
+    } else {
+        if (line.alignment == Qt::AlignCenter)
+            x = (availWidth - line.width) / 2;
+        else if (line.alignment == Qt::AlignRight)
+            x = availWidth - line.width;
+        for (int i = 0; i < count; ++i) {
+            line.boxX[i] = x;
+            x += line.glyphs[i].width;
+        }
+    }
+    line.hyphenX = x;
+}
+
+void resolveGlyphPositions(QList<PageElement> &elements)
+{
+    // Same widths BoxTreeRenderer lays the lines out in
+    for (PageElement &element : elements) {
+        if (auto *block = std::get_if<BlockBox>(&element)) {
+            resolveLines(block->lines, block->width, block->firstLineIndent);
+        } else if (auto *table = std::get_if<TableBox>(&element)) {
+            for (TableRowBox &row : table->rows) {
+                for (TableCellBox &cell : row.cells)
+                    resolveLines(cell.lines, cell.width - table->cellPadding * 2);
+            }
+        } else if (auto *section = std::get_if<FootnoteSectionBox>(&element)) {
+            for (FootnoteBox &fn : section->footnotes)
+                resolveLines(fn.lines, section->width);
+        }
+    }
+}
+
+void shiftSourceLines(QList<PageElement> &elements, int delta)
+{
+    for (PageElement &element : elements) {
+        Content::SourceRange *source = nullptr;
+        if (auto *block = std::get_if<BlockBox>(&element))
+            source = &block->source;
+        else if (auto *table = std::get_if<TableBox>(&element))
+            source = &table->source;
+        if (source && source->startLine > 0) {
+            source->startLine += delta;
+            source->endLine += delta;
+        }
+    }
+}
+
 // --- Page assignment ---
 
 void Engine::assignToPages(const QList<PageElement> &elements,
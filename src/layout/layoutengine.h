@@ -14,6 +14,7 @@
 #include <QColor>
 #include <QImage>
 #include <QList>
+#include <QPointF>
 #include <QRectF>
 #include <QSizeF>
 #include <QString>
@@ -28,6 +29,12 @@ class TextShaper;
 struct FontFace;
 struct ShapedRun;
 
+/// Named constants for superscript/subscript positioning.
+namespace RenderConstants {
+    constexpr qreal kSuperscriptRise = 0.35;
+    constexpr qreal kSubscriptDrop = 0.15;
+}
+
 namespace Layout {
 
 // --- Box tree ---
@@ -41,6 +48,13 @@ struct GlyphInfo {
     int cluster = 0; // character index in source text
 };
 
+// Glyph IDs with their final positions relative to the box origin on the
+// baseline (y top-down), ready to hand to a renderer
+struct GlyphRun {
+    QVector<quint32> glyphIds;
+    QVector<QPointF> positions;
+};
+
 struct GlyphBox {
     enum CheckboxState { NoCheckbox, Unchecked, Checked };
 
@@ -66,6 +80,9 @@ struct GlyphBox {
     QString text;      // original text content of this glyph box
     // Task list checkbox (rendered as vector graphic, not font glyph)
     CheckboxState checkboxState = NoCheckbox;
+    // Set by resolveGlyphPositions(): shaping offsets and the
+    // superscript/subscript shift applied
+    GlyphRun run;
 };
 
 // Returns true if the justify gap between two adjacent glyph boxes should be
@@ -103,6 +120,7 @@ struct LineBox {
     qreal baseline = 0; // distance from top of line to baseline
     Qt::Alignment alignment = Qt::AlignLeft;
     bool isLastLine = false; // last line of paragraph (don't justify)
+    QString text; // collected paragraph text, shared by all its lines (GlyphBox::textStart)
     bool showTrailingHyphen = false; // render '-' at end (soft hyphen break)
 
     struct JustifyInfo {
@@ -113,6 +131,12 @@ struct LineBox {
         qreal extraLetterSpacing = 0; // pre-computed per-character expansion (points)
     };
     JustifyInfo justify;
+
+    // Set by resolveGlyphPositions(): x of each glyph box from the line
+    // origin with alignment, justification and letter spacing applied,
+    // and of the trailing hyphen
+    QList<qreal> boxX;
+    qreal hyphenX = 0;
 };
 
 struct BlockBox {
@@ -128,6 +152,7 @@ struct BlockBox {
     qreal spaceBefore = 0;
     qreal spaceAfter = 0;
     QColor background; // invalid = none
+    int backgroundSlot = Content::ColorSlot::Fixed;
 
     // Code block specifics
     qreal padding = 0;
@@ -170,6 +195,7 @@ struct TableCellBox {
     qreal width = 0;
     qreal height = 0;
     QColor background;
+    int backgroundSlot = Content::ColorSlot::Fixed;
     Qt::Alignment alignment = Qt::AlignLeft;
     bool isHeader = false;
 };
@@ -236,6 +262,25 @@ splitFootnoteSection(const FootnoteSectionBox &box, qreal availableHeight);
 // A page element can be any of the above
 using PageElement = std::variant<BlockBox, TableBox, FootnoteSectionBox>;
 
+// Set every colour that has a Content::ColorSlot to its value in
+// @p colorSlots (StyleBinder::colorSlots()).  Lets a colour-only style
+// change repaint an existing layout.
+void recolor(QList<PageElement> &elements, const QList<QColor> &colorSlots);
+
+// Re-register the glyphs of an existing layout with @p fontManager, for
+// generating a PDF from it without shaping again.
+void markGlyphsUsed(const QList<PageElement> &elements, FontManager *fontManager);
+
+// Move the source breadcrumbs of laid out elements by @p delta lines, for
+// elements reused after lines were inserted or removed above them.
+void shiftSourceLines(QList<PageElement> &elements, int delta);
+
+// Resolve the positioned glyph runs of every line (GlyphBox::run,
+// LineBox::boxX) for the width each line is rendered at, so renderers only
+// stream glyphs.  Engine::layoutBlock() does this for its output.
+void resolveGlyphPositions(QList<PageElement> &elements);
+void resolveLinePositions(LineBox &line, qreal availWidth);
+
 // Source map: maps page-local rects to markdown source line ranges
 struct SourceMapEntry {
     int pageNumber = -1;
@@ -285,7 +330,27 @@ public:
     void setHyphenateJustifiedText(bool enabled) { m_hyphenateJustifiedText = enabled; }
     void setMarkdownDecorations(bool enabled) { m_markdownDecorations = enabled; }
 
+    // The elements each top-level block of the last laid out document
+    // became, before positioning
+    using BlockElements = QList<QList<PageElement>>;
+    const BlockElements &blockElements() const { return m_blockElements; }
+
+    // Let the next layout()/layoutContinuous() take the blocks @p splice
+    // reports unchanged from @p previous (blockElements() of a layout at
+    // the same width and styles) instead of shaping them again.
+    void setReusableBlocks(const BlockElements &previous, const Content::Splice &splice);
+    // Same for a restyle: block i of @p previous is taken where @p reuse[i]
+    // is set (the style edit did not reach it)
+    void setReusableBlocks(const BlockElements &previous, const QList<bool> &reuse);
+
+    // One top-level block into unpositioned page elements, as phase 1 of
+    // both layout modes does; lets callers build BlockElements piecemeal
+    QList<PageElement> layoutBlock(const Content::BlockNode &block, qreal availWidth);
+
 private:
+    // Phase 1 of both layout modes: every block into page elements
+    QList<PageElement> layoutBlocks(const Content::Document &doc, qreal availWidth);
+
     // Block layout
     BlockBox layoutParagraph(const Content::Paragraph &para, qreal availWidth);
     BlockBox layoutHeading(const Content::Heading &heading, qreal availWidth);
@@ -343,6 +408,11 @@ private:
     TextShaper *m_textShaper;
     bool m_hyphenateJustifiedText = true;
     bool m_markdownDecorations = false;
+
+    BlockElements m_blockElements;
+    BlockElements m_reusableBlocks;
+    Content::Splice m_splice;
+    QList<bool> m_reuseMask;
 };
 
 } // namespace Layout
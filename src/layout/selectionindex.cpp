@@ -0,0 +1,229 @@
+/*
+ * selectionindex.cpp — Document-order text index of a paged layout
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "selectionindex.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace Layout {
+
+namespace {
+
+constexpr QChar kSoftHyphen(0x00AD);
+
+void appendVisible(QString &out, QStringView text)
+{
+    for (QChar ch : text) {
+        if (ch != kSoftHyphen)
+            out.append(ch);
+    }
+}
+
+} // anonymous namespace
+
+SelectionIndex::SelectionIndex(const LayoutResult &layout, const PageLayout &pageLayout)
+{
+    const QMarginsF margins = pageLayout.marginsPoints();
+    const QPointF origin(margins.left(), margins.top() + pageLayout.headerTotalHeight());
+
+    // The paragraph text the last box came from and how far it was used
+    QString flowText;
+    int flowEnd = 0;
+    // Separator before the next box if it starts a new paragraph
+    QChar pendingBreak;
+
+    // Rest of the last word of the current paragraph (ligature tails
+    // that the last glyph's cluster does not cover)
+    auto finishFlow = [&]() {
+        const int wordEnd = flowEnd;
+        while (flowEnd < flowText.size() && !flowText[flowEnd].isSpace())
+            ++flowEnd;
+        appendVisible(m_text, QStringView(flowText).mid(wordEnd, flowEnd - wordEnd));
+    };
+
+    auto addLine = [&](const LineBox &line, QPointF lineOrigin, qreal availWidth,
+                       const Content::SourceRange &source) {
+        const LineBox *positioned = &line;
+        LineBox resolved;
+        if (line.boxX.size() != line.glyphs.size()) {
+            resolved = line;
+            resolveLinePositions(resolved, availWidth);
+            positioned = &resolved;
+        }
+
+        for (int i = 0; i < line.glyphs.size(); ++i) {
+            const GlyphBox &box = line.glyphs[i];
+            const int start = box.textStart;
+            const int end = qMin<int>(box.textStart + box.textLength, line.text.size());
+            if (start < 0 || end <= start)
+                continue;
+
+            if (!line.text.isEmpty() && line.text.constData() == flowText.constData()
+                && start >= flowEnd) {
+                // Same paragraph: the text between the boxes is exact
+                appendVisible(m_text, QStringView(line.text).mid(flowEnd, start - flowEnd));
+            } else {
+                finishFlow();
+                if (!m_text.isEmpty())
+                    m_text.append(pendingBreak.isNull() ? QLatin1Char(' ') : pendingBreak);
+                flowText = line.text;
+            }
+            pendingBreak = QChar();
+
+            Span span;
+            const qreal x = positioned->boxX[i];
+            const qreal right = i + 1 < line.glyphs.size() ? positioned->boxX[i + 1] : x + box.width;
+            span.rect = QRectF(lineOrigin.x() + x, lineOrigin.y(), qMax<qreal>(right - x, 0), line.height);
+            span.start = m_text.size();
+            appendVisible(m_text, QStringView(line.text).mid(start, end - start));
+            span.end = m_text.size();
+            span.startLine = source.startLine;
+            span.endLine = source.endLine;
+            m_spans.append(span);
+            flowEnd = end;
+        }
+    };
+
+    for (const Page &page : layout.pages) {
+        while (m_pageFirstSpan.size() <= page.pageNumber)
+            m_pageFirstSpan.append(m_spans.size());
+
+        for (const PageElement &element : page.elements) {
+            if (const auto *block = std::get_if<BlockBox>(&element)) {
+                pendingBreak = QLatin1Char('\n');
+                qreal lineY = origin.y() + block->y;
+                for (int li = 0; li < block->lines.size(); ++li) {
+                    const qreal indent = li == 0 ? block->firstLineIndent : 0;
+                    addLine(block->lines[li], QPointF(origin.x() + block->x + indent, lineY),
+                            block->width - indent, block->source);
+                    lineY += block->lines[li].height;
+                }
+            } else if (const auto *table = std::get_if<TableBox>(&element)) {
+                const QPointF tableOrigin = origin + QPointF(table->x, table->y);
+                for (const auto &row : table->rows) {
+                    pendingBreak = QLatin1Char('\n');
+                    for (const auto &cell : row.cells) {
+                        if (pendingBreak.isNull())
+                            pendingBreak = QLatin1Char('\t');
+                        qreal lineY = tableOrigin.y() + cell.y + table->cellPadding;
+                        const qreal lineX = tableOrigin.x() + cell.x + table->cellPadding;
+                        for (const auto &line : cell.lines) {
+                            addLine(line, QPointF(lineX, lineY),
+                                    cell.width - table->cellPadding * 2, table->source);
+                            lineY += line.height;
+                        }
+                    }
+                }
+            } else if (const auto *section = std::get_if<FootnoteSectionBox>(&element)) {
+                for (const auto &fn : section->footnotes) {
+                    pendingBreak = QLatin1Char('\n');
+                    qreal lineY = origin.y() + section->y + fn.y;
+                    for (const auto &line : fn.lines) {
+                        addLine(line, QPointF(origin.x() + section->x, lineY), section->width,
+                                Content::SourceRange());
+                        lineY += line.height;
+                    }
+                }
+            }
+        }
+    }
+    finishFlow();
+    m_pageFirstSpan.append(m_spans.size());
+}
+
+std::pair<int, int> SelectionIndex::pageSpans(int page) const
+{
+    if (page < 0 || page + 1 >= m_pageFirstSpan.size())
+        return {0, 0};
+    return {m_pageFirstSpan[page], m_pageFirstSpan[page + 1]};
+}
+
+const SelectionIndex::Span *SelectionIndex::nearestSpan(int page, const QPointF &pos) const
+{
+    const auto [first, last] = pageSpans(page);
+    const Span *best = nullptr;
+    qreal bestDy = 0;
+    qreal bestDx = 0;
+    for (int i = first; i < last; ++i) {
+        const QRectF &r = m_spans[i].rect;
+        const qreal dy = pos.y() < r.top() ? r.top() - pos.y()
+                       : pos.y() > r.bottom() ? pos.y() - r.bottom() : 0;
+        const qreal dx = pos.x() < r.left() ? r.left() - pos.x()
+                       : pos.x() > r.right() ? pos.x() - r.right() : 0;
+        // The nearest line first, then the nearest box on it
+        if (!best || dy < bestDy || (dy == bestDy && dx < bestDx)) {
+            best = &m_spans[i];
+            bestDy = dy;
+            bestDx = dx;
+        }
+    }
+    return best;
+}
+
+int SelectionIndex::offsetAt(int page, const QPointF &pos) const
+{
+    if (const Span *span = nearestSpan(page, pos))
+        return pos.x() < span->rect.center().x() ? span->start : span->end;
+
+    // No text on this page: its first span index is the next page's
+    int next = page < 0 ? 0 : int(m_spans.size());
+    if (page >= 0 && page < m_pageFirstSpan.size())
+        next = m_pageFirstSpan[page];
+    return next < m_spans.size() ? m_spans[next].start : int(m_text.size());
+}
+
+bool SelectionIndex::wordAt(int page, const QPointF &pos, int *from, int *to) const
+{
+    const Span *span = nearestSpan(page, pos);
+    if (!span)
+        return false;
+    // Without the space the box carries
+    int end = span->end;
+    while (end > span->start && m_text[end - 1].isSpace())
+        --end;
+    *from = span->start;
+    *to = end;
+    return true;
+}
+
+QList<QRectF> SelectionIndex::rects(int page, int from, int to) const
+{
+    QList<QRectF> result;
+    const auto [first, last] = pageSpans(page);
+    for (int i = first; i < last; ++i) {
+        const Span &span = m_spans[i];
+        if (span.end <= from || span.start >= to)
+            continue;
+        if (!result.isEmpty() && qAbs(result.last().top() - span.rect.top()) < 0.5
+            && span.rect.left() >= result.last().left()) {
+            result.last() = result.last().united(span.rect);
+        } else {
+            result.append(span.rect);
+        }
+    }
+    return result;
+}
+
+bool SelectionIndex::sourceLines(int from, int to, int *minLine, int *maxLine) const
+{
+    auto it = std::partition_point(m_spans.cbegin(), m_spans.cend(),
+                                   [from](const Span &span) { return span.end <= from; });
+    int lo = INT_MAX;
+    int hi = -1;
+    for (; it != m_spans.cend() && it->start < to; ++it) {
+        if (it->startLine > 0) {
+            lo = qMin(lo, it->startLine);
+            hi = qMax(hi, it->endLine);
+        }
+    }
+    if (lo > hi)
+        return false;
+    *minLine = lo;
+    *maxLine = hi;
+    return true;
+}
+
+} // namespace Layout
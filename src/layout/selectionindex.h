@@ -0,0 +1,79 @@
+/*
+ * selectionindex.h — Document-order text index of a paged layout
+ *
+ * Flattens the glyph boxes of a LayoutResult into one reading-order text
+ * with a span (page, rect, text range) per box, so a text selection is a
+ * pair of offsets: the endpoints resolve against the spans of their own
+ * page, and the selected text is a slice of text().  The gaps between
+ * boxes come from the paragraph text the boxes were shaped from
+ * (LineBox::text), so spaces, ligature tails and hard line breaks survive;
+ * soft hyphens are dropped.  Blocks and footnotes are separated by '\n',
+ * table cells by '\t'.
+ *
+ * Endpoints resolve to word boundaries (glyph box edges).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_SELECTIONINDEX_H
+#define PRETTYREADER_SELECTIONINDEX_H
+
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+
+#include <utility>
+
+#include "layoutengine.h"
+
+namespace Layout {
+
+class SelectionIndex
+{
+public:
+    SelectionIndex() = default;
+    // Page-local coordinates include the page margins and header
+    SelectionIndex(const LayoutResult &layout, const PageLayout &pageLayout);
+
+    bool isEmpty() const { return m_spans.isEmpty(); }
+    const QString &text() const { return m_text; }
+    QString text(int from, int to) const { return m_text.mid(from, to - from); }
+
+    // Offset at the edge of the word nearest to @p pos (page-local points)
+    // on page @p page; pages without text resolve to where the next
+    // page's text starts.
+    int offsetAt(int page, const QPointF &pos) const;
+
+    // Text range of the word nearest to @p pos; false if the page has no
+    // text.
+    bool wordAt(int page, const QPointF &pos, int *from, int *to) const;
+
+    // Highlight rects of [@p from, @p to) on page @p page, one per line
+    QList<QRectF> rects(int page, int from, int to) const;
+
+    // Markdown source lines of the blocks [@p from, @p to) touches; false
+    // if it touches none with a source range
+    bool sourceLines(int from, int to, int *minLine, int *maxLine) const;
+
+private:
+    struct Span {
+        QRectF rect;  // page-local, reaching to the next box on the line
+        int start = 0;
+        int end = 0;
+        int startLine = -1;
+        int endLine = -1;
+    };
+
+    // Spans of page @p page as [first, last) indexes
+    std::pair<int, int> pageSpans(int page) const;
+    const Span *nearestSpan(int page, const QPointF &pos) const;
+
+    QString m_text;
+    QList<Span> m_spans;
+    QList<int> m_pageFirstSpan; // by page number, plus one past the last page
+};
+
+} // namespace Layout
+
+#endif // PRETTYREADER_SELECTIONINDEX_H
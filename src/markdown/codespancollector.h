@@ -13,8 +13,10 @@
 #define PRETTYREADER_CODESPANCOLLECTOR_H
 
 #include <QColor>
+#include <QCoreApplication>
 #include <QList>
 #include <QString>
+#include <QThread>
 
 #include <KSyntaxHighlighting/AbstractHighlighter>
 #include <KSyntaxHighlighting/Definition>
@@ -38,12 +40,30 @@ public:
 
     CodeSpanCollector()
     {
-        static KSyntaxHighlighting::Repository repo;
-        m_repo = &repo;
-        auto defaultTheme = repo.defaultTheme(KSyntaxHighlighting::Repository::LightTheme);
+        m_repo = &repositoryForThread();
+        auto defaultTheme = m_repo->defaultTheme(KSyntaxHighlighting::Repository::LightTheme);
         setTheme(defaultTheme);
     }
 
+    // Process-wide repository; constructing it scans every syntax
+    // definition, so StartupWarmup touches it off the GUI thread.
+    static KSyntaxHighlighting::Repository &sharedRepository()
+    {
+        static KSyntaxHighlighting::Repository repo;
+        return repo;
+    }
+
+    // Repositories are not thread-safe: the GUI thread uses the shared
+    // one, worker threads (batch export) get one each.
+    static KSyntaxHighlighting::Repository &repositoryForThread()
+    {
+        QCoreApplication *app = QCoreApplication::instance();
+        if (!app || QThread::currentThread() == app->thread())
+            return sharedRepository();
+        thread_local KSyntaxHighlighting::Repository repo;
+        return repo;
+    }
+
     QList<Span> highlight(const QString &code, const QString &language)
     {
         m_spans.clear();
@@ -50,6 +50,7 @@ bool DocumentBuilder::build(const QString &markdownText)
     m_altText.clear();
     m_codeLanguage.clear();
     m_footnotes.clear();
+    m_footnoteIndex.clear();
     m_footnoteCounter = 0;
 
     // Extract footnotes before parsing using the full footnote parser
@@ -61,6 +62,8 @@ bool DocumentBuilder::build(const QString &markdownText)
         footnote.label = fn.label;
         footnote.text = fn.content;
         m_footnotes.append(footnote);
+        if (!m_footnoteIndex.contains(fn.label))
+            m_footnoteIndex.insert(fn.label, m_footnotes.size() - 1);
     }
 
     // Set the document default font from the resolved root paragraph style.
@@ -788,13 +791,7 @@ int DocumentBuilder::onText(MD_TEXTTYPE type, const MD_CHAR *text,
 
                 // Find the footnote index
                 QString label = match.captured(1);
-                int fnIndex = -1;
-                for (int i = 0; i < m_footnotes.size(); ++i) {
-                    if (m_footnotes[i].label == label) {
-                        fnIndex = i;
-                        break;
-                    }
-                }
+                const int fnIndex = m_footnoteIndex.value(label, -1);
 
                 if (fnIndex >= 0) {
                     int number = m_footnoteStyle.startNumber + fnIndex;
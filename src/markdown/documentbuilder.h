@@ -1,6 +1,7 @@
 #ifndef PRETTYREADER_DOCUMENTBUILDER_H
 #define PRETTYREADER_DOCUMENTBUILDER_H
 
+#include <QHash>
 #include <QObject>
 #include <QStack>
 #include <QTextCursor>
@@ -115,6 +116,7 @@ private:
         QString text;
     };
     QList<Footnote> m_footnotes;
+    QHash<QString, int> m_footnoteIndex; // label -> m_footnotes index
     int m_footnoteCounter = 0;
     FootnoteStyle m_footnoteStyle;
 };
@@ -1,172 +1,207 @@
 #include "footnoteparser.h"
 
 #include <QHash>
-#include <QRegularExpression>
+
+namespace {
+
+// Bytes @p text takes in UTF-8
+qsizetype utf8Length(QStringView text)
+{
+    qsizetype bytes = 0;
+    for (QChar c : text) {
+        const char16_t u = c.unicode();
+        if (u < 0x80)
+            bytes += 1;
+        else if (u < 0x800 || c.isSurrogate()) // a surrogate pair is 4
+            bytes += 2;
+        else
+            bytes += 3;
+    }
+    return bytes;
+}
+
+// "[^label]: content" at the start of a line
+bool parseDefinition(QStringView line, QString *label, QString *content)
+{
+    if (!line.startsWith(u"[^"))
+        return false;
+    const qsizetype close = line.indexOf(u']', 2);
+    if (close <= 2 || close + 1 >= line.size() || line[close + 1] != u':')
+        return false;
+    // At least one blank, then something
+    const QStringView rest = line.sliced(close + 2);
+    if (rest.size() < 2 || (rest[0] != u' ' && rest[0] != u'\t'))
+        return false;
+    *label = line.sliced(2, close - 2).toString();
+    *content = rest.trimmed().toString();
+    return true;
+}
+
+bool isBlank(QStringView line)
+{
+    return line.trimmed().isEmpty();
+}
+
+} // namespace
 
 QString FootnoteParser::process(const QString &markdownText)
 {
-    m_rawDefs.clear();
     m_footnotes.clear();
+    m_references.clear();
+    m_labelIndex.clear();
 
-    // Step 1: Extract all footnote definitions
-    extractDefinitions(markdownText);
-
-    if (m_rawDefs.isEmpty())
+    // Most documents have no footnotes at all
+    if (!markdownText.contains(QLatin1String("[^")))
         return markdownText;
 
-    // Step 2: Remove definitions from the text.
-    // A definition starts with [^label]: at the beginning of a line
-    // and continues with indented (4 spaces or 1 tab) continuation lines,
-    // separated by blank lines that are followed by indented content.
-    static const QRegularExpression defBlockRx(
-        QStringLiteral(R"((?:^|\n)\[\^([^\]]+)\]:[ \t]+[^\n]*(?:\n(?:[ \t]+[^\n]*|\s*))*)")
-    );
-
-    QString cleaned = markdownText;
-
-    // Remove definitions from bottom to top to preserve offsets
-    QList<QPair<int, int>> removeRanges;
-    auto it = defBlockRx.globalMatch(cleaned);
-    while (it.hasNext()) {
-        auto match = it.next();
-        int start = match.capturedStart();
-        int len = match.capturedLength();
-        // Skip the leading newline if we captured one
-        if (start > 0 && cleaned[start] == QLatin1Char('\n')) {
-            start++;
-            len--;
+    const QStringView text(markdownText);
+    QList<RawDefinition> defs;
+    QList<RawReference> refs;
+
+    // The cleaned text is the source minus definition blocks.  It is only
+    // built once a definition turns up, by copying the spans in between.
+    QString cleaned;
+    qsizetype copyFrom = 0;
+
+    // UTF-8 size of the cleaned text up to source position countedTo;
+    // only counted as far as the last reference needs
+    qsizetype countedTo = 0;
+    qsizetype utf8Pos = 0;
+    auto advanceTo = [&](qsizetype pos) {
+        utf8Pos += utf8Length(text.sliced(countedTo, pos - countedTo));
+        countedTo = pos;
+    };
+
+    auto scanReferences = [&](QStringView line, qsizetype lineStart, bool kept) {
+        qsizetype from = 0;
+        while ((from = line.indexOf(u"[^", from)) >= 0) {
+            const qsizetype close = line.indexOf(u']', from + 2);
+            if (close < 0)
+                break;
+            if (close == from + 2) {
+                ++from;
+                continue;
+            }
+            // "[^label]:" is definition syntax, not a reference
+            if (close + 1 < line.size() && line[close + 1] == u':') {
+                from = close + 1;
+                continue;
+            }
+            RawReference ref{line.sliced(from + 2, close - from - 2).toString(), -1, 0};
+            if (kept) {
+                advanceTo(lineStart + from);
+                ref.utf8Offset = utf8Pos;
+                ref.utf8Length = static_cast<int>(utf8Length(line.sliced(from, close + 1 - from)));
+            }
+            refs.append(ref);
+            from = close + 1;
+        }
+    };
+
+    auto lineAt = [&text](qsizetype pos) {
+        qsizetype eol = text.indexOf(u'\n', pos);
+        if (eol < 0)
+            eol = text.size();
+        return text.sliced(pos, eol - pos);
+    };
+
+    qsizetype pos = 0;
+    while (pos < text.size()) {
+        const QStringView line = lineAt(pos);
+        RawDefinition def;
+        if (!parseDefinition(line, &def.label, &def.content)) {
+            if (line.contains(u"[^"))
+                scanReferences(line, pos, true);
+            pos += line.size() + 1;
+            continue;
         }
-        removeRanges.append({start, len});
-    }
 
-    // Remove in reverse order
-    for (int i = removeRanges.size() - 1; i >= 0; --i) {
-        cleaned.remove(removeRanges[i].first, removeRanges[i].second);
-    }
+        // References inside notes still count for numbering
+        scanReferences(line.sliced(def.label.size() + 4), -1, false);
+        const qsizetype defStart = pos;
+        pos += line.size() + 1;
+
+        // Continuation lines are indented by 4 spaces or a tab; blank
+        // lines separate paragraphs within the note and go with it
+        bool inBlankRun = false;
+        while (pos < text.size()) {
+            const QStringView next = lineAt(pos);
+            if (isBlank(next)) {
+                inBlankRun = true;
+            } else if (next.startsWith(u"    ") || next.startsWith(u'\t')) {
+                def.content += inBlankRun ? QLatin1String("\n\n") : QLatin1String(" ");
+                inBlankRun = false;
+                const QStringView body = next.sliced(next.startsWith(u'\t') ? 1 : 4).trimmed();
+                def.content += body;
+                scanReferences(body, -1, false);
+            } else {
+                break;
+            }
+            pos += next.size() + 1;
+        }
 
-    // Clean up excessive blank lines left by removal
-    static const QRegularExpression excessBlanks(QStringLiteral(R"(\n{3,})"));
-    cleaned.replace(excessBlanks, QStringLiteral("\n\n"));
+        const qsizetype defEnd = qMin(pos, text.size());
+        if (cleaned.isEmpty())
+            cleaned.reserve(text.size());
+        cleaned += text.sliced(copyFrom, defStart - copyFrom);
+        copyFrom = defEnd;
+        if (countedTo < defStart)
+            advanceTo(defStart);
+        countedTo = defEnd;
+        defs.append(def);
+    }
 
-    // Step 3: Order footnotes by first reference appearance
-    orderByReference(markdownText);
+    orderByReference(defs, refs);
 
+    if (defs.isEmpty())
+        return markdownText;
+    cleaned += text.sliced(copyFrom);
     return cleaned;
 }
 
-void FootnoteParser::extractDefinitions(const QString &text)
+int FootnoteParser::indexOf(const QString &label) const
 {
-    // Match footnote definition: [^label]: content
-    // Continuation lines are indented by 4 spaces or a tab.
-    // Multiple paragraphs are separated by blank lines followed by indented content.
-    static const QRegularExpression defRx(
-        QStringLiteral(R"(^\[\^([^\]]+)\]:[ \t]+(.+))"),
-        QRegularExpression::MultilineOption);
-
-    QStringList lines = text.split(QLatin1Char('\n'));
-    int i = 0;
-    int defOrder = 0;
-
-    while (i < lines.size()) {
-        QRegularExpressionMatch match = defRx.match(lines[i]);
-        if (match.hasMatch()) {
-            RawDefinition def;
-            def.label = match.captured(1);
-            def.content = match.captured(2).trimmed();
-            def.sourceOrder = defOrder++;
-
-            // Collect continuation lines (indented by 4 spaces or tab)
-            ++i;
-            bool inBlankRun = false;
-            while (i < lines.size()) {
-                const QString &line = lines[i];
-                if (line.trimmed().isEmpty()) {
-                    // Blank line - might be paragraph separator within footnote
-                    inBlankRun = true;
-                    ++i;
-                    continue;
-                }
-                if (line.startsWith(QLatin1String("    "))
-                    || line.startsWith(QLatin1Char('\t'))) {
-                    // Continuation line
-                    if (inBlankRun) {
-                        def.content += QLatin1String("\n\n");
-                        inBlankRun = false;
-                    } else {
-                        def.content += QLatin1Char(' ');
-                    }
-                    def.content += line.mid(line.startsWith(QLatin1Char('\t')) ? 1 : 4).trimmed();
-                    ++i;
-                } else {
-                    // Not a continuation - end of this definition
-                    break;
-                }
-            }
-
-            m_rawDefs.append(def);
-        } else {
-            ++i;
-        }
-    }
+    return m_labelIndex.value(label, -1);
 }
 
-void FootnoteParser::orderByReference(const QString &text)
+void FootnoteParser::orderByReference(const QList<RawDefinition> &defs,
+                                      const QList<RawReference> &refs)
 {
-    // Find all [^label] references in order of appearance
-    static const QRegularExpression refRx(
-        QStringLiteral(R"(\[\^([^\]]+)\])"));
-
-    // Build a label -> raw definition map
-    QHash<QString, RawDefinition> defMap;
-    for (const auto &def : m_rawDefs)
-        defMap.insert(def.label, def);
-
-    // Scan references and assign sequential numbers
-    QHash<QString, int> assignedNumbers;
-    int nextNumber = 1;
-
-    auto it = refRx.globalMatch(text);
-    while (it.hasNext()) {
-        auto match = it.next();
-        QString label = match.captured(1);
-
-        // Skip if this is actually a definition line (has ]: after it)
-        int afterEnd = match.capturedEnd();
-        if (afterEnd < text.length() && text[afterEnd] == QLatin1Char(':'))
+    // Label -> definition; a repeated label takes the last one
+    QHash<QString, int> defIndex;
+    defIndex.reserve(defs.size());
+    for (int i = 0; i < defs.size(); ++i)
+        defIndex.insert(defs[i].label, i);
+
+    // Number notes in order of first reference
+    m_footnotes.reserve(defs.size());
+    for (const RawReference &ref : refs) {
+        if (m_labelIndex.contains(ref.label))
             continue;
-
-        if (!assignedNumbers.contains(label) && defMap.contains(label)) {
-            assignedNumbers.insert(label, nextNumber++);
-        }
+        const auto def = defIndex.constFind(ref.label);
+        if (def == defIndex.constEnd())
+            continue;
+        m_labelIndex.insert(ref.label, m_footnotes.size());
+        m_footnotes.append({ref.label, static_cast<int>(m_footnotes.size()) + 1,
+                            defs[*def].content});
     }
 
-    // Build the ordered footnotes list
-    m_footnotes.clear();
-    m_footnotes.reserve(assignedNumbers.size());
-
-    // Create a sorted list by assigned number
-    QList<QPair<int, QString>> ordered;
-    for (auto it = assignedNumbers.constBegin(); it != assignedNumbers.constEnd(); ++it)
-        ordered.append({it.value(), it.key()});
-    std::sort(ordered.begin(), ordered.end());
-
-    for (const auto &pair : ordered) {
-        const RawDefinition &raw = defMap.value(pair.second);
-        FootnoteDefinition fn;
-        fn.label = raw.label;
-        fn.sequentialNumber = pair.first;
-        fn.content = raw.content;
-        m_footnotes.append(fn);
+    // Add any definitions that were never referenced (at the end)
+    for (const RawDefinition &def : defs) {
+        if (m_labelIndex.contains(def.label))
+            continue;
+        m_footnotes.append({def.label, static_cast<int>(m_footnotes.size()) + 1, def.content});
+    }
+    for (int i = 0; i < m_footnotes.size(); ++i) {
+        if (!m_labelIndex.contains(m_footnotes[i].label))
+            m_labelIndex.insert(m_footnotes[i].label, i);
     }
 
-    // Add any definitions that were never referenced (at the end)
-    for (const auto &def : m_rawDefs) {
-        if (!assignedNumbers.contains(def.label)) {
-            FootnoteDefinition fn;
-            fn.label = def.label;
-            fn.sequentialNumber = nextNumber++;
-            fn.content = def.content;
-            m_footnotes.append(fn);
-        }
+    for (const RawReference &ref : refs) {
+        if (ref.utf8Offset < 0)
+            continue;
+        const int index = m_labelIndex.value(ref.label, -1);
+        if (index >= 0)
+            m_references.append({ref.utf8Offset, ref.utf8Length, index});
     }
 }
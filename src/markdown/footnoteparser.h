@@ -1,9 +1,10 @@
 #ifndef PRETTYREADER_FOOTNOTEPARSER_H
 #define PRETTYREADER_FOOTNOTEPARSER_H
 
+#include <QHash>
 #include <QList>
 #include <QString>
-#include <QStringList>
+#include <QStringView>
 
 // Extracts footnote definitions and references from markdown text
 // before it is passed to MD4C (which does not support footnotes).
@@ -14,6 +15,9 @@
 //                    Continuation lines indented 4 spaces.
 //
 //                    Additional paragraphs also indented.
+//
+// One pass over the lines finds both; the text is only copied when it
+// has definitions to drop.
 
 struct FootnoteDefinition {
     QString label;         // Original label (e.g., "1", "note")
@@ -21,35 +25,57 @@ struct FootnoteDefinition {
     QString content;       // Full content (may be multi-paragraph)
 };
 
+// A [^label] in the processed text whose label has a definition.
+// Positions are byte offsets into the text's UTF-8 encoding, which is
+// what MD4C reports text callbacks against.
+struct FootnoteReference {
+    qsizetype utf8Offset = 0;
+    int utf8Length = 0;  // "[^" through "]"
+    int index = -1;      // into FootnoteParser::footnotes()
+};
+
 class FootnoteParser
 {
 public:
     FootnoteParser() = default;
 
-    // Parse markdown text: extract footnote definitions and rewrite references.
+    // Parse markdown text: extract footnote definitions and locate references.
     // Returns the cleaned markdown with:
     //  - Footnote definitions removed
-    //  - [^label] references left intact (DocumentBuilder handles rendering)
-    // Populates the footnotes() list.
+    //  - [^label] references left intact (see references())
+    // Populates the footnotes() and references() lists.
     QString process(const QString &markdownText);
 
     // Get parsed footnotes in order of first reference
     const QList<FootnoteDefinition> &footnotes() const { return m_footnotes; }
 
-private:
-    void extractDefinitions(const QString &text);
-    void orderByReference(const QString &text);
+    // References outside definitions, in text order
+    const QList<FootnoteReference> &references() const { return m_references; }
+
+    // Index into footnotes() of the note labelled @p label, or -1
+    int indexOf(const QString &label) const;
 
-    // Raw definitions keyed by label
+private:
+    // Raw definitions in source order
     struct RawDefinition {
         QString label;
         QString content;
-        int sourceOrder;  // position in source text
     };
-    QList<RawDefinition> m_rawDefs;
+
+    // A [^label] seen while scanning, before labels are numbered
+    struct RawReference {
+        QString label;
+        qsizetype utf8Offset;  // -1 inside a definition
+        int utf8Length;
+    };
+
+    void orderByReference(const QList<RawDefinition> &defs,
+                          const QList<RawReference> &refs);
 
     // Final ordered footnotes
     QList<FootnoteDefinition> m_footnotes;
+    QList<FootnoteReference> m_references;
+    QHash<QString, int> m_labelIndex;
 };
 
 #endif // PRETTYREADER_FOOTNOTEPARSER_H
@@ -4,95 +4,419 @@
  */
 
 #include "contentbuilder.h"
-#include "stylemanager.h"
-#include "paragraphstyle.h"
-#include "characterstyle.h"
-#include "fontfeatures.h"
-#include "tablestyle.h"
+#include "allocprofiler.h"
+#include "stylebinder.h"
 #include "hyphenator.h"
 #include "shortwords.h"
-#include "footnoteparser.h"
+#include "utf16.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 #include <QBuffer>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
 #include <QImage>
 #include <QRegularExpression>
+#include <QSet>
+#include <QThread>
 
-ContentBuilder::ContentBuilder(QObject *parent)
-    : QObject(parent)
+namespace {
+
+// Documents below this size are parsed on the calling thread
+constexpr qsizetype kParallelParseThreshold = 1024 * 1024;
+constexpr qsizetype kMinChunkBytes = 256 * 1024;
+
+// Source lines of a top-level block; block quotes span their children.
+// Blocks without text (rules, empty code blocks) have none.
+Content::SourceRange blockRange(const Content::BlockNode &block)
 {
+    return std::visit([](const auto &b) -> Content::SourceRange {
+        using T = std::decay_t<decltype(b)>;
+        if constexpr (std::is_same_v<T, Content::BlockQuote>) {
+            Content::SourceRange range;
+            for (const auto &child : b.children) {
+                const Content::SourceRange r = blockRange(child);
+                if (r.startLine < 0)
+                    continue;
+                if (range.startLine < 0)
+                    range.startLine = r.startLine;
+                range.endLine = r.endLine;
+            }
+            return range;
+        } else if constexpr (std::is_same_v<T, Content::FootnoteSection>) {
+            return {};
+        } else {
+            return b.source;
+        }
+    }, block);
 }
 
-// --- Style resolution helpers ---
+void shiftRange(Content::SourceRange &range, int delta)
+{
+    if (range.startLine > 0) {
+        range.startLine += delta;
+        range.endLine += delta;
+    }
+}
 
-Content::TextStyle ContentBuilder::defaultTextStyle() const
+void shiftSourceLines(Content::BlockNode &block, int delta)
 {
-    Content::TextStyle s;
-    s.fontFamily = QStringLiteral("Noto Serif");
-    s.fontSize = 11.0;
-    s.fontWeight = 400;
-    s.italic = false;
-    s.foreground = QColor(0x1a, 0x1a, 0x1a);
-    return s;
+    std::visit([delta](auto &b) {
+        using T = std::decay_t<decltype(b)>;
+        if constexpr (std::is_same_v<T, Content::BlockQuote>) {
+            for (auto &child : b.children)
+                shiftSourceLines(child, delta);
+        } else if constexpr (std::is_same_v<T, Content::List>) {
+            shiftRange(b.source, delta);
+            for (auto &item : b.items) {
+                for (auto &child : item.children)
+                    shiftSourceLines(child, delta);
+            }
+        } else if constexpr (!std::is_same_v<T, Content::FootnoteSection>) {
+            shiftRange(b.source, delta);
+        }
+    }, block);
 }
 
-Content::TextStyle ContentBuilder::resolveTextStyle(const QString &paraStyleName) const
+void remapStyleRefs(QList<Content::InlineNode> &inlines, const QList<int> &map)
 {
-    Content::TextStyle s = defaultTextStyle();
-    if (!m_styleManager)
-        return s;
-    ParagraphStyle ps = m_styleManager->resolvedParagraphStyle(paraStyleName);
-    if (ps.hasFontFamily()) s.fontFamily = ps.fontFamily();
-    if (ps.hasFontSize()) s.fontSize = ps.fontSize();
-    if (ps.hasFontWeight()) s.fontWeight = static_cast<int>(ps.fontWeight());
-    if (ps.hasFontItalic()) s.italic = ps.fontItalic();
-    if (ps.hasForeground()) s.foreground = ps.foreground();
-    if (ps.hasFontFeatures()) {
-        s.fontFeatures = FontFeatures::toStringList(ps.fontFeatures());
+    for (auto &node : inlines) {
+        std::visit([&map](auto &n) {
+            using T = std::decay_t<decltype(n)>;
+            if constexpr (std::is_same_v<T, Content::TextRun> || std::is_same_v<T, Content::InlineCode>
+                          || std::is_same_v<T, Content::Link> || std::is_same_v<T, Content::FootnoteRef>) {
+                if (n.styleRef >= 0)
+                    n.styleRef = map.value(n.styleRef, -1);
+            }
+        }, node);
     }
-    return s;
 }
 
-Content::TextStyle ContentBuilder::resolveCharStyle(const QString &charStyleName) const
+void remapStyleRefs(Content::BlockNode &block, const QList<int> &map)
 {
-    Content::TextStyle s = m_currentStyle; // inherit from current
-    if (!m_styleManager)
-        return s;
-    CharacterStyle cs = m_styleManager->resolvedCharacterStyle(charStyleName);
-    if (cs.hasFontFamily()) s.fontFamily = cs.fontFamily();
-    if (cs.hasFontSize()) s.fontSize = cs.fontSize();
-    if (cs.hasFontWeight()) s.fontWeight = static_cast<int>(cs.fontWeight());
-    if (cs.hasFontItalic()) s.italic = cs.fontItalic();
-    if (cs.hasFontUnderline()) s.underline = cs.fontUnderline();
-    if (cs.hasFontStrikeOut()) s.strikethrough = cs.fontStrikeOut();
-    if (cs.hasForeground()) s.foreground = cs.foreground();
-    if (cs.hasBackground()) s.background = cs.background();
-    if (cs.hasLetterSpacing()) s.letterSpacing = cs.letterSpacing();
-    if (cs.hasFontFeatures()) {
-        s.fontFeatures = FontFeatures::toStringList(cs.fontFeatures());
+    std::visit([&map](auto &b) {
+        using T = std::decay_t<decltype(b)>;
+        if constexpr (std::is_same_v<T, Content::Paragraph> || std::is_same_v<T, Content::Heading>) {
+            remapStyleRefs(b.inlines, map);
+        } else if constexpr (std::is_same_v<T, Content::BlockQuote>) {
+            for (auto &child : b.children)
+                remapStyleRefs(child, map);
+        } else if constexpr (std::is_same_v<T, Content::List>) {
+            for (auto &item : b.items) {
+                for (auto &child : item.children)
+                    remapStyleRefs(child, map);
+            }
+        } else if constexpr (std::is_same_v<T, Content::Table>) {
+            for (auto &row : b.rows) {
+                for (auto &cell : row.cells)
+                    remapStyleRefs(cell.inlines, map);
+            }
+        } else if constexpr (std::is_same_v<T, Content::FootnoteSection>) {
+            if (b.styleRef >= 0)
+                b.styleRef = map.value(b.styleRef, -1);
+            for (auto &fn : b.footnotes)
+                remapStyleRefs(fn.content, map);
+        }
+    }, block);
+}
+
+// Same kind of block over the same lines, @p shift lines further down
+bool sameExtent(const Content::BlockNode &before, const Content::BlockNode &after, int shift)
+{
+    const Content::SourceRange a = blockRange(before);
+    const Content::SourceRange b = blockRange(after);
+    return before.index() == after.index()
+        && a.startLine + shift == b.startLine && a.endLine + shift == b.endLine;
+}
+
+// Fold @p partSteps into @p steps (indexed by @p stepIndex); returns the
+// new index of each part step, for remapStyleRefs()
+QList<int> mergeStyleSteps(QList<Content::StyleStep> &steps,
+                           QHash<Content::StyleStep, int> &stepIndex,
+                           const QList<Content::StyleStep> &partSteps)
+{
+    QList<int> stepMap;
+    stepMap.reserve(partSteps.size());
+    for (Content::StyleStep step : partSteps) {
+        if (step.parent >= 0)
+            step.parent = stepMap.at(step.parent);
+        auto it = stepIndex.constFind(step);
+        if (it == stepIndex.constEnd()) {
+            it = stepIndex.insert(step, steps.size());
+            steps.append(step);
+        }
+        stepMap.append(it.value());
+    }
+    return stepMap;
+}
+
+bool isBlankLine(const char *line, qsizetype length)
+{
+    for (qsizetype i = 0; i < length; ++i) {
+        if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+            return false;
+    }
+    return true;
+}
+
+bool startsWithNoCase(const char *line, qsizetype length, const char *prefix)
+{
+    const qsizetype n = qstrlen(prefix);
+    return length >= n && qstrnicmp(line, prefix, n) == 0;
+}
+
+// Title of a reference definition: quoted or parenthesized, alone on
+// the rest of its line.  @p open is set when the title does not close on
+// the line, as md4c would then look for the end on the following lines.
+bool isLinkTitle(QStringView text, bool *open)
+{
+    *open = false;
+    if (text.isEmpty())
+        return false;
+    const QChar closer = text[0] == u'(' ? QChar(u')') : text[0];
+    if (closer != u'"' && closer != u'\'' && closer != u')')
+        return false;
+    for (qsizetype i = 1; i < text.size(); ++i) {
+        if (text[i] == u'\\') {
+            ++i;
+        } else if (text[i] == closer) {
+            return i == text.size() - 1;
+        }
+    }
+    *open = true;
+    return false;
+}
+
+// End of the reference definition whose label line starts at @p pos: the
+// destination may be on the next line, and the title on the line after
+// the destination.  -1 unless the definition is certain to end there (an
+// unterminated title, an unusual destination), and then the caller does
+// not cut the document at all.  @p label receives the normalized label.
+qsizetype definitionEnd(const QByteArray &utf8, qsizetype pos, QString *label)
+{
+    static const QRegularExpression definitionRx(
+        QStringLiteral(R"(^ {0,3}\[([^\]^][^\]]*)\]:[ \t]*(.*)$)"));
+
+    auto lineEnd = [&utf8](qsizetype from) {
+        const qsizetype nl = utf8.indexOf('\n', from);
+        return nl < 0 ? utf8.size() : nl;
+    };
+    auto lineAt = [&utf8](qsizetype from, qsizetype end) {
+        return QString::fromUtf8(utf8.constData() + from, end - from).trimmed();
+    };
+
+    qsizetype end = lineEnd(pos);
+    const QRegularExpressionMatch match = definitionRx.match(
+        QString::fromUtf8(utf8.constData() + pos, end - pos));
+    if (!match.hasMatch())
+        return -1;
+    *label = match.captured(1).simplified().toCaseFolded();
+
+    QString rest = match.captured(2).trimmed();
+    if (rest.isEmpty()) {
+        if (end >= utf8.size())
+            return -1;
+        pos = end + 1;
+        end = lineEnd(pos);
+        rest = lineAt(pos, end);
+        if (rest.isEmpty())
+            return -1;
+    }
+
+    qsizetype destinationLength = 0;
+    if (rest.startsWith(u'<')) {
+        destinationLength = rest.indexOf(u'>') + 1;
+        if (destinationLength == 0)
+            return -1;
+    } else {
+        while (destinationLength < rest.size() && !rest[destinationLength].isSpace())
+            ++destinationLength;
+    }
+    const QString tail = rest.mid(destinationLength).trimmed();
+    bool open = false;
+    if (!tail.isEmpty())
+        return isLinkTitle(tail, &open) ? qMin(end + 1, utf8.size()) : -1;
+
+    // A title on the next line belongs to the definition; any other line
+    // (including one that only starts like a title) begins a new block
+    if (end < utf8.size()) {
+        const qsizetype next = end + 1;
+        const qsizetype nextEnd = lineEnd(next);
+        if (isLinkTitle(lineAt(next, nextEnd), &open))
+            end = nextEnd;
+        else if (open)
+            return -1;
+    }
+    return qMin(end + 1, utf8.size());
+}
+
+// Where @p utf8 may be cut into about @p chunkCount pieces that md4c
+// parses to the same blocks as the whole: the start of a line that
+// follows a blank line outside a fenced code block or a multi-line HTML
+// block, is not indented and starts with a letter or '#' (so it cannot
+// continue a list, quote, table or indented code).
+//
+// Reference definitions, continuation lines included, are collected into
+// @p definitions for parseChunks() to hand to every piece.  Only those
+// that plainly start a block (after a blank line, a heading, a closing
+// fence or another definition) are; anything else that may be one (in a
+// list or quote, after a line of unknown kind, a label reused) leaves
+// the document uncut, as does a fence or HTML block still open at the
+// end, which would swallow the definitions.  Empty when no cut was found.
+QList<qsizetype> chunkStarts(const QByteArray &utf8, int chunkCount, QByteArray *definitions)
+{
+    // Anything that may be a definition label, in any container
+    static const QRegularExpression candidateRx(QStringLiteral(
+        R"(^[ \t>]*(?:(?:[-*+]|\d{1,9}[.)])[ \t]+[ \t>]*)*\[(?:[^\]^][^\]]*\]:|[^\]]*$))"));
+
+    const char *data = utf8.constData();
+    const qsizetype size = utf8.size();
+    QList<qsizetype> starts{0};
+    QSet<QString> labels;
+
+    char fenceChar = 0;
+    qsizetype fenceLength = 0;
+    const char *htmlEnd = nullptr;
+    bool afterBlank = true;
+    bool blockStart = true; // the line cannot continue a paragraph
+    qsizetype pos = 0;
+    while (pos < size) {
+        const char *nl = static_cast<const char *>(memchr(data + pos, '\n', size - pos));
+        const qsizetype lineEnd = nl ? nl - data : size;
+        const char *line = data + pos;
+        const qsizetype length = lineEnd - pos;
+
+        // Up to three spaces of indentation still open fences and HTML
+        qsizetype indent = 0;
+        while (indent < length && indent < 4 && line[indent] == ' ')
+            ++indent;
+        const char *text = line + indent;
+        const qsizetype textLength = length - indent;
+
+        if (fenceChar) {
+            qsizetype run = 0;
+            while (indent < 4 && run < textLength && text[run] == fenceChar)
+                ++run;
+            if (run >= fenceLength && isBlankLine(text + run, textLength - run)) {
+                fenceChar = 0;
+                afterBlank = false;
+                blockStart = true;
+                pos = lineEnd + 1;
+                continue;
+            }
+        } else if (htmlEnd) {
+            if (QByteArrayView(line, length).contains(htmlEnd))
+                htmlEnd = nullptr;
+        } else if (isBlankLine(line, length)) {
+            afterBlank = true;
+            blockStart = true;
+            pos = lineEnd + 1;
+            continue;
+        } else {
+            // Past the last cut the scan goes on for the definitions
+            const qsizetype target = size * starts.size() / chunkCount;
+            if (starts.size() < chunkCount && afterBlank && indent == 0 && pos >= target
+                && pos - starts.last() >= kMinChunkBytes
+                && (isalpha(uchar(line[0])) || line[0] == '#' || uchar(line[0]) >= 0x80)) {
+                starts.append(pos);
+            }
+
+            if (QByteArrayView(line, length).contains('[')
+                && candidateRx.match(QString::fromUtf8(line, length)).hasMatch()) {
+                // Definitions start a block; md4c resolves them document-wide
+                if (!blockStart || indent >= 4 || text[0] != '[')
+                    return {};
+                QString label;
+                const qsizetype end = definitionEnd(utf8, pos, &label);
+                if (end < 0 || labels.contains(label))
+                    return {};
+                labels.insert(label);
+                definitions->append(data + pos, end - pos);
+                if (!definitions->endsWith('\n'))
+                    definitions->append('\n');
+                afterBlank = false;
+                pos = end; // the next line may be a definition too
+                continue;
+            }
+
+            if (indent < 4 && textLength >= 3 && (text[0] == '`' || text[0] == '~')
+                && text[1] == text[0] && text[2] == text[0]) {
+                fenceChar = text[0];
+                fenceLength = 0;
+                while (fenceLength < textLength && text[fenceLength] == fenceChar)
+                    ++fenceLength;
+            } else if (indent < 4 && textLength > 1 && text[0] == '<') {
+                // HTML blocks that run until a marker, blank lines included
+                if (startsWithNoCase(text, textLength, "<!--"))
+                    htmlEnd = "-->";
+                else if (startsWithNoCase(text, textLength, "<![CDATA["))
+                    htmlEnd = "]]>";
+                else if (startsWithNoCase(text, textLength, "<?"))
+                    htmlEnd = "?>";
+                else if (startsWithNoCase(text, textLength, "<script"))
+                    htmlEnd = "</script>";
+                else if (startsWithNoCase(text, textLength, "<pre"))
+                    htmlEnd = "</pre>";
+                else if (startsWithNoCase(text, textLength, "<style"))
+                    htmlEnd = "</style>";
+                else if (startsWithNoCase(text, textLength, "<textarea"))
+                    htmlEnd = "</textarea>";
+                else if (startsWithNoCase(text, textLength, "<!"))
+                    htmlEnd = ">";
+                if (htmlEnd && QByteArrayView(text + 2, textLength - 2).contains(htmlEnd))
+                    htmlEnd = nullptr;
+            }
+        }
+        // ATX headings are single lines; other lines may run on
+        qsizetype hashes = 0;
+        while (indent < 4 && hashes < textLength && text[hashes] == '#')
+            ++hashes;
+        blockStart = !fenceChar && !htmlEnd && hashes >= 1 && hashes <= 6
+            && (hashes == textLength || text[hashes] == ' ' || text[hashes] == '\t');
+        afterBlank = false;
+        pos = lineEnd + 1;
     }
-    return s;
+
+    if (starts.size() < 2 || (!definitions->isEmpty() && (fenceChar || htmlEnd)))
+        return {};
+    return starts;
 }
 
-Content::ParagraphFormat ContentBuilder::resolveParagraphFormat(const QString &styleName) const
+} // namespace
+
+ContentBuilder::ContentBuilder(QObject *parent)
+    : QObject(parent)
 {
-    Content::ParagraphFormat f;
-    if (!m_styleManager)
-        return f;
-    ParagraphStyle ps = m_styleManager->resolvedParagraphStyle(styleName);
-    if (ps.hasAlignment()) f.alignment = ps.alignment();
-    if (ps.hasSpaceBefore()) f.spaceBefore = ps.spaceBefore();
-    if (ps.hasSpaceAfter()) f.spaceAfter = ps.spaceAfter();
-    if (ps.hasLeftMargin()) f.leftMargin = ps.leftMargin();
-    if (ps.hasRightMargin()) f.rightMargin = ps.rightMargin();
-    if (ps.hasFirstLineIndent()) f.firstLineIndent = ps.firstLineIndent();
-    if (ps.hasLineHeight()) f.lineHeightPercent = ps.lineHeightPercent();
-    if (ps.hasBackground()) f.background = ps.background();
-    f.headingLevel = ps.headingLevel();
-    return f;
+}
+
+// --- Style references ---
+
+int ContentBuilder::addStyleStep(Content::StyleStep::Kind kind, int parent,
+                                 int level, const QString &href)
+{
+    Content::StyleStep step;
+    step.kind = kind;
+    step.parent = parent;
+    step.level = level;
+    step.href = href;
+    auto it = m_styleStepIndex.constFind(step);
+    if (it != m_styleStepIndex.constEnd())
+        return it.value();
+    const int index = m_doc.styleSteps.size();
+    m_doc.styleSteps.append(step);
+    m_styleStepIndex.insert(step, index);
+    return index;
+}
+
+void ContentBuilder::pushStyleStep(Content::StyleStep::Kind kind, const QString &href)
+{
+    m_styleStack.push(m_currentStyle);
+    m_currentStyle = addStyleStep(kind, m_currentStyle, 0, href);
 }
 
 // --- Block routing ---
@@ -121,11 +445,11 @@ void ContentBuilder::appendInlineNode(Content::InlineNode node)
     if (!m_listStack.isEmpty()) {
         auto &info = m_listStack.top();
         if (!info.items.isEmpty()) {
-            Content::ParagraphFormat fmt;
-            if (m_styleManager)
-                fmt = resolveParagraphFormat(QStringLiteral("ListItem"));
+            Content::Paragraph para;
+            para.styleName = QStringLiteral("ListItem");
+            para.quoteLevel = m_blockQuoteLevel;
             auto &children = info.items.last().children;
-            children.append(Content::Paragraph{fmt, {}});
+            children.append(std::move(para));
             auto *p = std::get_if<Content::Paragraph>(&children.last());
             m_inlineStack.push(&p->inlines);
             info.hasImplicitParagraph = true;
@@ -143,31 +467,158 @@ QList<Content::InlineNode> *ContentBuilder::currentInlines()
 
 // --- Typography ---
 
-QString ContentBuilder::processTypography(const QString &text) const
+qsizetype ContentBuilder::utf16Offset(qsizetype byteOffset)
 {
-    if (text.isEmpty())
-        return text;
-    QString result = text;
+    // md4c reports text in document order, so this only moves forward
+    if (byteOffset < m_utf8Cursor) {
+        m_utf8Cursor = 0;
+        m_utf16Cursor = 0;
+    }
+    m_utf16Cursor += Utf16::lengthOfUtf8(m_bufferStart + m_utf8Cursor, byteOffset - m_utf8Cursor);
+    m_utf8Cursor = byteOffset;
+    return m_textBase + m_utf16Cursor;
+}
+
+Content::TextSlice ContentBuilder::sourceText(const char *text, qsizetype size)
+{
+    const qsizetype offset = m_bufferStart ? text - m_bufferStart : -1;
+    if (offset < 0 || offset + size > m_textBytes)
+        return QString::fromUtf8(text, size);
+    const qsizetype begin = utf16Offset(offset);
+    return Content::TextSlice(m_textBuffer, begin, utf16Offset(offset + size) - begin);
+}
+
+void ContentBuilder::applyTypography(Content::TextSlice &slice) const
+{
+    if (slice.isEmpty() || (!m_shortWords && !(m_hyphenator && m_hyphenator->isLoaded())))
+        return;
+    // Short words swap spaces for no-break spaces and the hyphenator
+    // inserts soft hyphens inside words, so the two never meet at one
+    // index; both report positions in the buffer text
+    const QStringView source = slice.source();
+    QList<qsizetype> spaces;
+    QList<qsizetype> hyphens;
     if (m_shortWords)
-        result = m_shortWords->process(result);
-    if (m_hyphenator && m_hyphenator->isLoaded())
-        result = m_hyphenator->hyphenateText(result);
-    return result;
+        m_shortWords->nbspPositions(source, &spaces);
+    if (m_hyphenator)
+        m_hyphenator->hyphenPositions(source, &hyphens);
+    if (spaces.isEmpty() && hyphens.isEmpty())
+        return;
+
+    QList<Content::TextSlice::Edit> edits;
+    edits.reserve(spaces.size() + hyphens.size());
+    auto space = spaces.cbegin();
+    auto hyphen = hyphens.cbegin();
+    while (space != spaces.cend() || hyphen != hyphens.cend()) {
+        if (hyphen == hyphens.cend() || (space != spaces.cend() && *space < *hyphen))
+            edits.append({*space++, QChar(0x00A0), false});
+        else
+            edits.append({*hyphen++, QChar(0x00AD), true});
+    }
+    slice.setEdits(std::move(edits));
+}
+
+void ContentBuilder::appendCodeText(const char *text, qsizetype size)
+{
+    // Code lines arrive as pieces of the buffer with the newlines in
+    // between; a block stays one slice while its pieces keep matching the
+    // source bytes that follow (not inside a list or quote, which strip
+    // a prefix from every line)
+    const qsizetype offset = m_bufferStart ? text - m_bufferStart : -1;
+    if (!m_codeOwned) {
+        if (m_codeStart < 0 && offset >= 0 && offset + size <= m_textBytes) {
+            m_codeStart = offset;
+            m_codeEnd = offset + size;
+            return;
+        }
+        if (m_codeStart >= 0 && m_codeEnd + size <= m_textBytes
+            && (offset == m_codeEnd || std::memcmp(m_bufferStart + m_codeEnd, text, size) == 0)) {
+            m_codeEnd += size;
+            return;
+        }
+        if (m_codeStart >= 0)
+            m_codeText = QString::fromUtf8(m_bufferStart + m_codeStart, m_codeEnd - m_codeStart);
+        m_codeOwned = true;
+    }
+    m_codeText.append(QString::fromUtf8(text, size));
 }
 
 // --- Build entry point ---
 
 Content::Document ContentBuilder::build(const QString &markdownText)
+{
+    AllocProfiler::Scope allocScope(AllocProfiler::Parse);
+    Content::Document doc = parse(markdownText);
+    StyleBinder(m_styleManager, m_footnoteStyle).bind(doc);
+    return doc;
+}
+
+Content::Document ContentBuilder::parse(const QString &markdownText)
+{
+    m_footnotes.clear();
+    m_footnoteRefs.clear();
+
+    // Extract footnotes
+    FootnoteParser fnParser;
+    QString processed = fnParser.process(markdownText);
+    for (const auto &fn : fnParser.footnotes()) {
+        m_footnotes.append({fn.label, fn.content});
+    }
+    m_footnoteRefs = fnParser.references();
+
+    // Store processed text for source line extraction; node text is
+    // sliced from it
+    m_processedMarkdown = processed;
+    m_textBuffer = processed;
+    m_textBase = 0;
+
+    const QByteArray utf8 = processed.toUtf8();
+    m_textBytes = utf8.size();
+    QList<qsizetype> starts;
+    QByteArray definitions;
+    if (m_parallelParse && utf8.size() >= kParallelParseThreshold) {
+        const int chunkCount = qMin<qsizetype>(QThread::idealThreadCount(),
+                                               utf8.size() / kMinChunkBytes);
+        if (chunkCount > 1)
+            starts = chunkStarts(utf8, chunkCount, &definitions);
+    }
+    if (starts.isEmpty())
+        parseBuffer(utf8);
+    else
+        parseChunks(utf8, starts, definitions);
+
+    // Append footnote section (labels and note styles are bound later)
+    if (!m_footnotes.isEmpty()) {
+        Content::FootnoteSection section;
+        section.styleRef = m_currentStyle;
+        for (int i = 0; i < m_footnotes.size(); ++i) {
+            Content::Footnote fn;
+            Content::TextRun textRun;
+            textRun.text = m_footnotes[i].text;
+            fn.content.append(textRun);
+
+            section.footnotes.append(fn);
+        }
+        m_doc.blocks.append(section);
+    }
+
+    return m_doc;
+}
+
+void ContentBuilder::parseBuffer(const QByteArray &utf8)
 {
     m_doc = Content::Document{};
     m_inlineStack.clear();
     m_styleStack.clear();
+    m_styleStepIndex.clear();
     m_listStack.clear();
     m_blockQuoteLevel = 0;
     m_blockQuoteStack.clear();
     m_inCodeBlock = false;
     m_codeLanguage.clear();
     m_codeText.clear();
+    m_codeStart = m_codeEnd = -1;
+    m_codeOwned = false;
     m_inTable = false;
     m_inTableHeader = false;
     m_tableRows.clear();
@@ -176,27 +627,10 @@ Content::Document ContentBuilder::build(const QString &markdownText)
     m_tableCol = 0;
     m_collectingAltText = false;
     m_altText.clear();
-    m_linkHref.clear();
-    m_footnotes.clear();
-
-    // Resolve default text style
-    if (m_styleManager)
-        m_currentStyle = resolveTextStyle(QStringLiteral("Default Paragraph Style"));
-    else
-        m_currentStyle = defaultTextStyle();
-
-    // Extract footnotes
-    FootnoteParser fnParser;
-    QString processed = fnParser.process(markdownText);
-    for (const auto &fn : fnParser.footnotes()) {
-        m_footnotes.append({fn.label, fn.content});
-    }
 
-    // Store processed text for source line extraction
-    m_processedMarkdown = processed;
+    m_currentStyle = addStyleStep(Content::StyleStep::DocumentDefault, -1);
 
     // Build line offset table for source tracking
-    const QByteArray utf8 = processed.toUtf8();
     m_lineStartOffsets.clear();
     m_lineStartOffsets.append(0); // line 1 starts at byte 0
     for (int i = 0; i < utf8.size(); ++i) {
@@ -204,6 +638,9 @@ Content::Document ContentBuilder::build(const QString &markdownText)
             m_lineStartOffsets.append(i + 1);
     }
     m_bufferStart = utf8.constData();
+    m_bufferSize = utf8.size();
+    m_utf8Cursor = 0;
+    m_utf16Cursor = 0;
     m_blockTrackers.clear();
 
     // Parse
@@ -218,38 +655,225 @@ Content::Document ContentBuilder::build(const QString &markdownText)
     parser.text = &ContentBuilder::sText;
 
     md_parse(utf8.constData(), static_cast<MD_SIZE>(utf8.size()), &parser, this);
+}
 
-    // Append footnote section
-    if (!m_footnotes.isEmpty()) {
-        Content::FootnoteSection section;
-        section.showSeparator = m_footnoteStyle.showSeparator;
-        section.separatorLength = m_footnoteStyle.separatorLength;
-        for (int i = 0; i < m_footnotes.size(); ++i) {
-            Content::Footnote fn;
-            fn.label = m_footnoteStyle.formatNumber(m_footnoteStyle.startNumber + i);
+void ContentBuilder::parseChunks(const QByteArray &utf8, const QList<qsizetype> &starts,
+                                 const QByteArray &definitions)
+{
+    const int count = starts.size();
+    QList<Content::Document> parts(count);
+
+    // Where each piece begins in m_textBuffer
+    QList<qsizetype> textBases(count);
+    textBases[0] = m_textBase;
+    for (int i = 1; i < count; ++i)
+        textBases[i] = textBases[i - 1]
+            + Utf16::lengthOfUtf8(utf8.constData() + starts[i - 1], starts[i] - starts[i - 1]);
+
+    auto parseChunk = [&](int i) {
+        AllocProfiler::Scope allocScope(AllocProfiler::Parse);
+        const qsizetype begin = starts[i];
+        const qsizetype end = i + 1 < count ? starts[i + 1] : utf8.size();
+
+        ContentBuilder chunk;
+        chunk.m_basePath = m_basePath;
+        chunk.m_hyphenator = m_hyphenator; // const use only
+        chunk.m_shortWords = m_shortWords;
+        chunk.m_textBuffer = m_textBuffer;
+        chunk.m_textBase = textBases[i];
+        chunk.m_textBytes = end - begin;
+        for (const FootnoteReference &ref : std::as_const(m_footnoteRefs)) {
+            if (ref.utf8Offset >= begin && ref.utf8Offset < end) {
+                FootnoteReference local = ref;
+                local.utf8Offset -= begin;
+                chunk.m_footnoteRefs.append(local);
+            }
+        }
 
-            Content::TextStyle numStyle = m_currentStyle;
-            numStyle.fontSize = 8.0;
-            numStyle.foreground = QColor(0x03, 0x66, 0xd6);
-            numStyle.superscript = m_footnoteStyle.superscriptNote;
-            fn.numberStyle = numStyle;
+        // Definitions go after the piece's own text so its lines keep
+        // their offsets, behind a blank line that closes whatever block
+        // the piece ends in
+        QByteArray text = utf8.mid(begin, end - begin);
+        if (!definitions.isEmpty()) {
+            text += "\n\n";
+            text += definitions;
+        }
+        chunk.parseBuffer(text);
+        parts[i] = std::move(chunk.m_doc);
+    };
 
-            Content::TextStyle textStyle = m_currentStyle;
-            textStyle.fontSize = 9.0;
-            textStyle.foreground = QColor(0x55, 0x55, 0x55);
-            fn.textStyle = textStyle;
+    std::vector<std::unique_ptr<QThread>> threads;
+    threads.reserve(count - 1);
+    for (int i = 1; i < count; ++i) {
+        threads.emplace_back(QThread::create(parseChunk, i));
+        threads.back()->start();
+    }
+    parseChunk(0);
+    for (auto &thread : threads)
+        thread->wait();
+
+    // Stitch: one style step table, source lines counted from the top
+    m_doc = std::move(parts[0]);
+    m_styleStepIndex.clear();
+    for (int i = 0; i < m_doc.styleSteps.size(); ++i)
+        m_styleStepIndex.insert(m_doc.styleSteps[i], i);
+    int lineShift = 0;
+    for (int i = 1; i < count; ++i) {
+        lineShift += int(std::count(utf8.cbegin() + starts[i - 1], utf8.cbegin() + starts[i], '\n'));
+        const QList<int> stepMap = mergeStyleSteps(m_doc.styleSteps, m_styleStepIndex,
+                                                   parts[i].styleSteps);
+        m_doc.blocks.reserve(m_doc.blocks.size() + parts[i].blocks.size());
+        for (auto &block : parts[i].blocks) {
+            remapStyleRefs(block, stepMap);
+            shiftSourceLines(block, lineShift);
+            m_doc.blocks.append(std::move(block));
+        }
+    }
 
-            Content::TextRun textRun;
-            textRun.text = m_footnotes[i].text;
-            textRun.style = textStyle;
-            fn.content.append(textRun);
+    m_currentStyle = addStyleStep(Content::StyleStep::DocumentDefault, -1);
 
-            section.footnotes.append(fn);
-        }
-        m_doc.blocks.append(section);
+    // Line table of the whole text, as after a serial parse
+    m_lineStartOffsets.clear();
+    m_lineStartOffsets.append(0);
+    for (int i = 0; i < utf8.size(); ++i) {
+        if (utf8[i] == '\n')
+            m_lineStartOffsets.append(i + 1);
     }
+    m_bufferStart = nullptr;
+    m_bufferSize = 0;
+}
 
-    return m_doc;
+// --- Incremental re-parse ---
+
+Content::Document ContentBuilder::reparse(const QString &markdownText,
+                                          const Content::Document &previous,
+                                          const QString &previousProcessed,
+                                          Content::Splice *splice)
+{
+    if (splice)
+        *splice = Content::Splice();
+
+    // Footnote numbers and reference links resolve across the whole text
+    static const QRegularExpression referenceRx(
+        QStringLiteral(R"(^ {0,3}\[[^\]]+\]:)"), QRegularExpression::MultilineOption);
+    if (previous.blocks.isEmpty()
+        || std::holds_alternative<Content::FootnoteSection>(previous.blocks.last())
+        || markdownText.contains(QLatin1String("[^"))
+        || previousProcessed.contains(QLatin1String("[^"))
+        || referenceRx.match(markdownText).hasMatch()
+        || referenceRx.match(previousProcessed).hasMatch())
+        return parse(markdownText);
+
+    // Without footnotes the processed text is the markdown itself
+    const QList<QStringView> oldLines = QStringView(previousProcessed).split(u'\n');
+    const QList<QStringView> newLines = QStringView(markdownText).split(u'\n');
+    const int oldCount = oldLines.size();
+    const int newCount = newLines.size();
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount && oldLines[prefix] == newLines[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix
+           && oldLines[oldCount - 1 - suffix] == newLines[newCount - 1 - suffix])
+        ++suffix;
+    const int delta = newCount - oldCount;
+
+    const int blockCount = previous.blocks.size();
+    if (prefix == oldCount && prefix == newCount) {
+        m_doc = previous;
+        m_processedMarkdown = markdownText;
+        if (splice)
+            splice->leading = blockCount;
+        return previous;
+    }
+
+    QList<Content::SourceRange> ranges;
+    ranges.reserve(blockCount);
+    for (const auto &block : previous.blocks)
+        ranges.append(blockRange(block));
+
+    // The blocks bordering the change: the last one wholly within the
+    // unchanged head and the first one wholly within the unchanged tail.
+    // Both are re-parsed too, and must come out the same.
+    int before = -1;
+    for (int i = 0; i < blockCount && ranges[i].endLine <= prefix; ++i) {
+        if (ranges[i].startLine > 0)
+            before = i;
+    }
+    const int tailStart = oldCount - suffix + 1;
+    int after = -1;
+    for (int i = blockCount - 1; i > before
+         && (ranges[i].startLine < 0 || ranges[i].startLine >= tailStart); --i) {
+        if (ranges[i].startLine > 0)
+            after = i;
+    }
+
+    // Widen to the surrounding blank lines so that syntax without text of
+    // its own (code fences, setext underlines) is included
+    auto isBlank = [](QStringView line) { return line.trimmed().isEmpty(); };
+    int first = 0;
+    if (before >= 0) {
+        first = ranges[before].startLine - 1;
+        while (first > 0 && !isBlank(newLines[first - 1]))
+            --first;
+    }
+    int last = newCount - 1;
+    if (after >= 0) {
+        last = ranges[after].endLine - 1 + delta;
+        while (last + 1 < newCount && !isBlank(newLines[last + 1]))
+            ++last;
+    }
+
+    QString slice;
+    for (int i = first; i <= last; ++i) {
+        slice += newLines[i];
+        slice += QLatin1Char('\n');
+    }
+    Content::Document part = parse(slice);
+    for (auto &block : part.blocks)
+        shiftSourceLines(block, first);
+
+    bool converged = true;
+    if (before >= 0)
+        converged = !part.blocks.isEmpty() && sameExtent(previous.blocks[before], part.blocks.first(), 0);
+    if (converged && after >= 0)
+        converged = part.blocks.size() >= (before >= 0 ? 2 : 1)
+            && sameExtent(previous.blocks[after], part.blocks.last(), delta);
+    if (!converged)
+        return parse(markdownText);
+
+    // The slice was parsed with its own style step table; fold it into
+    // the previous one
+    Content::Document result;
+    result.styleSteps = previous.styleSteps;
+    QHash<Content::StyleStep, int> stepIndex;
+    for (int i = 0; i < result.styleSteps.size(); ++i)
+        stepIndex.insert(result.styleSteps[i], i);
+    const QList<int> stepMap = mergeStyleSteps(result.styleSteps, stepIndex, part.styleSteps);
+
+    const int leading = qMax(before, 0);
+    const int resumeAt = after >= 0 ? after + 1 : blockCount;
+    result.blocks.reserve(leading + part.blocks.size() + blockCount - resumeAt);
+    result.blocks.append(previous.blocks.mid(0, leading));
+    for (auto &block : part.blocks) {
+        remapStyleRefs(block, stepMap);
+        result.blocks.append(std::move(block));
+    }
+    for (int i = resumeAt; i < blockCount; ++i) {
+        Content::BlockNode block = previous.blocks[i];
+        if (delta != 0)
+            shiftSourceLines(block, delta);
+        result.blocks.append(std::move(block));
+    }
+
+    m_doc = result;
+    m_processedMarkdown = markdownText;
+    if (splice) {
+        splice->leading = leading;
+        splice->trailing = blockCount - resumeAt;
+        splice->lineDelta = delta;
+    }
+    return result;
 }
 
 // --- Setters ---
@@ -289,43 +913,32 @@ int ContentBuilder::enterBlock(MD_BLOCKTYPE type, void *detail)
         break;
 
     case MD_BLOCK_P: {
-        // Resolve paragraph format and text style
-        Content::ParagraphFormat fmt;
+        // Record paragraph style and text style
+        Content::Paragraph para;
+        para.quoteLevel = m_blockQuoteLevel;
         if (m_blockQuoteLevel > 0) {
-            if (m_styleManager) {
-                fmt = resolveParagraphFormat(QStringLiteral("BlockQuote"));
-                m_currentStyle = resolveTextStyle(QStringLiteral("BlockQuote"));
-            } else {
-                fmt.leftMargin = 20.0 * m_blockQuoteLevel;
-                m_currentStyle.italic = true;
-                m_currentStyle.foreground = QColor(0x55, 0x55, 0x55);
-            }
+            para.styleName = QStringLiteral("BlockQuote");
+            m_currentStyle = addStyleStep(Content::StyleStep::BlockQuoteText, m_currentStyle);
         } else if (!m_listStack.isEmpty()) {
-            if (m_styleManager) {
-                fmt = resolveParagraphFormat(QStringLiteral("ListItem"));
-                m_currentStyle = resolveTextStyle(QStringLiteral("ListItem"));
-            }
+            para.styleName = QStringLiteral("ListItem");
+            m_currentStyle = addStyleStep(Content::StyleStep::ListItemText, m_currentStyle);
         } else {
-            if (m_styleManager) {
-                fmt = resolveParagraphFormat(QStringLiteral("BodyText"));
-                m_currentStyle = resolveTextStyle(QStringLiteral("BodyText"));
-            } else {
-                fmt.spaceAfter = 6.0;
-            }
+            para.styleName = QStringLiteral("BodyText");
+            m_currentStyle = addStyleStep(Content::StyleStep::BodyText, m_currentStyle);
         }
 
         // Place paragraph in the right container
         if (!m_listStack.isEmpty() && !m_listStack.top().items.isEmpty()) {
             auto &children = m_listStack.top().items.last().children;
-            children.append(Content::Paragraph{fmt, {}});
+            children.append(std::move(para));
             auto *p = std::get_if<Content::Paragraph>(&children.last());
             m_inlineStack.push(&p->inlines);
         } else if (!m_blockQuoteStack.isEmpty()) {
-            m_blockQuoteStack.top().append(Content::Paragraph{fmt, {}});
+            m_blockQuoteStack.top().append(std::move(para));
             auto *p = std::get_if<Content::Paragraph>(&m_blockQuoteStack.top().last());
             m_inlineStack.push(&p->inlines);
         } else {
-            m_doc.blocks.append(Content::Paragraph{fmt, {}});
+            m_doc.blocks.append(std::move(para));
             auto *p = std::get_if<Content::Paragraph>(&m_doc.blocks.last());
             m_inlineStack.push(&p->inlines);
         }
@@ -338,23 +951,8 @@ int ContentBuilder::enterBlock(MD_BLOCKTYPE type, void *detail)
 
         Content::Heading heading;
         heading.level = level;
-        if (m_styleManager) {
-            QString styleName = QStringLiteral("Heading%1").arg(level);
-            heading.format = resolveParagraphFormat(styleName);
-            heading.format.headingLevel = level;
-            m_currentStyle = resolveTextStyle(styleName);
-        } else {
-            static const qreal spaceBefore[] = {0, 24, 20, 16, 12, 10, 8};
-            static const qreal spaceAfter[] = {0, 12, 10, 8, 6, 4, 4};
-            static const qreal sizes[] = {0, 28, 24, 20, 16, 14, 12};
-            heading.format.spaceBefore = spaceBefore[level];
-            heading.format.spaceAfter = spaceAfter[level];
-            heading.format.headingLevel = level;
-            m_currentStyle.fontFamily = QStringLiteral("Noto Sans");
-            m_currentStyle.fontWeight = 700;
-            m_currentStyle.fontSize = sizes[level];
-            if (level == 6) m_currentStyle.italic = true;
-        }
+        heading.format.headingLevel = level;
+        m_currentStyle = addStyleStep(Content::StyleStep::HeadingText, m_currentStyle, level);
 
         if (!m_blockQuoteStack.isEmpty()) {
             m_blockQuoteStack.top().append(std::move(heading));
@@ -417,8 +1015,7 @@ int ContentBuilder::enterBlock(MD_BLOCKTYPE type, void *detail)
             m_listStack.top().items.append(item);
         }
         // Set list item text style for tight lists (no P block will set it)
-        if (m_styleManager)
-            m_currentStyle = resolveTextStyle(QStringLiteral("ListItem"));
+        m_currentStyle = addStyleStep(Content::StyleStep::ListItemText, m_currentStyle);
         break;
     }
 
@@ -428,6 +1025,8 @@ int ContentBuilder::enterBlock(MD_BLOCKTYPE type, void *detail)
         m_codeFenced = (d->fence_char != 0);
         m_inCodeBlock = true;
         m_codeText.clear();
+        m_codeStart = m_codeEnd = -1;
+        m_codeOwned = false;
         break;
     }
 
@@ -470,31 +1069,9 @@ int ContentBuilder::enterBlock(MD_BLOCKTYPE type, void *detail)
         if (m_tableCol < m_tableColumnAligns.size())
             m_tableColumnAligns[m_tableCol] = cell.alignment;
 
-        // Resolve cell style
-        if (m_styleManager) {
-            TableStyle *ts = m_styleManager->tableStyle(QStringLiteral("Default"));
-            if (ts) {
-                if (cell.isHeader) {
-                    cell.style = resolveTextStyle(ts->headerParagraphStyle());
-                    cell.style.fontWeight = 700;
-                    if (ts->hasHeaderBackground())
-                        cell.background = ts->headerBackground();
-                    else
-                        cell.background = QColor(0xf0, 0xf0, 0xf0);
-                    if (ts->hasHeaderForeground())
-                        cell.style.foreground = ts->headerForeground();
-                } else {
-                    cell.style = resolveTextStyle(ts->bodyParagraphStyle());
-                    // Body cell backgrounds handled by layout engine
-                    // (applies bodyBackground + alternating row colors)
-                }
-            }
-        } else if (cell.isHeader) {
-            cell.background = QColor(0xf0, 0xf0, 0xf0);
-            cell.style.fontWeight = 700;
-        }
-
-        m_currentStyle = cell.style.fontFamily.isEmpty() ? defaultTextStyle() : cell.style;
+        // Cell text does not inherit from the surrounding text
+        m_currentStyle = addStyleStep(Content::StyleStep::TableCellText, -1,
+                                      cell.isHeader ? 1 : 0);
         m_currentRowCells.append(cell);
         m_inlineStack.push(&m_currentRowCells.last().inlines);
         break;
@@ -567,8 +1144,6 @@ int ContentBuilder::leaveBlock(MD_BLOCKTYPE type, void * /*detail*/)
         Content::BlockQuote bq;
         bq.level = m_blockQuoteLevel + 1; // level of this blockquote (1-based)
         bq.children = std::move(children);
-        if (m_styleManager)
-            bq.format = resolveParagraphFormat(QStringLiteral("BlockQuote"));
 
         addBlock(std::move(bq));
         break;
@@ -616,16 +1191,10 @@ int ContentBuilder::leaveBlock(MD_BLOCKTYPE type, void * /*detail*/)
         Content::CodeBlock cb;
         cb.language = m_codeLanguage;
         cb.isFenced = m_codeFenced;
-        cb.code = m_codeText;
-        if (m_styleManager) {
-            cb.style = resolveTextStyle(QStringLiteral("CodeBlock"));
-            ParagraphStyle ps = m_styleManager->resolvedParagraphStyle(QStringLiteral("CodeBlock"));
-            if (ps.hasBackground())
-                cb.background = ps.background();
-        } else {
-            cb.style.fontFamily = QStringLiteral("JetBrains Mono");
-            cb.style.fontSize = 10.0;
-        }
+        if (m_codeOwned)
+            cb.code = m_codeText;
+        else if (m_codeStart >= 0)
+            cb.code = sourceText(m_bufferStart + m_codeStart, m_codeEnd - m_codeStart);
         if (!m_blockTrackers.isEmpty()) {
             auto tracker = m_blockTrackers.pop();
             if (tracker.firstByteOffset >= 0) {
@@ -636,6 +1205,8 @@ int ContentBuilder::leaveBlock(MD_BLOCKTYPE type, void * /*detail*/)
         addBlock(std::move(cb));
         m_codeLanguage.clear();
         m_codeText.clear();
+        m_codeStart = m_codeEnd = -1;
+        m_codeOwned = false;
         break;
     }
 
@@ -650,29 +1221,6 @@ int ContentBuilder::leaveBlock(MD_BLOCKTYPE type, void * /*detail*/)
             else
                 break;
         }
-        // Apply table style
-        if (m_styleManager) {
-            TableStyle *ts = m_styleManager->tableStyle(QStringLiteral("Default"));
-            if (ts) {
-                if (ts->hasHeaderBackground()) table.headerBackground = ts->headerBackground();
-                if (ts->hasHeaderForeground()) table.headerForeground = ts->headerForeground();
-                if (ts->hasBodyBackground()) table.bodyBackground = ts->bodyBackground();
-                if (ts->hasAlternateRowColor()) table.alternateRowColor = ts->alternateRowColor();
-                table.cellPadding = ts->cellPadding().top();
-                if (ts->hasOuterBorder()) {
-                    table.borderWidth = ts->outerBorder().width;
-                    table.borderColor = ts->outerBorder().color;
-                }
-                if (ts->hasInnerBorder()) {
-                    table.innerBorderWidth = ts->innerBorder().width;
-                    table.innerBorderColor = ts->innerBorder().color;
-                }
-                if (ts->hasHeaderBottomBorder()) {
-                    table.headerBottomBorderWidth = ts->headerBottomBorder().width;
-                    table.headerBottomBorderColor = ts->headerBottomBorder().color;
-                }
-            }
-        }
         if (!m_blockTrackers.isEmpty()) {
             auto tracker = m_blockTrackers.pop();
             if (tracker.firstByteOffset >= 0) {
@@ -736,38 +1284,21 @@ int ContentBuilder::enterSpan(MD_SPANTYPE type, void *detail)
 {
     switch (type) {
     case MD_SPAN_EM:
-        m_styleStack.push(m_currentStyle);
-        m_currentStyle.italic = true;
+        pushStyleStep(Content::StyleStep::Emphasis);
         break;
 
     case MD_SPAN_STRONG:
-        m_styleStack.push(m_currentStyle);
-        m_currentStyle.fontWeight = 700;
+        pushStyleStep(Content::StyleStep::Strong);
         break;
 
     case MD_SPAN_CODE:
-        m_styleStack.push(m_currentStyle);
-        if (m_styleManager)
-            m_currentStyle = resolveCharStyle(QStringLiteral("InlineCode"));
-        else {
-            m_currentStyle.fontFamily = QStringLiteral("JetBrains Mono");
-            m_currentStyle.fontSize = 10.0;
-            m_currentStyle.foreground = QColor(0xc7, 0x25, 0x4e);
-            m_currentStyle.background = QColor(0xf0, 0xf0, 0xf0);
-        }
+        pushStyleStep(Content::StyleStep::InlineCode);
         break;
 
     case MD_SPAN_A: {
+        // The href flows through TextStyle on each TextRun inside the span
         auto *d = static_cast<MD_SPAN_A_DETAIL *>(detail);
-        m_styleStack.push(m_currentStyle);
-        if (m_styleManager)
-            m_currentStyle = resolveCharStyle(QStringLiteral("Link"));
-        else {
-            m_currentStyle.foreground = QColor(0x03, 0x66, 0xd6);
-            m_currentStyle.underline = true;
-        }
-        m_linkHref = extractAttribute(d->href);
-        m_currentStyle.linkHref = m_linkHref;
+        pushStyleStep(Content::StyleStep::Link, extractAttribute(d->href));
         break;
     }
 
@@ -781,13 +1312,11 @@ int ContentBuilder::enterSpan(MD_SPANTYPE type, void *detail)
     }
 
     case MD_SPAN_DEL:
-        m_styleStack.push(m_currentStyle);
-        m_currentStyle.strikethrough = true;
+        pushStyleStep(Content::StyleStep::Strikethrough);
         break;
 
     case MD_SPAN_U:
-        m_styleStack.push(m_currentStyle);
-        m_currentStyle.underline = true;
+        pushStyleStep(Content::StyleStep::Underline);
         break;
 
     case MD_SPAN_WIKILINK:
@@ -830,20 +1359,11 @@ int ContentBuilder::leaveSpan(MD_SPANTYPE type, void * /*detail*/)
         break;
     }
 
-    case MD_SPAN_A:
-        if (!m_styleStack.isEmpty())
-            m_currentStyle = m_styleStack.pop();
-        m_linkHref.clear();
-        m_currentStyle.linkHref.clear();
-        break;
-
     default:
-        if (!m_styleStack.isEmpty()) {
+        // Spans nest properly, so the restored step already carries the
+        // enclosing link's href (or none)
+        if (!m_styleStack.isEmpty())
             m_currentStyle = m_styleStack.pop();
-            // Preserve linkHref if we're still inside a link span
-            if (!m_linkHref.isEmpty())
-                m_currentStyle.linkHref = m_linkHref;
-        }
         break;
     }
     return 0;
@@ -864,78 +1384,55 @@ int ContentBuilder::onText(MD_TEXTTYPE type, const MD_CHAR *text, MD_SIZE size)
         }
     }
 
-    QString str = QString::fromUtf8(text, static_cast<int>(size));
-
     if (m_collectingAltText) {
-        m_altText.append(str);
+        m_altText.append(QString::fromUtf8(text, static_cast<int>(size)));
         return 0;
     }
 
     switch (type) {
     case MD_TEXT_NORMAL: {
-        // Check for footnote references
-        if (!m_footnotes.isEmpty()) {
-            static const QRegularExpression fnRefRx(QStringLiteral(R"(\[\^([^\]]+)\])"));
-            int lastEnd = 0;
-            auto it = fnRefRx.globalMatch(str);
-            bool found = false;
-            while (it.hasNext()) {
-                auto match = it.next();
-                if (match.capturedStart() > lastEnd) {
-                    QString seg = str.mid(lastEnd, match.capturedStart() - lastEnd);
-                    if (!m_inCodeBlock)
-                        seg = processTypography(seg);
-                    appendInlineNode(Content::TextRun{seg, m_currentStyle});
-                }
-                QString label = match.captured(1);
-                int fnIndex = -1;
-                for (int i = 0; i < m_footnotes.size(); ++i) {
-                    if (m_footnotes[i].label == label) {
-                        fnIndex = i;
-                        break;
-                    }
-                }
-                if (fnIndex >= 0) {
-                    int number = m_footnoteStyle.startNumber + fnIndex;
-                    Content::FootnoteRef ref;
-                    ref.index = fnIndex;
-                    ref.label = m_footnoteStyle.formatNumber(number);
-                    ref.style = m_currentStyle;
-                    ref.style.fontSize = 8.0;
-                    ref.style.foreground = QColor(0x03, 0x66, 0xd6);
-                    ref.style.superscript = m_footnoteStyle.superscriptRef;
-                    appendInlineNode(std::move(ref));
-                } else {
-                    appendInlineNode(Content::TextRun{match.captured(0), m_currentStyle});
-                }
-                lastEnd = match.capturedEnd();
-                found = true;
-            }
-            if (found) {
-                if (lastEnd < str.size()) {
-                    QString tail = str.mid(lastEnd);
-                    if (!m_inCodeBlock)
-                        tail = processTypography(tail);
-                    appendInlineNode(Content::TextRun{tail, m_currentStyle});
-                }
-            } else {
-                if (!m_inCodeBlock)
-                    str = processTypography(str);
-                appendInlineNode(Content::TextRun{str, m_currentStyle});
-            }
-        } else {
+        auto appendText = [this](const char *segment, qsizetype length) {
+            Content::TextSlice seg = sourceText(segment, length);
             if (!m_inCodeBlock)
-                str = processTypography(str);
-            appendInlineNode(Content::TextRun{str, m_currentStyle});
+                applyTypography(seg);
+            appendInlineNode(Content::TextRun{std::move(seg), {}, m_currentStyle});
+        };
+
+        // Footnote references FootnoteParser found within this text
+        const qsizetype offset = text - m_bufferStart;
+        const qsizetype end = offset + size;
+        auto ref = m_footnoteRefs.cend();
+        if (!m_footnoteRefs.isEmpty() && offset >= 0 && end <= m_bufferSize) {
+            ref = std::lower_bound(m_footnoteRefs.cbegin(), m_footnoteRefs.cend(), offset,
+                                   [](const FootnoteReference &r, qsizetype pos) {
+                                       return r.utf8Offset < pos;
+                                   });
+        }
+        if (ref == m_footnoteRefs.cend() || ref->utf8Offset + ref->utf8Length > end) {
+            appendText(text, size);
+            break;
+        }
+
+        qsizetype pos = offset;
+        for (; ref != m_footnoteRefs.cend() && ref->utf8Offset + ref->utf8Length <= end; ++ref) {
+            if (ref->utf8Offset > pos)
+                appendText(m_bufferStart + pos, ref->utf8Offset - pos);
+            Content::FootnoteRef node;
+            node.index = ref->index;
+            node.styleRef = m_currentStyle;
+            appendInlineNode(std::move(node));
+            pos = ref->utf8Offset + ref->utf8Length;
         }
+        if (pos < end)
+            appendText(m_bufferStart + pos, end - pos);
         break;
     }
 
     case MD_TEXT_CODE:
         if (m_inCodeBlock) {
-            m_codeText.append(str);
+            appendCodeText(text, size);
         } else {
-            appendInlineNode(Content::InlineCode{str, m_currentStyle});
+            appendInlineNode(Content::InlineCode{sourceText(text, size), {}, m_currentStyle});
         }
         break;
 
@@ -948,20 +1445,20 @@ int ContentBuilder::onText(MD_TEXTTYPE type, const MD_CHAR *text, MD_SIZE size)
         break;
 
     case MD_TEXT_ENTITY: {
-        QString decoded = resolveEntity(str);
-        appendInlineNode(Content::TextRun{decoded, m_currentStyle});
+        QString decoded = resolveEntity(QString::fromUtf8(text, static_cast<int>(size)));
+        appendInlineNode(Content::TextRun{decoded, {}, m_currentStyle});
         break;
     }
 
     case MD_TEXT_NULLCHAR:
-        appendInlineNode(Content::TextRun{QString(QChar(0xFFFD)), m_currentStyle});
+        appendInlineNode(Content::TextRun{QString(QChar(0xFFFD)), {}, m_currentStyle});
         break;
 
     case MD_TEXT_HTML:
         break;
 
     case MD_TEXT_LATEXMATH:
-        appendInlineNode(Content::TextRun{str, m_currentStyle});
+        appendInlineNode(Content::TextRun{sourceText(text, size), {}, m_currentStyle});
         break;
     }
     return 0;
@@ -4,12 +4,27 @@
  * Same callback structure as DocumentBuilder, but emits Content:: nodes
  * instead of QTextCursor operations.
  *
+ * parse() produces a style-independent tree (see StyleBinder); build()
+ * is parse() followed by binding against the configured StyleManager.
+ *
+ * Large documents are cut at blank lines where no block can continue
+ * across (outside fences, multi-line HTML, lists, quotes and tables) and
+ * the pieces parsed concurrently, each by its own builder and md4c run.
+ * Footnotes are extracted beforehand and reference definitions are
+ * handed to every piece, so the stitched result equals a serial parse.
+ *
+ * Text and code nodes are slices of the processed markdown rather than
+ * copies: md4c hands out pointers into the UTF-8 buffer, which map back
+ * to the UTF-16 text by a forward-moving cursor.  Text md4c synthesizes
+ * (entities, escapes resolved across pieces) falls back to own strings.
+ *
  * SPDX-License-Identifier: GPL-2.0-or-later
  */
 
 #ifndef PRETTYREADER_CONTENTBUILDER_H
 #define PRETTYREADER_CONTENTBUILDER_H
 
+#include <QHash>
 #include <QObject>
 #include <QStack>
 #include <QString>
@@ -17,6 +32,7 @@
 #include <md4c.h>
 
 #include "contentmodel.h"
+#include "footnoteparser.h"
 #include "footnotestyle.h"
 
 class Hyphenator;
@@ -30,6 +46,24 @@ public:
 
     Content::Document build(const QString &markdownText);
 
+    // Parse without resolving styles.  The result depends only on the
+    // markdown, base path, hyphenator and short words, and can be bound
+    // to any StyleManager with StyleBinder.
+    Content::Document parse(const QString &markdownText);
+
+    // Re-parse after an edit.  @p previous and @p previousProcessed are an
+    // earlier parse() result and its processedMarkdown(); only the blocks
+    // around the changed lines go through md4c again, the rest are reused
+    // (described by @p splice).  Falls back to a full parse() whenever a
+    // partial one could come out differently: footnotes and reference
+    // definitions reach across the document, and a block whose extent
+    // changed (an unclosed fence, a list that grew) fails the check on the
+    // blocks bordering the re-parsed range.
+    Content::Document reparse(const QString &markdownText,
+                              const Content::Document &previous,
+                              const QString &previousProcessed,
+                              Content::Splice *splice = nullptr);
+
     // The processed markdown text (after footnote extraction) used for parsing.
     // Source line ranges in blocks refer to this text.
     QString processedMarkdown() const { return m_processedMarkdown; }
@@ -40,6 +74,10 @@ public:
     void setShortWords(ShortWords *sw);
     void setFootnoteStyle(const FootnoteStyle &style);
 
+    // Large documents are parsed in pieces unless disabled; the result is
+    // the same either way
+    void setParallelParse(bool enabled) { m_parallelParse = enabled; }
+
 private:
     // MD4C static callbacks
     static int sEnterBlock(MD_BLOCKTYPE type, void *detail, void *userdata);
@@ -49,6 +87,15 @@ private:
     static int sText(MD_TEXTTYPE type, const MD_CHAR *text, MD_SIZE size,
                      void *userdata);
 
+    // md4c over @p utf8 into m_doc, from a clean block and style state.
+    // Footnote references are looked up in m_footnoteRefs by offset.
+    void parseBuffer(const QByteArray &utf8);
+
+    // Parse the pieces of @p utf8 starting at @p starts concurrently and
+    // stitch them into m_doc; see the file comment
+    void parseChunks(const QByteArray &utf8, const QList<qsizetype> &starts,
+                     const QByteArray &definitions);
+
     // Instance handlers
     int enterBlock(MD_BLOCKTYPE type, void *detail);
     int leaveBlock(MD_BLOCKTYPE type, void *detail);
@@ -59,13 +106,17 @@ private:
     // Helpers
     QString extractAttribute(const MD_ATTRIBUTE &attr);
     QString resolveEntity(const QString &entity);
-    QString processTypography(const QString &text) const;
 
-    // Style resolution
-    Content::TextStyle resolveTextStyle(const QString &paraStyleName) const;
-    Content::TextStyle resolveCharStyle(const QString &charStyleName) const;
-    Content::ParagraphFormat resolveParagraphFormat(const QString &styleName) const;
-    Content::TextStyle defaultTextStyle() const;
+    // Slices of m_textBuffer
+    qsizetype utf16Offset(qsizetype byteOffset);
+    Content::TextSlice sourceText(const char *text, qsizetype size);
+    void applyTypography(Content::TextSlice &slice) const;
+    void appendCodeText(const char *text, qsizetype size);
+
+    // Style references
+    int addStyleStep(Content::StyleStep::Kind kind, int parent,
+                     int level = 0, const QString &href = QString());
+    void pushStyleStep(Content::StyleStep::Kind kind, const QString &href = QString());
 
     // Inline node management
     void appendInlineNode(Content::InlineNode node);
@@ -80,6 +131,15 @@ private:
     QStack<BlockTracker> m_blockTrackers;
     QList<int> m_lineStartOffsets; // byte offset where each line starts
     const char *m_bufferStart = nullptr;
+    qsizetype m_bufferSize = 0;
+
+    // UTF-16 text the parsed buffer was encoded from; m_bufferStart
+    // corresponds to m_textBuffer[m_textBase]
+    QString m_textBuffer;
+    qsizetype m_textBase = 0;
+    qsizetype m_textBytes = 0;  // bytes of the buffer m_textBuffer covers
+    qsizetype m_utf8Cursor = 0;
+    qsizetype m_utf16Cursor = 0;
 
     // State
     Content::Document m_doc;
@@ -87,16 +147,15 @@ private:
     StyleManager *m_styleManager = nullptr;
     Hyphenator *m_hyphenator = nullptr;
     ShortWords *m_shortWords = nullptr;
+    bool m_parallelParse = true;
 
     // Current inline target stack (for nested blocks like blockquote > paragraph)
     QStack<QList<Content::InlineNode> *> m_inlineStack;
 
-    // Current style stack for spans
-    QStack<Content::TextStyle> m_styleStack;
-    Content::TextStyle m_currentStyle;
-
-    // Link tracking (href flows through TextStyle on each TextRun inside the span)
-    QString m_linkHref;
+    // Current style stack for spans, as indices into m_doc.styleSteps
+    QStack<int> m_styleStack;
+    int m_currentStyle = -1;
+    QHash<Content::StyleStep, int> m_styleStepIndex;
 
     // Block routing: adds a completed block to the correct container
     // (blockquote stack > list stack > doc.blocks)
@@ -108,7 +167,10 @@ private:
     bool m_inCodeBlock = false;
     bool m_codeFenced = true;
     QString m_codeLanguage;
-    QString m_codeText;
+    QString m_codeText;     // once the code is no longer one source range
+    qsizetype m_codeStart = -1; // byte range of the code so far
+    qsizetype m_codeEnd = -1;
+    bool m_codeOwned = false;
 
     // List tracking
     struct ListInfo {
@@ -139,6 +201,7 @@ private:
         QString text;
     };
     QList<ParsedFootnote> m_footnotes;
+    QList<FootnoteReference> m_footnoteRefs; // by UTF-8 offset
     FootnoteStyle m_footnoteStyle;
 
     QString m_processedMarkdown;
@@ -2,7 +2,13 @@
  * contentmodel.h — Content node types (header-only, std::variant)
  *
  * Defines the intermediate representation between Markdown parsing
- * and the layout engine. All style information is resolved at build time.
+ * and the layout engine.  The parser records where each node's style
+ * comes from (styleRef / styleName); StyleBinder resolves those against
+ * a StyleManager into the TextStyle / ParagraphFormat fields, so one
+ * parse can be bound to any number of themes.
+ *
+ * Node text is a TextSlice: a range of one buffer shared by the whole
+ * document (the processed markdown) rather than a string per node.
  *
  * NOTE: Qt GUI headers (QColor, QImage) must be included BEFORE
  * opening the Content namespace to avoid ADL issues with Qt6 macros.
@@ -14,10 +20,12 @@
 #define PRETTYREADER_CONTENTMODEL_H
 
 #include <QColor>
+#include <QHash>
 #include <QList>
 #include <QMarginsF>
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 #include <Qt>
 
 #include <variant>
@@ -31,6 +39,34 @@ struct SourceRange {
     int endLine = -1;    // 1-based line in markdown source
 };
 
+// --- Colour slots ---
+
+// Where a bound colour was resolved from.  Colours carry their slot into
+// the laid out boxes, so a colour-only theme edit resolves the slots again
+// (StyleBinder::colorSlots()) and recolours the boxes in place
+// (Layout::recolor()) instead of binding and laying out again.  Builder,
+// layout and syntax highlighting fallbacks are Fixed: no style edit
+// changes them.
+namespace ColorSlot {
+enum : int {
+    Fixed = -1,
+    CodeBlockText,
+    CodeBlockBackground,
+    TableHeaderText,
+    TableBodyText,
+    TableHeaderBackground,
+    TableBodyBackground,
+    TableAlternateRow,
+    TableBorder,
+    TableInnerBorder,
+    TableHeaderBottomBorder,
+    FirstStep, // two per Document::styleSteps entry, see below
+};
+
+inline int stepForeground(int styleRef) { return styleRef < 0 ? Fixed : FirstStep + 2 * styleRef; }
+inline int stepBackground(int styleRef) { return styleRef < 0 ? Fixed : FirstStep + 2 * styleRef + 1; }
+} // namespace ColorSlot
+
 // --- Style structs ---
 
 struct TextStyle {
@@ -47,6 +83,8 @@ struct TextStyle {
     bool subscript = false;
     QStringList fontFeatures;   // e.g. {"liga", "kern", "onum"}
     QString linkHref;           // non-empty when this run is inside <a href="...">
+    int foregroundSlot = ColorSlot::Fixed;
+    int backgroundSlot = ColorSlot::Fixed;
 };
 
 struct ParagraphFormat {
@@ -61,23 +99,145 @@ struct ParagraphFormat {
     int headingLevel = 0;       // 0 = not a heading, 1-6
 };
 
+// --- Style references ---
+
+// One step of a run's style derivation, applied to the style of the
+// step at index @c parent in Document::styleSteps (parents always come
+// first).  Mirrors the context the parser saw: the paragraph kind that
+// set the base style and the spans nested inside it.
+struct StyleStep {
+    enum Kind {
+        DocumentDefault,  // "Default Paragraph Style"; no parent
+        BodyText,
+        BlockQuoteText,
+        ListItemText,
+        HeadingText,      // level = heading level
+        TableCellText,    // level = 1 for header cells
+        Emphasis,
+        Strong,
+        Strikethrough,
+        Underline,
+        InlineCode,
+        Link,             // href
+    };
+    Kind kind = DocumentDefault;
+    int parent = -1;
+    int level = 0;
+    QString href;
+
+    bool operator==(const StyleStep &o) const {
+        return kind == o.kind && parent == o.parent && level == o.level && href == o.href;
+    }
+    friend size_t qHash(const StyleStep &s, size_t seed = 0) {
+        return qHashMulti(seed, int(s.kind), s.parent, s.level, s.href);
+    }
+};
+
+// --- Text ---
+
+// Characters [offset, offset + length) of a shared buffer, with sparse
+// edits on top: the typography pass only inserts soft hyphens and swaps
+// single characters (non-breaking spaces), so those are recorded instead
+// of a rewritten copy.  Made from a QString, a slice owns that string;
+// copies share the buffer either way.
+class TextSlice
+{
+public:
+    struct Edit {
+        qsizetype position = 0; // source index within the slice
+        QChar ch;
+        bool insert = false;    // before position; else replaces it
+    };
+
+    TextSlice() = default;
+    TextSlice(const QString &text) : m_buffer(text), m_length(text.size()) {}
+    TextSlice(const QString &buffer, qsizetype offset, qsizetype length)
+        : m_buffer(buffer), m_offset(offset), m_length(length) {}
+
+    bool isEmpty() const { return size() == 0; }
+    qsizetype size() const { return m_length + m_insertions; }
+
+    // The buffer characters, edits not applied
+    QStringView source() const { return QStringView(m_buffer).mid(m_offset, m_length); }
+
+    const QList<Edit> &edits() const { return m_edits; }
+    void setEdits(QList<Edit> edits) {
+        m_edits = std::move(edits);
+        m_insertions = 0;
+        for (const Edit &e : std::as_const(m_edits))
+            m_insertions += e.insert ? 1 : 0;
+    }
+
+    // Calls @p f with every character of the edited text in order
+    template<typename F>
+    void forEachChar(F f) const {
+        const QStringView src = source();
+        qsizetype pos = 0;
+        for (const Edit &e : m_edits) {
+            for (; pos < e.position; ++pos)
+                f(src[pos]);
+            f(e.ch);
+            if (!e.insert)
+                ++pos;
+        }
+        for (; pos < src.size(); ++pos)
+            f(src[pos]);
+    }
+
+    void appendTo(QString &out) const {
+        if (m_edits.isEmpty()) {
+            out.append(source());
+            return;
+        }
+        out.reserve(out.size() + size());
+        forEachChar([&out](QChar c) { out.append(c); });
+    }
+
+    QString toString() const {
+        if (m_edits.isEmpty() && m_offset == 0 && m_length == m_buffer.size())
+            return m_buffer;
+        QString s;
+        appendTo(s);
+        return s;
+    }
+
+    // Characters [pos, pos + n) of the edited text; n < 0 = to the end
+    TextSlice mid(qsizetype pos, qsizetype n = -1) const {
+        if (n < 0 || pos + n > size())
+            n = size() - pos;
+        if (m_edits.isEmpty())
+            return TextSlice(m_buffer, m_offset + pos, n);
+        return TextSlice(toString().mid(pos, n));
+    }
+
+private:
+    QString m_buffer;
+    qsizetype m_offset = 0;
+    qsizetype m_length = 0;
+    qsizetype m_insertions = 0;
+    QList<Edit> m_edits; // by position, insertions before a replacement
+};
+
 // --- Inline nodes ---
 
 struct TextRun {
-    QString text;
+    TextSlice text;
     TextStyle style;
+    int styleRef = -1;  // index into Document::styleSteps
 };
 
 struct InlineCode {
-    QString text;
+    TextSlice text;
     TextStyle style;
+    int styleRef = -1;  // index into Document::styleSteps
 };
 
 struct Link {
     QString href;
     QString tooltip;
-    QString text;   // display text (flattened from children)
+    TextSlice text; // display text (flattened from children)
     TextStyle style;
+    int styleRef = -1;
 };
 
 struct InlineImage {
@@ -92,6 +252,7 @@ struct FootnoteRef {
     int index = 0;
     QString label;
     TextStyle style;
+    int styleRef = -1;
 };
 
 struct SoftBreak {};
@@ -114,6 +275,8 @@ struct Paragraph {
     ParagraphFormat format;
     QList<InlineNode> inlines;
     SourceRange source;
+    QString styleName;  // paragraph style the format is bound from
+    int quoteLevel = 0; // enclosing blockquote depth at parse time
 };
 
 struct Heading {
@@ -125,7 +288,7 @@ struct Heading {
 
 struct CodeBlock {
     QString language;
-    QString code;
+    TextSlice code;
     TextStyle style;
     QColor background = QColor(0xf6, 0xf8, 0xfa);
     qreal padding = 8.0;
@@ -173,6 +336,7 @@ struct TableCell {
     Qt::Alignment alignment = Qt::AlignLeft;
     bool isHeader = false;
     QColor background;
+    int backgroundSlot = ColorSlot::Fixed;
     TextStyle style;
 };
 
@@ -218,12 +382,26 @@ struct FootnoteSection {
     QList<Footnote> footnotes;
     bool showSeparator = true;
     qreal separatorLength = 0.33; // fraction of page width
+    int styleRef = -1;            // style the note styles derive from
 };
 
 // --- Document ---
 
 struct Document {
     QList<BlockNode> blocks;
+    QList<StyleStep> styleSteps;
+};
+
+// How a re-parsed document relates to the one it was re-parsed from (see
+// ContentBuilder::reparse()): its first @c leading and last @c trailing
+// top-level blocks are unchanged, the trailing ones moved by @c lineDelta
+// source lines.  The blocks in between are new.
+struct Splice {
+    int leading = 0;
+    int trailing = 0;
+    int lineDelta = 0;
+
+    bool isEmpty() const { return leading == 0 && trailing == 0; }
 };
 
 } // namespace Content
@@ -42,6 +42,10 @@ struct PdfExportOptions {
 
     enum PageLayout { SinglePage, Continuous, FacingPages, FacingPagesFirstAlone };
     PageLayout pageLayout = Continuous;
+
+    // Output — reproducible builds: no wall-clock /CreationDate (taken from
+    // SOURCE_DATE_EPOCH when set), so identical input gives identical bytes
+    bool reproducible = false;
 };
 
 #endif // PRETTYREADER_PDFEXPORTOPTIONS_H
@@ -0,0 +1,527 @@
+/*
+ * stylebinder.cpp — Bind resolved styles onto a parsed Content::Document
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stylebinder.h"
+#include "stylemanager.h"
+#include "paragraphstyle.h"
+#include "characterstyle.h"
+#include "fontfeatures.h"
+#include "tablestyle.h"
+
+#include <functional>
+
+StyleBinder::StyleBinder(StyleManager *styleManager, const FootnoteStyle &footnoteStyle)
+    : m_styleManager(styleManager)
+    , m_footnoteStyle(footnoteStyle)
+{
+}
+
+// --- Style resolution helpers ---
+
+Content::TextStyle StyleBinder::defaultTextStyle() const
+{
+    Content::TextStyle s;
+    s.fontFamily = QStringLiteral("Noto Serif");
+    s.fontSize = 11.0;
+    s.fontWeight = 400;
+    s.italic = false;
+    s.foreground = QColor(0x1a, 0x1a, 0x1a);
+    return s;
+}
+
+Content::TextStyle StyleBinder::resolveTextStyle(const QString &paraStyleName) const
+{
+    Content::TextStyle s = defaultTextStyle();
+    if (!m_styleManager)
+        return s;
+    ParagraphStyle ps = m_styleManager->resolvedParagraphStyle(paraStyleName);
+    if (ps.hasFontFamily()) s.fontFamily = ps.fontFamily();
+    if (ps.hasFontSize()) s.fontSize = ps.fontSize();
+    if (ps.hasFontWeight()) s.fontWeight = static_cast<int>(ps.fontWeight());
+    if (ps.hasFontItalic()) s.italic = ps.fontItalic();
+    if (ps.hasForeground()) s.foreground = ps.foreground();
+    if (ps.hasFontFeatures()) {
+        s.fontFeatures = FontFeatures::toStringList(ps.fontFeatures());
+    }
+    return s;
+}
+
+Content::TextStyle StyleBinder::resolveCharStyle(const QString &charStyleName,
+                                                 const Content::TextStyle &inherited) const
+{
+    Content::TextStyle s = inherited;
+    if (!m_styleManager)
+        return s;
+    CharacterStyle cs = m_styleManager->resolvedCharacterStyle(charStyleName);
+    if (cs.hasFontFamily()) s.fontFamily = cs.fontFamily();
+    if (cs.hasFontSize()) s.fontSize = cs.fontSize();
+    if (cs.hasFontWeight()) s.fontWeight = static_cast<int>(cs.fontWeight());
+    if (cs.hasFontItalic()) s.italic = cs.fontItalic();
+    if (cs.hasFontUnderline()) s.underline = cs.fontUnderline();
+    if (cs.hasFontStrikeOut()) s.strikethrough = cs.fontStrikeOut();
+    if (cs.hasForeground()) s.foreground = cs.foreground();
+    if (cs.hasBackground()) s.background = cs.background();
+    if (cs.hasLetterSpacing()) s.letterSpacing = cs.letterSpacing();
+    if (cs.hasFontFeatures()) {
+        s.fontFeatures = FontFeatures::toStringList(cs.fontFeatures());
+    }
+    return s;
+}
+
+Content::ParagraphFormat StyleBinder::resolveParagraphFormat(const QString &styleName) const
+{
+    Content::ParagraphFormat f;
+    if (!m_styleManager)
+        return f;
+    ParagraphStyle ps = m_styleManager->resolvedParagraphStyle(styleName);
+    if (ps.hasAlignment()) f.alignment = ps.alignment();
+    if (ps.hasSpaceBefore()) f.spaceBefore = ps.spaceBefore();
+    if (ps.hasSpaceAfter()) f.spaceAfter = ps.spaceAfter();
+    if (ps.hasLeftMargin()) f.leftMargin = ps.leftMargin();
+    if (ps.hasRightMargin()) f.rightMargin = ps.rightMargin();
+    if (ps.hasFirstLineIndent()) f.firstLineIndent = ps.firstLineIndent();
+    if (ps.hasLineHeight()) f.lineHeightPercent = ps.lineHeightPercent();
+    if (ps.hasBackground()) f.background = ps.background();
+    f.headingLevel = ps.headingLevel();
+    return f;
+}
+
+Content::TextStyle StyleBinder::cellTextStyle(bool header, QColor *background) const
+{
+    Content::TextStyle style;
+    *background = QColor();
+    if (m_styleManager) {
+        TableStyle *ts = m_styleManager->tableStyle(QStringLiteral("Default"));
+        if (ts) {
+            if (header) {
+                style = resolveTextStyle(ts->headerParagraphStyle());
+                style.fontWeight = 700;
+                if (ts->hasHeaderBackground())
+                    *background = ts->headerBackground();
+                else
+                    *background = QColor(0xf0, 0xf0, 0xf0);
+                if (ts->hasHeaderForeground())
+                    style.foreground = ts->headerForeground();
+            } else {
+                style = resolveTextStyle(ts->bodyParagraphStyle());
+                // Body cell backgrounds handled by layout engine
+                // (applies bodyBackground + alternating row colors)
+            }
+        }
+    } else if (header) {
+        *background = QColor(0xf0, 0xf0, 0xf0);
+        style.fontWeight = 700;
+    }
+    return style;
+}
+
+Content::TextStyle StyleBinder::codeBlockStyle(QColor *background) const
+{
+    Content::TextStyle style;
+    *background = Content::CodeBlock().background;
+    if (m_styleManager) {
+        style = resolveTextStyle(QStringLiteral("CodeBlock"));
+        ParagraphStyle ps = m_styleManager->resolvedParagraphStyle(QStringLiteral("CodeBlock"));
+        if (ps.hasBackground())
+            *background = ps.background();
+    } else {
+        style.fontFamily = QStringLiteral("JetBrains Mono");
+        style.fontSize = 10.0;
+    }
+    style.foregroundSlot = Content::ColorSlot::CodeBlockText;
+    return style;
+}
+
+void StyleBinder::bindTableColors(Content::Table &table) const
+{
+    const Content::Table defaults;
+    table.headerBackground = defaults.headerBackground;
+    table.headerForeground = defaults.headerForeground;
+    table.bodyBackground = defaults.bodyBackground;
+    table.alternateRowColor = defaults.alternateRowColor;
+    table.cellPadding = defaults.cellPadding;
+    table.borderWidth = defaults.borderWidth;
+    table.borderColor = defaults.borderColor;
+    table.innerBorderWidth = defaults.innerBorderWidth;
+    table.innerBorderColor = defaults.innerBorderColor;
+    table.headerBottomBorderWidth = defaults.headerBottomBorderWidth;
+    table.headerBottomBorderColor = defaults.headerBottomBorderColor;
+
+    TableStyle *ts = m_styleManager
+        ? m_styleManager->tableStyle(QStringLiteral("Default")) : nullptr;
+    if (!ts)
+        return;
+    if (ts->hasHeaderBackground()) table.headerBackground = ts->headerBackground();
+    if (ts->hasHeaderForeground()) table.headerForeground = ts->headerForeground();
+    if (ts->hasBodyBackground()) table.bodyBackground = ts->bodyBackground();
+    if (ts->hasAlternateRowColor()) table.alternateRowColor = ts->alternateRowColor();
+    table.cellPadding = ts->cellPadding().top();
+    if (ts->hasOuterBorder()) {
+        table.borderWidth = ts->outerBorder().width;
+        table.borderColor = ts->outerBorder().color;
+    }
+    if (ts->hasInnerBorder()) {
+        table.innerBorderWidth = ts->innerBorder().width;
+        table.innerBorderColor = ts->innerBorder().color;
+    }
+    if (ts->hasHeaderBottomBorder()) {
+        table.headerBottomBorderWidth = ts->headerBottomBorder().width;
+        table.headerBottomBorderColor = ts->headerBottomBorder().color;
+    }
+}
+
+// --- Style steps ---
+
+Content::TextStyle StyleBinder::styleFor(int styleRef) const
+{
+    if (styleRef >= 0 && styleRef < m_styles.size())
+        return m_styles[styleRef];
+    return defaultTextStyle();
+}
+
+Content::TextStyle StyleBinder::resolveStep(const Content::StyleStep &step) const
+{
+    using Step = Content::StyleStep;
+
+    Content::TextStyle s = styleFor(step.parent);
+    switch (step.kind) {
+    case Step::DocumentDefault:
+        if (m_styleManager)
+            return resolveTextStyle(QStringLiteral("Default Paragraph Style"));
+        return defaultTextStyle();
+
+    case Step::BodyText:
+        if (m_styleManager)
+            return resolveTextStyle(QStringLiteral("BodyText"));
+        return s;
+
+    case Step::BlockQuoteText:
+        if (m_styleManager)
+            return resolveTextStyle(QStringLiteral("BlockQuote"));
+        s.italic = true;
+        s.foreground = QColor(0x55, 0x55, 0x55);
+        return s;
+
+    case Step::ListItemText:
+        if (m_styleManager)
+            return resolveTextStyle(QStringLiteral("ListItem"));
+        return s;
+
+    case Step::HeadingText: {
+        if (m_styleManager)
+            return resolveTextStyle(QStringLiteral("Heading%1").arg(step.level));
+        static const qreal sizes[] = {0, 28, 24, 20, 16, 14, 12};
+        const int level = qBound(1, step.level, 6);
+        s.fontFamily = QStringLiteral("Noto Sans");
+        s.fontWeight = 700;
+        s.fontSize = sizes[level];
+        if (level == 6) s.italic = true;
+        return s;
+    }
+
+    case Step::TableCellText:
+        s = step.level ? m_headerCellStyle : m_bodyCellStyle;
+        return s.fontFamily.isEmpty() ? defaultTextStyle() : s;
+
+    case Step::Emphasis:
+        s.italic = true;
+        return s;
+
+    case Step::Strong:
+        s.fontWeight = 700;
+        return s;
+
+    case Step::Strikethrough:
+        s.strikethrough = true;
+        return s;
+
+    case Step::Underline:
+        s.underline = true;
+        return s;
+
+    case Step::InlineCode:
+        if (m_styleManager)
+            return resolveCharStyle(QStringLiteral("InlineCode"), s);
+        s.fontFamily = QStringLiteral("JetBrains Mono");
+        s.fontSize = 10.0;
+        s.foreground = QColor(0xc7, 0x25, 0x4e);
+        s.background = QColor(0xf0, 0xf0, 0xf0);
+        return s;
+
+    case Step::Link:
+        if (m_styleManager) {
+            s = resolveCharStyle(QStringLiteral("Link"), s);
+        } else {
+            s.foreground = QColor(0x03, 0x66, 0xd6);
+            s.underline = true;
+        }
+        s.linkHref = step.href;
+        return s;
+    }
+    return s;
+}
+
+// --- Binding ---
+
+void StyleBinder::resolveStyles(const Content::Document &doc)
+{
+    m_headerCellStyle = cellTextStyle(true, &m_headerCellBackground);
+    m_headerCellStyle.foregroundSlot = Content::ColorSlot::TableHeaderText;
+    m_bodyCellStyle = cellTextStyle(false, &m_bodyCellBackground);
+    m_bodyCellStyle.foregroundSlot = Content::ColorSlot::TableBodyText;
+
+    // Steps only refer back to earlier steps: one forward pass resolves
+    // each distinct style once, however many runs share it.
+    m_styles.clear();
+    m_styles.reserve(doc.styleSteps.size());
+    for (const Content::StyleStep &step : std::as_const(doc.styleSteps)) {
+        Content::TextStyle style = resolveStep(step);
+        style.foregroundSlot = Content::ColorSlot::stepForeground(m_styles.size());
+        style.backgroundSlot = Content::ColorSlot::stepBackground(m_styles.size());
+        m_styles.append(style);
+    }
+}
+
+void StyleBinder::bind(Content::Document &doc)
+{
+    resolveStyles(doc);
+    for (Content::BlockNode &block : doc.blocks)
+        bindBlock(block);
+    m_styles.clear();
+}
+
+QList<QColor> StyleBinder::colorSlots(const Content::Document &doc)
+{
+    using namespace Content::ColorSlot;
+
+    resolveStyles(doc);
+    QList<QColor> colors(FirstStep + 2 * m_styles.size());
+
+    QColor codeBackground;
+    colors[CodeBlockText] = codeBlockStyle(&codeBackground).foreground;
+    colors[CodeBlockBackground] = codeBackground;
+
+    Content::Table table;
+    bindTableColors(table);
+    colors[TableHeaderText] = m_headerCellStyle.foreground;
+    colors[TableBodyText] = m_bodyCellStyle.foreground;
+    colors[TableHeaderBackground] = m_headerCellBackground;
+    colors[TableBodyBackground] = table.bodyBackground;
+    colors[TableAlternateRow] = table.alternateRowColor;
+    colors[TableBorder] = table.borderColor;
+    colors[TableInnerBorder] = table.innerBorderColor;
+    colors[TableHeaderBottomBorder] = table.headerBottomBorderColor;
+
+    for (int i = 0; i < m_styles.size(); ++i) {
+        colors[stepForeground(i)] = m_styles[i].foreground;
+        colors[stepBackground(i)] = m_styles[i].background;
+    }
+    m_styles.clear();
+    return colors;
+}
+
+QSet<QString> StyleBinder::stylesRead(const Content::Document &doc,
+                                      const Content::BlockNode &block) const
+{
+    using Step = Content::StyleStep;
+
+    QSet<QString> names;
+    auto addTable = [&]() {
+        names.insert(QStringLiteral("Default"));
+        if (TableStyle *ts = m_styleManager
+                ? m_styleManager->tableStyle(QStringLiteral("Default")) : nullptr) {
+            names.insert(ts->headerParagraphStyle());
+            names.insert(ts->bodyParagraphStyle());
+        }
+    };
+    // Every step of the derivation, not only the ones that resolve a
+    // style by name: over-reporting only costs a relayout
+    auto addRef = [&](int styleRef) {
+        for (int i = styleRef; i >= 0 && i < doc.styleSteps.size(); i = doc.styleSteps[i].parent) {
+            const Step &step = doc.styleSteps[i];
+            switch (step.kind) {
+            case Step::DocumentDefault:
+                names.insert(QStringLiteral("Default Paragraph Style"));
+                break;
+            case Step::BodyText:
+                names.insert(QStringLiteral("BodyText"));
+                break;
+            case Step::BlockQuoteText:
+                names.insert(QStringLiteral("BlockQuote"));
+                break;
+            case Step::ListItemText:
+                names.insert(QStringLiteral("ListItem"));
+                break;
+            case Step::HeadingText:
+                names.insert(QStringLiteral("Heading%1").arg(step.level));
+                break;
+            case Step::TableCellText:
+                addTable();
+                break;
+            case Step::InlineCode:
+                names.insert(QStringLiteral("InlineCode"));
+                break;
+            case Step::Link:
+                names.insert(QStringLiteral("Link"));
+                break;
+            case Step::Emphasis:
+            case Step::Strong:
+            case Step::Strikethrough:
+            case Step::Underline:
+                break;
+            }
+        }
+    };
+    auto addInlines = [&](const QList<Content::InlineNode> &inlines) {
+        for (const Content::InlineNode &node : inlines) {
+            std::visit([&](const auto &n) {
+                using T = std::decay_t<decltype(n)>;
+                if constexpr (std::is_same_v<T, Content::TextRun>
+                              || std::is_same_v<T, Content::InlineCode>
+                              || std::is_same_v<T, Content::Link>
+                              || std::is_same_v<T, Content::FootnoteRef>)
+                    addRef(n.styleRef);
+            }, node);
+        }
+    };
+    std::function<void(const Content::BlockNode &)> addBlock = [&](const Content::BlockNode &node) {
+        if (const auto *para = std::get_if<Content::Paragraph>(&node)) {
+            names.insert(para->styleName);
+            addInlines(para->inlines);
+        } else if (const auto *heading = std::get_if<Content::Heading>(&node)) {
+            names.insert(QStringLiteral("Heading%1").arg(qBound(1, heading->level, 6)));
+            addInlines(heading->inlines);
+        } else if (std::holds_alternative<Content::CodeBlock>(node)) {
+            names.insert(QStringLiteral("CodeBlock"));
+        } else if (const auto *bq = std::get_if<Content::BlockQuote>(&node)) {
+            names.insert(QStringLiteral("BlockQuote"));
+            for (const Content::BlockNode &child : bq->children)
+                addBlock(child);
+        } else if (const auto *list = std::get_if<Content::List>(&node)) {
+            for (const Content::ListItem &item : list->items) {
+                for (const Content::BlockNode &child : item.children)
+                    addBlock(child);
+            }
+        } else if (const auto *table = std::get_if<Content::Table>(&node)) {
+            addTable();
+            for (const Content::TableRow &row : table->rows) {
+                for (const Content::TableCell &cell : row.cells)
+                    addInlines(cell.inlines);
+            }
+        } else if (const auto *section = std::get_if<Content::FootnoteSection>(&node)) {
+            addRef(section->styleRef);
+            for (const Content::Footnote &fn : section->footnotes)
+                addInlines(fn.content);
+        }
+    };
+    addBlock(block);
+    names.remove(QString());
+    return names;
+}
+
+void StyleBinder::bindInlines(QList<Content::InlineNode> &inlines)
+{
+    for (Content::InlineNode &node : inlines) {
+        if (auto *run = std::get_if<Content::TextRun>(&node)) {
+            if (run->styleRef >= 0)
+                run->style = styleFor(run->styleRef);
+        } else if (auto *code = std::get_if<Content::InlineCode>(&node)) {
+            if (code->styleRef >= 0)
+                code->style = styleFor(code->styleRef);
+        } else if (auto *link = std::get_if<Content::Link>(&node)) {
+            if (link->styleRef >= 0)
+                link->style = styleFor(link->styleRef);
+        } else if (auto *ref = std::get_if<Content::FootnoteRef>(&node)) {
+            ref->label = m_footnoteStyle.formatNumber(m_footnoteStyle.startNumber + ref->index);
+            if (ref->styleRef >= 0) {
+                ref->style = styleFor(ref->styleRef);
+                ref->style.fontSize = 8.0;
+                ref->style.foreground = QColor(0x03, 0x66, 0xd6);
+                ref->style.foregroundSlot = Content::ColorSlot::Fixed;
+                ref->style.superscript = m_footnoteStyle.superscriptRef;
+            }
+        }
+    }
+}
+
+void StyleBinder::bindBlock(Content::BlockNode &block)
+{
+    if (auto *para = std::get_if<Content::Paragraph>(&block)) {
+        if (m_styleManager) {
+            para->format = para->styleName.isEmpty()
+                ? Content::ParagraphFormat()
+                : resolveParagraphFormat(para->styleName);
+        } else {
+            para->format = Content::ParagraphFormat();
+            if (para->styleName == QLatin1String("BlockQuote"))
+                para->format.leftMargin = 20.0 * para->quoteLevel;
+            else if (para->styleName == QLatin1String("BodyText"))
+                para->format.spaceAfter = 6.0;
+        }
+        bindInlines(para->inlines);
+    } else if (auto *heading = std::get_if<Content::Heading>(&block)) {
+        const int level = qBound(1, heading->level, 6);
+        if (m_styleManager) {
+            heading->format = resolveParagraphFormat(QStringLiteral("Heading%1").arg(level));
+        } else {
+            static const qreal spaceBefore[] = {0, 24, 20, 16, 12, 10, 8};
+            static const qreal spaceAfter[] = {0, 12, 10, 8, 6, 4, 4};
+            heading->format = Content::ParagraphFormat();
+            heading->format.spaceBefore = spaceBefore[level];
+            heading->format.spaceAfter = spaceAfter[level];
+        }
+        heading->format.headingLevel = heading->level;
+        bindInlines(heading->inlines);
+    } else if (auto *cb = std::get_if<Content::CodeBlock>(&block)) {
+        cb->style = codeBlockStyle(&cb->background);
+    } else if (auto *bq = std::get_if<Content::BlockQuote>(&block)) {
+        bq->format = m_styleManager ? resolveParagraphFormat(QStringLiteral("BlockQuote"))
+                                    : Content::ParagraphFormat();
+        for (Content::BlockNode &child : bq->children)
+            bindBlock(child);
+    } else if (auto *list = std::get_if<Content::List>(&block)) {
+        for (Content::ListItem &item : list->items) {
+            for (Content::BlockNode &child : item.children)
+                bindBlock(child);
+        }
+    } else if (auto *table = std::get_if<Content::Table>(&block)) {
+        bindTableColors(*table);
+
+        for (Content::TableRow &row : table->rows) {
+            for (Content::TableCell &cell : row.cells) {
+                cell.style = cell.isHeader ? m_headerCellStyle : m_bodyCellStyle;
+                cell.background = cell.isHeader ? m_headerCellBackground : m_bodyCellBackground;
+                // Body cells take their background at layout
+                cell.backgroundSlot = cell.isHeader ? Content::ColorSlot::TableHeaderBackground
+                                                    : Content::ColorSlot::Fixed;
+                bindInlines(cell.inlines);
+            }
+        }
+    } else if (auto *section = std::get_if<Content::FootnoteSection>(&block)) {
+        section->showSeparator = m_footnoteStyle.showSeparator;
+        section->separatorLength = m_footnoteStyle.separatorLength;
+        const Content::TextStyle base = styleFor(section->styleRef);
+        for (int i = 0; i < section->footnotes.size(); ++i) {
+            Content::Footnote &fn = section->footnotes[i];
+            fn.label = m_footnoteStyle.formatNumber(m_footnoteStyle.startNumber + i);
+
+            fn.numberStyle = base;
+            fn.numberStyle.fontSize = 8.0;
+            fn.numberStyle.foreground = QColor(0x03, 0x66, 0xd6);
+            fn.numberStyle.foregroundSlot = Content::ColorSlot::Fixed;
+            fn.numberStyle.superscript = m_footnoteStyle.superscriptNote;
+
+            fn.textStyle = base;
+            fn.textStyle.fontSize = 9.0;
+            fn.textStyle.foreground = QColor(0x55, 0x55, 0x55);
+            fn.textStyle.foregroundSlot = Content::ColorSlot::Fixed;
+
+            for (Content::InlineNode &node : fn.content) {
+                if (auto *run = std::get_if<Content::TextRun>(&node))
+                    run->style = fn.textStyle;
+            }
+        }
+    }
+}
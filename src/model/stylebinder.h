@@ -0,0 +1,77 @@
+/*
+ * stylebinder.h — Bind resolved styles onto a parsed Content::Document
+ *
+ * ContentBuilder::parse() produces a style-independent tree: every run
+ * carries a styleRef into Document::styleSteps and paragraphs carry the
+ * name of their paragraph style.  StyleBinder resolves those references
+ * against a StyleManager and fills in the TextStyle, ParagraphFormat and
+ * table/footnote styling, so a theme change re-binds a cached parse
+ * instead of re-running md4c, footnote extraction and hyphenation.
+ *
+ * Binding overwrites every style field, so the same tree may be bound
+ * again with different styles.  Bound colours record their
+ * Content::ColorSlot; colorSlots() resolves the slots alone, for
+ * recolouring a layout after a colour-only edit.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_STYLEBINDER_H
+#define PRETTYREADER_STYLEBINDER_H
+
+#include <QColor>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include "contentmodel.h"
+#include "footnotestyle.h"
+
+class StyleManager;
+
+class StyleBinder
+{
+public:
+    // A null StyleManager binds the built-in fallback styles.
+    explicit StyleBinder(StyleManager *styleManager,
+                         const FootnoteStyle &footnoteStyle = FootnoteStyle());
+
+    void bind(Content::Document &doc);
+
+    // Colour of every Content::ColorSlot of @p doc, as bind() would set it
+    QList<QColor> colorSlots(const Content::Document &doc);
+
+    // Names of the paragraph, character and table styles binding @p block
+    // reads, to tell which blocks a style edit reaches
+    QSet<QString> stylesRead(const Content::Document &doc,
+                             const Content::BlockNode &block) const;
+
+private:
+    void resolveStyles(const Content::Document &doc);
+    void bindBlock(Content::BlockNode &block);
+    void bindInlines(QList<Content::InlineNode> &inlines);
+    Content::TextStyle styleFor(int styleRef) const;
+    Content::TextStyle resolveStep(const Content::StyleStep &step) const;
+
+    // Style resolution
+    Content::TextStyle resolveTextStyle(const QString &paraStyleName) const;
+    Content::TextStyle resolveCharStyle(const QString &charStyleName,
+                                        const Content::TextStyle &inherited) const;
+    Content::ParagraphFormat resolveParagraphFormat(const QString &styleName) const;
+    Content::TextStyle defaultTextStyle() const;
+    Content::TextStyle cellTextStyle(bool header, QColor *background) const;
+    Content::TextStyle codeBlockStyle(QColor *background) const;
+    void bindTableColors(Content::Table &table) const;
+
+    StyleManager *m_styleManager = nullptr;
+    FootnoteStyle m_footnoteStyle;
+
+    // Per bind(): resolved styleSteps and table cell styles
+    QList<Content::TextStyle> m_styles;
+    Content::TextStyle m_headerCellStyle;
+    Content::TextStyle m_bodyCellStyle;
+    QColor m_headerCellBackground;
+    QColor m_bodyCellBackground;
+};
+
+#endif // PRETTYREADER_STYLEBINDER_H
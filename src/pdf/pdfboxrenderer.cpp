@@ -16,10 +16,10 @@
 
 namespace {
 
-QByteArray coord(qreal v) { return QByteArray::number(v, 'f', 2); }
+using Pdf::coord;
 
 struct OutlineCtx {
-    QByteArray *stream;
+    Pdf::Buffer *stream;
     qreal scale;
     qreal tx, ty;
     FT_Vector last;
@@ -27,16 +27,16 @@ struct OutlineCtx {
 
 int outlineMoveTo(const FT_Vector *to, void *user) {
     auto *c = static_cast<OutlineCtx *>(user);
-    *c->stream += coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " m\n";
+    *c->stream << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " m\n";
     c->last = *to;
     return 0;
 }
 
 int outlineLineTo(const FT_Vector *to, void *user) {
     auto *c = static_cast<OutlineCtx *>(user);
-    *c->stream += coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " l\n";
+    *c->stream << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " l\n";
     c->last = *to;
     return 0;
 }
@@ -47,24 +47,24 @@ int outlineConicTo(const FT_Vector *ctrl, const FT_Vector *to, void *user) {
     qreal cp1y = (c->last.y + 2.0 * ctrl->y) / 3.0;
     qreal cp2x = (to->x + 2.0 * ctrl->x) / 3.0;
     qreal cp2y = (to->y + 2.0 * ctrl->y) / 3.0;
-    *c->stream += coord(cp1x * c->scale + c->tx) + " "
-                + coord(cp1y * c->scale + c->ty) + " "
-                + coord(cp2x * c->scale + c->tx) + " "
-                + coord(cp2y * c->scale + c->ty) + " "
-                + coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " c\n";
+    *c->stream << coord(cp1x * c->scale + c->tx) << ' '
+               << coord(cp1y * c->scale + c->ty) << ' '
+               << coord(cp2x * c->scale + c->tx) << ' '
+               << coord(cp2y * c->scale + c->ty) << ' '
+               << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " c\n";
     c->last = *to;
     return 0;
 }
 
 int outlineCubicTo(const FT_Vector *c1, const FT_Vector *c2, const FT_Vector *to, void *user) {
     auto *c = static_cast<OutlineCtx *>(user);
-    *c->stream += coord(c1->x * c->scale + c->tx) + " "
-                + coord(c1->y * c->scale + c->ty) + " "
-                + coord(c2->x * c->scale + c->tx) + " "
-                + coord(c2->y * c->scale + c->ty) + " "
-                + coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " c\n";
+    *c->stream << coord(c1->x * c->scale + c->tx) << ' '
+               << coord(c1->y * c->scale + c->ty) << ' '
+               << coord(c2->x * c->scale + c->tx) << ' '
+               << coord(c2->y * c->scale + c->ty) << ' '
+               << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " c\n";
     c->last = *to;
     return 0;
 }
@@ -84,31 +84,13 @@ void PdfBoxRenderer::setContentOrigin(qreal originX, qreal contentTopY)
     m_contentTopY = contentTopY;
 }
 
-// --- PDF coordinate helpers ---
+// --- PDF helpers ---
 
-QByteArray PdfBoxRenderer::pdfCoord(qreal v)
+void PdfBoxRenderer::beginActualText(const QString &text)
 {
-    return QByteArray::number(v, 'f', 2);
-}
-
-QByteArray PdfBoxRenderer::colorOperator(const QColor &color, bool fill)
-{
-    if (!color.isValid())
-        return {};
-    qreal r = color.redF();
-    qreal g = color.greenF();
-    qreal b = color.blueF();
-    QByteArray op = fill ? " rg\n" : " RG\n";
-    return pdfCoord(r) + " " + pdfCoord(g) + " " + pdfCoord(b) + op;
-}
-
-QByteArray PdfBoxRenderer::toUtf16BeHex(const QString &text)
-{
-    QByteArray hex;
-    hex += "FEFF";
-    for (QChar ch : text)
-        hex += QByteArray::number(ch.unicode(), 16).toUpper().rightJustified(4, '0');
-    return hex;
+    *m_stream << "/Span <</ActualText <FEFF";
+    m_stream->appendUtf16Hex(text);
+    *m_stream << ">>> BDC\n";
 }
 
 // --- Drawing primitives ---
@@ -123,17 +105,17 @@ void PdfBoxRenderer::drawRect(const QRectF &rect, const QColor &fill,
     qreal pdfBottom = pdfY(rect.y()) - rect.height();
 
     if (fill.isValid()) {
-        *m_stream += "q\n" + colorOperator(fill, true);
-        *m_stream += pdfCoord(pdfLeft) + " " + pdfCoord(pdfBottom) + " "
-                + pdfCoord(rect.width()) + " " + pdfCoord(rect.height()) + " re f\n";
-        *m_stream += "Q\n";
+        *m_stream << "q\n" << Pdf::colorOp(fill, true);
+        *m_stream << Pdf::coord(pdfLeft) << ' ' << Pdf::coord(pdfBottom) << ' '
+                  << Pdf::coord(rect.width()) << ' ' << Pdf::coord(rect.height()) << " re f\n";
+        *m_stream << "Q\n";
     }
     if (stroke.isValid()) {
-        *m_stream += "q\n" + colorOperator(stroke, false);
-        *m_stream += pdfCoord(strokeWidth) + " w\n";
-        *m_stream += pdfCoord(pdfLeft) + " " + pdfCoord(pdfBottom) + " "
-                + pdfCoord(rect.width()) + " " + pdfCoord(rect.height()) + " re S\n";
-        *m_stream += "Q\n";
+        *m_stream << "q\n" << Pdf::colorOp(stroke, false);
+        *m_stream << Pdf::coord(strokeWidth) << " w\n";
+        *m_stream << Pdf::coord(pdfLeft) << ' ' << Pdf::coord(pdfBottom) << ' '
+                  << Pdf::coord(rect.width()) << ' ' << Pdf::coord(rect.height()) << " re S\n";
+        *m_stream << "Q\n";
     }
 }
 
@@ -150,47 +132,47 @@ void PdfBoxRenderer::drawRoundedRect(const QRectF &rect, qreal xRadius, qreal yR
     qreal h = rect.height();
     qreal r = qMin(xRadius, yRadius);
 
-    *m_stream += "q\n";
+    *m_stream << "q\n";
 
     if (stroke.isValid()) {
-        *m_stream += colorOperator(stroke, false);
-        *m_stream += pdfCoord(strokeWidth) + " w\n";
+        *m_stream << Pdf::colorOp(stroke, false);
+        *m_stream << Pdf::coord(strokeWidth) << " w\n";
     }
 
     // Rounded rectangle path (clockwise from bottom-left)
     // Bottom edge
-    *m_stream += pdfCoord(cx + r) + " " + pdfCoord(cy) + " m\n";
-    *m_stream += pdfCoord(cx + w - r) + " " + pdfCoord(cy) + " l\n";
+    *m_stream << Pdf::coord(cx + r) << ' ' << Pdf::coord(cy) << " m\n";
+    *m_stream << Pdf::coord(cx + w - r) << ' ' << Pdf::coord(cy) << " l\n";
     // Bottom-right corner
-    *m_stream += pdfCoord(cx + w) + " " + pdfCoord(cy) + " "
-            + pdfCoord(cx + w) + " " + pdfCoord(cy + r) + " v\n";
+    *m_stream << Pdf::coord(cx + w) << ' ' << Pdf::coord(cy) << ' '
+              << Pdf::coord(cx + w) << ' ' << Pdf::coord(cy + r) << " v\n";
     // Right edge
-    *m_stream += pdfCoord(cx + w) + " " + pdfCoord(cy + h - r) + " l\n";
+    *m_stream << Pdf::coord(cx + w) << ' ' << Pdf::coord(cy + h - r) << " l\n";
     // Top-right corner
-    *m_stream += pdfCoord(cx + w) + " " + pdfCoord(cy + h) + " "
-            + pdfCoord(cx + w - r) + " " + pdfCoord(cy + h) + " v\n";
+    *m_stream << Pdf::coord(cx + w) << ' ' << Pdf::coord(cy + h) << ' '
+              << Pdf::coord(cx + w - r) << ' ' << Pdf::coord(cy + h) << " v\n";
     // Top edge
-    *m_stream += pdfCoord(cx + r) + " " + pdfCoord(cy + h) + " l\n";
+    *m_stream << Pdf::coord(cx + r) << ' ' << Pdf::coord(cy + h) << " l\n";
     // Top-left corner
-    *m_stream += pdfCoord(cx) + " " + pdfCoord(cy + h) + " "
-            + pdfCoord(cx) + " " + pdfCoord(cy + h - r) + " v\n";
+    *m_stream << Pdf::coord(cx) << ' ' << Pdf::coord(cy + h) << ' '
+              << Pdf::coord(cx) << ' ' << Pdf::coord(cy + h - r) << " v\n";
     // Left edge
-    *m_stream += pdfCoord(cx) + " " + pdfCoord(cy + r) + " l\n";
+    *m_stream << Pdf::coord(cx) << ' ' << Pdf::coord(cy + r) << " l\n";
     // Bottom-left corner
-    *m_stream += pdfCoord(cx) + " " + pdfCoord(cy) + " "
-            + pdfCoord(cx + r) + " " + pdfCoord(cy) + " v\n";
+    *m_stream << Pdf::coord(cx) << ' ' << Pdf::coord(cy) << ' '
+              << Pdf::coord(cx + r) << ' ' << Pdf::coord(cy) << " v\n";
 
     if (fill.isValid() && stroke.isValid()) {
-        *m_stream += colorOperator(fill, true);
-        *m_stream += "B\n"; // fill + stroke
+        *m_stream << Pdf::colorOp(fill, true);
+        *m_stream << "B\n"; // fill + stroke
     } else if (fill.isValid()) {
-        *m_stream += colorOperator(fill, true);
-        *m_stream += "f\n";
+        *m_stream << Pdf::colorOp(fill, true);
+        *m_stream << "f\n";
     } else {
-        *m_stream += "S\n"; // stroke only
+        *m_stream << "S\n"; // stroke only
     }
 
-    *m_stream += "Q\n";
+    *m_stream << "Q\n";
 }
 
 void PdfBoxRenderer::drawLine(const QPointF &p1, const QPointF &p2,
@@ -198,11 +180,11 @@ void PdfBoxRenderer::drawLine(const QPointF &p1, const QPointF &p2,
 {
     if (!m_stream) return;
 
-    *m_stream += "q\n" + colorOperator(color, false);
-    *m_stream += pdfCoord(width) + " w\n";
-    *m_stream += pdfCoord(p1.x()) + " " + pdfCoord(pdfY(p1.y())) + " m "
-            + pdfCoord(p2.x()) + " " + pdfCoord(pdfY(p2.y())) + " l S\n";
-    *m_stream += "Q\n";
+    *m_stream << "q\n" << Pdf::colorOp(color, false);
+    *m_stream << Pdf::coord(width) << " w\n";
+    *m_stream << Pdf::coord(p1.x()) << ' ' << Pdf::coord(pdfY(p1.y())) << " m "
+              << Pdf::coord(p2.x()) << ' ' << Pdf::coord(pdfY(p2.y())) << " l S\n";
+    *m_stream << "Q\n";
 }
 
 void PdfBoxRenderer::drawPolyline(const QPolygonF &poly, const QColor &color,
@@ -211,26 +193,26 @@ void PdfBoxRenderer::drawPolyline(const QPolygonF &poly, const QColor &color,
 {
     if (!m_stream || poly.size() < 2) return;
 
-    *m_stream += "q\n";
-    *m_stream += colorOperator(color, false);
-    *m_stream += pdfCoord(width) + " w\n";
+    *m_stream << "q\n";
+    *m_stream << Pdf::colorOp(color, false);
+    *m_stream << Pdf::coord(width) << " w\n";
 
     // Map Qt cap/join to PDF
     int pdfCap = 0; // butt
     if (cap == Qt::RoundCap) pdfCap = 1;
     else if (cap == Qt::SquareCap) pdfCap = 2;
-    *m_stream += QByteArray::number(pdfCap) + " J\n";
+    *m_stream << pdfCap << " J\n";
 
     int pdfJoin = 0; // miter
     if (join == Qt::RoundJoin) pdfJoin = 1;
     else if (join == Qt::BevelJoin) pdfJoin = 2;
-    *m_stream += QByteArray::number(pdfJoin) + " j\n";
+    *m_stream << pdfJoin << " j\n";
 
-    *m_stream += pdfCoord(poly[0].x()) + " " + pdfCoord(pdfY(poly[0].y())) + " m\n";
+    *m_stream << Pdf::coord(poly[0].x()) << ' ' << Pdf::coord(pdfY(poly[0].y())) << " m\n";
     for (int i = 1; i < poly.size(); ++i)
-        *m_stream += pdfCoord(poly[i].x()) + " " + pdfCoord(pdfY(poly[i].y())) + " l\n";
-    *m_stream += "S\n";
-    *m_stream += "Q\n";
+        *m_stream << Pdf::coord(poly[i].x()) << ' ' << Pdf::coord(pdfY(poly[i].y())) << " l\n";
+    *m_stream << "S\n";
+    *m_stream << "Q\n";
 }
 
 void PdfBoxRenderer::drawCheckmark(const QPolygonF &poly, const QColor &color,
@@ -268,23 +250,23 @@ void PdfBoxRenderer::drawGlyphsCIDFont(FontFace *face, qreal fontSize,
     // Convert baselineY from layout to PDF
     qreal pdfBaseY = pdfY(baselineY);
 
-    *m_stream += "BT\n";
-    *m_stream += "/" + fontName + " " + pdfCoord(fontSize) + " Tf\n";
-    *m_stream += colorOperator(foreground, true);
+    *m_stream << "BT\n";
+    *m_stream << '/' << fontName << ' ' << Pdf::coord(fontSize) << " Tf\n";
+    *m_stream << Pdf::colorOp(foreground, true);
 
     for (int i = 0; i < info.glyphIds.size(); ++i) {
         qreal gx = x + info.positions[i].x();
         qreal gy = pdfBaseY - info.positions[i].y(); // layout yOffset is top-down
 
-        *m_stream += "1 0 0 1 " + pdfCoord(gx) + " " + pdfCoord(gy) + " Tm\n";
-        *m_stream += Pdf::toHexString16(static_cast<quint16>(info.glyphIds[i])) + " Tj\n";
+        *m_stream << "1 0 0 1 " << Pdf::coord(gx) << ' ' << Pdf::coord(gy) << " Tm\n";
+        m_stream->appendGlyph(static_cast<quint16>(info.glyphIds[i])) << " Tj\n";
 
         // Mark glyph used for subsetting
         if (m_markGlyphUsedCb)
             m_markGlyphUsedCb(face, info.glyphIds[i]);
     }
 
-    *m_stream += "ET\n";
+    *m_stream << "ET\n";
 }
 
 void PdfBoxRenderer::drawGlyphsAsPath(FontFace *face, qreal fontSize,
@@ -298,8 +280,8 @@ void PdfBoxRenderer::drawGlyphsAsPath(FontFace *face, qreal fontSize,
     qreal scale = fontSize / ftFace->units_per_EM;
     qreal pdfBaseY = pdfY(baselineY);
 
-    *m_stream += "q\n";
-    *m_stream += colorOperator(foreground, true);
+    *m_stream << "q\n";
+    *m_stream << Pdf::colorOp(foreground, true);
 
     FT_Outline_Funcs funcs = {};
     funcs.move_to = outlineMoveTo;
@@ -323,8 +305,8 @@ void PdfBoxRenderer::drawGlyphsAsPath(FontFace *face, qreal fontSize,
         }
     }
 
-    *m_stream += "f\n";
-    *m_stream += "Q\n";
+    *m_stream << "f\n";
+    *m_stream << "Q\n";
 }
 
 void PdfBoxRenderer::drawGlyphsAsXObject(FontFace *face, qreal fontSize,
@@ -339,18 +321,18 @@ void PdfBoxRenderer::drawGlyphsAsXObject(FontFace *face, qreal fontSize,
     qreal pdfBaseY = pdfY(baselineY);
 
     for (int i = 0; i < info.glyphIds.size(); ++i) {
-        auto entry = m_glyphFormCb(nullptr, face, info.glyphIds[i], false);
+        auto entry = m_glyphFormCb(face, info.glyphIds[i]);
         if (entry.objId == 0) continue;
 
         qreal gx = x + info.positions[i].x();
         qreal gy = pdfBaseY - info.positions[i].y();
 
-        *m_stream += "q\n";
-        *m_stream += colorOperator(foreground, true);
-        *m_stream += pdfCoord(scale) + " 0 0 " + pdfCoord(scale)
-                + " " + pdfCoord(gx) + " " + pdfCoord(gy) + " cm\n";
-        *m_stream += "/" + entry.pdfName + " Do\n";
-        *m_stream += "Q\n";
+        *m_stream << "q\n";
+        *m_stream << Pdf::colorOp(foreground, true);
+        *m_stream << Pdf::coord(scale) << " 0 0 " << Pdf::coord(scale)
+                  << ' ' << Pdf::coord(gx) << ' ' << Pdf::coord(gy) << " cm\n";
+        *m_stream << '/' << entry.pdfName << " Do\n";
+        *m_stream << "Q\n";
     }
 }
 
@@ -360,14 +342,15 @@ void PdfBoxRenderer::drawHersheyStrokes(const QVector<QVector<QPointF>> &strokes
                                           qreal strokeWidth)
 {
     // Fallback: draw inline stroke operators for Hershey glyphs.
-    // The primary Hershey path uses renderHersheyGlyphBox() override with
-    // XObject references. This fallback handles edge cases like trailing hyphens.
+    // Hershey text normally goes through the renderHersheyGlyphBox()
+    // override as Type 3 font runs; this is only reached from base-class
+    // paths that bypass it.
     if (!m_stream || strokes.isEmpty()) return;
 
-    *m_stream += "q\n";
-    *m_stream += colorOperator(foreground, false);
-    *m_stream += pdfCoord(strokeWidth) + " w\n";
-    *m_stream += "1 J 1 j\n"; // round cap & join
+    *m_stream << "q\n";
+    *m_stream << Pdf::colorOp(foreground, false);
+    *m_stream << Pdf::coord(strokeWidth) << " w\n";
+    *m_stream << "1 J 1 j\n"; // round cap & join
 
     for (const auto &stroke : strokes) {
         if (stroke.size() < 2) continue;
@@ -376,15 +359,15 @@ void PdfBoxRenderer::drawHersheyStrokes(const QVector<QVector<QPointF>> &strokes
         // to layout coordinates (with Y increasing downward). We still need
         // to flip Y for PDF.
         QPointF p0 = transform.map(stroke[0]);
-        *m_stream += pdfCoord(p0.x()) + " " + pdfCoord(pdfY(p0.y())) + " m\n";
+        *m_stream << Pdf::coord(p0.x()) << ' ' << Pdf::coord(pdfY(p0.y())) << " m\n";
         for (int i = 1; i < stroke.size(); ++i) {
             QPointF pt = transform.map(stroke[i]);
-            *m_stream += pdfCoord(pt.x()) + " " + pdfCoord(pdfY(pt.y())) + " l\n";
+            *m_stream << Pdf::coord(pt.x()) << ' ' << Pdf::coord(pdfY(pt.y())) << " l\n";
         }
-        *m_stream += "S\n";
+        *m_stream << "S\n";
     }
 
-    *m_stream += "Q\n";
+    *m_stream << "Q\n";
 }
 
 void PdfBoxRenderer::drawImage(const QRectF &destRect, const QImage &image)
@@ -399,13 +382,13 @@ void PdfBoxRenderer::drawImage(const QRectF &destRect, const QImage &image)
 void PdfBoxRenderer::pushState()
 {
     if (m_stream)
-        *m_stream += "q\n";
+        *m_stream << "q\n";
 }
 
 void PdfBoxRenderer::popState()
 {
     if (m_stream)
-        *m_stream += "Q\n";
+        *m_stream << "Q\n";
 }
 
 void PdfBoxRenderer::collectLink(const QRectF &rect, const QString &href)
@@ -441,17 +424,17 @@ void PdfBoxRenderer::renderBlockBox(const Layout::BlockBox &box)
         if (!box.codeLanguage.isEmpty())
             fence += box.codeLanguage;
         fence += QLatin1Char('\n');
-        *m_stream += "/Span <</ActualText <" + toUtf16BeHex(fence) + ">>> BDC\n";
+        beginActualText(fence);
         // Invisible text anchor at block top
         writeInvisibleAnchor(box.x, pdfY(box.y));
-        *m_stream += "EMC\n";
+        *m_stream << "EMC\n";
     }
 
     // Markdown copy: HRule gets "---\n\n" ActualText before visual rendering
     if (m_exportOptions.markdownCopy && box.type == Layout::BlockBox::HRuleBlock) {
-        *m_stream += "/Span <</ActualText <" + toUtf16BeHex(QStringLiteral("---\n\n")) + ">>> BDC\n";
+        beginActualText(QStringLiteral("---\n\n"));
         writeInvisibleAnchor(box.x, pdfY(box.y + box.height / 2));
-        *m_stream += "EMC\n";
+        *m_stream << "EMC\n";
     }
 
     // Delegate to base class for the actual visual rendering
@@ -469,10 +452,10 @@ void PdfBoxRenderer::renderBlockBox(const Layout::BlockBox &box)
             sep = QStringLiteral("\n");
         else
             sep = QStringLiteral("\n\n");
-        *m_stream += "/Span <</ActualText <" + toUtf16BeHex(sep) + ">>> BDC\n";
+        beginActualText(sep);
         if (isCodeBlock)
             writeInvisibleAnchor(box.x, pdfY(box.y + box.height));
-        *m_stream += "EMC\n";
+        *m_stream << "EMC\n";
     }
 }
 
@@ -492,16 +475,21 @@ void PdfBoxRenderer::renderLineBox(const Layout::LineBox &line,
 
     // --- Markdown copy mode ---
 
+    if (line.boxX.size() != line.glyphs.size()) {
+        // Not from Engine::layoutBlock(); resolve a copy
+        Layout::LineBox resolved = line;
+        Layout::resolveLinePositions(resolved, availWidth);
+        renderLineBox(resolved, originX, originY, availWidth);
+        return;
+    }
+
     qreal baselineY = originY + line.baseline;
     qreal pdfBaseY = pdfY(baselineY);
 
-    // Phase 1: compute x-positions
-    QList<qreal> glyphXPositions = computeGlyphXPositions(line, originX, availWidth);
-
     if (line.glyphs.isEmpty())
         return;
 
-    // Phase 2: build line ActualText
+    // Phase 1: build line ActualText
     QString lineText;
     for (int i = 0; i < line.glyphs.size(); ++i) {
         const auto &gbox = line.glyphs[i];
@@ -532,52 +520,50 @@ void PdfBoxRenderer::renderLineBox(const Layout::LineBox &line,
         lineText += QLatin1Char('\n');
     }
 
-    // Phase 3: emit BDC ActualText span
-    *m_stream += "/Span <</ActualText <" + toUtf16BeHex(lineText) + ">>> BDC\n";
+    // Phase 2: emit BDC ActualText span
+    beginActualText(lineText);
 
-    // Phase 4: invisible text overlay (per-glyph Tm matching visual positions)
-    *m_stream += "BT\n";
-    *m_stream += "3 Tr\n";
+    // Phase 3: invisible text overlay (per-glyph Tm matching visual positions).
+    // Hershey boxes are skipped: their visible Type 3 text is real text.
+    bool overlayOpen = false;
     for (int i = 0; i < line.glyphs.size(); ++i) {
         const auto &gbox = line.glyphs[i];
-        if (gbox.glyphs.isEmpty() || !gbox.font)
+        if (gbox.glyphs.isEmpty() || !gbox.font || gbox.font->isHershey)
             continue;
         QByteArray fontName;
-        if (gbox.font->isHershey || xobjectGlyphs)
+        if (xobjectGlyphs || m_hasHersheyGlyphs)
             fontName = "HvInv";
         else if (m_pdfFontNameCb)
             fontName = m_pdfFontNameCb(gbox.font);
         else
             continue;
-        *m_stream += "/" + fontName + " " + pdfCoord(gbox.fontSize) + " Tf\n";
-        qreal curX = glyphXPositions[i];
-        for (const auto &g : gbox.glyphs) {
-            qreal px = curX + g.xOffset;
-            qreal py = pdfBaseY + g.yOffset; // PDF: yOffset goes up
-            if (gbox.style.superscript)
-                py += gbox.fontSize * RenderConstants::kSuperscriptRise;
-            else if (gbox.style.subscript)
-                py -= gbox.fontSize * RenderConstants::kSubscriptDrop;
-            *m_stream += "1 0 0 1 " + pdfCoord(px) + " " + pdfCoord(py) + " Tm\n";
-            *m_stream += Pdf::toHexString16(static_cast<quint16>(g.glyphId)) + " Tj\n";
-            curX += g.xAdvance;
+        if (!overlayOpen) {
+            *m_stream << "BT\n3 Tr\n";
+            overlayOpen = true;
+        }
+        *m_stream << '/' << fontName << ' ' << Pdf::coord(gbox.fontSize) << " Tf\n";
+        const qreal boxX = originX + line.boxX[i];
+        for (int gi = 0; gi < gbox.run.glyphIds.size(); ++gi) {
+            const QPointF pos = gbox.run.positions[gi];
+            qreal px = boxX + pos.x();
+            qreal py = pdfBaseY - pos.y(); // run y is top-down
+            *m_stream << "1 0 0 1 " << Pdf::coord(px) << ' ' << Pdf::coord(py) << " Tm\n";
+            m_stream->appendGlyph(static_cast<quint16>(gbox.run.glyphIds[gi])) << " Tj\n";
         }
     }
-    *m_stream += "0 Tr\n";
-    *m_stream += "ET\n";
-    *m_stream += "EMC\n";
+    if (overlayOpen)
+        *m_stream << "0 Tr\nET\n";
 
-    // Phase 5: render visible glyphs at computed positions
+    // Phase 4: render visible glyphs at their resolved positions.  Inside
+    // the span, so Hershey text is replaced by the ActualText when copied.
     for (int i = 0; i < line.glyphs.size(); ++i)
-        renderGlyphBox(line.glyphs[i], glyphXPositions[i], baselineY);
+        renderGlyphBox(line.glyphs[i], originX + line.boxX[i], baselineY);
 
-    // Phase 6: trailing soft-hyphen
-    qreal x = glyphXPositions.isEmpty() ? originX
-        : glyphXPositions.last() + line.glyphs.last().width;
+    // Phase 5: trailing soft-hyphen
+    if (line.showTrailingHyphen)
+        renderTrailingHyphen(line.glyphs.last(), originX + line.hyphenX, baselineY);
 
-    if (line.showTrailingHyphen && !line.glyphs.isEmpty()) {
-        renderTrailingHyphen(line.glyphs.last(), x, baselineY);
-    }
+    *m_stream << "EMC\n";
 }
 
 void PdfBoxRenderer::renderImageBlock(const Layout::BlockBox &box)
@@ -593,12 +579,12 @@ void PdfBoxRenderer::renderImageBlock(const Layout::BlockBox &box)
     qreal imgX = box.x;
     qreal imgY = pdfY(box.y) - box.imageHeight;
 
-    *m_stream += "q\n";
-    *m_stream += pdfCoord(box.imageWidth) + " 0 0 "
-            + pdfCoord(box.imageHeight) + " "
-            + pdfCoord(imgX) + " " + pdfCoord(imgY) + " cm\n";
-    *m_stream += "/" + imgName + " Do\n";
-    *m_stream += "Q\n";
+    *m_stream << "q\n";
+    *m_stream << Pdf::coord(box.imageWidth) << " 0 0 "
+              << Pdf::coord(box.imageHeight) << ' '
+              << Pdf::coord(imgX) << ' ' << Pdf::coord(imgY) << " cm\n";
+    *m_stream << '/' << imgName << " Do\n";
+    *m_stream << "Q\n";
 }
 
 void PdfBoxRenderer::renderHersheyGlyphBox(const Layout::GlyphBox &gbox,
@@ -606,55 +592,15 @@ void PdfBoxRenderer::renderHersheyGlyphBox(const Layout::GlyphBox &gbox,
 {
     if (gbox.glyphs.isEmpty() || !gbox.font || !gbox.font->hersheyFont)
         return;
-    if (!m_stream || !m_glyphFormCb)
+    if (!m_stream || !m_hersheyGlyphCb)
         return;
 
-    HersheyFont *hFont = gbox.font->hersheyFont;
-    qreal fontSize = gbox.fontSize;
-    qreal scale = fontSize / hFont->unitsPerEm();
-
     drawInlineBackground(gbox, x, baselineY);
 
-    qreal pdfBaseY = pdfY(baselineY);
-
-    qreal curX = x;
-    for (const auto &g : gbox.glyphs) {
-        auto entry = m_glyphFormCb(hFont, nullptr, g.glyphId, gbox.font->hersheyBold);
-        if (entry.objId == 0) {
-            curX += g.xAdvance;
-            continue;
-        }
-
-        qreal gx = curX + g.xOffset;
-        qreal gy = pdfBaseY + g.yOffset; // PDF: yOffset goes up
-
-        // Superscript/subscript adjustment (in PDF, up = positive)
-        if (gbox.style.superscript)
-            gy += fontSize * RenderConstants::kSuperscriptRise;
-        else if (gbox.style.subscript)
-            gy -= fontSize * RenderConstants::kSubscriptDrop;
-
-        *m_stream += "q\n";
-        *m_stream += colorOperator(gbox.style.foreground, false); // stroke color
+    writeHersheyText(gbox.font, gbox.fontSize, gbox.style.foreground,
+                     gbox.run, x, pdfY(baselineY));
 
-        if (gbox.font->hersheyItalic) {
-            // Scale + italic skew + translate
-            *m_stream += pdfCoord(scale) + " 0 "
-                    + pdfCoord(scale * HersheyConstants::kItalicSkew) + " " + pdfCoord(scale)
-                    + " " + pdfCoord(gx) + " " + pdfCoord(gy) + " cm\n";
-        } else {
-            // Scale + translate only
-            *m_stream += pdfCoord(scale) + " 0 0 " + pdfCoord(scale)
-                    + " " + pdfCoord(gx) + " " + pdfCoord(gy) + " cm\n";
-        }
-
-        *m_stream += "/" + entry.pdfName + " Do\n";
-        *m_stream += "Q\n";
-
-        curX += g.xAdvance;
-    }
-
-    renderGlyphDecorations(gbox, x, baselineY, curX);
+    renderGlyphDecorations(gbox, x, baselineY, x + gbox.width);
 }
 
 // --- Helpers ---
@@ -663,11 +609,73 @@ void PdfBoxRenderer::writeInvisibleAnchor(qreal x, qreal pdfBaseY)
 {
     if (!m_stream || !m_embeddedFonts || m_embeddedFonts->isEmpty())
         return;
-    *m_stream += "BT\n3 Tr\n";
-    *m_stream += "/" + m_embeddedFonts->first().pdfName + " 1 Tf\n";
-    *m_stream += "1 0 0 1 " + pdfCoord(x) + " " + pdfCoord(pdfBaseY) + " Tm\n";
-    *m_stream += "<0000> Tj\n";
-    *m_stream += "0 Tr\nET\n";
+    *m_stream << "BT\n3 Tr\n";
+    *m_stream << '/' << m_embeddedFonts->first().pdfName << " 1 Tf\n";
+    *m_stream << "1 0 0 1 " << Pdf::coord(x) << ' ' << Pdf::coord(pdfBaseY) << " Tm\n";
+    *m_stream << "<0000> Tj\n";
+    *m_stream << "0 Tr\nET\n";
+}
+
+void PdfBoxRenderer::writeHersheyText(FontFace *font, qreal fontSize,
+                                       const QColor &foreground,
+                                       const Layout::GlyphRun &run,
+                                       qreal x, qreal pdfBaseY)
+{
+    const HersheyFont *hFont = font->hersheyFont;
+    const qreal unitsPerEm = hFont->unitsPerEm();
+
+    QByteArray currentFont;
+    bool positioned = false;
+    bool inArray = false;
+    qreal lineY = 0;
+    qreal textX = 0; // where the text position stands after the last glyph
+
+    // Glyph procedures stroke, so the stroke colour applies
+    *m_stream << "BT\n" << Pdf::colorOp(foreground, false);
+    for (int i = 0; i < run.glyphIds.size(); ++i) {
+        const HersheyGlyphCode code = m_hersheyGlyphCb(hFont, font->hersheyBold,
+                                                       static_cast<char32_t>(run.glyphIds[i]));
+        if (code.pdfName.isEmpty())
+            continue;
+
+        const qreal gx = x + run.positions[i].x();
+        const qreal gy = pdfBaseY - run.positions[i].y(); // run y is top-down
+        if (code.pdfName != currentFont || !positioned || gy != lineY) {
+            if (inArray)
+                *m_stream << "] TJ\n";
+            inArray = false;
+        }
+        if (code.pdfName != currentFont) {
+            *m_stream << '/' << code.pdfName << ' ' << Pdf::coord(fontSize) << " Tf\n";
+            currentFont = code.pdfName;
+        }
+        if (!positioned || gy != lineY) {
+            // Italic is a skewed text matrix
+            *m_stream << "1 0 ";
+            if (font->hersheyItalic)
+                *m_stream << Pdf::real(HersheyConstants::kItalicSkew);
+            else
+                *m_stream << '0';
+            *m_stream << " 1 " << Pdf::coord(gx) << ' ' << Pdf::coord(gy) << " Tm\n";
+            positioned = true;
+            lineY = gy;
+            textX = gx;
+        }
+        if (!inArray) {
+            *m_stream << '[';
+            inArray = true;
+        }
+        // Layout advances (justification, letter spacing) differ from the
+        // font widths; TJ adjustments are in thousandths of the font size
+        const qreal adjust = (textX - gx) * 1000.0 / fontSize;
+        if (qAbs(adjust) >= 0.005)
+            *m_stream << Pdf::coord(adjust);
+        m_stream->appendCode(code.code);
+        textX = gx + code.advanceWidth * fontSize / unitsPerEm;
+    }
+    if (inArray)
+        *m_stream << "] TJ\n";
+    *m_stream << "ET\n";
 }
 
 // --- Trailing hyphen helper ---
@@ -680,40 +688,28 @@ void PdfBoxRenderer::renderTrailingHyphen(const Layout::GlyphBox &lastGbox, qrea
     qreal pdfBaseY = pdfY(baselineY);
 
     if (lastGbox.font->isHershey && lastGbox.font->hersheyFont) {
-        // Hershey hyphen via XObject
-        if (!m_glyphFormCb) return;
-        HersheyFont *hFont = lastGbox.font->hersheyFont;
-        auto entry = m_glyphFormCb(hFont, nullptr, uint(U'-'), lastGbox.font->hersheyBold);
-        if (entry.objId != 0) {
-            qreal scale = lastGbox.fontSize / hFont->unitsPerEm();
-            *m_stream += "q\n";
-            *m_stream += colorOperator(lastGbox.style.foreground, false);
-            if (lastGbox.font->hersheyItalic) {
-                *m_stream += pdfCoord(scale) + " 0 "
-                        + pdfCoord(scale * HersheyConstants::kItalicSkew) + " " + pdfCoord(scale)
-                        + " " + pdfCoord(x) + " " + pdfCoord(pdfBaseY) + " cm\n";
-            } else {
-                *m_stream += pdfCoord(scale) + " 0 0 " + pdfCoord(scale)
-                        + " " + pdfCoord(x) + " " + pdfCoord(pdfBaseY) + " cm\n";
-            }
-            *m_stream += "/" + entry.pdfName + " Do\n";
-            *m_stream += "Q\n";
-        }
+        // Hershey hyphen as Type 3 text
+        if (!m_hersheyGlyphCb) return;
+        Layout::GlyphRun hyphen;
+        hyphen.glyphIds = {quint32(U'-')};
+        hyphen.positions = {QPointF(0, 0)};
+        writeHersheyText(lastGbox.font, lastGbox.fontSize, lastGbox.style.foreground,
+                         hyphen, x, pdfBaseY);
     } else if (lastGbox.font->ftFace) {
         FT_UInt hyphenGid = FT_Get_Char_Index(lastGbox.font->ftFace, '-');
 
         if (m_exportOptions.xobjectGlyphs) {
             // XObject mode
             if (m_glyphFormCb) {
-                auto entry = m_glyphFormCb(nullptr, lastGbox.font, hyphenGid, false);
+                auto entry = m_glyphFormCb(lastGbox.font, hyphenGid);
                 if (entry.objId != 0) {
                     qreal scale = lastGbox.fontSize / lastGbox.font->ftFace->units_per_EM;
-                    *m_stream += "q\n";
-                    *m_stream += colorOperator(lastGbox.style.foreground, true);
-                    *m_stream += pdfCoord(scale) + " 0 0 " + pdfCoord(scale)
-                            + " " + pdfCoord(x) + " " + pdfCoord(pdfBaseY) + " cm\n";
-                    *m_stream += "/" + entry.pdfName + " Do\n";
-                    *m_stream += "Q\n";
+                    *m_stream << "q\n";
+                    *m_stream << Pdf::colorOp(lastGbox.style.foreground, true);
+                    *m_stream << Pdf::coord(scale) << " 0 0 " << Pdf::coord(scale)
+                              << ' ' << Pdf::coord(x) << ' ' << Pdf::coord(pdfBaseY) << " cm\n";
+                    *m_stream << '/' << entry.pdfName << " Do\n";
+                    *m_stream << "Q\n";
                 }
             }
         } else if (m_exportOptions.markdownCopy || m_hasHersheyGlyphs) {
@@ -733,10 +729,10 @@ void PdfBoxRenderer::renderTrailingHyphen(const Layout::GlyphBox &lastGbox, qrea
                 ctx.tx = x;
                 ctx.ty = pdfBaseY;
                 ctx.last = {0, 0};
-                *m_stream += "q\n";
-                *m_stream += colorOperator(lastGbox.style.foreground, true);
+                *m_stream << "q\n";
+                *m_stream << Pdf::colorOp(lastGbox.style.foreground, true);
                 FT_Outline_Decompose(&face->glyph->outline, &funcs, &ctx);
-                *m_stream += "f\nQ\n";
+                *m_stream << "f\nQ\n";
             }
         } else {
             // Standard CIDFont mode
@@ -747,12 +743,12 @@ void PdfBoxRenderer::renderTrailingHyphen(const Layout::GlyphBox &lastGbox, qrea
                 fontName = m_pdfFontNameCb(lastGbox.font);
             else
                 return;
-            *m_stream += "BT\n";
-            *m_stream += "/" + fontName + " " + pdfCoord(lastGbox.fontSize) + " Tf\n";
-            *m_stream += colorOperator(lastGbox.style.foreground, true);
-            *m_stream += "1 0 0 1 " + pdfCoord(x) + " " + pdfCoord(pdfBaseY) + " Tm\n";
-            *m_stream += Pdf::toHexString16(static_cast<quint16>(hyphenGid)) + " Tj\n";
-            *m_stream += "ET\n";
+            *m_stream << "BT\n";
+            *m_stream << '/' << fontName << ' ' << Pdf::coord(lastGbox.fontSize) << " Tf\n";
+            *m_stream << Pdf::colorOp(lastGbox.style.foreground, true);
+            *m_stream << "1 0 0 1 " << Pdf::coord(x) << ' ' << Pdf::coord(pdfBaseY) << " Tm\n";
+            m_stream->appendGlyph(static_cast<quint16>(hyphenGid)) << " Tj\n";
+            *m_stream << "ET\n";
         }
     }
 }
@@ -1,10 +1,11 @@
 /*
  * pdfboxrenderer.h --- PDF content stream backend for BoxTreeRenderer
  *
- * Subclasses BoxTreeRenderer to write PDF operators to a QByteArray.
+ * Subclasses BoxTreeRenderer to write PDF operators to a Pdf::Buffer.
  * Handles the Y-axis flip (layout top-down -> PDF bottom-up) and
  * overrides renderLineBox() / renderBlockBox() for ActualText markdown
- * copy mode.
+ * copy mode.  Hershey glyphs are written as TJ runs in Type 3 fonts
+ * that PdfGenerator builds while pages render.
  *
  * SPDX-License-Identifier: GPL-2.0-or-later
  */
@@ -13,6 +14,7 @@
 #define PRETTYREADER_PDFBOXRENDERER_H
 
 #include "boxtreerenderer.h"
+#include "pdfbuffer.h"
 #include "pdfexportoptions.h"
 
 #include <QByteArray>
@@ -32,6 +34,13 @@ struct GlyphFormEntry {
     qreal advanceWidth = 0; // in glyph units
 };
 
+// Code of a Hershey glyph in one of the document's Type 3 fonts
+struct HersheyGlyphCode {
+    QByteArray pdfName;     // "HF0", "HF1", ...; empty if the glyph is missing
+    quint8 code = 0;
+    qreal advanceWidth = 0; // in Hershey font units
+};
+
 struct EmbeddedFont {
     uint32_t fontObjId = 0;
     QByteArray pdfName; // e.g. "F0", "F1"
@@ -51,8 +60,8 @@ public:
 
     // --- Configuration setters ---
 
-    /// Set the output byte array where PDF operators are written.
-    void setStream(QByteArray *stream) { m_stream = stream; }
+    /// Set the output buffer where PDF operators are written.
+    void setStream(Pdf::Buffer *stream) { m_stream = stream; }
 
     /// Set the content area origin in PDF coordinates.
     /// @param originX  left margin in PDF coordinates (same as layout X)
@@ -77,11 +86,16 @@ public:
     }
 
     /// Ensure a glyph form XObject exists; returns entry with pdfName/objId.
-    void setGlyphFormCallback(
-        std::function<GlyphFormEntry(const HersheyFont *, FontFace *, uint, bool)> cb) {
+    void setGlyphFormCallback(std::function<GlyphFormEntry(FontFace *, uint)> cb) {
         m_glyphFormCb = std::move(cb);
     }
 
+    /// Assign a Type 3 font code to a Hershey glyph (font, bold, codepoint).
+    void setHersheyGlyphCallback(
+        std::function<HersheyGlyphCode(const HersheyFont *, bool, char32_t)> cb) {
+        m_hersheyGlyphCb = std::move(cb);
+    }
+
     /// Mark a glyph as used for font subsetting.
     void setMarkGlyphUsedCallback(std::function<void(FontFace *, uint)> cb) {
         m_markGlyphUsedCb = std::move(cb);
@@ -150,14 +164,13 @@ public:
     void renderImageBlock(const Layout::BlockBox &box) override;
 
 private:
-    // --- PDF coordinate helpers ---
+    // --- PDF output helpers ---
 
     /// Convert layout Y (top-down) to PDF Y (bottom-up).
     qreal pdfY(qreal layoutY) const { return m_contentTopY - layoutY; }
 
-    static QByteArray pdfCoord(qreal v);
-    static QByteArray colorOperator(const QColor &color, bool fill = true);
-    static QByteArray toUtf16BeHex(const QString &text);
+    /// Open a marked-content span with @p text as its UTF-16BE ActualText.
+    void beginActualText(const QString &text);
 
     // --- Glyph rendering dispatch ---
 
@@ -179,12 +192,19 @@ private:
     /// Write an invisible text anchor at (x, pdfY) for ActualText spans.
     void writeInvisibleAnchor(qreal x, qreal pdfBaseY);
 
+    /// Write a positioned Hershey run as one text object, its origin at
+    /// (x, pdfBaseY).
+    void writeHersheyText(FontFace *font, qreal fontSize,
+                          const QColor &foreground,
+                          const Layout::GlyphRun &run,
+                          qreal x, qreal pdfBaseY);
+
     void renderTrailingHyphen(const Layout::GlyphBox &lastGbox, qreal x,
                               qreal baselineY);
 
     // --- State ---
 
-    QByteArray *m_stream = nullptr;
+    Pdf::Buffer *m_stream = nullptr;
     qreal m_originX = 0;
     qreal m_contentTopY = 0;
     qreal m_maxJustifyGap = 14.0;
@@ -194,7 +214,8 @@ private:
 
     // Callbacks
     std::function<QByteArray(FontFace *)> m_pdfFontNameCb;
-    std::function<GlyphFormEntry(const HersheyFont *, FontFace *, uint, bool)> m_glyphFormCb;
+    std::function<GlyphFormEntry(FontFace *, uint)> m_glyphFormCb;
+    std::function<HersheyGlyphCode(const HersheyFont *, bool, char32_t)> m_hersheyGlyphCb;
     std::function<void(FontFace *, uint)> m_markGlyphUsedCb;
     std::function<QByteArray(const QString &)> m_imageNameCb;
     const QList<EmbeddedFont> *m_embeddedFonts = nullptr;
@@ -0,0 +1,139 @@
+/*
+ * pdfbuffer.cpp — Append-in-place output buffer for PDF serialization
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "pdfbuffer.h"
+#include "utf16.h"
+
+#include <QDebug>
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Pdf {
+
+namespace {
+
+// Upper-case hex digit pairs for every byte value
+constexpr std::array<std::array<char, 2>, 256> kHexPairs = [] {
+    std::array<std::array<char, 2>, 256> table{};
+    constexpr char digits[] = "0123456789ABCDEF";
+    for (int i = 0; i < 256; ++i)
+        table[i] = {digits[i >> 4], digits[i & 0xf]};
+    return table;
+}();
+
+constexpr int kMaxDecimals = 17;
+// Sign, the 309 integer digits of the largest double, point and decimals
+constexpr int kFixedCapacity = 1 + std::numeric_limits<double>::max_exponent10 + 1 + 1 + kMaxDecimals;
+
+// Writes @p v into @p buf (kFixedCapacity characters); returns the number
+// of characters written
+int writeFixed(char *buf, double v, int decimals)
+{
+    if (!std::isfinite(v)) {
+        // PDF has no NaN or infinity; whatever computed this is broken
+        qWarning() << "Pdf::Buffer: non-finite number" << v << "written as 0";
+        buf[0] = '0';
+        return 1;
+    }
+    auto [end, ec] = std::to_chars(buf, buf + kFixedCapacity, v, std::chars_format::fixed,
+                                   qBound(0, decimals, kMaxDecimals));
+    Q_ASSERT(ec == std::errc()); // every finite double fits
+    if (ec != std::errc()) {
+        buf[0] = '0';
+        return 1;
+    }
+    int len = static_cast<int>(end - buf);
+    // Values that round to zero come out as "-0.00"; drop the sign
+    if (buf[0] == '-') {
+        bool zero = true;
+        for (int i = 1; i < len && zero; ++i)
+            zero = buf[i] == '0' || buf[i] == '.';
+        if (zero) {
+            std::memmove(buf, buf + 1, len - 1);
+            --len;
+        }
+    }
+    return len;
+}
+
+} // anonymous namespace
+
+Buffer &Buffer::operator<<(const ColorOp &op)
+{
+    if (!op.color.isValid())
+        return *this;
+    *this << coord(op.color.redF()) << ' '
+          << coord(op.color.greenF()) << ' '
+          << coord(op.color.blueF()) << (op.fill ? " rg\n" : " RG\n");
+    return *this;
+}
+
+Buffer &Buffer::appendGlyph(quint16 gid)
+{
+    const auto &hi = kHexPairs[gid >> 8];
+    const auto &lo = kHexPairs[gid & 0xff];
+    const char code[6] = {'<', hi[0], hi[1], lo[0], lo[1], '>'};
+    m_data.append(code, 6);
+    return *this;
+}
+
+Buffer &Buffer::appendCode(quint8 code)
+{
+    const auto &hex = kHexPairs[code];
+    const char text[4] = {'<', hex[0], hex[1], '>'};
+    m_data.append(text, 4);
+    return *this;
+}
+
+Buffer &Buffer::appendHex16(quint16 v)
+{
+    const auto &hi = kHexPairs[v >> 8];
+    const auto &lo = kHexPairs[v & 0xff];
+    const char code[4] = {hi[0], hi[1], lo[0], lo[1]};
+    m_data.append(code, 4);
+    return *this;
+}
+
+Buffer &Buffer::appendUtf16Hex(QStringView text)
+{
+    const qsizetype start = m_data.size();
+    m_data.resize(start + 4 * text.size());
+    Utf16::toBigEndianHex(text, m_data.data() + start);
+    return *this;
+}
+
+void Buffer::appendInteger(qlonglong v)
+{
+    char buf[24];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    Q_UNUSED(ec); // 24 characters always suffice for 64-bit integers
+    m_data.append(buf, end - buf);
+}
+
+void Buffer::appendFixed(double v, int decimals)
+{
+    char buf[kFixedCapacity];
+    m_data.append(buf, writeFixed(buf, v, decimals));
+}
+
+QByteArray formatInteger(qlonglong v)
+{
+    Buffer out(24);
+    out.appendInteger(v);
+    return out.take();
+}
+
+QByteArray formatFixed(double v, int decimals)
+{
+    Buffer out(32);
+    out.appendFixed(v, decimals);
+    return out.take();
+}
+
+} // namespace Pdf
@@ -0,0 +1,100 @@
+/*
+ * pdfbuffer.h — Append-in-place output buffer for PDF serialization
+ *
+ * Content streams and object dictionaries are built by streaming tokens
+ * into a Pdf::Buffer instead of concatenating temporary QByteArrays:
+ *
+ *     out << Pdf::coord(x) << ' ' << Pdf::coord(y) << " m\n";
+ *     out.appendGlyph(gid) << " Tj\n";
+ *
+ * Numbers are formatted with std::to_chars straight into the buffer.
+ * Floating-point values must be wrapped in Pdf::coord() (2 decimals, for
+ * content stream geometry) or Pdf::real() (6 decimals, as Pdf::toPdf()),
+ * so the precision is always explicit at the call site.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_PDFBUFFER_H
+#define PRETTYREADER_PDFBUFFER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QColor>
+#include <QStringView>
+
+#include <type_traits>
+#include <utility>
+
+namespace Pdf {
+
+// Fixed-point number with a given number of decimals
+struct Fixed {
+    double value;
+    int decimals;
+};
+
+inline constexpr Fixed coord(double v) { return {v, 2}; }
+inline constexpr Fixed real(double v) { return {v, 6}; }
+
+// "r g b rg" (fill) or "r g b RG" (stroke); nothing for an invalid colour
+struct ColorOp {
+    QColor color;
+    bool fill = true;
+};
+
+inline ColorOp colorOp(const QColor &color, bool fill = true) { return {color, fill}; }
+
+class Buffer
+{
+public:
+    Buffer() = default;
+    explicit Buffer(qsizetype reserve) { m_data.reserve(reserve); }
+
+    Buffer &operator<<(const char *s) { m_data.append(s); return *this; }
+    Buffer &operator<<(char c) { m_data.append(c); return *this; }
+    Buffer &operator<<(QByteArrayView s) { m_data.append(s); return *this; }
+    Buffer &operator<<(const QByteArray &s) { m_data.append(s); return *this; }
+
+    template <typename T,
+              std::enable_if_t<(std::is_integral_v<T> && !std::is_same_v<T, char>
+                                && !std::is_same_v<T, bool>) || std::is_enum_v<T>, bool> = true>
+    Buffer &operator<<(T v) { appendInteger(static_cast<qlonglong>(v)); return *this; }
+
+    // Bare floating-point values are ambiguous; use coord() or real()
+    Buffer &operator<<(double) = delete;
+
+    Buffer &operator<<(Fixed f) { appendFixed(f.value, f.decimals); return *this; }
+    Buffer &operator<<(const ColorOp &op);
+
+    // "<XXXX>" — a 2-byte Identity-H glyph code
+    Buffer &appendGlyph(quint16 gid);
+    // "<XX>" — a 1-byte simple font code (Hershey Type 3 fonts)
+    Buffer &appendCode(quint8 code);
+    // "XXXX" — four upper-case hex digits
+    Buffer &appendHex16(quint16 v);
+    // Four hex digits per UTF-16 code unit of @p text, big-endian
+    Buffer &appendUtf16Hex(QStringView text);
+    Buffer &append(const char *data, qsizetype size) { m_data.append(data, size); return *this; }
+
+    void appendInteger(qlonglong v);
+    void appendFixed(double v, int decimals);
+
+    const QByteArray &data() const { return m_data; }
+    QByteArray take() { return std::exchange(m_data, QByteArray()); }
+    qsizetype size() const { return m_data.size(); }
+    bool isEmpty() const { return m_data.isEmpty(); }
+    void reserve(qsizetype size) { m_data.reserve(size); }
+    void clear() { m_data.clear(); }
+
+private:
+    QByteArray m_data;
+};
+
+// Stand-alone formatting, for the few places that still need a QByteArray
+QByteArray formatInteger(qlonglong v);
+QByteArray formatFixed(double v, int decimals);
+
+} // namespace Pdf
+
+#endif // PRETTYREADER_PDFBUFFER_H
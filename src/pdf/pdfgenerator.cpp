@@ -4,6 +4,7 @@
  */
 
 #include "pdfgenerator.h"
+#include "allocprofiler.h"
 #include "pdfboxrenderer.h"
 #include "fontmanager.h"
 #include "sfnt.h"
@@ -11,6 +12,9 @@
 
 #include <QColor>
 #include <QDateTime>
+#include <QTimeZone>
+
+#include <algorithm>
 #include <zlib.h>
 #include FT_OUTLINE_H
 
@@ -25,30 +29,11 @@ void PdfGenerator::setDocumentInfo(const QString &filename, const QString &title
     m_title = title;
 }
 
-// --- PDF coordinate helpers ---
-
-QByteArray PdfGenerator::pdfCoord(qreal v)
-{
-    return QByteArray::number(v, 'f', 2);
-}
-
-QByteArray PdfGenerator::colorOperator(const QColor &color, bool fill)
-{
-    if (!color.isValid())
-        return {};
-    qreal r = color.redF();
-    qreal g = color.greenF();
-    qreal b = color.blueF();
-    QByteArray op = fill ? " rg\n" : " RG\n";
-    return pdfCoord(r) + " " + pdfCoord(g) + " " + pdfCoord(b) + op;
-}
-
 // --- Font registration ---
 
 QByteArray PdfGenerator::pdfFontName(FontFace *face)
 {
-    int idx = ensureFontRegistered(face);
-    return "F" + QByteArray::number(idx);
+    return m_embeddedFonts[ensureFontRegistered(face)].pdfName;
 }
 
 int PdfGenerator::ensureFontRegistered(FontFace *face)
@@ -71,6 +56,7 @@ QByteArray PdfGenerator::generate(const Layout::LayoutResult &layout,
                                    const PageLayout &pageLayout,
                                    const QString &title)
 {
+    AllocProfiler::Scope allocScope(AllocProfiler::PdfGeneration);
     m_embeddedFonts.clear();
     m_fontIndex.clear();
     m_embeddedImages.clear();
@@ -78,6 +64,8 @@ QByteArray PdfGenerator::generate(const Layout::LayoutResult &layout,
     m_pageAnnotations.clear();
     m_glyphForms.clear();
     m_nextGlyphFormIdx = 0;
+    m_type3Fonts.clear();
+    m_hersheyCodes.clear();
     if (m_title.isEmpty())
         m_title = title;
 
@@ -213,7 +201,8 @@ QByteArray PdfGenerator::generate(const Layout::LayoutResult &layout,
     for (auto &ei : m_embeddedImages)
         resources.xObjects[ei.pdfName] = ei.objId;
 
-    // Base 14 Helvetica for markdown invisible text in Hershey mode
+    // Base 14 Helvetica for the invisible markdown text over glyphs drawn
+    // as paths or XObjects (Hershey text is real Type 3 text)
     if ((m_hasHersheyGlyphs || m_exportOptions.xobjectGlyphs) && m_exportOptions.markdownCopy) {
         Pdf::ObjId hvInvObj = writer.startObj();
         writer.write("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
@@ -230,6 +219,7 @@ QByteArray PdfGenerator::generate(const Layout::LayoutResult &layout,
     for (int pi = 0; pi < layout.pages.size(); ++pi) {
         m_currentPageIndex = pi;
         QByteArray contentStream = renderPage(layout.pages[pi], pageLayout, resources);
+        m_lastStreamSize = contentStream.size();
 
         // Content stream object
         Pdf::ObjId contentObj = writer.startObj();
@@ -241,11 +231,12 @@ QByteArray PdfGenerator::generate(const Layout::LayoutResult &layout,
         for (const auto &annot : m_pageAnnotations[pi]) {
             Pdf::ObjId annotObj = writer.startObj();
             writer.write("<<\n/Type /Annot\n/Subtype /Link\n");
-            writer.write("/Rect ["
-                         + pdfCoord(annot.rect.left()) + " "
-                         + pdfCoord(annot.rect.bottom()) + " "
-                         + pdfCoord(annot.rect.right()) + " "
-                         + pdfCoord(annot.rect.top()) + "]\n");
+            Pdf::Buffer rect(64);
+            rect << "/Rect [" << Pdf::coord(annot.rect.left()) << ' '
+                 << Pdf::coord(annot.rect.bottom()) << ' '
+                 << Pdf::coord(annot.rect.right()) << ' '
+                 << Pdf::coord(annot.rect.top()) << "]\n";
+            writer.write(rect);
             writer.write("/Border [0 0 0]\n"); // no visible border
             writer.write("/A <</Type /Action /S /URI /URI "
                          + Pdf::toLiteralString(annot.href.toUtf8()) + ">>\n");
@@ -256,26 +247,32 @@ QByteArray PdfGenerator::generate(const Layout::LayoutResult &layout,
 
         // Page object
         Pdf::ObjId pageObj = writer.startObj();
-        writer.write("<<\n");
-        writer.write("/Type /Page\n");
-        writer.write("/Parent " + Pdf::toObjRef(writer.pagesObj()) + "\n");
-        writer.write("/MediaBox [0 0 "
-                     + Pdf::toPdf(layout.pageSize.width()) + " "
-                     + Pdf::toPdf(layout.pageSize.height()) + "]\n");
-        writer.write("/Contents " + Pdf::toObjRef(contentObj) + "\n");
-        writer.write("/Resources ");
+        Pdf::Buffer page(256);
+        page << "<<\n";
+        page << "/Type /Page\n";
+        page << "/Parent " << writer.pagesObj() << " 0 R\n";
+        page << "/MediaBox [0 0 " << Pdf::real(layout.pageSize.width()) << ' '
+             << Pdf::real(layout.pageSize.height()) << "]\n";
+        page << "/Contents " << contentObj << " 0 R\n";
+        page << "/Resources ";
+        writer.write(page);
         writer.writeResourceDict(resources);
+        page.clear();
         if (!annotObjIds.isEmpty()) {
-            writer.write("/Annots [");
+            page << "/Annots [";
             for (auto id : annotObjIds)
-                writer.write(Pdf::toObjRef(id) + " ");
-            writer.write("]\n");
+                page << id << " 0 R ";
+            page << "]\n";
         }
-        writer.write(">>");
+        page << ">>";
+        writer.write(page);
         writer.endObj(pageObj);
         pageObjIds.append(pageObj);
     }
 
+    // Type 3 fonts are complete once every page has rendered
+    writeType3Fonts(writer);
+
     // Pages object
     writer.startObj(writer.pagesObj());
     writer.write("<<\n/Type /Pages\n/Kids [");
@@ -300,7 +297,16 @@ QByteArray PdfGenerator::generate(const Layout::LayoutResult &layout,
         writer.write("/Subject " + Pdf::toLiteralString(Pdf::toUTF16(m_exportOptions.subject)) + "\n");
     if (!m_exportOptions.keywords.isEmpty())
         writer.write("/Keywords " + Pdf::toLiteralString(Pdf::toUTF16(m_exportOptions.keywords)) + "\n");
-    writer.write("/CreationDate " + Pdf::toDateString(QDateTime::currentDateTime()) + "\n");
+    if (!m_exportOptions.reproducible) {
+        writer.write("/CreationDate " + Pdf::toDateString(QDateTime::currentDateTime()) + "\n");
+    } else {
+        // Seconds past 2038 need 64 bits; a malformed value omits the date
+        bool ok = false;
+        const qint64 epoch = qgetenv("SOURCE_DATE_EPOCH").toLongLong(&ok);
+        if (ok && epoch >= 0)
+            writer.write("/CreationDate "
+                         + Pdf::toDateString(QDateTime::fromSecsSinceEpoch(epoch, QTimeZone::UTC)) + "\n");
+    }
     writer.write(">>");
     writer.endObj(writer.infoObj());
 
@@ -372,7 +378,8 @@ QByteArray PdfGenerator::renderPage(const Layout::Page &page,
                                      const Pdf::ResourceDict &resources)
 {
     Q_UNUSED(resources);
-    QByteArray stream;
+    // Pages of a document are similar in size; start from the last one
+    Pdf::Buffer stream(qMax<qsizetype>(m_lastStreamSize + m_lastStreamSize / 8, 4096));
 
     QSizeF pageSize = QPageSize(pageLayout.pageSizeId).sizePoints();
     qreal pageWidth = pageSize.width();
@@ -381,8 +388,8 @@ QByteArray PdfGenerator::renderPage(const Layout::Page &page,
     // Page background fill (theme color)
     if (pageLayout.pageBackground.isValid()
         && pageLayout.pageBackground != Qt::white) {
-        stream += colorOperator(pageLayout.pageBackground, true);
-        stream += "0 0 " + pdfCoord(pageWidth) + " " + pdfCoord(pageHeight) + " re f\n";
+        stream << Pdf::colorOp(pageLayout.pageBackground, true);
+        stream << "0 0 " << Pdf::coord(pageWidth) << ' ' << Pdf::coord(pageHeight) << " re f\n";
     }
 
     // Calculate content area
@@ -411,10 +418,13 @@ QByteArray PdfGenerator::renderPage(const Layout::Page &page,
     renderer.setPdfFontNameCallback([this](FontFace *f) {
         return pdfFontName(f);
     });
-    renderer.setGlyphFormCallback([this](const HersheyFont *hf, FontFace *face, uint gid, bool bold) {
-        auto entry = ensureGlyphForm(hf, face, gid, bold);
+    renderer.setGlyphFormCallback([this](FontFace *face, uint gid) {
+        auto entry = ensureGlyphForm(face, gid);
         return ::GlyphFormEntry{entry.objId, entry.pdfName, entry.advanceWidth};
     });
+    renderer.setHersheyGlyphCallback([this](const HersheyFont *font, bool bold, char32_t cp) {
+        return ensureHersheyGlyph(font, bold, cp);
+    });
     renderer.setMarkGlyphUsedCallback([this](FontFace *f, uint g) {
         m_fontManager->markGlyphUsed(f, g);
     });
@@ -437,19 +447,19 @@ QByteArray PdfGenerator::renderPage(const Layout::Page &page,
     // relative to the content area (starting at 0). The CTM translation
     // offsets all rendering by the left margin. Y-flip is handled per-primitive
     // by PdfBoxRenderer::pdfY().
-    stream += "q\n1 0 0 1 " + pdfCoord(originX) + " 0 cm\n";
+    stream << "q\n1 0 0 1 " << Pdf::coord(originX) << " 0 cm\n";
 
     // Render all page elements through PdfBoxRenderer
     for (const auto &elem : page.elements)
         renderer.renderElement(elem);
 
-    stream += "Q\n";
+    stream << "Q\n";
 
     // Collect link annotations from renderer
     for (const auto &link : renderer.linkAnnotations())
         m_pageAnnotations[m_currentPageIndex].append(link);
 
-    return stream;
+    return stream.take();
 }
 
 // --- Glyph Form XObjects ---
@@ -460,10 +470,10 @@ QByteArray PdfGenerator::renderPage(const Layout::Page &page,
 
 namespace {
 
-QByteArray coord(qreal v) { return QByteArray::number(v, 'f', 2); }
+using Pdf::coord;
 
 struct OutlineCtx {
-    QByteArray *stream;
+    Pdf::Buffer *stream;
     qreal scale;
     qreal tx, ty;
     FT_Vector last;
@@ -471,16 +481,16 @@ struct OutlineCtx {
 
 int outlineMoveTo(const FT_Vector *to, void *user) {
     auto *c = static_cast<OutlineCtx *>(user);
-    *c->stream += coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " m\n";
+    *c->stream << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " m\n";
     c->last = *to;
     return 0;
 }
 
 int outlineLineTo(const FT_Vector *to, void *user) {
     auto *c = static_cast<OutlineCtx *>(user);
-    *c->stream += coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " l\n";
+    *c->stream << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " l\n";
     c->last = *to;
     return 0;
 }
@@ -491,122 +501,76 @@ int outlineConicTo(const FT_Vector *ctrl, const FT_Vector *to, void *user) {
     qreal cp1y = (c->last.y + 2.0 * ctrl->y) / 3.0;
     qreal cp2x = (to->x + 2.0 * ctrl->x) / 3.0;
     qreal cp2y = (to->y + 2.0 * ctrl->y) / 3.0;
-    *c->stream += coord(cp1x * c->scale + c->tx) + " "
-                + coord(cp1y * c->scale + c->ty) + " "
-                + coord(cp2x * c->scale + c->tx) + " "
-                + coord(cp2y * c->scale + c->ty) + " "
-                + coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " c\n";
+    *c->stream << coord(cp1x * c->scale + c->tx) << ' '
+               << coord(cp1y * c->scale + c->ty) << ' '
+               << coord(cp2x * c->scale + c->tx) << ' '
+               << coord(cp2y * c->scale + c->ty) << ' '
+               << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " c\n";
     c->last = *to;
     return 0;
 }
 
 int outlineCubicTo(const FT_Vector *c1, const FT_Vector *c2, const FT_Vector *to, void *user) {
     auto *c = static_cast<OutlineCtx *>(user);
-    *c->stream += coord(c1->x * c->scale + c->tx) + " "
-                + coord(c1->y * c->scale + c->ty) + " "
-                + coord(c2->x * c->scale + c->tx) + " "
-                + coord(c2->y * c->scale + c->ty) + " "
-                + coord(to->x * c->scale + c->tx) + " "
-                + coord(to->y * c->scale + c->ty) + " c\n";
+    *c->stream << coord(c1->x * c->scale + c->tx) << ' '
+               << coord(c1->y * c->scale + c->ty) << ' '
+               << coord(c2->x * c->scale + c->tx) << ' '
+               << coord(c2->y * c->scale + c->ty) << ' '
+               << coord(to->x * c->scale + c->tx) << ' '
+               << coord(to->y * c->scale + c->ty) << " c\n";
     c->last = *to;
     return 0;
 }
 
 } // anonymous namespace
 
-PdfGenerator::GlyphFormEntry PdfGenerator::ensureGlyphForm(
-    const HersheyFont *hersheyFont, FontFace *ttfFace,
-    uint glyphId, bool bold)
+PdfGenerator::GlyphFormEntry PdfGenerator::ensureGlyphForm(FontFace *ttfFace, uint glyphId)
 {
     // Preconditions: must be called during generate() with valid writer/resources
-    if ((!hersheyFont && !ttfFace) || !m_writer || !m_resources)
+    if (!ttfFace || !ttfFace->ftFace || !m_writer || !m_resources)
         return {};
 
-    GlyphFormKey key{hersheyFont, ttfFace, glyphId, bold};
+    GlyphFormKey key{ttfFace, glyphId};
     auto it = m_glyphForms.find(key);
     if (it != m_glyphForms.end())
         return it.value();
 
-    QByteArray formStream;
-    qreal advW = 0;
-    qreal bboxBottom = 0;
-    qreal bboxTop = 0;
-
-    if (hersheyFont) {
-        const HersheyGlyph *hGlyph = hersheyFont->glyph(static_cast<char32_t>(glyphId));
-        if (!hGlyph) {
-            GlyphFormEntry dummy;
-            return dummy;
-        }
-
-        // Build the Form stream in glyph-local coordinates.
-        // Origin: left baseline (x=0 at leftBound, y=0 at baseline).
-        // Coordinates are in Hershey font units (scaled at call site via cm).
-        formStream += "1 J 1 j\n"; // round cap & join
-
-        // Stroke width in glyph units. Call site scales by fontSize/unitsPerEm,
-        // so: strokeWidth_glyphUnits * (fontSize/upm) = 0.02 * fontSize
-        // Therefore: strokeWidth_glyphUnits = 0.02 * upm
-        qreal strokeWidth = HersheyConstants::kStrokeWidthFactor * hersheyFont->unitsPerEm();
-        if (bold)
-            strokeWidth *= HersheyConstants::kBoldStrokeMultiplier;
-        formStream += pdfCoord(strokeWidth) + " w\n";
-
-        for (const auto &stroke : hGlyph->strokes) {
-            if (stroke.size() < 2)
-                continue;
-            qreal px = stroke[0].x() - hGlyph->leftBound;
-            qreal py = stroke[0].y();
-            formStream += pdfCoord(px) + " " + pdfCoord(py) + " m\n";
-            for (int si = 1; si < stroke.size(); ++si) {
-                px = stroke[si].x() - hGlyph->leftBound;
-                py = stroke[si].y();
-                formStream += pdfCoord(px) + " " + pdfCoord(py) + " l\n";
-            }
-            formStream += "S\n";
-        }
+    FT_Face face = ttfFace->ftFace;
+    if (FT_Load_Glyph(face, glyphId, FT_LOAD_NO_SCALE) != 0
+        || face->glyph->format != FT_GLYPH_FORMAT_OUTLINE) {
+        return {};
+    }
 
-        advW = hGlyph->rightBound - hGlyph->leftBound;
-        bboxBottom = -hersheyFont->descent();
-        bboxTop = hersheyFont->ascent();
+    Pdf::Buffer formStream;
 
-    } else if (ttfFace && ttfFace->ftFace) {
-        FT_Face face = ttfFace->ftFace;
-        if (FT_Load_Glyph(face, glyphId, FT_LOAD_NO_SCALE) != 0
-            || face->glyph->format != FT_GLYPH_FORMAT_OUTLINE) {
-            return {};
-        }
+    FT_Outline_Funcs funcs = {};
+    funcs.move_to = outlineMoveTo;
+    funcs.line_to = outlineLineTo;
+    funcs.conic_to = outlineConicTo;
+    funcs.cubic_to = outlineCubicTo;
 
-        FT_Outline_Funcs funcs = {};
-        funcs.move_to = outlineMoveTo;
-        funcs.line_to = outlineLineTo;
-        funcs.conic_to = outlineConicTo;
-        funcs.cubic_to = outlineCubicTo;
-
-        OutlineCtx ctx;
-        ctx.stream = &formStream;
-        ctx.scale = 1.0;  // font units, scaling at call site via cm
-        ctx.tx = 0;
-        ctx.ty = 0;
-        ctx.last = {0, 0};
-        FT_Outline_Decompose(&face->glyph->outline, &funcs, &ctx);
-        formStream += "f\n";
-
-        advW = face->glyph->metrics.horiAdvance;
-        bboxBottom = face->glyph->metrics.horiBearingY - face->glyph->metrics.height;
-        bboxTop = face->glyph->metrics.horiBearingY;
+    OutlineCtx ctx;
+    ctx.stream = &formStream;
+    ctx.scale = 1.0;  // font units, scaling at call site via cm
+    ctx.tx = 0;
+    ctx.ty = 0;
+    ctx.last = {0, 0};
+    FT_Outline_Decompose(&face->glyph->outline, &funcs, &ctx);
+    formStream << "f\n";
 
-    } else {
-        return {};
-    }
+    const qreal advW = face->glyph->metrics.horiAdvance;
+    const qreal bboxBottom = face->glyph->metrics.horiBearingY - face->glyph->metrics.height;
+    const qreal bboxTop = face->glyph->metrics.horiBearingY;
 
     // Write the Form XObject to PDF
     Pdf::ObjId objId = m_writer->startObj();
     m_writer->write("<<\n/Type /XObject\n/Subtype /Form\n");
-    m_writer->write("/BBox [0 " + pdfCoord(bboxBottom) + " "
-                    + pdfCoord(advW) + " " + pdfCoord(bboxTop) + "]\n");
-    m_writer->endObjectWithStream(objId, formStream);
+    Pdf::Buffer bbox(64);
+    bbox << "/BBox [0 " << Pdf::coord(bboxBottom) << ' '
+         << Pdf::coord(advW) << ' ' << Pdf::coord(bboxTop) << "]\n";
+    m_writer->write(bbox);
+    m_writer->endObjectWithStream(objId, formStream.data());
 
     // Register in resource dict and cache
     GlyphFormEntry entry;
@@ -620,9 +584,133 @@ PdfGenerator::GlyphFormEntry PdfGenerator::ensureGlyphForm(
     return entry;
 }
 
+// --- Hershey Type 3 fonts ---
+
+HersheyGlyphCode PdfGenerator::ensureHersheyGlyph(const HersheyFont *font, bool bold,
+                                                  char32_t codepoint)
+{
+    if (!font || !m_writer || !m_resources)
+        return {};
+
+    const HersheyGlyphKey key{font, bold, codepoint};
+    auto it = m_hersheyCodes.constFind(key);
+    if (it != m_hersheyCodes.constEnd())
+        return it.value();
+
+    const HersheyGlyph *glyph = font->glyph(codepoint);
+    if (!glyph)
+        return {};
+
+    // The newest font of this (font, bold) pair is the only one with free codes
+    int index = -1;
+    for (int i = m_type3Fonts.size() - 1; i >= 0; --i) {
+        if (m_type3Fonts[i].font == font && m_type3Fonts[i].bold == bold) {
+            if (m_type3Fonts[i].codepoints.size() < 256)
+                index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        Type3Font t3;
+        t3.objId = m_writer->newObject();
+        t3.pdfName = "HF" + QByteArray::number(m_type3Fonts.size());
+        t3.font = font;
+        t3.bold = bold;
+        m_resources->fonts[t3.pdfName] = t3.objId;
+        m_type3Fonts.append(t3);
+        index = m_type3Fonts.size() - 1;
+    }
+
+    Type3Font &t3 = m_type3Fonts[index];
+    HersheyGlyphCode code;
+    code.pdfName = t3.pdfName;
+    code.code = static_cast<quint8>(t3.codepoints.size());
+    code.advanceWidth = glyph->rightBound - glyph->leftBound;
+    t3.codepoints.append(codepoint);
+    m_hersheyCodes.insert(key, code);
+    return code;
+}
+
+void PdfGenerator::writeType3Fonts(Pdf::Writer &writer)
+{
+    for (const Type3Font &t3 : std::as_const(m_type3Fonts)) {
+        const HersheyFont *font = t3.font;
+        const int glyphCount = t3.codepoints.size();
+
+        // Glyph procedures are in Hershey units (the FontMatrix scales by
+        // 1/unitsPerEm), origin at the glyph's left bound on the baseline
+        qreal strokeWidth = HersheyConstants::kStrokeWidthFactor * font->unitsPerEm();
+        if (t3.bold)
+            strokeWidth *= HersheyConstants::kBoldStrokeMultiplier;
+
+        Pdf::Buffer charProcs(glyphCount * 16);
+        Pdf::Buffer differences(glyphCount * 5);
+        Pdf::Buffer widths(glyphCount * 6);
+        qreal minX = 0;
+        qreal minY = -font->descent();
+        qreal maxX = 0;
+        qreal maxY = font->ascent();
+
+        for (int code = 0; code < glyphCount; ++code) {
+            const HersheyGlyph *glyph = font->glyph(t3.codepoints[code]);
+            const qreal advW = glyph->rightBound - glyph->leftBound;
+
+            Pdf::Buffer proc;
+            proc << Pdf::coord(advW) << " 0 d0\n1 J 1 j\n"
+                 << Pdf::coord(strokeWidth) << " w\n";
+            for (const auto &stroke : glyph->strokes) {
+                if (stroke.size() < 2)
+                    continue;
+                for (int si = 0; si < stroke.size(); ++si) {
+                    const qreal px = stroke[si].x() - glyph->leftBound;
+                    const qreal py = stroke[si].y();
+                    proc << Pdf::coord(px) << ' ' << Pdf::coord(py) << (si ? " l\n" : " m\n");
+                    minX = qMin(minX, px);
+                    maxX = qMax(maxX, px);
+                    minY = qMin(minY, py);
+                    maxY = qMax(maxY, py);
+                }
+                proc << "S\n";
+            }
+            maxX = qMax(maxX, advW);
+
+            Pdf::ObjId procObj = writer.startObj();
+            writer.write("<<\n");
+            writer.endObjectWithStream(procObj, proc.data());
+
+            charProcs << "/g" << code << ' ' << procObj << " 0 R\n";
+            differences << " /g" << code;
+            widths << Pdf::coord(advW) << ' ';
+        }
+
+        Pdf::ObjId toUnicodeObj = writer.startObj();
+        writer.write("<<\n");
+        writer.endObjectWithStream(toUnicodeObj, buildType3ToUnicodeCMap(t3.codepoints));
+
+        // Strokes extend half their width past the points
+        const qreal pad = strokeWidth / 2;
+        const qreal em = 1.0 / font->unitsPerEm();
+
+        writer.startObj(t3.objId);
+        Pdf::Buffer dict(256 + charProcs.size() + differences.size() + widths.size());
+        dict << "<<\n/Type /Font\n/Subtype /Type3\n";
+        dict << "/FontBBox [" << Pdf::coord(minX - pad) << ' ' << Pdf::coord(minY - pad) << ' '
+             << Pdf::coord(maxX + pad) << ' ' << Pdf::coord(maxY + pad) << "]\n";
+        dict << "/FontMatrix [" << Pdf::real(em) << " 0 0 " << Pdf::real(em) << " 0 0]\n";
+        dict << "/CharProcs <<\n" << charProcs.data() << ">>\n";
+        dict << "/Encoding << /Type /Encoding /Differences [0" << differences.data() << "] >>\n";
+        dict << "/FirstChar 0\n/LastChar " << glyphCount - 1 << '\n';
+        dict << "/Widths [" << widths.data() << "]\n";
+        dict << "/Resources << >>\n";
+        dict << "/ToUnicode " << toUnicodeObj << " 0 R\n>>";
+        writer.write(dict);
+        writer.endObj(t3.objId);
+    }
+}
+
 // --- Header/Footer rendering ---
 
-void PdfGenerator::renderHeaderFooter(QByteArray &stream, const PageLayout &pageLayout,
+void PdfGenerator::renderHeaderFooter(Pdf::Buffer &stream, const PageLayout &pageLayout,
                                        int pageNumber, int totalPages,
                                        qreal pageWidth, qreal pageHeight)
 {
@@ -644,9 +732,9 @@ void PdfGenerator::renderHeaderFooter(QByteArray &stream, const PageLayout &page
         qreal marginRight = pageLayout.margins.right() * 72.0 / 25.4;
         qreal textY = rectY;
 
-        stream += "BT\n";
-        stream += "/" + fname + " " + pdfCoord(fontSize) + " Tf\n";
-        stream += "0.53 0.53 0.53 rg\n"; // #888888
+        stream << "BT\n";
+        stream << '/' << fname << ' ' << Pdf::coord(fontSize) << " Tf\n";
+        stream << "0.53 0.53 0.53 rg\n"; // #888888
 
         // Helper: measure text width and collect glyph IDs
         auto measureText = [&](const QString &text) -> qreal {
@@ -663,14 +751,14 @@ void PdfGenerator::renderHeaderFooter(QByteArray &stream, const PageLayout &page
             for (QChar ch : text) {
                 FT_UInt gid = FT_Get_Char_Index(font->ftFace, ch.unicode());
                 m_fontManager->markGlyphUsed(font, gid);
-                stream += Pdf::toHexString16(static_cast<quint16>(gid)) + " Tj\n";
+                stream.appendGlyph(static_cast<quint16>(gid)) << " Tj\n";
             }
         };
 
         // Left field
         QString leftText = resolveField(left);
         if (!leftText.isEmpty()) {
-            stream += "1 0 0 1 " + pdfCoord(marginLeft) + " " + pdfCoord(textY) + " Tm\n";
+            stream << "1 0 0 1 " << Pdf::coord(marginLeft) << ' ' << Pdf::coord(textY) << " Tm\n";
             emitText(leftText);
         }
 
@@ -679,7 +767,7 @@ void PdfGenerator::renderHeaderFooter(QByteArray &stream, const PageLayout &page
         if (!centerText.isEmpty()) {
             qreal textWidth = measureText(centerText);
             qreal centerX = (pageWidth - textWidth) / 2;
-            stream += "1 0 0 1 " + pdfCoord(centerX) + " " + pdfCoord(textY) + " Tm\n";
+            stream << "1 0 0 1 " << Pdf::coord(centerX) << ' ' << Pdf::coord(textY) << " Tm\n";
             emitText(centerText);
         }
 
@@ -688,11 +776,11 @@ void PdfGenerator::renderHeaderFooter(QByteArray &stream, const PageLayout &page
         if (!rightText.isEmpty()) {
             qreal textWidth = measureText(rightText);
             qreal rightX = pageWidth - marginRight - textWidth;
-            stream += "1 0 0 1 " + pdfCoord(rightX) + " " + pdfCoord(textY) + " Tm\n";
+            stream << "1 0 0 1 " << Pdf::coord(rightX) << ' ' << Pdf::coord(textY) << " Tm\n";
             emitText(rightText);
         }
 
-        stream += "ET\n";
+        stream << "ET\n";
     };
 
     qreal mTop = pageLayout.margins.top() * 72.0 / 25.4;
@@ -708,10 +796,10 @@ void PdfGenerator::renderHeaderFooter(QByteArray &stream, const PageLayout &page
         qreal sepY = pageHeight - mTop;
         qreal mLeft = pageLayout.margins.left() * 72.0 / 25.4;
         qreal mRight = pageLayout.margins.right() * 72.0 / 25.4;
-        stream += "q\n0.80 0.80 0.80 RG\n0.5 w\n";
-        stream += pdfCoord(mLeft) + " " + pdfCoord(sepY) + " m "
-                + pdfCoord(pageWidth - mRight) + " " + pdfCoord(sepY) + " l S\n";
-        stream += "Q\n";
+        stream << "q\n0.80 0.80 0.80 RG\n0.5 w\n";
+        stream << Pdf::coord(mLeft) << ' ' << Pdf::coord(sepY) << " m "
+               << Pdf::coord(pageWidth - mRight) << ' ' << Pdf::coord(sepY) << " l S\n";
+        stream << "Q\n";
     }
 
     // Footer
@@ -724,10 +812,10 @@ void PdfGenerator::renderHeaderFooter(QByteArray &stream, const PageLayout &page
         qreal sepY = mBottom + PageLayout::kFooterHeight;
         qreal mLeft = pageLayout.margins.left() * 72.0 / 25.4;
         qreal mRight = pageLayout.margins.right() * 72.0 / 25.4;
-        stream += "q\n0.80 0.80 0.80 RG\n0.5 w\n";
-        stream += pdfCoord(mLeft) + " " + pdfCoord(sepY) + " m "
-                + pdfCoord(pageWidth - mRight) + " " + pdfCoord(sepY) + " l S\n";
-        stream += "Q\n";
+        stream << "q\n0.80 0.80 0.80 RG\n0.5 w\n";
+        stream << Pdf::coord(mLeft) << ' ' << Pdf::coord(sepY) << " m "
+               << Pdf::coord(pageWidth - mRight) << ' ' << Pdf::coord(sepY) << " l S\n";
+        stream << "Q\n";
     }
 }
 
@@ -884,8 +972,10 @@ Pdf::ObjId PdfGenerator::writeOutlines(Pdf::Writer &writer,
 
         // Destination: page + XYZ position
         if (entry.pageIndex >= 0 && entry.pageIndex < pageObjIds.size()) {
-            writer.write("/Dest [" + Pdf::toObjRef(pageObjIds[entry.pageIndex])
-                         + " /XYZ 0 " + pdfCoord(entry.destY) + " null]\n");
+            Pdf::Buffer dest(64);
+            dest << "/Dest [" << pageObjIds[entry.pageIndex] << " 0 R /XYZ 0 "
+                 << Pdf::coord(entry.destY) << " null]\n";
+            writer.write(dest);
         }
 
         if (prevIdx >= 0)
@@ -971,14 +1061,19 @@ Pdf::ObjId PdfGenerator::writeCidFont(Pdf::Writer &writer, FontFace *face,
 
     // 4. Glyph widths
     Pdf::ObjId widthsObj = writer.startObj();
-    writer.write("[");
+    Pdf::Buffer widths(face->usedGlyphs.size() * 14 + 2);
+    widths << '[';
     qreal upem = m_fontManager->unitsPerEm(face);
-    for (uint gid : face->usedGlyphs) {
+    // usedGlyphs is a hash set; sort so the array is the same on every run
+    QList<uint> gids(face->usedGlyphs.cbegin(), face->usedGlyphs.cend());
+    std::sort(gids.begin(), gids.end());
+    for (uint gid : std::as_const(gids)) {
         qreal w = m_fontManager->glyphWidth(face, gid, upem);
         int pdfWidth = static_cast<int>(w * 1000.0 / upem);
-        writer.write(Pdf::toPdf(gid) + " [" + Pdf::toPdf(pdfWidth) + "] ");
+        widths << gid << " [" << pdfWidth << "] ";
     }
-    writer.write("]");
+    widths << ']';
+    writer.write(widths);
     writer.endObj(widthsObj);
 
     // 5. ToUnicode CMap
@@ -1011,14 +1106,14 @@ Pdf::ObjId PdfGenerator::writeCidFont(Pdf::Writer &writer, FontFace *face,
 
 QByteArray PdfGenerator::buildToUnicodeCMap(FontFace *face)
 {
-    QByteArray cmap;
-    cmap += "/CIDInit /ProcSet findresource begin\n";
-    cmap += "12 dict begin\n";
-    cmap += "begincmap\n";
-    cmap += "/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n";
-    cmap += "/CMapName /Adobe-Identity-UCS def\n";
-    cmap += "/CMapType 2 def\n";
-    cmap += "1 begincodespacerange\n<0000> <FFFF>\nendcodespacerange\n";
+    Pdf::Buffer cmap(1024);
+    cmap << "/CIDInit /ProcSet findresource begin\n";
+    cmap << "12 dict begin\n";
+    cmap << "begincmap\n";
+    cmap << "/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n";
+    cmap << "/CMapName /Adobe-Identity-UCS def\n";
+    cmap << "/CMapType 2 def\n";
+    cmap << "1 begincodespacerange\n<0000> <FFFF>\nendcodespacerange\n";
 
     // Build glyph-to-unicode mapping using FreeType's charmap
     QList<QPair<uint, uint>> mappings; // glyph ID → unicode
@@ -1037,18 +1132,62 @@ QByteArray PdfGenerator::buildToUnicodeCMap(FontFace *face)
     int pos = 0;
     while (pos < mappings.size()) {
         int batchSize = qMin(100, mappings.size() - pos);
-        cmap += Pdf::toPdf(batchSize) + " beginbfchar\n";
+        cmap << batchSize << " beginbfchar\n";
         for (int i = 0; i < batchSize; ++i) {
             auto [gid, unicode] = mappings[pos + i];
-            cmap += "<" + QByteArray::number(gid, 16).toUpper().rightJustified(4, '0') + "> "
-                  + "<" + QByteArray::number(unicode, 16).toUpper().rightJustified(4, '0') + ">\n";
+            cmap.appendGlyph(static_cast<quint16>(gid)) << " <";
+            // Supplementary-plane characters map to a UTF-16 surrogate pair
+            if (unicode > 0xFFFF) {
+                cmap.appendHex16(QChar::highSurrogate(unicode));
+                cmap.appendHex16(QChar::lowSurrogate(unicode));
+            } else {
+                cmap.appendHex16(static_cast<quint16>(unicode));
+            }
+            cmap << ">\n";
+        }
+        cmap << "endbfchar\n";
+        pos += batchSize;
+    }
+
+    cmap << "endcmap\n";
+    cmap << "CMapName currentdict /CMap defineresource pop\n";
+    cmap << "end\nend\n";
+    return cmap.take();
+}
+
+QByteArray PdfGenerator::buildType3ToUnicodeCMap(const QList<char32_t> &codepoints)
+{
+    Pdf::Buffer cmap(512 + codepoints.size() * 16);
+    cmap << "/CIDInit /ProcSet findresource begin\n";
+    cmap << "12 dict begin\n";
+    cmap << "begincmap\n";
+    cmap << "/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n";
+    cmap << "/CMapName /Adobe-Identity-UCS def\n";
+    cmap << "/CMapType 2 def\n";
+    cmap << "1 begincodespacerange\n<00> <FF>\nendcodespacerange\n";
+
+    // Codes are indices into @p codepoints; batches of 100 as above
+    int pos = 0;
+    while (pos < codepoints.size()) {
+        int batchSize = qMin(100, codepoints.size() - pos);
+        cmap << batchSize << " beginbfchar\n";
+        for (int i = 0; i < batchSize; ++i) {
+            const char32_t unicode = codepoints[pos + i];
+            cmap.appendCode(static_cast<quint8>(pos + i)) << " <";
+            if (unicode > 0xFFFF) {
+                cmap.appendHex16(QChar::highSurrogate(unicode));
+                cmap.appendHex16(QChar::lowSurrogate(unicode));
+            } else {
+                cmap.appendHex16(static_cast<quint16>(unicode));
+            }
+            cmap << ">\n";
         }
-        cmap += "endbfchar\n";
+        cmap << "endbfchar\n";
         pos += batchSize;
     }
 
-    cmap += "endcmap\n";
-    cmap += "CMapName currentdict /CMap defineresource pop\n";
-    cmap += "end\nend\n";
-    return cmap;
+    cmap << "endcmap\n";
+    cmap << "CMapName currentdict /CMap defineresource pop\n";
+    cmap << "end\nend\n";
+    return cmap.take();
 }
@@ -2,7 +2,8 @@
  * pdfgenerator.h — Box tree → PDF content streams + font embedding
  *
  * Converts Layout::LayoutResult into a complete PDF document.
- * Uses CIDFont Type 2 + Identity-H encoding for text,
+ * Uses CIDFont Type 2 + Identity-H encoding for text, Type 3 fonts
+ * with stroked glyph procedures for Hershey text, and
  * DCTDecode/FlateDecode for images.
  *
  * Page content rendering is delegated to PdfBoxRenderer; this class
@@ -71,7 +72,7 @@ private:
     QByteArray buildToUnicodeCMap(FontFace *face);
 
     // Header/footer rendering
-    void renderHeaderFooter(QByteArray &stream, const PageLayout &pageLayout,
+    void renderHeaderFooter(Pdf::Buffer &stream, const PageLayout &pageLayout,
                             int pageNumber, int totalPages,
                             qreal pageWidth, qreal pageHeight);
 
@@ -85,19 +86,15 @@ private:
     };
     // Glyph Form XObjects (reusable vector glyph drawings)
     struct GlyphFormKey {
-        const HersheyFont *hersheyFont = nullptr;
         FontFace *ttfFace = nullptr;
         uint glyphId = 0;
-        bool bold = false;
 
         bool operator==(const GlyphFormKey &o) const {
-            return hersheyFont == o.hersheyFont && ttfFace == o.ttfFace
-                   && glyphId == o.glyphId && bold == o.bold;
+            return ttfFace == o.ttfFace && glyphId == o.glyphId;
         }
     };
     friend size_t qHash(const PdfGenerator::GlyphFormKey &k, size_t seed = 0) {
-        return qHashMulti(seed, quintptr(k.hersheyFont), quintptr(k.ttfFace),
-                          k.glyphId, k.bold);
+        return qHashMulti(seed, quintptr(k.ttfFace), k.glyphId);
     }
 
     struct GlyphFormEntry {
@@ -108,8 +105,38 @@ private:
 
     QHash<GlyphFormKey, GlyphFormEntry> m_glyphForms;
     int m_nextGlyphFormIdx = 0;
-    GlyphFormEntry ensureGlyphForm(const HersheyFont *hersheyFont, FontFace *ttfFace,
-                                   uint glyphId, bool bold);
+    GlyphFormEntry ensureGlyphForm(FontFace *ttfFace, uint glyphId);
+
+    // Hershey Type 3 fonts: one per (font, bold) and per 256 glyphs.
+    // Codes are handed out in first-use order while pages render; font
+    // objects are reserved when first used and written after the last page.
+    struct HersheyGlyphKey {
+        const HersheyFont *font = nullptr;
+        bool bold = false;
+        char32_t codepoint = 0;
+
+        bool operator==(const HersheyGlyphKey &o) const {
+            return font == o.font && bold == o.bold && codepoint == o.codepoint;
+        }
+    };
+    friend size_t qHash(const PdfGenerator::HersheyGlyphKey &k, size_t seed = 0) {
+        return qHashMulti(seed, quintptr(k.font), k.bold, uint(k.codepoint));
+    }
+
+    struct Type3Font {
+        Pdf::ObjId objId = 0;
+        QByteArray pdfName;         // "HF0", "HF1", ...
+        const HersheyFont *font = nullptr;
+        bool bold = false;
+        QList<char32_t> codepoints; // indexed by code
+    };
+
+    QList<Type3Font> m_type3Fonts;
+    QHash<HersheyGlyphKey, HersheyGlyphCode> m_hersheyCodes;
+    HersheyGlyphCode ensureHersheyGlyph(const HersheyFont *font, bool bold,
+                                        char32_t codepoint);
+    void writeType3Fonts(Pdf::Writer &writer);
+    static QByteArray buildType3ToUnicodeCMap(const QList<char32_t> &codepoints);
 
     QList<EmbeddedImage> m_embeddedImages;
     QHash<QString, int> m_imageIndex; // imageId -> index in m_embeddedImages
@@ -131,10 +158,6 @@ private:
                               const Layout::LayoutResult &layout,
                               const PageLayout &pageLayout);
 
-    // Utility
-    static QByteArray colorOperator(const QColor &color, bool fill = true);
-    static QByteArray pdfCoord(qreal v);
-
     FontManager *m_fontManager;
     QString m_filename;
     QString m_title;
@@ -143,6 +166,7 @@ private:
     bool m_hasHersheyGlyphs = false;
     Pdf::Writer *m_writer = nullptr;           // set during generate(), null otherwise
     Pdf::ResourceDict *m_resources = nullptr;  // set during generate(), null otherwise
+    qsizetype m_lastStreamSize = 0;            // previous page's content stream, for reserve
 };
 
 #endif // PRETTYREADER_PDFGENERATOR_H
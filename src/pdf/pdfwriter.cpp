@@ -6,6 +6,7 @@
  */
 
 #include "pdfwriter.h"
+#include "utf16.h"
 
 #include <QCryptographicHash>
 #include <cassert>
@@ -87,20 +88,18 @@ QByteArray toPdfDocEncoding(const QString &s)
 
 QByteArray toUTF16(const QString &s)
 {
-    QByteArray result;
-    result.reserve(2 + s.length() * 2);
-    result.append('\xfe');
-    result.append('\xff');
-    for (int i = 0; i < s.length(); ++i) {
-        result.append(static_cast<char>(s[i].row()));
-        result.append(static_cast<char>(s[i].cell()));
-    }
+    QByteArray result(2 + s.length() * 2, Qt::Uninitialized);
+    result[0] = '\xfe';
+    result[1] = '\xff';
+    Utf16::toBigEndian(s, result.data() + 2);
     return result;
 }
 
 QByteArray toObjRef(ObjId id)
 {
-    return toPdf(id) + " 0 R";
+    Buffer out(16);
+    out << id << " 0 R";
+    return out.take();
 }
 
 QByteArray toLiteralString(const QByteArray &s)
@@ -149,13 +148,9 @@ QByteArray toHexString(const QByteArray &s)
 
 QByteArray toHexString16(quint16 b)
 {
-    QByteArray result("<");
-    result.append("0123456789ABCDEF"[(b >> 12) & 0xf]);
-    result.append("0123456789ABCDEF"[(b >> 8) & 0xf]);
-    result.append("0123456789ABCDEF"[(b >> 4) & 0xf]);
-    result.append("0123456789ABCDEF"[b & 0xf]);
-    result.append('>');
-    return result;
+    Buffer out(6);
+    out.appendGlyph(b);
+    return out.take();
 }
 
 QByteArray toName(const QByteArray &s)
@@ -186,12 +181,7 @@ QByteArray toDateString(const QDateTime &dt)
 
 // --- Writer implementation ---
 
-Writer::Writer()
-{
-    m_fileId = QCryptographicHash::hash(
-        QDateTime::currentDateTime().toString().toUtf8(),
-        QCryptographicHash::Md5);
-}
+Writer::Writer() = default;
 
 bool Writer::openFile(const QString &filename)
 {
@@ -206,6 +196,7 @@ bool Writer::openFile(const QString &filename)
     m_infoObj = 2;
     m_pagesObj = 3;
     m_xref.clear();
+    m_contentHash.reset();
     return true;
 }
 
@@ -222,6 +213,7 @@ bool Writer::openBuffer(QByteArray *buffer)
     m_infoObj = 2;
     m_pagesObj = 3;
     m_xref.clear();
+    m_contentHash.reset();
     return true;
 }
 
@@ -242,17 +234,18 @@ bool Writer::close(bool aborted)
     return ok && !aborted;
 }
 
-void Writer::writeRaw(const QByteArray &bytes)
+void Writer::writeRaw(QByteArrayView bytes)
 {
     if (m_usingBuffer) {
         m_buffer->append(bytes);
     } else {
-        m_file.write(bytes);
+        m_file.write(bytes.data(), bytes.size());
     }
+    m_contentHash.addData(bytes);
     m_bytesWritten += bytes.size();
 }
 
-void Writer::write(const QByteArray &bytes)
+void Writer::write(QByteArrayView bytes)
 {
     writeRaw(bytes);
 }
@@ -266,50 +259,50 @@ void Writer::writeHeader()
 void Writer::writeXrefAndTrailer()
 {
     qint64 startXref = m_bytesWritten;
-    write("xref\n");
-    write("0 " + toPdf(m_objCounter) + "\n");
+    // Fixed 20-byte entries, written in one go
+    Buffer out(m_xref.count() * 20 + 256);
+    out << "xref\n";
+    out << "0 " << m_objCounter << '\n';
     for (int i = 0; i < m_xref.count(); ++i) {
         if (m_xref[i] > 0) {
-            QByteArray offset = QByteArray::number(m_xref[i]);
-            while (offset.length() < 10)
-                offset.prepend('0');
-            write(offset + " 00000 n \n");
+            char offset[10];
+            qint64 v = m_xref[i];
+            for (int d = 9; d >= 0; --d, v /= 10)
+                offset[d] = static_cast<char>('0' + v % 10);
+            out.append(offset, 10) << " 00000 n \n";
         } else {
-            write("0000000000 65535 f \n");
+            out << "0000000000 65535 f \n";
         }
     }
-    write("trailer\n<<\n");
-    write("/Size " + toPdf(m_xref.count()) + "\n");
-    QByteArray idHex = toHexString(m_fileId);
-    write("/Root " + toObjRef(m_catalogObj) + "\n");
-    write("/Info " + toObjRef(m_infoObj) + "\n");
-    write("/ID [" + idHex + idHex + "]\n");
-    write(">>\nstartxref\n");
-    write(toPdf(startXref) + "\n%%EOF\n");
+    out << "trailer\n<<\n";
+    out << "/Size " << m_xref.count() << '\n';
+    const QByteArray idHex = toHexString(m_contentHash.result());
+    out << "/Root " << m_catalogObj << " 0 R\n";
+    out << "/Info " << m_infoObj << " 0 R\n";
+    out << "/ID [" << idHex << idHex << "]\n";
+    out << ">>\nstartxref\n";
+    out << startXref << "\n%%EOF\n";
+    write(out);
 }
 
 void Writer::writeResourceDict(const ResourceDict &dict)
 {
-    write("<< /ProcSet [/PDF /Text /ImageB /ImageC /ImageI]\n");
-    if (!dict.fonts.isEmpty()) {
-        write("/Font <<\n");
-        for (auto it = dict.fonts.begin(); it != dict.fonts.end(); ++it)
-            write(toName(it.key()) + " " + toObjRef(it.value()) + "\n");
-        write(">>\n");
-    }
-    if (!dict.xObjects.isEmpty()) {
-        write("/XObject <<\n");
-        for (auto it = dict.xObjects.begin(); it != dict.xObjects.end(); ++it)
-            write(toName(it.key()) + " " + toObjRef(it.value()) + "\n");
-        write(">>\n");
-    }
-    if (!dict.extGState.isEmpty()) {
-        write("/ExtGState <<\n");
-        for (auto it = dict.extGState.begin(); it != dict.extGState.end(); ++it)
-            write(toName(it.key()) + " " + toObjRef(it.value()) + "\n");
-        write(">>\n");
-    }
-    write(">>\n");
+    Buffer out(1024);
+    auto writeEntries = [&out](const char *key, const QMap<QByteArray, ObjId> &entries) {
+        if (entries.isEmpty())
+            return;
+        out << key << " <<\n";
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+            out << toName(it.key()) << ' ' << it.value() << " 0 R\n";
+        out << ">>\n";
+    };
+
+    out << "<< /ProcSet [/PDF /Text /ImageB /ImageC /ImageI]\n";
+    writeEntries("/Font", dict.fonts);
+    writeEntries("/XObject", dict.xObjects);
+    writeEntries("/ExtGState", dict.extGState);
+    out << ">>\n";
+    write(out);
 }
 
 ObjId Writer::reserveObjects(unsigned int n)
@@ -327,7 +320,9 @@ void Writer::startObj(ObjId id)
     while (static_cast<uint>(m_xref.length()) <= id)
         m_xref.append(0);
     m_xref[id] = m_bytesWritten;
-    write(toPdf(id) + " 0 obj\n");
+    Buffer out(24);
+    out << id << " 0 obj\n";
+    write(out);
 }
 
 ObjId Writer::startObj()
@@ -367,12 +362,14 @@ void Writer::endObjectWithStream(ObjId id, const QByteArray &streamContent, bool
         data = streamContent;
     }
 
-    write("/Length " + toPdf(data.size()) + "\n");
+    Buffer header(96);
+    header << "/Length " << data.size() << '\n';
     if (compressed) {
-        write("/Filter /FlateDecode\n");
-        write("/Length1 " + toPdf(streamContent.size()) + "\n");
+        header << "/Filter /FlateDecode\n";
+        header << "/Length1 " << streamContent.size() << '\n';
     }
-    write(">>\nstream\n");
+    header << ">>\nstream\n";
+    write(header);
     write(data);
     write("\nendstream");
     endObj(id);
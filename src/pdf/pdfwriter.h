@@ -5,7 +5,8 @@
  *   - No encryption, no PDFVersion enum, no ScStreamFilter
  *   - Hardcoded PDF-1.7
  *   - In-memory QByteArray output alongside file output
- *   - Simple QHash resource dictionaries
+ *   - Simple QMap resource dictionaries (sorted, so output is reproducible)
+ *   - Document /ID derived from the file content instead of the clock
  *
  * SPDX-License-Identifier: GPL-2.0-or-later
  */
@@ -15,11 +16,14 @@
 
 #include <type_traits>
 
+#include "pdfbuffer.h"
+
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QFile>
-#include <QHash>
 #include <QList>
+#include <QMap>
 #include <QString>
 
 namespace Pdf {
@@ -35,10 +39,10 @@ QByteArray toPdfDocEncoding(const QString &s);
 
 QByteArray toUTF16(const QString &s);
 template <typename T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>, bool> = true>
-inline QByteArray toPdf(T v) { return QByteArray::number(static_cast<qlonglong>(v)); }
+inline QByteArray toPdf(T v) { return formatInteger(static_cast<qlonglong>(v)); }
 
 template <typename T, std::enable_if_t<std::is_floating_point_v<T>, bool> = true>
-inline QByteArray toPdf(T v) { return QByteArray::number(v, 'f', 6); }
+inline QByteArray toPdf(T v) { return formatFixed(v, 6); }
 
 QByteArray toObjRef(ObjId id);
 
@@ -56,9 +60,9 @@ QByteArray toDateString(const QDateTime &dt);
 // --- Resource dictionary (simplified from Scribus) ---
 
 struct ResourceDict {
-    QHash<QByteArray, ObjId> fonts;
-    QHash<QByteArray, ObjId> xObjects;
-    QHash<QByteArray, ObjId> extGState;
+    QMap<QByteArray, ObjId> fonts;
+    QMap<QByteArray, ObjId> xObjects;
+    QMap<QByteArray, ObjId> extGState;
 };
 
 // --- PDF Writer ---
@@ -75,7 +79,8 @@ public:
     // PDF structure
     void writeHeader();
     void writeXrefAndTrailer();
-    void write(const QByteArray &bytes);
+    void write(QByteArrayView bytes);
+    void write(const Buffer &buffer) { write(QByteArrayView(buffer.data())); }
     void writeResourceDict(const ResourceDict &dict);
 
     // Object management
@@ -109,9 +114,11 @@ private:
     ObjId m_infoObj = 0;
     ObjId m_pagesObj = 0;
 
-    QByteArray m_fileId;
+    // MD5 of everything before the trailer; becomes the /ID, so identical
+    // documents get identical files.
+    QCryptographicHash m_contentHash{QCryptographicHash::Md5};
 
-    void writeRaw(const QByteArray &bytes);
+    void writeRaw(QByteArrayView bytes);
 };
 
 } // namespace Pdf
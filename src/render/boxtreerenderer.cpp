@@ -188,38 +188,20 @@ void BoxTreeRenderer::renderFootnoteSectionBox(const Layout::FootnoteSectionBox
 void BoxTreeRenderer::renderLineBox(const Layout::LineBox &line,
                                      qreal originX, qreal originY, qreal availWidth)
 {
+    if (line.boxX.size() != line.glyphs.size()) {
+        // Not from Engine::layoutBlock(); resolve a copy
+        Layout::LineBox resolved = line;
+        Layout::resolveLinePositions(resolved, availWidth);
+        renderLineBox(resolved, originX, originY, availWidth);
+        return;
+    }
+
     qreal baselineY = originY + line.baseline;
 
-    // Justification
-    JustifyParams jp = computeJustification(line, availWidth);
-
-    qreal x;
-
-    if (jp.doJustify) {
-        x = originX;
-        for (int i = 0; i < line.glyphs.size(); ++i) {
-            renderGlyphBox(line.glyphs[i], x, baselineY);
-            x += line.glyphs[i].width;
-            if (i < line.glyphs.size() - 1)
-                x += jp.extraPerChar * line.glyphs[i].glyphs.size();
-            if (i < line.glyphs.size() - 1) {
-                if (!Layout::shouldSkipJustifyGap(line.glyphs[i], line.glyphs[i + 1]))
-                    x += jp.extraPerGap;
-            }
-        }
-    } else {
-        qreal xOffset = 0;
-        if (line.alignment == Qt::AlignCenter)
-            xOffset = (availWidth - line.width) / 2;
-        else if (line.alignment == Qt::AlignRight)
-            xOffset = availWidth - line.width;
-
-        x = originX + xOffset;
-        for (const auto &gbox : line.glyphs) {
-            renderGlyphBox(gbox, x, baselineY);
-            x += gbox.width;
-        }
-    }
+    // Positions were resolved at layout time
+    for (int i = 0; i < line.glyphs.size(); ++i)
+        renderGlyphBox(line.glyphs[i], originX + line.boxX[i], baselineY);
+    const qreal x = originX + line.hyphenX;
 
     // Trailing soft-hyphen
     if (line.showTrailingHyphen && !line.glyphs.isEmpty()) {
@@ -281,25 +263,7 @@ void BoxTreeRenderer::renderGlyphBox(const Layout::GlyphBox &gbox,
 
     drawInlineBackground(gbox, x, baselineY);
 
-    // Build glyph positions
-    GlyphRenderInfo info;
-    info.glyphIds.reserve(gbox.glyphs.size());
-    info.positions.reserve(gbox.glyphs.size());
-
-    qreal curX = 0;
-    for (const auto &g : gbox.glyphs) {
-        info.glyphIds.append(g.glyphId);
-        qreal gx = curX + g.xOffset;
-        qreal gy = -g.yOffset; // layout Y is top-down
-        if (gbox.style.superscript)
-            gy -= gbox.fontSize * RenderConstants::kSuperscriptRise;
-        else if (gbox.style.subscript)
-            gy += gbox.fontSize * RenderConstants::kSubscriptDrop;
-        info.positions.append(QPointF(gx, gy));
-        curX += g.xAdvance;
-    }
-
-    drawGlyphs(gbox.font, gbox.fontSize, info, gbox.style.foreground, x, baselineY);
+    drawGlyphs(gbox.font, gbox.fontSize, gbox.run, gbox.style.foreground, x, baselineY);
 
     renderGlyphDecorations(gbox, x, baselineY, x + gbox.width);
 }
@@ -320,20 +284,14 @@ void BoxTreeRenderer::renderHersheyGlyphBox(const Layout::GlyphBox &gbox,
     if (gbox.font->hersheyBold)
         strokeWidth *= HersheyConstants::kBoldStrokeMultiplier;
 
-    qreal curX = x;
-    for (const auto &g : gbox.glyphs) {
-        const HersheyGlyph *hGlyph = hFont->glyph(static_cast<char32_t>(g.glyphId));
-        if (!hGlyph) {
-            curX += g.xAdvance;
+    const Layout::GlyphRun &run = gbox.run;
+    for (int i = 0; i < run.glyphIds.size(); ++i) {
+        const HersheyGlyph *hGlyph = hFont->glyph(static_cast<char32_t>(run.glyphIds[i]));
+        if (!hGlyph)
             continue;
-        }
 
-        qreal gx = curX + g.xOffset;
-        qreal gy = baselineY - g.yOffset;
-        if (gbox.style.superscript)
-            gy -= fontSize * RenderConstants::kSuperscriptRise;
-        else if (gbox.style.subscript)
-            gy += fontSize * RenderConstants::kSubscriptDrop;
+        qreal gx = x + run.positions[i].x();
+        qreal gy = baselineY + run.positions[i].y();
 
         QTransform t;
         if (gbox.font->hersheyItalic)
@@ -352,11 +310,9 @@ void BoxTreeRenderer::renderHersheyGlyphBox(const Layout::GlyphBox &gbox,
         }
 
         drawHersheyStrokes(strokes, t, gbox.style.foreground, strokeWidth);
-
-        curX += g.xAdvance;
     }
 
-    renderGlyphDecorations(gbox, x, baselineY, curX);
+    renderGlyphDecorations(gbox, x, baselineY, x + gbox.width);
 }
 
 void BoxTreeRenderer::renderGlyphDecorations(const Layout::GlyphBox &gbox,
@@ -427,78 +383,3 @@ void BoxTreeRenderer::drawInlineBackground(const Layout::GlyphBox &gbox,
                  gbox.style.background);
     }
 }
-
-// --- Shared justification helpers ---
-
-JustifyParams BoxTreeRenderer::computeJustification(const Layout::LineBox &line,
-                                                    qreal availWidth,
-                                                    qreal maxJustifyGap) const
-{
-    JustifyParams result;
-
-    if (line.alignment != Qt::AlignJustify || line.isLastLine
-        || line.glyphs.size() <= 1 || line.width >= availWidth)
-        return result;
-
-    if (line.justify.wordGapCount > 0) {
-        // New path: use pre-computed JustifyInfo from the layout engine
-        result.doJustify = true;
-        result.extraPerGap = line.justify.extraWordSpacing;
-        result.extraPerChar = line.justify.extraLetterSpacing;
-        return result;
-    }
-
-    // Legacy fallback: compute gaps inline
-    int gapCount = 0;
-    for (int i = 1; i < line.glyphs.size(); ++i) {
-        if (!Layout::shouldSkipJustifyGap(line.glyphs[i - 1], line.glyphs[i]))
-            gapCount++;
-    }
-
-    if (gapCount > 0) {
-        qreal extraSpace = availWidth - line.width;
-        qreal epg = extraSpace / gapCount;
-        if (epg <= maxJustifyGap) {
-            result.doJustify = true;
-            result.extraPerGap = epg;
-        }
-    }
-
-    return result;
-}
-
-QList<qreal> BoxTreeRenderer::computeGlyphXPositions(const Layout::LineBox &line,
-                                                     qreal originX,
-                                                     qreal availWidth) const
-{
-    JustifyParams jp = computeJustification(line, availWidth);
-    QList<qreal> positions;
-    positions.reserve(line.glyphs.size());
-
-    if (jp.doJustify) {
-        qreal cx = originX;
-        for (int i = 0; i < line.glyphs.size(); ++i) {
-            positions.append(cx);
-            cx += line.glyphs[i].width;
-            if (i < line.glyphs.size() - 1)
-                cx += jp.extraPerChar * line.glyphs[i].glyphs.size();
-            if (i < line.glyphs.size() - 1) {
-                if (!Layout::shouldSkipJustifyGap(line.glyphs[i], line.glyphs[i + 1]))
-                    cx += jp.extraPerGap;
-            }
-        }
-    } else {
-        qreal xOffset = 0;
-        if (line.alignment == Qt::AlignCenter)
-            xOffset = (availWidth - line.width) / 2;
-        else if (line.alignment == Qt::AlignRight)
-            xOffset = availWidth - line.width;
-        qreal cx = originX + xOffset;
-        for (int i = 0; i < line.glyphs.size(); ++i) {
-            positions.append(cx);
-            cx += line.glyphs[i].width;
-        }
-    }
-
-    return positions;
-}
@@ -28,24 +28,8 @@
 class FontManager;
 struct FontFace;
 
-/// Named constants for superscript/subscript positioning.
-namespace RenderConstants {
-    constexpr qreal kSuperscriptRise = 0.35;
-    constexpr qreal kSubscriptDrop = 0.15;
-}
-
 /// Glyph IDs and positions relative to the drawing origin (x, baselineY).
-struct GlyphRenderInfo {
-    QVector<quint32> glyphIds;
-    QVector<QPointF> positions; // relative to (x, baselineY)
-};
-
-/// Result of justification parameter computation.
-struct JustifyParams {
-    bool doJustify = false;
-    qreal extraPerGap = 0;
-    qreal extraPerChar = 0;
-};
+using GlyphRenderInfo = Layout::GlyphRun;
 
 class BoxTreeRenderer
 {
@@ -129,21 +113,6 @@ protected:
                               qreal x, qreal baselineY);
 
     FontManager *m_fontManager;
-
-    // --- Shared justification helpers ---
-
-    /// Compute justification parameters for a line.
-    /// @param maxJustifyGap  maximum per-gap expansion before giving up
-    ///                       (WebView uses 20 pt, PDF uses its m_maxJustifyGap).
-    JustifyParams computeJustification(const Layout::LineBox &line,
-                                       qreal availWidth,
-                                       qreal maxJustifyGap = 20.0) const;
-
-    /// Compute x-position of each glyph box in a justified/aligned line.
-    /// Returns a list the same size as line.glyphs.
-    QList<qreal> computeGlyphXPositions(const Layout::LineBox &line,
-                                        qreal originX,
-                                        qreal availWidth) const;
 };
 
 #endif // PRETTYREADER_BOXTREERENDERER_H
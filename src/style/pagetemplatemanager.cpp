@@ -24,12 +24,23 @@ PageTemplateManager::PageTemplateManager(QObject *parent)
                    == QLatin1String("pageTemplate");
         },
         {userTemplatesDir()});
+
+    m_store.watchUserDirs(this, [this]() {
+        m_cache.clear();
+        Q_EMIT templatesChanged();
+    });
 }
 
 PageTemplate PageTemplateManager::pageTemplate(const QString &id) const
 {
+    auto it = m_cache.constFind(id);
+    if (it != m_cache.constEnd())
+        return it.value();
+
     QJsonObject json = m_store.loadJson(id);
-    return json.isEmpty() ? PageTemplate{} : PageTemplate::fromJson(json);
+    if (json.isEmpty())
+        return PageTemplate{};
+    return *m_cache.insert(id, PageTemplate::fromJson(json));
 }
 
 QString PageTemplateManager::saveTemplate(const PageTemplate &tmpl)
@@ -39,14 +50,17 @@ QString PageTemplateManager::saveTemplate(const PageTemplate &tmpl)
         toSave.id = QStringLiteral("placeholder");
     QString id = m_store.save(tmpl.id, tmpl.name,
                               toSave.toJson(), QStringLiteral("template"));
-    if (!id.isEmpty())
+    if (!id.isEmpty()) {
+        m_cache.remove(id);
         Q_EMIT templatesChanged();
+    }
     return id;
 }
 
 bool PageTemplateManager::deleteTemplate(const QString &id)
 {
     if (m_store.remove(id, "PageTemplateManager")) {
+        m_cache.remove(id);
         Q_EMIT templatesChanged();
         return true;
     }
@@ -7,6 +7,7 @@
 #ifndef PRETTYREADER_PAGETEMPLATEMANAGER_H
 #define PRETTYREADER_PAGETEMPLATEMANAGER_H
 
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QStringList>
@@ -33,6 +34,7 @@ Q_SIGNALS:
 
 private:
     ResourceStore m_store;
+    mutable QHash<QString, PageTemplate> m_cache; // parsed on first request
 };
 
 #endif // PRETTYREADER_PAGETEMPLATEMANAGER_H
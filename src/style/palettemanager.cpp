@@ -24,12 +24,23 @@ PaletteManager::PaletteManager(QObject *parent)
                    == QLatin1String("colorPalette");
         },
         {userPalettesDir()});
+
+    m_store.watchUserDirs(this, [this]() {
+        m_cache.clear();
+        Q_EMIT palettesChanged();
+    });
 }
 
 ColorPalette PaletteManager::palette(const QString &id) const
 {
+    auto it = m_cache.constFind(id);
+    if (it != m_cache.constEnd())
+        return it.value();
+
     QJsonObject json = m_store.loadJson(id);
-    return json.isEmpty() ? ColorPalette{} : ColorPalette::fromJson(json);
+    if (json.isEmpty())
+        return ColorPalette{};
+    return *m_cache.insert(id, ColorPalette::fromJson(json));
 }
 
 QString PaletteManager::savePalette(const ColorPalette &palette)
@@ -39,14 +50,17 @@ QString PaletteManager::savePalette(const ColorPalette &palette)
         toSave.id = QStringLiteral("placeholder");
     QString id = m_store.save(palette.id, palette.name,
                               toSave.toJson(), QStringLiteral("palette"));
-    if (!id.isEmpty())
+    if (!id.isEmpty()) {
+        m_cache.remove(id);
         Q_EMIT palettesChanged();
+    }
     return id;
 }
 
 bool PaletteManager::deletePalette(const QString &id)
 {
     if (m_store.remove(id, "PaletteManager")) {
+        m_cache.remove(id);
         Q_EMIT palettesChanged();
         return true;
     }
@@ -7,6 +7,7 @@
 #ifndef PRETTYREADER_PALETTEMANAGER_H
 #define PRETTYREADER_PALETTEMANAGER_H
 
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QStringList>
@@ -33,6 +34,7 @@ Q_SIGNALS:
 
 private:
     ResourceStore m_store;
+    mutable QHash<QString, ColorPalette> m_cache; // parsed on first request
 };
 
 #endif // PRETTYREADER_PALETTEMANAGER_H
@@ -0,0 +1,129 @@
+/*
+ * resourcestore.cpp — Built-in cache, refresh and file watching for
+ *                     ResourceStore
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "resourcestore.h"
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTimer>
+
+QList<ResourceStore::Entry> ResourceStore::builtinEntries(const QString &resourceDir,
+                                                          const TypeChecker &matchesType)
+{
+    // Built-ins are compiled in and never change while running: parse the
+    // bundled JSON once per process, whichever manager asks first.
+    static QMutex s_mutex;
+    static QHash<QString, QList<Entry>> s_builtins;
+
+    QMutexLocker lock(&s_mutex);
+    auto it = s_builtins.constFind(resourceDir);
+    if (it != s_builtins.constEnd())
+        return it.value();
+
+    QList<Entry> entries;
+    scanDir(entries, QStringLiteral(":/") + resourceDir, matchesType, true);
+    s_builtins.insert(resourceDir, entries);
+    return entries;
+}
+
+void ResourceStore::ensureScanned() const
+{
+    if (m_scanned)
+        return;
+    // Logically const: the entries are what discover() already described
+    auto *self = const_cast<ResourceStore *>(this);
+    self->m_scanned = true;
+    self->rescan();
+    self->rewatch();
+}
+
+void ResourceStore::rescan()
+{
+    // Built-in resources bundled as Qt resources
+    m_entries = builtinEntries(m_resourceDir, m_matchesType);
+
+    // User resources from XDG data directories
+    for (const QString &dirPath : std::as_const(m_userDirs))
+        scanDir(m_entries, dirPath, m_matchesType, false);
+}
+
+bool ResourceStore::refresh()
+{
+    // Nothing was handed out yet, so nothing can have changed
+    if (!m_scanned) {
+        ensureScanned();
+        return false;
+    }
+
+    const QList<Entry> previous = m_entries;
+    rescan();
+    rewatch();
+    return !(m_entries == previous);
+}
+
+void ResourceStore::watchUserDirs(QObject *owner, const std::function<void()> &onChanged)
+{
+    if (m_watcher)
+        return;
+
+    m_watcher = new QFileSystemWatcher(owner);
+
+    // Editors save via temp file + rename, which arrives as a burst of
+    // directory and file events: coalesce them into one refresh.
+    m_refreshTimer = new QTimer(owner);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(200);
+    QObject::connect(m_refreshTimer, &QTimer::timeout, owner, [this, onChanged]() {
+        if (refresh())
+            onChanged();
+    });
+
+    QObject::connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+                     m_refreshTimer, qOverload<>(&QTimer::start));
+    QObject::connect(m_watcher, &QFileSystemWatcher::fileChanged,
+                     m_refreshTimer, qOverload<>(&QTimer::start));
+
+    rewatch();
+}
+
+void ResourceStore::rewatch()
+{
+    // The first scan starts watching
+    if (!m_watcher || !m_scanned)
+        return;
+
+    QStringList wanted;
+    for (const QString &dirPath : std::as_const(m_userDirs)) {
+        if (QFileInfo::exists(dirPath))
+            wanted.append(dirPath);
+    }
+    for (const Entry &e : std::as_const(m_entries)) {
+        if (!e.builtin)
+            wanted.append(e.path);
+    }
+
+    // Paths removed by a rename drop out of the watcher on their own;
+    // re-adding is needed for files replaced in place.
+    QStringList watched = m_watcher->directories() + m_watcher->files();
+    QStringList stale;
+    for (const QString &path : std::as_const(watched)) {
+        if (!wanted.contains(path))
+            stale.append(path);
+    }
+    if (!stale.isEmpty())
+        m_watcher->removePaths(stale);
+
+    QStringList missing;
+    for (const QString &path : std::as_const(wanted)) {
+        if (!watched.contains(path))
+            missing.append(path);
+    }
+    if (!missing.isEmpty())
+        m_watcher->addPaths(missing);
+}
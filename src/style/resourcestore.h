@@ -4,6 +4,15 @@
  * Factored out of PaletteManager, PageTemplateManager, and TypeSetManager.
  * Not a QObject — the owning manager handles signals.
  *
+ * Each file is parsed once; loadJson() hands out the cached (implicitly
+ * shared) object.  Built-in resources are parsed once per process and
+ * shared by every store.  watchUserDirs() re-scans the user directories
+ * when they change on disk.
+ *
+ * Discovery is lazy: the directories are scanned (and watched) on first
+ * use, so stores nothing reads during startup cost nothing.  GUI thread
+ * only.
+ *
  * SPDX-License-Identifier: GPL-2.0-or-later
  */
 
@@ -23,6 +32,10 @@
 
 #include <functional>
 
+class QFileSystemWatcher;
+class QObject;
+class QTimer;
+
 class ResourceStore
 {
 public:
@@ -31,28 +44,43 @@ public:
         QString name;
         QString path;
         bool builtin = false;
+        QJsonObject json; // parsed once at discovery
+
+        bool operator==(const Entry &o) const
+        {
+            return id == o.id && name == o.name && path == o.path
+                && builtin == o.builtin && json == o.json;
+        }
     };
 
     using TypeChecker = std::function<bool(const QJsonObject &)>;
 
     /// Discover resources from a Qt resource dir and one or more user dirs.
+    /// The scan itself runs on first use.
     void discover(const QString &resourceDir,
                   const TypeChecker &matchesType,
                   const QStringList &userDirs)
     {
+        m_resourceDir = resourceDir;
+        m_matchesType = matchesType;
+        m_userDirs = userDirs;
         m_userDir = userDirs.isEmpty() ? QString() : userDirs.first();
         m_entries.clear();
+        m_scanned = false;
+    }
 
-        // Built-in resources bundled as Qt resources
-        scanDir(QStringLiteral(":/") + resourceDir, matchesType, true);
+    /// Re-run discovery with the same arguments.  Returns true if any
+    /// entry was added, removed or changed.
+    bool refresh();
 
-        // User resources from XDG data directories
-        for (const QString &dirPath : userDirs)
-            scanDir(dirPath, matchesType, false);
-    }
+    /// Watch the user directories (and the files in them); on change,
+    /// refresh() after a short debounce and call @p onChanged if the
+    /// set of resources differs.  The watcher is owned by @p owner.
+    void watchUserDirs(QObject *owner, const std::function<void()> &onChanged);
 
     QStringList availableIds() const
     {
+        ensureScanned();
         QStringList ids;
         for (const auto &e : m_entries)
             ids.append(e.id);
@@ -61,6 +89,7 @@ public:
 
     QString name(const QString &id) const
     {
+        ensureScanned();
         for (const auto &e : m_entries) {
             if (e.id == id)
                 return e.name;
@@ -70,6 +99,7 @@ public:
 
     bool isBuiltin(const QString &id) const
     {
+        ensureScanned();
         for (const auto &e : m_entries) {
             if (e.id == id)
                 return e.builtin;
@@ -79,14 +109,10 @@ public:
 
     QJsonObject loadJson(const QString &id) const
     {
+        ensureScanned();
         for (const auto &e : m_entries) {
-            if (e.id == id) {
-                QFile file(e.path);
-                if (!file.open(QIODevice::ReadOnly))
-                    return {};
-                QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-                return doc.isNull() ? QJsonObject{} : doc.object();
-            }
+            if (e.id == id)
+                return e.json;
         }
         return {};
     }
@@ -98,6 +124,7 @@ public:
         if (m_userDir.isEmpty())
             return {};
 
+        ensureScanned();
         QDir().mkpath(m_userDir);
 
         QString id = itemId;
@@ -139,22 +166,25 @@ public:
 
         QString displayName = json.value(QLatin1String("name")).toString(id);
         if (!found) {
-            m_entries.append({id, displayName, path, false});
+            m_entries.append({id, displayName, path, false, json});
         } else {
             for (auto &e : m_entries) {
                 if (e.id == id) {
                     e.name = displayName;
                     e.path = path;
+                    e.json = json;
                     break;
                 }
             }
         }
 
+        rewatch();
         return id;
     }
 
     bool remove(const QString &id, const char *managerName)
     {
+        ensureScanned();
         for (int i = 0; i < m_entries.size(); ++i) {
             if (m_entries[i].id == id) {
                 if (m_entries[i].builtin)
@@ -163,6 +193,7 @@ public:
                     qWarning("%s: failed to remove %s",
                              managerName, qPrintable(m_entries[i].path));
                 m_entries.removeAt(i);
+                rewatch();
                 return true;
             }
         }
@@ -170,7 +201,17 @@ public:
     }
 
 private:
-    void scanDir(const QString &dirPath, const TypeChecker &matchesType, bool builtin)
+    // Runs the deferred discovery scan
+    void ensureScanned() const;
+    void rescan();
+    void rewatch();
+
+    // Parsed built-in entries for @p resourceDir, shared process-wide
+    static QList<Entry> builtinEntries(const QString &resourceDir,
+                                       const TypeChecker &matchesType);
+
+    static void scanDir(QList<Entry> &entries, const QString &dirPath,
+                        const TypeChecker &matchesType, bool builtin)
     {
         QDir dir(dirPath);
         if (!dir.exists())
@@ -199,19 +240,28 @@ private:
 
             // Skip if already known (built-ins take precedence)
             bool alreadyKnown = false;
-            for (const auto &existing : m_entries) {
+            for (const auto &existing : std::as_const(entries)) {
                 if (existing.id == id) { alreadyKnown = true; break; }
             }
             if (alreadyKnown)
                 continue;
 
             QString name = root.value(QLatin1String("name")).toString(id);
-            m_entries.append({id, name, path, builtin});
+            entries.append({id, name, path, builtin, root});
         }
     }
 
     QList<Entry> m_entries;
+    bool m_scanned = false;
     QString m_userDir;
+
+    // discover() arguments, kept for refresh()
+    QString m_resourceDir;
+    TypeChecker m_matchesType;
+    QStringList m_userDirs;
+
+    QFileSystemWatcher *m_watcher = nullptr; // owned by the watching QObject
+    QTimer *m_refreshTimer = nullptr;
 };
 
 #endif // PRETTYREADER_RESOURCESTORE_H
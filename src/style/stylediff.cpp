@@ -0,0 +1,370 @@
+/*
+ * stylediff.cpp — Classify the effect of a style edit on a rendered document
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stylediff.h"
+#include "pagelayout.h"
+#include "stylemanager.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+
+namespace {
+
+template<typename T>
+bool sameOptional(bool hadBefore, const T &before, bool hasAfter, const T &after)
+{
+    return hadBefore == hasAfter && (!hadBefore || before == after);
+}
+
+bool sameBorderMetrics(bool hadBefore, const TableStyle::Border &before,
+                       bool hasAfter, const TableStyle::Border &after)
+{
+    return hadBefore == hasAfter
+        && (!hadBefore || (qFuzzyCompare(before.width, after.width)
+                           && before.style == after.style));
+}
+
+bool sameMasterPage(const MasterPage &a, const MasterPage &b)
+{
+    return a.headerEnabled == b.headerEnabled
+        && a.footerEnabled == b.footerEnabled
+        && a.hasHeaderLeft == b.hasHeaderLeft && a.headerLeft == b.headerLeft
+        && a.hasHeaderCenter == b.hasHeaderCenter && a.headerCenter == b.headerCenter
+        && a.hasHeaderRight == b.hasHeaderRight && a.headerRight == b.headerRight
+        && a.hasFooterLeft == b.hasFooterLeft && a.footerLeft == b.footerLeft
+        && a.hasFooterCenter == b.hasFooterCenter && a.footerCenter == b.footerCenter
+        && a.hasFooterRight == b.hasFooterRight && a.footerRight == b.footerRight
+        && a.marginTop == b.marginTop && a.marginBottom == b.marginBottom
+        && a.marginLeft == b.marginLeft && a.marginRight == b.marginRight;
+}
+
+bool sameFootnoteStyle(const FootnoteStyle &a, const FootnoteStyle &b)
+{
+    return a.format == b.format && a.startNumber == b.startNumber
+        && a.restart == b.restart && a.prefix == b.prefix && a.suffix == b.suffix
+        && a.superscriptRef == b.superscriptRef && a.superscriptNote == b.superscriptNote
+        && a.asEndnotes == b.asEndnotes && a.showSeparator == b.showSeparator
+        && a.separatorWidth == b.separatorWidth && a.separatorLength == b.separatorLength;
+}
+
+template<typename Key, typename Value>
+QSet<Key> keySet(const QHash<Key, Value> &hash)
+{
+    QSet<Key> keys;
+    keys.reserve(hash.size());
+    for (auto it = hash.cbegin(); it != hash.cend(); ++it)
+        keys.insert(it.key());
+    return keys;
+}
+
+// Serializes properties for fingerprint().  Optional properties write
+// their presence flag and, only when present, the value, mirroring
+// sameOptional() above.
+class FingerprintStream
+{
+public:
+    FingerprintStream()
+        : m_stream(&m_data, QIODevice::WriteOnly)
+    {
+        // Pinned so fingerprints survive a Qt upgrade
+        m_stream.setVersion(QDataStream::Qt_6_0);
+    }
+
+    template<typename T>
+    FingerprintStream &operator<<(const T &value)
+    {
+        m_stream << value;
+        return *this;
+    }
+
+    template<typename T>
+    FingerprintStream &optional(bool has, const T &value)
+    {
+        m_stream << has;
+        if (has)
+            m_stream << value;
+        return *this;
+    }
+
+    FingerprintStream &border(bool has, const TableStyle::Border &b)
+    {
+        m_stream << has;
+        if (has)
+            m_stream << b.width << int(b.style) << b.color.rgba();
+        return *this;
+    }
+
+    FingerprintStream &masterPage(const MasterPage &mp)
+    {
+        *this << mp.headerEnabled << mp.footerEnabled;
+        optional(mp.hasHeaderLeft, mp.headerLeft);
+        optional(mp.hasHeaderCenter, mp.headerCenter);
+        optional(mp.hasHeaderRight, mp.headerRight);
+        optional(mp.hasFooterLeft, mp.footerLeft);
+        optional(mp.hasFooterCenter, mp.footerCenter);
+        optional(mp.hasFooterRight, mp.footerRight);
+        return *this << mp.marginTop << mp.marginBottom << mp.marginLeft << mp.marginRight;
+    }
+
+    QByteArray result() const
+    {
+        return QCryptographicHash::hash(m_data, QCryptographicHash::Sha256);
+    }
+
+private:
+    QByteArray m_data;
+    QDataStream m_stream;
+};
+
+QStringList sorted(QStringList names)
+{
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+} // namespace
+
+void StyleDiff::raise(Impact impact)
+{
+    if (impact > m_impact)
+        m_impact = impact;
+}
+
+bool StyleDiff::compareMetric(bool same)
+{
+    if (!same)
+        raise(Relayout);
+    return !same;
+}
+
+bool StyleDiff::compareColor(bool hadBefore, const QColor &before,
+                             bool hasAfter, const QColor &after)
+{
+    // A colour that appears or disappears can change which fallback a use
+    // site takes (table rows, justification of background spans)
+    if (hadBefore != hasAfter) {
+        raise(Relayout);
+        return true;
+    }
+    if (!hadBefore || before.rgba() == after.rgba())
+        return false;
+
+    raise(Repaint);
+    return true;
+}
+
+StyleDiff StyleDiff::compare(StyleManager *before, StyleManager *after)
+{
+    StyleDiff diff;
+    if (!before || !after) {
+        diff.m_impact = Rebuild;
+        return diff;
+    }
+
+    if (keySet(before->paragraphStyles()) != keySet(after->paragraphStyles())
+        || keySet(before->characterStyles()) != keySet(after->characterStyles())
+        || keySet(before->tableStyles()) != keySet(after->tableStyles())
+        || !sameFootnoteStyle(before->footnoteStyle(), after->footnoteStyle())) {
+        diff.m_impact = Rebuild;
+        return diff;
+    }
+
+    for (const QString &name : before->paragraphStyleNames()) {
+        const ParagraphStyle a = before->resolvedParagraphStyle(name);
+        const ParagraphStyle b = after->resolvedParagraphStyle(name);
+        bool changed = false;
+
+        changed |= diff.compareMetric(sameOptional(a.hasAlignment(), a.alignment(), b.hasAlignment(), b.alignment())
+            && sameOptional(a.hasSpaceBefore(), a.spaceBefore(), b.hasSpaceBefore(), b.spaceBefore())
+            && sameOptional(a.hasSpaceAfter(), a.spaceAfter(), b.hasSpaceAfter(), b.spaceAfter())
+            && sameOptional(a.hasLeftMargin(), a.leftMargin(), b.hasLeftMargin(), b.leftMargin())
+            && sameOptional(a.hasRightMargin(), a.rightMargin(), b.hasRightMargin(), b.rightMargin())
+            && sameOptional(a.hasLineHeight(), a.lineHeightPercent(), b.hasLineHeight(), b.lineHeightPercent())
+            && sameOptional(a.hasFirstLineIndent(), a.firstLineIndent(), b.hasFirstLineIndent(), b.firstLineIndent())
+            && sameOptional(a.hasWordSpacing(), a.wordSpacing(), b.hasWordSpacing(), b.wordSpacing())
+            && sameOptional(a.hasFontFeatures(), a.fontFeatures(), b.hasFontFeatures(), b.fontFeatures())
+            && sameOptional(a.hasFontFamily(), a.fontFamily(), b.hasFontFamily(), b.fontFamily())
+            && sameOptional(a.hasFontSize(), a.fontSize(), b.hasFontSize(), b.fontSize())
+            && sameOptional(a.hasFontWeight(), a.fontWeight(), b.hasFontWeight(), b.fontWeight())
+            && sameOptional(a.hasFontItalic(), a.fontItalic(), b.hasFontItalic(), b.fontItalic())
+            && a.headingLevel() == b.headingLevel());
+        changed |= diff.compareColor(a.hasForeground(), a.foreground(), b.hasForeground(), b.foreground());
+        changed |= diff.compareColor(a.hasBackground(), a.background(), b.hasBackground(), b.background());
+
+        if (changed)
+            diff.m_changedStyles.append(name);
+    }
+
+    for (const QString &name : before->characterStyleNames()) {
+        const CharacterStyle a = before->resolvedCharacterStyle(name);
+        const CharacterStyle b = after->resolvedCharacterStyle(name);
+        bool changed = false;
+
+        changed |= diff.compareMetric(sameOptional(a.hasFontFamily(), a.fontFamily(), b.hasFontFamily(), b.fontFamily())
+            && sameOptional(a.hasFontSize(), a.fontSize(), b.hasFontSize(), b.fontSize())
+            && sameOptional(a.hasFontWeight(), a.fontWeight(), b.hasFontWeight(), b.fontWeight())
+            && sameOptional(a.hasFontItalic(), a.fontItalic(), b.hasFontItalic(), b.fontItalic())
+            && sameOptional(a.hasFontUnderline(), a.fontUnderline(), b.hasFontUnderline(), b.fontUnderline())
+            && sameOptional(a.hasFontStrikeOut(), a.fontStrikeOut(), b.hasFontStrikeOut(), b.fontStrikeOut())
+            && sameOptional(a.hasLetterSpacing(), a.letterSpacing(), b.hasLetterSpacing(), b.letterSpacing())
+            && sameOptional(a.hasFontFeatures(), a.fontFeatures(), b.hasFontFeatures(), b.fontFeatures()));
+        changed |= diff.compareColor(a.hasForeground(), a.foreground(), b.hasForeground(), b.foreground());
+        changed |= diff.compareColor(a.hasBackground(), a.background(), b.hasBackground(), b.background());
+
+        if (changed)
+            diff.m_changedStyles.append(name);
+    }
+
+    for (const QString &name : before->tableStyleNames()) {
+        const TableStyle a = *before->tableStyle(name);
+        const TableStyle b = *after->tableStyle(name);
+        bool changed = false;
+
+        // The alternation period decides which rows get which background
+        changed |= diff.compareMetric(a.cellPadding() == b.cellPadding()
+            && a.headerParagraphStyle() == b.headerParagraphStyle()
+            && a.bodyParagraphStyle() == b.bodyParagraphStyle()
+            && a.alternateFrequency() == b.alternateFrequency()
+            && sameBorderMetrics(a.hasOuterBorder(), a.outerBorder(), b.hasOuterBorder(), b.outerBorder())
+            && sameBorderMetrics(a.hasInnerBorder(), a.innerBorder(), b.hasInnerBorder(), b.innerBorder())
+            && sameBorderMetrics(a.hasHeaderBottomBorder(), a.headerBottomBorder(),
+                                 b.hasHeaderBottomBorder(), b.headerBottomBorder()));
+        changed |= diff.compareColor(a.hasHeaderBackground(), a.headerBackground(),
+                          b.hasHeaderBackground(), b.headerBackground());
+        changed |= diff.compareColor(a.hasHeaderForeground(), a.headerForeground(),
+                          b.hasHeaderForeground(), b.headerForeground());
+        changed |= diff.compareColor(a.hasBodyBackground(), a.bodyBackground(),
+                          b.hasBodyBackground(), b.bodyBackground());
+        changed |= diff.compareColor(a.hasAlternateRowColor(), a.alternateRowColor(),
+                          b.hasAlternateRowColor(), b.alternateRowColor());
+        changed |= diff.compareColor(a.hasOuterBorder(), a.outerBorder().color,
+                          b.hasOuterBorder(), b.outerBorder().color);
+        changed |= diff.compareColor(a.hasInnerBorder(), a.innerBorder().color,
+                          b.hasInnerBorder(), b.innerBorder().color);
+        changed |= diff.compareColor(a.hasHeaderBottomBorder(), a.headerBottomBorder().color,
+                          b.hasHeaderBottomBorder(), b.headerBottomBorder().color);
+
+        if (changed)
+            diff.m_changedStyles.append(name);
+    }
+
+    return diff;
+}
+
+StyleDiff::Impact StyleDiff::comparePageLayouts(const PageLayout &before, const PageLayout &after)
+{
+    bool sameMasters = before.masterPages.size() == after.masterPages.size();
+    for (auto it = before.masterPages.cbegin(); sameMasters && it != before.masterPages.cend(); ++it) {
+        auto other = after.masterPages.constFind(it.key());
+        sameMasters = other != after.masterPages.cend() && sameMasterPage(it.value(), other.value());
+    }
+
+    // Page size, margins and header/footer presence move the content area
+    if (before.pageSizeId != after.pageSizeId
+        || before.orientation != after.orientation
+        || before.margins != after.margins
+        || before.headerEnabled != after.headerEnabled
+        || before.footerEnabled != after.footerEnabled
+        || !sameMasters)
+        return Relayout;
+
+    // Background and header/footer text are painted at PDF generation
+    if (before.pageBackground != after.pageBackground
+        || before.headerLeft != after.headerLeft
+        || before.headerCenter != after.headerCenter
+        || before.headerRight != after.headerRight
+        || before.footerLeft != after.footerLeft
+        || before.footerCenter != after.footerCenter
+        || before.footerRight != after.footerRight)
+        return Repaint;
+
+    return NoChange;
+}
+
+QByteArray StyleDiff::fingerprint(StyleManager *styles)
+{
+    if (!styles)
+        return {};
+
+    FingerprintStream out;
+    const FootnoteStyle fn = styles->footnoteStyle();
+    out << int(fn.format) << fn.startNumber << int(fn.restart) << fn.prefix << fn.suffix
+        << fn.superscriptRef << fn.superscriptNote << fn.asEndnotes << fn.showSeparator
+        << fn.separatorWidth << fn.separatorLength;
+
+    const QStringList paragraphNames = sorted(styles->paragraphStyleNames());
+    out << paragraphNames;
+    for (const QString &name : paragraphNames) {
+        const ParagraphStyle s = styles->resolvedParagraphStyle(name);
+        out.optional(s.hasAlignment(), s.alignment().toInt())
+            .optional(s.hasSpaceBefore(), s.spaceBefore())
+            .optional(s.hasSpaceAfter(), s.spaceAfter())
+            .optional(s.hasLeftMargin(), s.leftMargin())
+            .optional(s.hasRightMargin(), s.rightMargin())
+            .optional(s.hasLineHeight(), s.lineHeightPercent())
+            .optional(s.hasFirstLineIndent(), s.firstLineIndent())
+            .optional(s.hasWordSpacing(), s.wordSpacing())
+            .optional(s.hasFontFeatures(), quint32(s.fontFeatures().toInt()))
+            .optional(s.hasFontFamily(), s.fontFamily())
+            .optional(s.hasFontSize(), s.fontSize())
+            .optional(s.hasFontWeight(), int(s.fontWeight()))
+            .optional(s.hasFontItalic(), s.fontItalic())
+            .optional(s.hasForeground(), s.foreground().rgba())
+            .optional(s.hasBackground(), s.background().rgba())
+            << s.headingLevel();
+    }
+
+    const QStringList characterNames = sorted(styles->characterStyleNames());
+    out << characterNames;
+    for (const QString &name : characterNames) {
+        const CharacterStyle s = styles->resolvedCharacterStyle(name);
+        out.optional(s.hasFontFamily(), s.fontFamily())
+            .optional(s.hasFontSize(), s.fontSize())
+            .optional(s.hasFontWeight(), int(s.fontWeight()))
+            .optional(s.hasFontItalic(), s.fontItalic())
+            .optional(s.hasFontUnderline(), s.fontUnderline())
+            .optional(s.hasFontStrikeOut(), s.fontStrikeOut())
+            .optional(s.hasLetterSpacing(), s.letterSpacing())
+            .optional(s.hasFontFeatures(), quint32(s.fontFeatures().toInt()))
+            .optional(s.hasForeground(), s.foreground().rgba())
+            .optional(s.hasBackground(), s.background().rgba());
+    }
+
+    const QStringList tableNames = sorted(styles->tableStyleNames());
+    out << tableNames;
+    for (const QString &name : tableNames) {
+        const TableStyle s = *styles->tableStyle(name);
+        out << s.cellPadding() << s.headerParagraphStyle() << s.bodyParagraphStyle()
+            << s.alternateFrequency();
+        out.optional(s.hasHeaderBackground(), s.headerBackground().rgba())
+            .optional(s.hasHeaderForeground(), s.headerForeground().rgba())
+            .optional(s.hasBodyBackground(), s.bodyBackground().rgba())
+            .optional(s.hasAlternateRowColor(), s.alternateRowColor().rgba())
+            .border(s.hasOuterBorder(), s.outerBorder())
+            .border(s.hasInnerBorder(), s.innerBorder())
+            .border(s.hasHeaderBottomBorder(), s.headerBottomBorder());
+    }
+
+    return out.result();
+}
+
+QByteArray StyleDiff::fingerprint(const PageLayout &layout)
+{
+    FingerprintStream out;
+    out << int(layout.pageSizeId) << int(layout.orientation) << layout.margins
+        << layout.pageBackground.rgba() << layout.headerEnabled << layout.footerEnabled
+        << layout.headerLeft << layout.headerCenter << layout.headerRight
+        << layout.footerLeft << layout.footerCenter << layout.footerRight;
+
+    const QStringList names = sorted(layout.masterPages.keys());
+    out << names;
+    for (const QString &name : names)
+        out.masterPage(layout.masterPages.value(name));
+    return out.result();
+}
@@ -0,0 +1,61 @@
+/*
+ * stylediff.h — Classify the effect of a style edit on a rendered document
+ *
+ * Compares two StyleManager snapshots (resolved through their parent
+ * chains) and two PageLayouts, and reports the cheapest pipeline stage
+ * that has to run again:
+ *
+ *   NoChange  nothing that reaches the output differs
+ *   Repaint   only colour values differ; the existing layout can be
+ *             recoloured through its colour slots and repainted
+ *   Relayout  metrics differ (fonts, spacing, margins, page geometry), or
+ *             a colour appears or disappears; only the blocks that read
+ *             one of changedStyles() need laying out again
+ *   Rebuild   the set of styles or the footnote style differs
+ *
+ * fingerprint() hashes the same resolved properties, so two snapshots that
+ * compare as NoChange have equal fingerprints; the export cache keys on it.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_STYLEDIFF_H
+#define PRETTYREADER_STYLEDIFF_H
+
+#include <QByteArray>
+#include <QColor>
+#include <QStringList>
+
+struct PageLayout;
+class StyleManager;
+
+class StyleDiff
+{
+public:
+    enum Impact { NoChange, Repaint, Relayout, Rebuild };
+
+    // Either side may be null, which always yields Rebuild.
+    static StyleDiff compare(StyleManager *before, StyleManager *after);
+    static Impact comparePageLayouts(const PageLayout &before, const PageLayout &after);
+
+    // SHA-256 over everything compare()/comparePageLayouts() look at
+    static QByteArray fingerprint(StyleManager *styles);
+    static QByteArray fingerprint(const PageLayout &layout);
+
+    Impact impact() const { return m_impact; }
+
+    // Names of the styles whose resolved properties differ
+    QStringList changedStyles() const { return m_changedStyles; }
+
+private:
+    void raise(Impact impact);
+    // Both return true if the property differs
+    bool compareMetric(bool same);
+    bool compareColor(bool hadBefore, const QColor &before,
+                      bool hasAfter, const QColor &after);
+
+    Impact m_impact = NoChange;
+    QStringList m_changedStyles;
+};
+
+#endif // PRETTYREADER_STYLEDIFF_H
@@ -125,9 +125,14 @@ QStringList StyleManager::tableStyleNames() const
 StyleManager *StyleManager::clone(QObject *parent) const
 {
     auto *copy = new StyleManager(parent);
-    copy->m_paraStyles = m_paraStyles;
-    copy->m_charStyles = m_charStyles;
-    copy->m_tableStyles = m_tableStyles;
-    copy->m_footnoteStyle = m_footnoteStyle;
+    copy->copyFrom(*this);
     return copy;
 }
+
+void StyleManager::copyFrom(const StyleManager &other)
+{
+    m_paraStyles = other.m_paraStyles;
+    m_charStyles = other.m_charStyles;
+    m_tableStyles = other.m_tableStyles;
+    m_footnoteStyle = other.m_footnoteStyle;
+}
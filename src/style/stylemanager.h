@@ -46,6 +46,8 @@ public:
 
     // Deep-copy this style manager
     StyleManager *clone(QObject *parent = nullptr) const;
+    // Replace all styles with those of @p other (implicitly shared copy)
+    void copyFrom(const StyleManager &other);
 
 private:
     QHash<QString, ParagraphStyle> m_paraStyles;
@@ -21,6 +21,8 @@ void ThemeComposer::setColorPalette(const ColorPalette &palette)
 {
     if (!(m_palette == palette)) {
         m_palette = palette;
+        delete m_composed;
+        m_composed = nullptr;
     }
 }
 
@@ -28,6 +30,10 @@ void ThemeComposer::setTypeSet(const TypeSet &typeSet)
 {
     if (!(m_typeSet == typeSet)) {
         m_typeSet = typeSet;
+        delete m_composed;
+        m_composed = nullptr;
+        delete m_typeSetBase;
+        m_typeSetBase = nullptr;
     }
 }
 
@@ -41,17 +47,27 @@ void ThemeComposer::compose(StyleManager *target)
     if (!target || !m_themeManager)
         return;
 
-    // 1. Load hardcoded defaults to establish the style hierarchy
-    m_themeManager->loadDefaults(target);
+    if (!m_composed) {
+        if (!m_typeSetBase) {
+            m_typeSetBase = new StyleManager(this);
 
-    // 2. Apply type set (fonts + style overrides)
-    applyTypeSet(target);
+            // 1. Load hardcoded defaults to establish the style hierarchy
+            m_themeManager->loadDefaults(m_typeSetBase);
 
-    // 3. Apply color palette (foreground/background colors) — always last
-    applyColorPalette(target);
+            // 2. Apply type set (fonts + style overrides)
+            applyTypeSet(m_typeSetBase);
+        }
+
+        m_composed = m_typeSetBase->clone(this);
+
+        // 3. Apply color palette (foreground/background colors) — always last
+        applyColorPalette(m_composed);
+
+        // 4. Ensure parent hierarchy is intact after all modifications
+        m_themeManager->assignDefaultParents(m_composed);
+    }
 
-    // 4. Ensure parent hierarchy is intact after all modifications
-    m_themeManager->assignDefaultParents(target);
+    target->copyFrom(*m_composed);
 }
 
 void ThemeComposer::applyTypeSet(StyleManager *target)
@@ -29,13 +29,18 @@ public:
     void setColorPalette(const ColorPalette &palette);
     void setTypeSet(const TypeSet &typeSet);
 
-    /// Compose the current type set + palette into @p target.
+    /// Compose the current type set + palette into @p target, replacing
+    /// its styles.
     ///
     /// Composition order:
     ///   1. loadDefaults() — hardcoded style hierarchy
     ///   2. Type set (fonts + style overrides)
     ///   3. Color palette — set foreground/background per the role mapping
     ///   4. assignDefaultParents() — ensure parent hierarchy is intact
+    ///
+    /// Steps 1–2 are cached until the type set changes and the full result
+    /// until either input changes, so switching palettes only re-applies
+    /// the palette and repeated rebuilds just copy the cached styles.
     void compose(StyleManager *target);
 
     const ColorPalette &currentPalette() const { return m_palette; }
@@ -52,6 +57,9 @@ private:
     ThemeManager *m_themeManager = nullptr;
     ColorPalette m_palette;
     TypeSet m_typeSet;
+
+    StyleManager *m_typeSetBase = nullptr; // defaults + type set
+    StyleManager *m_composed = nullptr;    // + palette + parents
 };
 
 #endif // PRETTYREADER_THEMECOMPOSER_H
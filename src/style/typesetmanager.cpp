@@ -31,12 +31,23 @@ TypeSetManager::TypeSetManager(QObject *parent)
                    || type == QLatin1String("typographyTheme");
         },
         {userTypeSetsDir(), legacyUserTypeSetsDir()});
+
+    m_store.watchUserDirs(this, [this]() {
+        m_cache.clear();
+        Q_EMIT typeSetsChanged();
+    });
 }
 
 TypeSet TypeSetManager::typeSet(const QString &id) const
 {
+    auto it = m_cache.constFind(id);
+    if (it != m_cache.constEnd())
+        return it.value();
+
     QJsonObject json = m_store.loadJson(id);
-    return json.isEmpty() ? TypeSet{} : TypeSet::fromJson(json);
+    if (json.isEmpty())
+        return TypeSet{};
+    return *m_cache.insert(id, TypeSet::fromJson(json));
 }
 
 QString TypeSetManager::saveTypeSet(const TypeSet &typeSet)
@@ -46,14 +57,17 @@ QString TypeSetManager::saveTypeSet(const TypeSet &typeSet)
         toSave.id = QStringLiteral("placeholder");
     QString id = m_store.save(typeSet.id, typeSet.name,
                               toSave.toJson(), QStringLiteral("typeset"));
-    if (!id.isEmpty())
+    if (!id.isEmpty()) {
+        m_cache.remove(id);
         Q_EMIT typeSetsChanged();
+    }
     return id;
 }
 
 bool TypeSetManager::deleteTypeSet(const QString &id)
 {
     if (m_store.remove(id, "TypeSetManager")) {
+        m_cache.remove(id);
         Q_EMIT typeSetsChanged();
         return true;
     }
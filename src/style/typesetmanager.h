@@ -7,6 +7,7 @@
 #ifndef PRETTYREADER_TYPESETMANAGER_H
 #define PRETTYREADER_TYPESETMANAGER_H
 
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QStringList>
@@ -33,6 +34,7 @@ Q_SIGNALS:
 
 private:
     ResourceStore m_store;
+    mutable QHash<QString, TypeSet> m_cache; // parsed on first request
 };
 
 #endif // PRETTYREADER_TYPESETMANAGER_H
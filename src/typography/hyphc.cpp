@@ -0,0 +1,42 @@
+/*
+ * hyphc.cpp — Build-time compiler for bundled hyphenation dictionaries
+ *
+ * Usage: prettyreader-hyphc <input.dic> <output.hyb>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "hyphenpatterns.h"
+
+#include <QFile>
+#include <QSaveFile>
+
+#include <cstdio>
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <input.dic> <output.hyb>\n", argv[0]);
+        return 2;
+    }
+
+    QFile input(QString::fromLocal8Bit(argv[1]));
+    if (!input.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "prettyreader-hyphc: cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    QByteArray compiled;
+    if (!HyphenPatterns::compile(input.readAll(), &compiled)) {
+        std::fprintf(stderr, "prettyreader-hyphc: unsupported dictionary %s\n", argv[1]);
+        return 1;
+    }
+
+    QSaveFile output(QString::fromLocal8Bit(argv[2]));
+    if (!output.open(QIODevice::WriteOnly) || output.write(compiled) != compiled.size()
+        || !output.commit()) {
+        std::fprintf(stderr, "prettyreader-hyphc: cannot write %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "hyphenator.h"
+#include "hyphenpatterns.h"
+#include "utf16.h"
 
 #include <QDir>
 #include <QFile>
@@ -8,6 +10,8 @@
 
 #include <hyphen.h>
 
+#include <mutex>
+
 QHash<QString, QString> Hyphenator::s_dictPaths;
 
 static constexpr QChar kSoftHyphen(0x00AD);
@@ -22,9 +26,14 @@ Hyphenator::~Hyphenator()
 
 void Hyphenator::initDictPaths()
 {
-    if (!s_dictPaths.isEmpty())
-        return;
+    // The startup warm-up loads a dictionary on its own thread while the
+    // GUI may already list them; scan once, and let later callers wait
+    static std::once_flag scanned;
+    std::call_once(scanned, scanDictPaths);
+}
 
+void Hyphenator::scanDictPaths()
+{
     // 1. Bundled dictionaries in Qt resources
     QDir resourceDir(QStringLiteral(":/dicts"));
     if (resourceDir.exists()) {
@@ -69,11 +78,12 @@ QStringList Hyphenator::availableLanguages()
 
 bool Hyphenator::loadDictionary(const QString &language)
 {
+    m_patterns.reset();
     if (m_dict) {
         hnj_hyphen_free(m_dict);
         m_dict = nullptr;
-        m_language.clear();
     }
+    m_language.clear();
 
     initDictPaths();
 
@@ -91,6 +101,12 @@ bool Hyphenator::loadDictionary(const QString &language)
     if (path.isEmpty())
         return false;
 
+    m_patterns = HyphenPatterns::load(path);
+    if (m_patterns) {
+        m_language = language;
+        return true;
+    }
+
     // libhyphen needs a real file path, not a Qt resource path.
     // If the dictionary is embedded as a resource, extract to a temp file.
     QString realPath = path;
@@ -119,10 +135,21 @@ bool Hyphenator::loadDictionary(const QString &language)
     return false;
 }
 
-QString Hyphenator::hyphenate(const QString &word) const
+void Hyphenator::wordBreaks(QStringView word, qsizetype base, QList<qsizetype> *positions) const
 {
-    if (!m_dict || word.length() < m_minWordLength)
-        return word;
+    if (word.length() < m_minWordLength)
+        return;
+
+    if (m_patterns) {
+        // Native lookup on UTF-16; same 2/2 minimum prefix and suffix
+        // as the libhyphen path below
+        const auto values = m_patterns->breakValues(word);
+        for (qsizetype k = 2; k <= word.length() - 2; ++k) {
+            if ((values[k] & 1) && !word[k].isLowSurrogate())
+                positions->append(base + k);
+        }
+        return;
+    }
 
     QByteArray utf8 = word.toUtf8();
     int wordLen = utf8.length();
@@ -137,54 +164,24 @@ QString Hyphenator::hyphenate(const QString &word) const
         m_dict, utf8.constData(), wordLen,
         hyphens.data(), nullptr, &rep, &pos, &cut);
 
-    if (ret != 0)
-        return word;
-
-    // Build result with soft hyphens at odd-numbered positions.
-    // The hyphens array contains '0'-'9' characters; odd digits
-    // indicate valid break points.
-    QString result;
-    result.reserve(word.length() + 10);
-
-    // Map UTF-8 byte positions back to QString character positions.
-    // Build a byte-offset -> char-index map.
-    QVector<int> byteToChar(wordLen + 1, 0);
-    int bytePos = 0;
-    for (int charIdx = 0; charIdx < word.length(); ++charIdx) {
-        byteToChar[bytePos] = charIdx;
-        QChar ch = word[charIdx];
-        if (ch.unicode() < 0x80) bytePos += 1;
-        else if (ch.unicode() < 0x800) bytePos += 2;
-        else if (ch.isHighSurrogate()) { bytePos += 4; ++charIdx; }
-        else bytePos += 3;
-    }
-
-    // Track position in the original word independently of result length,
-    // since soft hyphens inserted into result inflate its length.
-    int wordPos = 0;
-    int prevCharIdx = 0;
-    for (int i = 0; i < wordLen; ++i) {
-        int charIdx = (i < byteToChar.size()) ? byteToChar[i] : prevCharIdx;
-        prevCharIdx = charIdx;
-
-        if ((hyphens[i] - '0') & 1) {
-            // Valid break point after this byte position
-            // Only insert if we're past minimum prefix (2 chars) and
-            // before minimum suffix (2 chars from end)
-            int charAfter = (i + 1 < byteToChar.size()) ? byteToChar[i + 1] : word.length();
-            if (charAfter >= 2 && charAfter <= word.length() - 2) {
-                // Copy characters from wordPos up to charAfter
-                while (wordPos < charAfter)
-                    result.append(word[wordPos++]);
-                result.append(kSoftHyphen);
+    if (ret == 0) {
+        // Odd digits in the hyphens array mark valid break points after
+        // a byte.  Map UTF-8 byte positions back to QString character
+        // positions; ASCII words need no map.  Breaks inside a multi-byte
+        // sequence map to -1 and are skipped.
+        const bool ascii = wordLen == word.length();
+        const QList<int> byteToChar = ascii ? QList<int>() : Utf16::utf8Offsets(word);
+        for (int i = 0; i < wordLen; ++i) {
+            if ((hyphens[i] - '0') & 1) {
+                // Only past the minimum prefix (2 chars) and before the
+                // minimum suffix (2 chars from end)
+                const int charAfter = ascii ? i + 1 : byteToChar[i + 1];
+                if (charAfter >= 2 && charAfter <= word.length() - 2)
+                    positions->append(base + charAfter);
             }
         }
     }
 
-    // Append remaining characters
-    while (wordPos < word.length())
-        result.append(word[wordPos++]);
-
     // Free allocated memory from hnj_hyphen_hyphenate2
     if (rep) {
         for (int i = 0; i < wordLen; ++i)
@@ -193,38 +190,53 @@ QString Hyphenator::hyphenate(const QString &word) const
     }
     free(pos);
     free(cut);
+}
 
-    return result;
+QString Hyphenator::hyphenate(const QString &word) const
+{
+    if (!isLoaded())
+        return word;
+    QList<qsizetype> positions;
+    wordBreaks(word, 0, &positions);
+    return insertSoftHyphens(word, positions);
 }
 
-QString Hyphenator::hyphenateText(const QString &text) const
+void Hyphenator::hyphenPositions(QStringView text, QList<qsizetype> *positions) const
 {
-    if (!m_dict || text.isEmpty())
-        return text;
+    if (!isLoaded() || text.isEmpty())
+        return;
 
-    // Split text into words and non-words, preserving everything
     static const QRegularExpression wordRx(
         QStringLiteral(R"([\p{L}\p{M}]+)"));
 
-    QString result;
-    result.reserve(text.length() + text.length() / 10);
-
-    int lastEnd = 0;
-    auto it = wordRx.globalMatch(text);
+    auto it = wordRx.globalMatchView(text);
     while (it.hasNext()) {
-        auto match = it.next();
-        // Append non-word text before this word
-        if (match.capturedStart() > lastEnd)
-            result.append(text.mid(lastEnd, match.capturedStart() - lastEnd));
-
-        // Hyphenate the word
-        result.append(hyphenate(match.captured()));
-        lastEnd = match.capturedEnd();
+        const auto match = it.next();
+        wordBreaks(match.capturedView(), match.capturedStart(), positions);
     }
+}
 
-    // Append remaining non-word text
-    if (lastEnd < text.length())
-        result.append(text.mid(lastEnd));
+QString Hyphenator::hyphenateText(const QString &text) const
+{
+    if (!isLoaded() || text.isEmpty())
+        return text;
+    QList<qsizetype> positions;
+    hyphenPositions(text, &positions);
+    return insertSoftHyphens(text, positions);
+}
 
+QString Hyphenator::insertSoftHyphens(const QString &text, const QList<qsizetype> &positions)
+{
+    if (positions.isEmpty())
+        return text;
+    QString result;
+    result.reserve(text.length() + positions.size());
+    qsizetype copied = 0;
+    for (qsizetype position : positions) {
+        result.append(QStringView(text).mid(copied, position - copied));
+        result.append(kSoftHyphen);
+        copied = position;
+    }
+    result.append(QStringView(text).mid(copied));
     return result;
 }
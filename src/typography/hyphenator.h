@@ -2,8 +2,13 @@
 #define PRETTYREADER_HYPHENATOR_H
 
 #include <QHash>
+#include <QList>
 #include <QString>
 
+#include <memory>
+
+class HyphenPatterns;
+
 // Opaque forward declaration matching the typedef in hyphen.h:
 //   typedef struct _HyphenDict HyphenDict;
 // We use the struct tag directly to avoid redeclaration conflicts.
@@ -16,7 +21,7 @@ public:
     ~Hyphenator();
 
     bool loadDictionary(const QString &language);
-    bool isLoaded() const { return m_dict != nullptr; }
+    bool isLoaded() const { return m_patterns || m_dict; }
 
     // Insert soft hyphens (U+00AD) at valid break points in a word.
     // Returns the word unchanged if no hyphenation points are found
@@ -27,19 +32,35 @@ public:
     // whitespace, punctuation, and existing hyphens.
     QString hyphenateText(const QString &text) const;
 
+    // Indexes in @p text before which hyphenateText() inserts a soft
+    // hyphen, appended to @p positions in ascending order
+    void hyphenPositions(QStringView text, QList<qsizetype> *positions) const;
+
     // Available dictionary languages (scans resource paths)
     static QStringList availableLanguages();
 
     // Set minimum word length for hyphenation
     void setMinWordLength(int len) { m_minWordLength = len; }
+    int minWordLength() const { return m_minWordLength; }
+    // Language of the loaded dictionary, empty if none
+    QString language() const { return m_language; }
 
 private:
+    // Break positions of one word, offset by @p base
+    void wordBreaks(QStringView word, qsizetype base, QList<qsizetype> *positions) const;
+    static QString insertSoftHyphens(const QString &text, const QList<qsizetype> &positions);
+
+    // Precompiled patterns, shared across instances; libhyphen is only
+    // used for dictionaries HyphenPatterns cannot compile.
+    std::shared_ptr<const HyphenPatterns> m_patterns;
     _HyphenDict *m_dict = nullptr;
     int m_minWordLength = 5;
     QString m_language;
 
+    // Filled once by initDictPaths(), read-only afterwards
     static QHash<QString, QString> s_dictPaths;
     static void initDictPaths();
+    static void scanDictPaths();
 };
 
 #endif // PRETTYREADER_HYPHENATOR_H
@@ -0,0 +1,400 @@
+/*
+ * hyphenpatterns.cpp — Precompiled Liang hyphenation patterns
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "hyphenpatterns.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QResource>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringDecoder>
+#include <QtEndian>
+
+#include <cstring>
+
+// Binary layout, all integers little-endian:
+//
+//   header   magic "PRHY", u32 version, u32 nodeCount, u32 edgeCount,
+//            u32 valueBytes, u32 reserved, i64 sourceStamp, i64 sourceSize
+//   nodes    nodeCount x { u32 firstEdge, u16 edgeCount, u16 valueLen,
+//            u32 valueOffset }; node 0 is the root
+//   edges    edgeCount x u16 character (sorted per node), then
+//            edgeCount x u32 child node
+//   values   valueBytes of Liang digits; a pattern of n letters has n + 1
+//            values, one per gap
+
+namespace {
+
+constexpr char kMagic[4] = {'P', 'R', 'H', 'Y'};
+constexpr quint32 kVersion = 1;
+constexpr int kHeaderSize = 40;
+constexpr int kNodeSize = 12;
+
+struct BuildNode {
+    QMap<char16_t, quint32> children;
+    QByteArray values;
+};
+
+bool isKeyword(QStringView token)
+{
+    static const char16_t *const keywords[] = {
+        u"LEFTHYPHENMIN", u"RIGHTHYPHENMIN",
+        u"COMPOUNDLEFTHYPHENMIN", u"COMPOUNDRIGHTHYPHENMIN",
+        u"NOHYPHEN",
+    };
+    for (const char16_t *kw : keywords) {
+        if (token == QStringView(kw))
+            return true;
+    }
+    return false;
+}
+
+void appendU16(QByteArray &out, quint16 v)
+{
+    char buf[2];
+    qToLittleEndian(v, buf);
+    out.append(buf, 2);
+}
+
+void appendU32(QByteArray &out, quint32 v)
+{
+    char buf[4];
+    qToLittleEndian(v, buf);
+    out.append(buf, 4);
+}
+
+void appendI64(QByteArray &out, qint64 v)
+{
+    char buf[8];
+    qToLittleEndian(v, buf);
+    out.append(buf, 8);
+}
+
+QString cachePathFor(const QFileInfo &source)
+{
+    const QByteArray pathHash = QCryptographicHash::hash(
+        source.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex().left(12);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+        + QLatin1String("/hyphenation/") + source.completeBaseName()
+        + QLatin1Char('-') + QString::fromLatin1(pathHash) + QLatin1String(".hyb");
+}
+
+} // namespace
+
+HyphenPatterns::~HyphenPatterns()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+// --- Compilation ---
+
+bool HyphenPatterns::compile(const QByteArray &dicData, QByteArray *out,
+                             qint64 sourceStamp, qint64 sourceSize)
+{
+    // The first line names the charset ("UTF-8", "ISO8859-1", ...)
+    const qsizetype firstNewline = dicData.indexOf('\n');
+    if (firstNewline < 0)
+        return false;
+    QByteArray charset = dicData.left(firstNewline).trimmed();
+    if (charset.startsWith("ISO8859"))
+        charset.insert(3, '-');
+    QStringDecoder decoder(charset.constData());
+    if (!decoder.isValid())
+        return false;
+    const QString text = decoder.decode(QByteArrayView(dicData).mid(firstNewline + 1));
+    if (decoder.hasError())
+        return false;
+
+    QList<BuildNode> nodes(1);
+    const QList<QStringView> lines = QStringView(text).split(u'\n');
+    for (QStringView line : lines) {
+        // A pattern ends at the first whitespace, as libhyphen reads it
+        qsizetype end = 0;
+        while (end < line.size() && !line[end].isSpace())
+            ++end;
+        const QStringView token = line.left(end);
+        if (token.isEmpty() || token[0] == u'%' || token[0] == u'#' || isKeyword(token))
+            continue;
+        if (token == u"NEXTLEVEL")
+            break; // compound level: unused by hnj_hyphen_hyphenate2() either
+        if (token.contains(u'/'))
+            return false; // non-standard hyphenation (replacements)
+
+        quint32 node = 0;
+        QByteArray values(1, 0);
+        for (QChar ch : token) {
+            if (ch >= u'0' && ch <= u'9') {
+                values.back() = char(ch.unicode() - u'0');
+                continue;
+            }
+            auto it = nodes[node].children.constFind(ch.unicode());
+            if (it == nodes[node].children.constEnd()) {
+                const quint32 child = quint32(nodes.size());
+                nodes[node].children.insert(ch.unicode(), child);
+                nodes.append(BuildNode());
+                node = child;
+            } else {
+                node = it.value();
+            }
+            values.append(char(0));
+        }
+        if (node == 0 || values.size() > 0xffff)
+            continue;
+        if (values.count(char(0)) != values.size())
+            nodes[node].values = values;
+    }
+
+    // Serialize
+    quint32 edgeCount = 0;
+    quint32 valueBytes = 0;
+    for (const BuildNode &n : std::as_const(nodes)) {
+        edgeCount += quint32(n.children.size());
+        valueBytes += quint32(n.values.size());
+    }
+
+    out->clear();
+    out->reserve(kHeaderSize + nodes.size() * kNodeSize + edgeCount * 6 + valueBytes);
+    out->append(kMagic, 4);
+    appendU32(*out, kVersion);
+    appendU32(*out, quint32(nodes.size()));
+    appendU32(*out, edgeCount);
+    appendU32(*out, valueBytes);
+    appendU32(*out, 0);
+    appendI64(*out, sourceStamp);
+    appendI64(*out, sourceSize);
+
+    quint32 firstEdge = 0;
+    quint32 valueOffset = 0;
+    for (const BuildNode &n : std::as_const(nodes)) {
+        if (n.children.size() > 0xffff)
+            return false;
+        appendU32(*out, firstEdge);
+        appendU16(*out, quint16(n.children.size()));
+        appendU16(*out, quint16(n.values.size()));
+        appendU32(*out, valueOffset);
+        firstEdge += quint32(n.children.size());
+        valueOffset += quint32(n.values.size());
+    }
+    // QMap keeps children sorted, which the lookup's binary search needs
+    for (const BuildNode &n : std::as_const(nodes)) {
+        for (auto it = n.children.constBegin(); it != n.children.constEnd(); ++it)
+            appendU16(*out, it.key());
+    }
+    for (const BuildNode &n : std::as_const(nodes)) {
+        for (auto it = n.children.constBegin(); it != n.children.constEnd(); ++it)
+            appendU32(*out, it.value());
+    }
+    for (const BuildNode &n : std::as_const(nodes))
+        out->append(n.values);
+
+    return true;
+}
+
+// --- Loading ---
+
+bool HyphenPatterns::attach(const uchar *data, qint64 size)
+{
+    if (!data || size < kHeaderSize || memcmp(data, kMagic, 4) != 0
+        || qFromLittleEndian<quint32>(data + 4) != kVersion)
+        return false;
+
+    const quint32 nodeCount = qFromLittleEndian<quint32>(data + 8);
+    const quint32 edgeCount = qFromLittleEndian<quint32>(data + 12);
+    const quint32 valueBytes = qFromLittleEndian<quint32>(data + 16);
+    if (nodeCount == 0 || nodeCount > 0x7fffffff)
+        return false;
+    const qint64 expected = kHeaderSize + qint64(nodeCount) * kNodeSize
+        + qint64(edgeCount) * 6 + valueBytes;
+    if (size != expected)
+        return false;
+
+    const uchar *nodes = data + kHeaderSize;
+    const uchar *edgeChars = nodes + qint64(nodeCount) * kNodeSize;
+    const uchar *edgeTargets = edgeChars + qint64(edgeCount) * 2;
+    const uchar *values = edgeTargets + qint64(edgeCount) * 4;
+
+    // Validate once so that lookups need no bounds checks
+    for (quint32 i = 0; i < nodeCount; ++i) {
+        const uchar *n = nodes + qint64(i) * kNodeSize;
+        const quint64 edgeEnd = quint64(qFromLittleEndian<quint32>(n))
+            + qFromLittleEndian<quint16>(n + 4);
+        const quint64 valueEnd = quint64(qFromLittleEndian<quint32>(n + 8))
+            + qFromLittleEndian<quint16>(n + 6);
+        if (edgeEnd > edgeCount || valueEnd > valueBytes)
+            return false;
+    }
+    for (quint32 i = 0; i < edgeCount; ++i) {
+        if (qFromLittleEndian<quint32>(edgeTargets + qint64(i) * 4) >= nodeCount)
+            return false;
+    }
+
+    m_data = data;
+    m_nodeCount = nodeCount;
+    m_edgeCount = edgeCount;
+    m_nodes = nodes;
+    m_edgeChars = edgeChars;
+    m_edgeTargets = edgeTargets;
+    m_values = values;
+    return true;
+}
+
+std::shared_ptr<const HyphenPatterns> HyphenPatterns::load(const QString &dicPath)
+{
+    // One copy per dictionary, shared by every Hyphenator in the process
+    static QMutex s_mutex;
+    static QHash<QString, std::weak_ptr<const HyphenPatterns>> s_loaded;
+
+    QMutexLocker lock(&s_mutex);
+    if (auto existing = s_loaded.value(dicPath).lock())
+        return existing;
+
+    std::shared_ptr<const HyphenPatterns> patterns = loadUncached(dicPath);
+    if (patterns)
+        s_loaded.insert(dicPath, patterns);
+    return patterns;
+}
+
+std::shared_ptr<const HyphenPatterns> HyphenPatterns::loadUncached(const QString &dicPath)
+{
+    std::shared_ptr<HyphenPatterns> patterns(new HyphenPatterns);
+
+    if (dicPath.startsWith(QLatin1String(":/"))) {
+        // Bundled: compiled at build time next to the .dic
+        QResource compiled(dicPath.chopped(4) + QLatin1String(".hyb"));
+        if (compiled.isValid()) {
+            if (compiled.compressionAlgorithm() == QResource::NoCompression) {
+                if (patterns->attach(compiled.data(), compiled.size()))
+                    return patterns;
+            } else {
+                patterns->m_owned = compiled.uncompressedData();
+                if (patterns->attach(reinterpret_cast<const uchar *>(patterns->m_owned.constData()),
+                                     patterns->m_owned.size()))
+                    return patterns;
+            }
+        }
+
+        QFile source(dicPath);
+        if (!source.open(QIODevice::ReadOnly)
+            || !compile(source.readAll(), &patterns->m_owned))
+            return {};
+        if (!patterns->attach(reinterpret_cast<const uchar *>(patterns->m_owned.constData()),
+                              patterns->m_owned.size()))
+            return {};
+        return patterns;
+    }
+
+    // System dictionary: compile once into the cache, then map it
+    const QFileInfo sourceInfo(dicPath);
+    const qint64 stamp = sourceInfo.lastModified().toMSecsSinceEpoch();
+    const qint64 size = sourceInfo.size();
+    const QString cachePath = cachePathFor(sourceInfo);
+
+    auto mapCache = [&](HyphenPatterns *p) {
+        p->m_file.setFileName(cachePath);
+        if (!p->m_file.open(QIODevice::ReadOnly))
+            return false;
+        p->m_map = p->m_file.map(0, p->m_file.size());
+        if (p->m_map && p->attach(p->m_map, p->m_file.size())
+            && qFromLittleEndian<qint64>(p->m_data + 24) == stamp
+            && qFromLittleEndian<qint64>(p->m_data + 32) == size)
+            return true;
+        if (p->m_map)
+            p->m_file.unmap(p->m_map);
+        p->m_map = nullptr;
+        p->m_data = nullptr;
+        p->m_file.close();
+        return false;
+    };
+
+    if (mapCache(patterns.get()))
+        return patterns;
+
+    QFile source(dicPath);
+    QByteArray compiled;
+    if (!source.open(QIODevice::ReadOnly)
+        || !compile(source.readAll(), &compiled, stamp, size))
+        return {};
+
+    // Written atomically: other processes keep their mapping of the old file
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile cacheFile(cachePath);
+    if (cacheFile.open(QIODevice::WriteOnly) && cacheFile.write(compiled) == compiled.size()
+        && cacheFile.commit() && mapCache(patterns.get()))
+        return patterns;
+
+    // Cache not writable: keep the compiled copy in memory
+    patterns->m_owned = compiled;
+    if (!patterns->attach(reinterpret_cast<const uchar *>(patterns->m_owned.constData()),
+                          patterns->m_owned.size()))
+        return {};
+    return patterns;
+}
+
+// --- Lookup ---
+
+int HyphenPatterns::findChild(quint32 node, char16_t ch) const
+{
+    const uchar *n = m_nodes + qint64(node) * kNodeSize;
+    const quint32 first = qFromLittleEndian<quint32>(n);
+    int lo = 0;
+    int hi = qFromLittleEndian<quint16>(n + 4);
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const char16_t c = qFromLittleEndian<quint16>(m_edgeChars + qint64(first + mid) * 2);
+        if (c < ch)
+            lo = mid + 1;
+        else if (c > ch)
+            hi = mid;
+        else
+            return int(qFromLittleEndian<quint32>(m_edgeTargets + qint64(first + mid) * 4));
+    }
+    return -1;
+}
+
+QVarLengthArray<quint8, 64> HyphenPatterns::breakValues(QStringView word) const
+{
+    // Liang's algorithm over ".word.": every pattern matching at every
+    // offset raises the values of the gaps it spans
+    const qsizetype n = word.size();
+    QVarLengthArray<char16_t, 64> dotted(n + 2);
+    dotted[0] = u'.';
+    for (qsizetype i = 0; i < n; ++i)
+        dotted[i + 1] = word[i].unicode();
+    dotted[n + 1] = u'.';
+
+    QVarLengthArray<quint8, 64> gaps(n + 3);
+    std::fill(gaps.begin(), gaps.end(), quint8(0));
+
+    for (qsizetype i = 0; i < n + 2; ++i) {
+        quint32 node = 0;
+        for (qsizetype j = i; j < n + 2; ++j) {
+            const int child = findChild(node, dotted[j]);
+            if (child < 0)
+                break;
+            node = quint32(child);
+            const uchar *nd = m_nodes + qint64(node) * kNodeSize;
+            const quint16 len = qFromLittleEndian<quint16>(nd + 6);
+            if (len == 0 || i + len > gaps.size())
+                continue;
+            const uchar *v = m_values + qFromLittleEndian<quint32>(nd + 8);
+            for (quint16 t = 0; t < len; ++t)
+                gaps[i + t] = qMax(gaps[i + t], v[t]);
+        }
+    }
+
+    // Gap k of the word is gap k + 1 of the dotted word
+    QVarLengthArray<quint8, 64> result(n + 1);
+    for (qsizetype k = 0; k <= n; ++k)
+        result[k] = gaps[k + 1];
+    return result;
+}
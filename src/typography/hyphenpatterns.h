@@ -0,0 +1,70 @@
+/*
+ * hyphenpatterns.h — Precompiled Liang hyphenation patterns
+ *
+ * A libhyphen .dic pattern file compiled into a flat binary trie over
+ * UTF-16 code units.  The binary form is used in place: bundled
+ * dictionaries are compiled at build time (prettyreader-hyphc) and read
+ * straight from the resource data, system dictionaries are compiled on
+ * first use into the cache directory and memory-mapped.  Loaded pattern
+ * sets are shared by every Hyphenator in the process, and the mapped
+ * pages by every process.
+ *
+ * Only the first level of two-level (NEXTLEVEL) dictionaries is used,
+ * as with hnj_hyphen_hyphenate2().  Dictionaries with non-standard
+ * (replacement) patterns are rejected; callers fall back to libhyphen.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_HYPHENPATTERNS_H
+#define PRETTYREADER_HYPHENPATTERNS_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringView>
+#include <QVarLengthArray>
+
+#include <memory>
+
+class HyphenPatterns
+{
+public:
+    ~HyphenPatterns();
+
+    // Shared, read-only patterns for a .dic path (file or ":/" resource).
+    // Returns null if the dictionary cannot be compiled.
+    static std::shared_ptr<const HyphenPatterns> load(const QString &dicPath);
+
+    // Compile .dic text into the binary form.  @p sourceStamp and
+    // @p sourceSize identify the source for cache validation.
+    static bool compile(const QByteArray &dicData, QByteArray *out,
+                        qint64 sourceStamp = 0, qint64 sourceSize = 0);
+
+    // Liang values for the gaps of @p word: entry k is the gap before
+    // word[k] (k = 0..word.size()); odd values allow a break.
+    QVarLengthArray<quint8, 64> breakValues(QStringView word) const;
+
+private:
+    HyphenPatterns() = default;
+    bool attach(const uchar *data, qint64 size);
+    static std::shared_ptr<const HyphenPatterns> loadUncached(const QString &dicPath);
+
+    // Trie accessors (all fields little-endian, read unaligned)
+    int findChild(quint32 node, char16_t ch) const;
+
+    const uchar *m_data = nullptr;
+    quint32 m_nodeCount = 0;
+    quint32 m_edgeCount = 0;
+    const uchar *m_nodes = nullptr;
+    const uchar *m_edgeChars = nullptr;
+    const uchar *m_edgeTargets = nullptr;
+    const uchar *m_values = nullptr;
+
+    // Backing storage: one of a mapping, an owned copy, or resource data
+    QFile m_file;
+    uchar *m_map = nullptr;
+    QByteArray m_owned;
+};
+
+#endif // PRETTYREADER_HYPHENPATTERNS_H
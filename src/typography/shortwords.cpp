@@ -2,12 +2,13 @@
 
 #include <QRegularExpression>
 
+#include <algorithm>
+
 static constexpr QChar kNbsp(0x00A0);
 
 ShortWords::ShortWords()
 {
-    loadEnglish();
-    m_language = QStringLiteral("en");
+    setLanguage(QStringLiteral("en"));
 }
 
 void ShortWords::setLanguage(const QString &language)
@@ -26,54 +27,70 @@ void ShortWords::setLanguage(const QString &language)
         loadGerman();
     else
         loadEnglish();
+
+    std::sort(m_words.begin(), m_words.end(), [](const QString &a, const QString &b) {
+        return a.compare(b, Qt::CaseInsensitive) < 0;
+    });
+    m_maxLength = 0;
+    for (const QString &word : std::as_const(m_words))
+        m_maxLength = qMax(m_maxLength, word.size());
 }
 
 QString ShortWords::process(const QString &text) const
 {
-    if (m_words.isEmpty() || text.isEmpty())
+    QList<qsizetype> positions;
+    nbspPositions(text, &positions);
+    if (positions.isEmpty())
         return text;
 
-    QString result;
-    result.reserve(text.length());
+    QString result = text;
+    for (qsizetype position : std::as_const(positions))
+        result[position] = kNbsp;
+    return result;
+}
+
+void ShortWords::nbspPositions(QStringView text, QList<qsizetype> *positions) const
+{
+    if (m_words.isEmpty() || text.isEmpty())
+        return;
 
     // State machine: scan for word boundaries and check if words
     // match the short-word list. Replace the following space with nbsp.
-    int i = 0;
-    int len = text.length();
+    qsizetype i = 0;
+    const qsizetype len = text.length();
 
     while (i < len) {
         // Skip non-letter characters
         if (!text[i].isLetter()) {
-            result.append(text[i]);
             ++i;
             continue;
         }
 
         // Collect word
-        int wordStart = i;
+        const qsizetype wordStart = i;
         while (i < len && text[i].isLetter())
             ++i;
 
-        QString word = text.mid(wordStart, i - wordStart);
-
-        // Check if this word is in the short-words list (case-insensitive)
-        bool isShortWord = m_words.contains(word.toLower());
-
-        result.append(word);
-
         // If it's a short word and followed by a single space and then
         // a letter (not end of text), replace the space with nbsp
-        if (isShortWord && i < len && text[i] == QLatin1Char(' ')) {
-            // Check that next char after space is a letter (not another space or punctuation)
-            if (i + 1 < len && text[i + 1].isLetter()) {
-                result.append(kNbsp);
-                ++i; // skip the space
-            }
-            // Otherwise, keep the normal space
+        if (i + 1 < len && text[i] == QLatin1Char(' ') && text[i + 1].isLetter()
+            && isShortWord(text.mid(wordStart, i - wordStart))) {
+            positions->append(i);
+            ++i; // skip the space
         }
     }
+}
 
-    return result;
+bool ShortWords::isShortWord(QStringView word) const
+{
+    // Case-insensitive lookup in the sorted list, without a lowered copy
+    if (word.size() > m_maxLength)
+        return false;
+    const auto it = std::lower_bound(m_words.cbegin(), m_words.cend(), word,
+        [](const QString &entry, QStringView w) {
+            return QStringView(entry).compare(w, Qt::CaseInsensitive) < 0;
+        });
+    return it != m_words.cend() && QStringView(*it).compare(word, Qt::CaseInsensitive) == 0;
 }
 
 void ShortWords::loadEnglish()
@@ -93,7 +110,7 @@ void ShortWords::loadEnglish()
     };
 
     for (const char *w : words)
-        m_words.insert(QString::fromLatin1(w));
+        m_words.append(QString::fromLatin1(w));
 }
 
 void ShortWords::loadCzech()
@@ -106,7 +123,7 @@ void ShortWords::loadCzech()
     };
 
     for (const char *w : words)
-        m_words.insert(QString::fromLatin1(w));
+        m_words.append(QString::fromLatin1(w));
 }
 
 void ShortWords::loadPolish()
@@ -117,7 +134,7 @@ void ShortWords::loadPolish()
     };
 
     for (const char *w : words)
-        m_words.insert(QString::fromLatin1(w));
+        m_words.append(QString::fromLatin1(w));
 }
 
 void ShortWords::loadFrench()
@@ -130,7 +147,7 @@ void ShortWords::loadFrench()
     };
 
     for (const char *w : words)
-        m_words.insert(QString::fromLatin1(w));
+        m_words.append(QString::fromLatin1(w));
 }
 
 void ShortWords::loadGerman()
@@ -144,5 +161,5 @@ void ShortWords::loadGerman()
     };
 
     for (const char *w : words)
-        m_words.insert(QString::fromLatin1(w));
+        m_words.append(QString::fromLatin1(w));
 }
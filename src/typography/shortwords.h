@@ -1,7 +1,7 @@
 #ifndef PRETTYREADER_SHORTWORDS_H
 #define PRETTYREADER_SHORTWORDS_H
 
-#include <QSet>
+#include <QList>
 #include <QString>
 #include <QStringList>
 
@@ -12,12 +12,17 @@ public:
 
     // Load a language-specific word list. Falls back to English if not found.
     void setLanguage(const QString &language);
+    QString language() const { return m_language; }
 
     // Process text: replace spaces after short words with non-breaking spaces (U+00A0).
     // Prevents short prepositions, articles, and conjunctions from being stranded
     // at line ends.
     QString process(const QString &text) const;
 
+    // Indexes of the spaces in @p text that process() replaces, appended
+    // to @p positions in ascending order
+    void nbspPositions(QStringView text, QList<qsizetype> *positions) const;
+
 private:
     void loadEnglish();
     void loadCzech();
@@ -25,7 +30,10 @@ private:
     void loadFrench();
     void loadGerman();
 
-    QSet<QString> m_words;
+    bool isShortWord(QStringView word) const;
+
+    QStringList m_words; // sorted case-insensitively
+    qsizetype m_maxLength = 0;
     QString m_language;
 };
 
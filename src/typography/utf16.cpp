@@ -0,0 +1,171 @@
+/*
+ * utf16.cpp — UTF-16 transcoding helpers for the text hot paths
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "utf16.h"
+
+#include <QtAlgorithms>
+#include <QtEndian>
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789ABCDEF";
+
+inline void hex16(char16_t u, char *out)
+{
+    out[0] = kHexDigits[u >> 12];
+    out[1] = kHexDigits[(u >> 8) & 0xf];
+    out[2] = kHexDigits[(u >> 4) & 0xf];
+    out[3] = kHexDigits[u & 0xf];
+}
+
+#if defined(__SSE2__)
+// Nibbles (0–15 per byte) to upper-case hex digits
+inline __m128i hexDigits(__m128i nibbles)
+{
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                                          _mm_set1_epi8('A' - '0' - 10));
+    return _mm_add_epi8(nibbles, _mm_add_epi8(_mm_set1_epi8('0'), letters));
+}
+#endif
+
+} // namespace
+
+namespace Utf16 {
+
+qsizetype lengthOfUtf8(const char *utf8, qsizetype size)
+{
+    // One unit per lead byte (anything but 10xxxxxx), two for 4-byte
+    // sequences (11110xxx)
+    qsizetype units = 0;
+    qsizetype i = 0;
+#if defined(__SSE2__)
+    const __m128i lastContinuation = _mm_set1_epi8(char(0xBF));
+    const __m128i lastThreeByteLead = _mm_set1_epi8(char(0xEF));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8 + i));
+        // Signed compares: ASCII is 0..127, 0x80..0xBF is -128..-65
+        const int leads = _mm_movemask_epi8(_mm_cmpgt_epi8(v, lastContinuation));
+        const int fourByte = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpgt_epi8(v, lastThreeByteLead), _mm_cmplt_epi8(v, zero)));
+        units += qPopulationCount(quint32(leads)) + qPopulationCount(quint32(fourByte));
+    }
+#else
+    for (; i + 8 <= size; i += 8) {
+        quint64 word;
+        std::memcpy(&word, utf8 + i, 8);
+        if (word & 0x8080808080808080ull)
+            break;
+        units += 8;
+    }
+#endif
+    for (; i < size; ++i) {
+        const uchar c = uchar(utf8[i]);
+        if ((c & 0xC0) != 0x80)
+            units += c >= 0xF0 ? 2 : 1;
+    }
+    return units;
+}
+
+bool isAscii(QStringView text)
+{
+    const char16_t *p = text.utf16();
+    const qsizetype size = text.size();
+    qsizetype i = 0;
+#if defined(__SSE2__)
+    __m128i bits = _mm_setzero_si128();
+    for (; i + 8 <= size; i += 8)
+        bits = _mm_or_si128(bits, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)));
+    const __m128i high = _mm_and_si128(bits, _mm_set1_epi16(short(0xFF80)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+#endif
+    char16_t rest = 0;
+    for (; i < size; ++i)
+        rest |= p[i];
+    return rest < 0x80;
+}
+
+QList<int> utf8Offsets(QStringView text)
+{
+    QList<int> offsets;
+    const char16_t *p = text.utf16();
+    const int size = int(text.size());
+    if (isAscii(text)) {
+        offsets.resize(size + 1);
+        for (int i = 0; i <= size; ++i)
+            offsets[i] = i;
+        return offsets;
+    }
+
+    offsets.reserve(size * 3 + 1);
+    for (int i = 0; i < size; ++i) {
+        const char16_t u = p[i];
+        offsets.append(i);
+        if (u < 0x80)
+            continue;
+        if (u < 0x800) {
+            offsets.append(-1);
+        } else if (QChar::isHighSurrogate(u) && i + 1 < size && QChar::isLowSurrogate(p[i + 1])) {
+            offsets.append({-1, -1, -1});
+            ++i;
+        } else {
+            offsets.append({-1, -1}); // lone surrogates encode as U+FFFD
+        }
+    }
+    offsets.append(size);
+    return offsets;
+}
+
+void toBigEndian(QStringView text, char *out)
+{
+    const char16_t *p = text.utf16();
+    const qsizetype size = text.size();
+    qsizetype i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= size; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i), swapped);
+    }
+#endif
+    for (; i < size; ++i)
+        qToBigEndian<quint16>(p[i], out + 2 * i);
+}
+
+void toBigEndianHex(QStringView text, char *out)
+{
+    const char16_t *p = text.utf16();
+    const qsizetype size = text.size();
+    qsizetype i = 0;
+#if defined(__SSE2__)
+    const __m128i lowNibbles = _mm_set1_epi16(0x0F0F);
+    for (; i + 8 <= size; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        // Per unit n3 n2 n1 n0 (n3 most significant): these hold bytes
+        // [n1, n3] and [n0, n2]
+        const __m128i odd = _mm_and_si128(_mm_srli_epi16(v, 4), lowNibbles);
+        const __m128i even = _mm_and_si128(v, lowNibbles);
+        // Interleaved to [n1, n0, n3, n2]; swapping the 16-bit halves
+        // gives [n3, n2, n1, n0]
+        __m128i lo = _mm_unpacklo_epi8(odd, even);
+        __m128i hi = _mm_unpackhi_epi8(odd, even);
+        lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * i), hexDigits(lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * i + 16), hexDigits(hi));
+    }
+#endif
+    for (; i < size; ++i)
+        hex16(p[i], out + 4 * i);
+}
+
+} // namespace Utf16
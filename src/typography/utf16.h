@@ -0,0 +1,43 @@
+/*
+ * utf16.h — UTF-16 transcoding helpers for the text hot paths
+ *
+ * Conversions QString does not offer directly, used per text run, word
+ * or PDF string: UTF-16 lengths of UTF-8 input (md4c offsets), UTF-8 to
+ * UTF-16 offset maps (libhyphen results) and big-endian UTF-16, raw or
+ * as hex (PDF text strings, ActualText).  Whole-buffer conversions stay
+ * with QString::toUtf8()/fromUtf8(), which are vectorised already.
+ *
+ * On x86 the loops take 16 bytes at a time with SSE2 (part of the x86-64
+ * baseline); elsewhere they run scalar with a word-at-a-time ASCII skip.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PRETTYREADER_UTF16_H
+#define PRETTYREADER_UTF16_H
+
+#include <QList>
+#include <QStringView>
+
+namespace Utf16 {
+
+// UTF-16 code units encoded by @p size bytes of valid UTF-8
+qsizetype lengthOfUtf8(const char *utf8, qsizetype size);
+
+// True if every code unit of @p text is below U+0080
+bool isAscii(QStringView text);
+
+// For each byte of @p text's UTF-8 form, the index of the code unit
+// starting there, or -1 inside a multi-byte sequence; one extra entry
+// maps the end to text.size().
+QList<int> utf8Offsets(QStringView text);
+
+// 2 * text.size() bytes of big-endian UTF-16 into @p out
+void toBigEndian(QStringView text, char *out);
+
+// 4 * text.size() upper-case hex digits of big-endian UTF-16 into @p out
+void toBigEndianHex(QStringView text, char *out);
+
+} // namespace Utf16
+
+#endif // PRETTYREADER_UTF16_H
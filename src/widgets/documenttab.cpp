@@ -1,6 +1,7 @@
 #include "documenttab.h"
 #include "documentview.h"
 #include "markdownhighlighter.h"
+#include "stylemanager.h"
 
 #include <QFont>
 #include <QPlainTextEdit>
@@ -31,6 +32,9 @@ DocumentTab::DocumentTab(QWidget *parent)
 
     m_stack->addWidget(m_sourceEditor);
     m_stack->setCurrentIndex(0); // Start in reader mode
+
+    // Tabs opened in the background count as idle from the start
+    m_inactiveTimer.start();
 }
 
 void DocumentTab::setSourceMode(bool source)
@@ -57,3 +61,55 @@ void DocumentTab::setTocData(const Content::Document &doc, const QList<Layout::S
     m_sourceMap = sourceMap;
     m_hasTocData = true;
 }
+
+void DocumentTab::setSnapshotStyles(StyleManager *styles)
+{
+    if (styles == m_snapshotStyles)
+        return;
+    delete m_snapshotStyles;
+    m_snapshotStyles = styles;
+    if (m_snapshotStyles)
+        m_snapshotStyles->setParent(this);
+}
+
+void DocumentTab::clearRenderSnapshot()
+{
+    setSnapshotStyles(nullptr);
+    m_renderSnapshot = RenderSnapshot();
+}
+
+void DocumentTab::setActive(bool active)
+{
+    if (m_active == active)
+        return;
+    m_active = active;
+    if (active) {
+        m_inactiveTimer.invalidate();
+        m_documentView->wake();
+    } else {
+        m_inactiveTimer.start();
+    }
+}
+
+qint64 DocumentTab::inactiveMsecs() const
+{
+    return m_inactiveTimer.isValid() ? m_inactiveTimer.elapsed() : 0;
+}
+
+void DocumentTab::hibernate()
+{
+    if (m_active || m_documentView->isHibernated())
+        return;
+    m_documentView->hibernate();
+    if (!m_documentView->isHibernated())
+        return; // nothing to release (legacy view or not yet rendered)
+    // The parse is small next to the layouts and spares a woken tab
+    // md4c, footnotes and hyphenation
+    clearRenderSnapshot();
+    m_preparedLayouts.clear();
+}
+
+bool DocumentTab::isHibernated() const
+{
+    return m_documentView->isHibernated();
+}
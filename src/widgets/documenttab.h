@@ -1,15 +1,18 @@
 #ifndef PRETTYREADER_DOCUMENTTAB_H
 #define PRETTYREADER_DOCUMENTTAB_H
 
+#include <QElapsedTimer>
 #include <QWidget>
 
 #include "contentmodel.h"
 #include "layoutengine.h"
+#include "pagelayout.h"
 
 class QPlainTextEdit;
 class QStackedWidget;
 class DocumentView;
 class MarkdownHighlighter;
+class StyleManager;
 
 class DocumentTab : public QWidget
 {
@@ -43,6 +46,60 @@ public:
     void setCompositionGeneration(quint64 gen) { m_compositionGeneration = gen; }
     quint64 compositionGeneration() const { return m_compositionGeneration; }
 
+    // State of the last render, diffed against when styles change so that
+    // colour-only and page-geometry edits can skip stages of the pipeline.
+    struct RenderSnapshot {
+        PageLayout pageLayout;
+        QString processedMarkdown;
+        bool webMode = false;
+        Layout::LayoutResult printLayout;
+        Layout::ContinuousLayoutResult webLayout;
+        // Per-block boxes, reused for the blocks an edit leaves alone
+        Layout::Engine::BlockElements blockElements;
+    };
+    RenderSnapshot &renderSnapshot() { return m_renderSnapshot; }
+    // Styles the snapshot was rendered with; takes ownership
+    void setSnapshotStyles(StyleManager *styles);
+    StyleManager *snapshotStyles() const { return m_snapshotStyles; }
+    bool hasRenderSnapshot() const { return m_snapshotStyles != nullptr; }
+    void clearRenderSnapshot();
+
+    // Style-independent parse of the markdown (ContentBuilder::parse),
+    // re-bound to the current styles on every rebuild.  The key hashes
+    // the markdown text; callers clear it when parse settings change.
+    struct ParseCache {
+        QByteArray key;
+        Content::Document doc;
+        QString processedMarkdown;
+    };
+    ParseCache &parseCache() { return m_parseCache; }
+    void clearParseCache()
+    {
+        m_parseCache = ParseCache();
+        m_preparedLayouts.clear();
+    }
+
+    // Block layouts of the bound document made ahead of need, while the
+    // user was idle (see IdleScheduler), keyed by what they were laid out
+    // for; cleared with the parse cache
+    QHash<QByteArray, Layout::Engine::BlockElements> &preparedLayouts() { return m_preparedLayouts; }
+
+    // The file changed on disk while the tab was in the background; it is
+    // reloaded when the tab is activated
+    void setSourceStale(bool stale) { m_sourceStale = stale; }
+    bool isSourceStale() const { return m_sourceStale; }
+
+    // Idle tracking for hibernation.  Activating a tab wakes it.
+    void setActive(bool active);
+    qint64 inactiveMsecs() const;
+
+    // Releases the view's rendered state (see DocumentView::hibernate())
+    // along with the render snapshot and prepared layouts; the parse cache
+    // and TOC data are kept.  A woken tab that needs laying out again
+    // (web mode, or a restyle) binds the kept parse instead of parsing.
+    void hibernate();
+    bool isHibernated() const;
+
 private:
     QStackedWidget *m_stack = nullptr;
     DocumentView *m_documentView = nullptr;
@@ -50,6 +107,7 @@ private:
     MarkdownHighlighter *m_highlighter = nullptr;
     QString m_filePath;
     bool m_sourceMode = false;
+    bool m_sourceStale = false;
 
     // Cached TOC data
     Content::Document m_contentDoc;
@@ -58,6 +116,14 @@ private:
 
     // Composition generation (0 = never built)
     quint64 m_compositionGeneration = 0;
+
+    RenderSnapshot m_renderSnapshot;
+    StyleManager *m_snapshotStyles = nullptr;
+    ParseCache m_parseCache;
+    QHash<QByteArray, Layout::Engine::BlockElements> m_preparedLayouts;
+
+    bool m_active = false;
+    QElapsedTimer m_inactiveTimer;
 };
 
 #endif // PRETTYREADER_DOCUMENTTAB_H
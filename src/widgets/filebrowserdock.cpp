@@ -5,12 +5,26 @@
 #include <KDirSortFilterProxyModel>
 #include <KFileItem>
 
+#include <KLocalizedString>
+
 #include <QAbstractItemView>
 #include <QDir>
+#include <QDirIterator>
+#include <QIcon>
 #include <QLineEdit>
+#include <QMenu>
 #include <QTreeView>
 #include <QVBoxLayout>
 
+static bool isMarkdownFileName(const QString &fileName)
+{
+    QString name = fileName.toLower();
+    return name.endsWith(QLatin1String(".md"))
+        || name.endsWith(QLatin1String(".markdown"))
+        || name.endsWith(QLatin1String(".mkd"))
+        || name.endsWith(QLatin1String(".txt"));
+}
+
 FileBrowserDock::FileBrowserDock(QWidget *parent)
     : QWidget(parent)
 {
@@ -40,12 +54,16 @@ FileBrowserDock::FileBrowserDock(QWidget *parent)
         m_treeView->setColumnHidden(i, true);
     m_treeView->setRootIsDecorated(true);
     m_treeView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_treeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_treeView->setContextMenuPolicy(Qt::CustomContextMenu);
     layout->addWidget(m_treeView);
 
     connect(m_treeView, &QTreeView::doubleClicked,
             this, &FileBrowserDock::onItemActivated);
     connect(m_pathEdit, &QLineEdit::returnPressed,
             this, &FileBrowserDock::onPathEdited);
+    connect(m_treeView, &QTreeView::customContextMenuRequested,
+            this, &FileBrowserDock::onContextMenuRequested);
 
     // Default to home directory
     setRootPath(QDir::homePath());
@@ -74,13 +92,8 @@ void FileBrowserDock::onItemActivated(const QModelIndex &index)
         setRootPath(item.localPath());
     } else {
         // Check if it's a markdown file
-        QString name = item.name().toLower();
-        if (name.endsWith(QLatin1String(".md"))
-            || name.endsWith(QLatin1String(".markdown"))
-            || name.endsWith(QLatin1String(".mkd"))
-            || name.endsWith(QLatin1String(".txt"))) {
+        if (isMarkdownFileName(item.name()))
             Q_EMIT fileActivated(item.url());
-        }
     }
 }
 
@@ -91,3 +104,50 @@ void FileBrowserDock::onPathEdited()
         setRootPath(path);
     }
 }
+
+QStringList FileBrowserDock::selectedMarkdownFiles() const
+{
+    QStringList files;
+    const QModelIndexList rows = m_treeView->selectionModel()->selectedRows();
+    for (const QModelIndex &index : rows) {
+        KFileItem item = m_dirModel->itemForIndex(m_proxyModel->mapToSource(index));
+        if (item.isNull() || !item.isLocalFile())
+            continue;
+
+        if (item.isDir()) {
+            QStringList inDir;
+            QDirIterator it(item.localPath(), QDir::Files | QDir::Readable,
+                            QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                QString path = it.next();
+                if (isMarkdownFileName(it.fileName()))
+                    inDir.append(path);
+            }
+            // Volumes of a manual are usually numbered: keep them in order
+            inDir.sort();
+            for (const QString &path : std::as_const(inDir)) {
+                if (!files.contains(path))
+                    files.append(path);
+            }
+        } else if (isMarkdownFileName(item.name())) {
+            if (!files.contains(item.localPath()))
+                files.append(item.localPath());
+        }
+    }
+    return files;
+}
+
+void FileBrowserDock::onContextMenuRequested(const QPoint &pos)
+{
+    const QStringList files = selectedMarkdownFiles();
+    if (files.isEmpty())
+        return;
+
+    QMenu menu(this);
+    QAction *exportAction = menu.addAction(
+        QIcon::fromTheme(QStringLiteral("document-export")),
+        i18np("Export %1 Document as PDF...", "Export %1 Documents as PDF...",
+              files.size()));
+    if (menu.exec(m_treeView->viewport()->mapToGlobal(pos)) == exportAction)
+        Q_EMIT exportPdfRequested(files);
+}
@@ -18,12 +18,18 @@ public:
     void setRootPath(const QString &path);
     QString rootPath() const;
 
+    // Markdown files in the selection; selected directories contribute
+    // every markdown file below them.
+    QStringList selectedMarkdownFiles() const;
+
 Q_SIGNALS:
     void fileActivated(const QUrl &url);
+    void exportPdfRequested(const QStringList &paths);
 
 private Q_SLOTS:
     void onItemActivated(const QModelIndex &index);
     void onPathEdited();
+    void onContextMenuRequested(const QPoint &pos);
 
 private:
     QTreeView *m_treeView = nullptr;
@@ -43,6 +43,25 @@ PrettyReaderConfigDialog::PrettyReaderConfigDialog(QWidget *parent)
     autoReloadCheck->setObjectName(QStringLiteral("kcfg_AutoReloadOnChange"));
     filesGroupLayout->addWidget(autoReloadCheck);
 
+    auto *hibernateRow = new QHBoxLayout;
+    hibernateRow->addWidget(new QLabel(i18n("Free memory of background tabs after:")));
+    auto *hibernateSpin = new QSpinBox;
+    hibernateSpin->setObjectName(QStringLiteral("kcfg_HibernateTabsAfterMinutes"));
+    hibernateSpin->setRange(0, 1440);
+    hibernateSpin->setSuffix(i18n(" min"));
+    hibernateSpin->setSpecialValueText(i18n("Never"));
+    hibernateRow->addWidget(hibernateSpin);
+    hibernateRow->addStretch();
+    filesGroupLayout->addLayout(hibernateRow);
+
+    auto *prepareCheck = new QCheckBox(i18n("Prepare other views and nearby pages while idle"));
+    prepareCheck->setObjectName(QStringLiteral("kcfg_PrepareViewsWhileIdle"));
+    filesGroupLayout->addWidget(prepareCheck);
+
+    auto *exportCacheCheck = new QCheckBox(i18n("Reuse PDFs of unchanged documents in batch export"));
+    exportCacheCheck->setObjectName(QStringLiteral("kcfg_PdfExportCache"));
+    filesGroupLayout->addWidget(exportCacheCheck);
+
     generalLayout->addWidget(filesGroup);
     generalLayout->addStretch();
 
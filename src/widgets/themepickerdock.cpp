@@ -27,7 +27,25 @@ ThemePickerDock::ThemePickerDock(ThemeManager *themeManager,
     , m_pageTemplateManager(pageTemplateManager)
     , m_themeComposer(themeComposer)
 {
+}
+
+void ThemePickerDock::showEvent(QShowEvent *event)
+{
+    ensureBuilt();
+    QWidget::showEvent(event);
+}
+
+void ThemePickerDock::ensureBuilt()
+{
+    if (m_typeSetPicker)
+        return;
     buildUI();
+
+    // Apply what was set while the dock was not built yet
+    syncPickersFromComposer();
+    if (!m_currentTemplateId.isEmpty())
+        m_templatePicker->setCurrentId(m_currentTemplateId);
+    m_templateSection->setVisible(m_printMode);
 }
 
 static QScrollArea *makeScrollArea(QWidget *content, QWidget *parent)
@@ -127,6 +145,7 @@ void ThemePickerDock::setCurrentTemplateId(const QString &id)
 
 void ThemePickerDock::setRenderMode(bool printMode)
 {
+    m_printMode = printMode;
     if (m_templateSection)
         m_templateSection->setVisible(printMode);
 }
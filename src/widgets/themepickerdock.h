@@ -40,6 +40,9 @@ public:
     // Show/hide template section based on render mode
     void setRenderMode(bool printMode);
 
+protected:
+    void showEvent(QShowEvent *event) override;
+
 Q_SIGNALS:
     void compositionApplied(); // type set or palette changed, compose() done
     void templateApplied(const PageLayout &layout);
@@ -52,6 +55,8 @@ private Q_SLOTS:
     void onTemplateSelected(const QString &id);
 
 private:
+    // The pickers render a preview per resource: build them on first show
+    void ensureBuilt();
     void buildUI();
     void composeAndNotify();
 
@@ -67,6 +72,7 @@ private:
     QWidget *m_templateSection = nullptr;
 
     QString m_currentTemplateId;
+    bool m_printMode = false;
 };
 
 #endif // PRETTYREADER_THEMEPICKERDOCK_H
@@ -94,11 +94,11 @@ void TocWidget::buildFromContentModel(const Content::Document &doc,
             std::visit([&](const auto &n) {
                 using T = std::decay_t<decltype(n)>;
                 if constexpr (std::is_same_v<T, Content::TextRun>)
-                    text += n.text;
+                    n.text.appendTo(text);
                 else if constexpr (std::is_same_v<T, Content::InlineCode>)
-                    text += n.text;
+                    n.text.appendTo(text);
                 else if constexpr (std::is_same_v<T, Content::Link>)
-                    text += n.text;
+                    n.text.appendTo(text);
             }, node);
         }
         text = text.trimmed();